@@ -0,0 +1,207 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cuda_runtime_api.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "Framework/Framework/SceneGraph.h"
+#include "Framework/Framework/Log.h"
+#include "Framework/Framework/Profiler.h"
+#include "Framework/Framework/IOPipeline.h"
+
+using namespace std;
+using namespace PhysIKA;
+
+/*
+*	Headless runner: loads a scene file, takes a fixed number of frames without any window or GL context
+*	and reports the throughput. Outputs are written by the IOModules attached to the scene.
+*
+*	Usage: physika_batch <scene.xml> [options]
+*		-frames N			number of frames to take (default 100)
+*		-fps R				frame rate of the scene graph (default 25)
+*		-timing file.csv	per-frame wall-clock time in milliseconds
+*		-profile file.json	Chrome trace of the profiled scopes
+*		-log file.txt		log file (default batch_log.txt)
+*		-io-threads N		number of writer threads of the I/O pipeline (default 2)
+*		-io-queue N			capacity of the I/O queue in frames (default 8)
+*		-io-drop			drop the oldest queued frame instead of waiting when the I/O queue is full
+*/
+
+void RecieveLogMessage(const Log::Message& m)
+{
+	switch (m.type)
+	{
+	case Log::Warning:
+		cerr << "???: " << m.text << endl; break;
+	case Log::Error:
+		cerr << "!!!: " << m.text << endl; break;
+	default: break;
+	}
+}
+
+size_t getPeakHostMemory()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return (size_t)usage.ru_maxrss * 1024;
+	return 0;
+#endif
+}
+
+size_t getDeviceMemoryUsage()
+{
+	size_t freeMem = 0;
+	size_t totalMem = 0;
+	if (cudaMemGetInfo(&freeMem, &totalMem) != cudaSuccess)
+		return 0;
+	return totalMem - freeMem;
+}
+
+void printUsage()
+{
+	cout << "Usage: physika_batch <scene.xml> [-frames N] [-fps R] [-timing file.csv] [-profile file.json] [-log file.txt]"
+		<< " [-io-threads N] [-io-queue N] [-io-drop]" << endl;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		printUsage();
+		return 1;
+	}
+
+	std::string sceneFile = argv[1];
+	int frameNum = 100;
+	float frameRate = 25.0f;
+	std::string timingFile;
+	std::string profileFile;
+	std::string logFile = "batch_log.txt";
+
+	for (int i = 2; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "-io-drop")
+		{
+			IOPipeline::getInstance().setOverflowPolicy(IOPipeline::DropOldest);
+			continue;
+		}
+
+		if (i + 1 >= argc)
+		{
+			printUsage();
+			return 1;
+		}
+
+		if (arg == "-frames")			frameNum = atoi(argv[++i]);
+		else if (arg == "-fps")			frameRate = (float)atof(argv[++i]);
+		else if (arg == "-timing")		timingFile = argv[++i];
+		else if (arg == "-profile")		profileFile = argv[++i];
+		else if (arg == "-log")			logFile = argv[++i];
+		else if (arg == "-io-threads")	IOPipeline::getInstance().setThreadNumber(atoi(argv[++i]));
+		else if (arg == "-io-queue")	IOPipeline::getInstance().setCapacity(atoi(argv[++i]));
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+
+	Log::setOutput(logFile);
+	Log::setLevel(Log::Info);
+	Log::setUserReceiver(&RecieveLogMessage);
+
+	size_t deviceBase = getDeviceMemoryUsage();
+
+	SceneGraph& scene = SceneGraph::getInstance();
+	if (!scene.load(sceneFile) || scene.getRootNode() == nullptr)
+	{
+		cerr << "Failed to load " << sceneFile << endl;
+		return 1;
+	}
+
+	scene.setFrameRate(frameRate);
+	scene.setAdaptiveInterval(false);
+
+	if (!scene.initialize())
+	{
+		cerr << "Failed to initialize " << sceneFile << endl;
+		return 1;
+	}
+
+	if (!profileFile.empty())
+	{
+		Profiler::getInstance().setMaxRecordedFrames(frameNum);
+		Profiler::getInstance().setEnabled(true);
+	}
+
+	std::vector<float> frameCost(frameNum);
+	size_t devicePeak = getDeviceMemoryUsage();
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < frameNum; i++)
+	{
+		scene.takeOneFrame();
+		frameCost[i] = scene.getTimeCostPerFrame();
+		devicePeak = std::max(devicePeak, getDeviceMemoryUsage());
+	}
+	double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	IOPipeline& io = IOPipeline::getInstance();
+	io.flush();
+	double totalWithIO = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<float> sorted = frameCost;
+	std::sort(sorted.begin(), sorted.end());
+
+	cout << "Scene:              " << sceneFile << endl;
+	cout << "Frames:             " << frameNum << endl;
+	cout << "Total time (s):     " << total << endl;
+	cout << "Frames/sec:         " << (total > 0 ? frameNum / total : 0.0) << endl;
+	if (frameNum > 0)
+	{
+		cout << "Frame time (ms):    min " << sorted.front()
+			<< ", median " << sorted[frameNum / 2]
+			<< ", max " << sorted.back() << endl;
+	}
+	cout << "Peak host memory:   " << getPeakHostMemory() / (1024.0 * 1024.0) << " MB" << endl;
+	cout << "Peak device memory: " << (devicePeak > deviceBase ? devicePeak - deviceBase : 0) / (1024.0 * 1024.0) << " MB" << endl;
+	cout << "I/O frames:         " << io.getCompletedNumber() << " written, " << io.getDroppedNumber() << " dropped, " << io.getFailedNumber() << " failed" << endl;
+	cout << "I/O queue depth:    peak " << io.getPeakQueueDepth() << " of " << io.getCapacity() << endl;
+	cout << "I/O blocked (ms):   " << io.getBlockedTime() << endl;
+	cout << "I/O drain (s):      " << totalWithIO - total << endl;
+
+	if (!timingFile.empty())
+	{
+		std::ofstream output(timingFile.c_str(), std::ios::out);
+		output << "frame,time_ms\n";
+		for (int i = 0; i < frameNum; i++)
+		{
+			output << i << "," << frameCost[i] << "\n";
+		}
+		output.close();
+	}
+
+	if (!profileFile.empty())
+	{
+		Profiler::getInstance().exportChromeTrace(profileFile);
+	}
+
+	return 0;
+}
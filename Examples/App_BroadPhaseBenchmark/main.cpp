@@ -0,0 +1,162 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "Dynamics/RigidBody/BroadPhaseDetector.h"
+#include "Dynamics/RigidBody/AABBTreeDetector.h"
+
+using namespace std;
+using namespace PhysIKA;
+
+/*
+*	Broad phase benchmark, compares SortSweepDetector and AABBTreeDetector on moving boxes.
+*
+*	Usage: App_BroadPhaseBenchmark [options]
+*		-n N				number of boxes (default 50000)
+*		-frames N			number of detected frames (default 100)
+*		-speed V			displacement per frame relative to the mean box size (default 0.05)
+*/
+
+struct Scene
+{
+	std::vector<float> center;
+	std::vector<float> size;
+	std::vector<float> velocity;
+};
+
+enum Distribution
+{
+	Uniform,
+	Clustered,
+	MixedScale
+};
+
+Scene createScene(Distribution dist, int n, float speed)
+{
+	std::default_random_engine e(0);
+	std::uniform_real_distribution<float> u(0.0f, 1.0f);
+	std::normal_distribution<float> normal(0.0f, 1.0f);
+
+	// about one box per unit cell
+	float extent = std::cbrt((float)n);
+
+	Scene scene;
+	scene.center.resize(3 * n);
+	scene.size.resize(n);
+	scene.velocity.resize(3 * n);
+
+	std::vector<float> clusters(3 * 16);
+	for (int i = 0; i < clusters.size(); ++i)
+	{
+		clusters[i] = u(e) * extent;
+	}
+
+	for (int i = 0; i < n; ++i)
+	{
+		int cluster = i % 16;
+		for (int k = 0; k < 3; ++k)
+		{
+			switch (dist)
+			{
+			case Clustered:
+				scene.center[3 * i + k] = clusters[3 * cluster + k] + normal(e) * 0.15f * extent;
+				break;
+			default:
+				scene.center[3 * i + k] = u(e) * extent;
+				break;
+			}
+			scene.velocity[3 * i + k] = (2.0f * u(e) - 1.0f) * speed * 0.5f;
+		}
+
+		// sizes from 0.05 to 5, most boxes are small
+		scene.size[i] = dist == MixedScale ? 0.05f * std::pow(100.0f, u(e) * u(e) * u(e)) : 0.5f;
+	}
+
+	return scene;
+}
+
+void updateBoxes(Scene& scene, std::vector<BoxAABB3d<float>>& boxes, bool move)
+{
+	int n = scene.size.size();
+	boxes.resize(n);
+	for (int i = 0; i < n; ++i)
+	{
+		float* c = &scene.center[3 * i];
+		if (move)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				c[k] += scene.velocity[3 * i + k];
+			}
+		}
+
+		float h = 0.5f * scene.size[i];
+		boxes[i] = BoxAABB3d<float>(c[0] - h, c[1] - h, c[2] - h, c[0] + h, c[1] + h, c[2] + h);
+	}
+}
+
+double benchmark(BroadPhaseDetector<float>& detector, Scene scene, int frames, size_t& pair_num)
+{
+	std::vector<BoxAABB3d<float>> boxes;
+
+	// the first call builds the structure
+	updateBoxes(scene, boxes, false);
+	detector.reset();
+	pair_num = detector.detect(boxes).size();
+
+	double ms = 0;
+	for (int i = 0; i < frames; ++i)
+	{
+		updateBoxes(scene, boxes, true);
+
+		auto t0 = std::chrono::steady_clock::now();
+		pair_num = detector.detect(boxes).size();
+		ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	}
+
+	return ms / frames;
+}
+
+int main(int argc, char** argv)
+{
+	int n = 50000;
+	int frames = 100;
+	float speed = 0.05f;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string arg = argv[i];
+		if (arg == "-n")				n = atoi(argv[i + 1]);
+		else if (arg == "-frames")		frames = atoi(argv[i + 1]);
+		else if (arg == "-speed")		speed = (float)atof(argv[i + 1]);
+	}
+
+	const char* names[3] = { "uniform", "clustered", "mixed scale" };
+	Distribution dists[3] = { Uniform, Clustered, MixedScale };
+
+	cout << n << " boxes, " << frames << " frames" << endl;
+	for (int d = 0; d < 3; ++d)
+	{
+		Scene scene = createScene(dists[d], n, speed);
+
+		SortSweepDetector<float> sap;
+		AABBTreeDetector<float> tree;
+
+		// a box may move a few frames before it leaves its fattened bounds
+		tree.setMargin(2.0f * speed, 0.1f);
+
+		size_t sap_pairs = 0, tree_pairs = 0;
+		double sap_ms = benchmark(sap, scene, frames, sap_pairs);
+		double tree_ms = benchmark(tree, scene, frames, tree_pairs);
+
+		cout << names[d] << ": SortSweepDetector " << sap_ms << " ms/frame, AABBTreeDetector " << tree_ms << " ms/frame, "
+			<< tree_pairs << " pairs" << (sap_pairs == tree_pairs ? "" : " (pair count differs!)") << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,178 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+
+#include "Dynamics/RigidBody/RigidBodyRoot.h"
+#include "Dynamics/RigidBody/RevoluteJoint.h"
+#include "Dynamics/RigidBody/SphericalJoint.h"
+#include "Dynamics/RigidBody/ForwardDynamicsSolver.h"
+#include "Dynamics/RigidBody/SparseInertiaMatrixFDSolver.h"
+#include "Dynamics/RigidBody/ArticulatedBodyFDSolver.h"
+#include "Dynamics/RigidBody/RigidBatchIntegrator.h"
+
+using namespace std;
+using namespace PhysIKA;
+
+/*
+*	Forward dynamics benchmark on a branched articulated body: a torso attached to the base by a spherical joint
+*	with a number of limbs, each a chain of revolute links.
+*
+*	Usage: App_RigidBenchmark [options]
+*		-limbs N			number of limbs attached to the torso (default 4)
+*		-links N			number of links per limb (default 8)
+*		-iterations N		number of solves per solver (default 1000)
+*		-envs N				also step N environments in a batch and report env-steps/s (default 0)
+*		-steps N			number of batched steps (default 100)
+*/
+
+RigidBodyRoot_ptr createBranchedBody(int limbNum, int linkNum)
+{
+	std::default_random_engine e(0);
+	std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+
+	RigidBodyRoot_ptr root = std::make_shared<RigidBodyRoot<DataType3f>>("rigid_root");
+
+	std::vector<RigidBody2_ptr> bodies;
+	std::vector<std::shared_ptr<Joint>> joints;
+
+	auto attach = [&](RigidBody2_ptr parent, std::shared_ptr<Joint> joint) {
+		RigidBody2_ptr body = std::make_shared<RigidBody2<DataType3f>>("link");
+		parent->addChild(body);
+		joint->setRigidBody(parent.get(), body.get());
+		parent->addChildJoint(joint);
+		body->setParentJoint(joint.get());
+		bodies.push_back(body);
+		joints.push_back(joint);
+		return body;
+	};
+
+	Vector3f half(0, -0.5f, 0);
+
+	auto torsoJoint = std::make_shared<SphericalJoint>("torso_joint");
+	RigidBody2_ptr torso = attach(root, torsoJoint);
+	torsoJoint->setJointInfo(-half);
+
+	for (int i = 0; i < limbNum; ++i)
+	{
+		RigidBody2_ptr last = torso;
+		for (int j = 0; j < linkNum; ++j)
+		{
+			auto joint = std::make_shared<RevoluteJoint>("limb_joint");
+			last = attach(last, joint);
+
+			Vector3f axis(u(e), u(e), u(e));
+			joint->setJointInfo(axis / axis.norm(), -half);
+		}
+	}
+
+	root->updateTree();
+
+	std::shared_ptr<SystemMotionState> motion_state = root->getSystemState()->m_motionState;
+	const std::vector<int>& idx_map = root->getJointIdxMap();
+	for (int i = 0; i < bodies.size(); ++i)
+	{
+		int id = bodies[i]->getId();
+		motion_state->m_rel_r[id] = Vector3f(0, -1.0f, 0);
+		motion_state->m_rel_q[id] = Quaternion<float>(Vector3f(u(e), u(e), u(e)), u(e));
+		bodies[i]->setI(Inertia<float>(1.0f, Vector3f(0.1f, 0.02f, 0.1f)));
+
+		int dof = joints[i]->getJointDOF();
+		for (int k = 0; k < dof; ++k)
+		{
+			motion_state->m_dq[idx_map[id] + k] = u(e);
+		}
+		if (dof > 0)
+		{
+			motion_state->m_v[id] = joints[i]->getJointSpace().mul(&(motion_state->m_dq[idx_map[id]]));
+		}
+	}
+	motion_state->updateGlobalInfo();
+
+	return root;
+}
+
+double benchmark(const std::string& name, ForwardDynamicsSolver& solver, RigidBodyRoot_ptr root, int iterations, Vectornd<float>& ddq)
+{
+	solver.setParent(root.get());
+
+	const SystemState& system_state = *(root->getSystemState());
+	const SystemMotionState& motion_state = *(system_state.m_motionState);
+
+	// warm up, also sizes the solver buffers
+	solver.solve(system_state, motion_state, ddq);
+
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		solver.solve(system_state, motion_state, ddq);
+	}
+	double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / iterations;
+
+	cout << name << ": " << us << " us/solve" << endl;
+	return us;
+}
+
+float maxDifference(const Vectornd<float>& a, const Vectornd<float>& b)
+{
+	float diff = 0;
+	for (int i = 0; i < a.size(); ++i)
+	{
+		diff = std::max(diff, std::abs(a[i] - b[i]));
+	}
+	return diff;
+}
+
+int main(int argc, char** argv)
+{
+	int limbNum = 4;
+	int linkNum = 8;
+	int iterations = 1000;
+	int envNum = 0;
+	int stepNum = 100;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string arg = argv[i];
+		if (arg == "-limbs")			limbNum = atoi(argv[i + 1]);
+		else if (arg == "-links")		linkNum = atoi(argv[i + 1]);
+		else if (arg == "-iterations")	iterations = atoi(argv[i + 1]);
+		else if (arg == "-envs")		envNum = atoi(argv[i + 1]);
+		else if (arg == "-steps")		stepNum = atoi(argv[i + 1]);
+	}
+
+	RigidBodyRoot_ptr root = createBranchedBody(limbNum, linkNum);
+	cout << "Bodies: " << root->getAllNode().size() << ", dofs: " << root->getJointDof() << endl;
+
+	InertiaMatrixFDSolver dense;
+	SparseInertiaMatrixFDSolver sparse;
+	ArticulatedBodyFDSolver aba;
+
+	Vectornd<float> ddq_dense, ddq_sparse, ddq_aba;
+	benchmark("InertiaMatrixFDSolver", dense, root, iterations, ddq_dense);
+	benchmark("SparseInertiaMatrixFDSolver", sparse, root, iterations, ddq_sparse);
+	benchmark("ArticulatedBodyFDSolver", aba, root, iterations, ddq_aba);
+
+	cout << "Max difference to the dense solve: sparse " << maxDifference(ddq_sparse, ddq_dense)
+		<< ", articulated body " << maxDifference(ddq_aba, ddq_dense) << endl;
+
+	if (envNum > 0)
+	{
+		RigidBatchIntegrator batch(root.get());
+		batch.setEnvironmentNum(envNum);
+
+		auto t0 = std::chrono::steady_clock::now();
+		for (int i = 0; i < stepNum; ++i)
+		{
+			batch.step(0.001);
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+		cout << "Batch of " << envNum << " environments: " << envNum * stepNum / seconds << " env-steps/s" << endl;
+	}
+
+	return 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <cassert>
+#include <cstring>
 #include <vector>
 #include <cuda_runtime.h>
 #include <memory>
@@ -19,6 +20,7 @@ namespace PhysIKA {
 		Array(const std::shared_ptr<MemoryManager<deviceType>> alloc = std::make_shared<DefaultMemoryManager<deviceType>>())
 			: m_data(NULL)
 			, m_totalNum(0)
+			, m_capacity(0)
 			, m_alloc(alloc)
 		{
 		};
@@ -26,6 +28,7 @@ namespace PhysIKA {
 		Array(int num, const std::shared_ptr<MemoryManager<deviceType>> alloc = std::make_shared<DefaultMemoryManager<deviceType>>())
 			: m_data(NULL)
 			, m_totalNum(num)
+			, m_capacity(0)
 			, m_alloc(alloc)
 		{
 			allocMemory();
@@ -36,8 +39,26 @@ namespace PhysIKA {
 		*/
 		~Array() {};
 
+		/*!
+		*	\brief	Resize the array and clear all data to zero, the allocated memory is reused if it is large enough.
+		*/
 		void resize(int n);
 
+		/*!
+		*	\brief	Make room for at least n elements, the existing data is kept.
+		*/
+		void reserve(int n);
+
+		/*!
+		*	\brief	Append all elements of arr, the capacity grows geometrically so that repeated appends are amortized O(arr.size()).
+		*/
+		void append(const Array<T, deviceType>& arr);
+
+		/*!
+		*	\brief	Release the memory beyond size().
+		*/
+		void shrinkToFit();
+
 		/*!
 		*	\brief	Clear all data to zero.
 		*/
@@ -60,6 +81,10 @@ namespace PhysIKA {
 			T* tp = arr.m_data;
 			arr.m_data = m_data;
 			m_data = tp;
+
+			int cap = arr.m_capacity;
+			arr.m_capacity = m_capacity;
+			m_capacity = cap;
 		}
 
 		COMM_FUNC inline T& operator [] (unsigned int id)
@@ -73,16 +98,19 @@ namespace PhysIKA {
 		}
 
 		COMM_FUNC inline int size() { return m_totalNum; }
+		COMM_FUNC inline int capacity() { return m_capacity; }
 		COMM_FUNC inline bool isCPU() { return deviceType == DeviceType::CPU; }
 		COMM_FUNC inline bool isGPU() { return deviceType == DeviceType::GPU; }
 		COMM_FUNC inline bool isEmpty() { return m_data == NULL; }
 
 	protected:
 		void allocMemory();
+		void copyMemory(T* dst, const T* src, int num);
 		
 	private:
 		T* m_data;
 		int m_totalNum;
+		int m_capacity;
 		std::shared_ptr<MemoryManager<deviceType>> m_alloc;
 	};
 
@@ -90,6 +118,13 @@ namespace PhysIKA {
 	void Array<T, deviceType>::resize(const int n)
 	{
 //		assert(n >= 1);
+		if (NULL != m_data && n > 0 && n <= m_capacity)
+		{
+			m_totalNum = n;
+			reset();
+			return;
+		}
+
 		if (NULL != m_data) release();
 		if (n <= 0)
 		{
@@ -102,6 +137,81 @@ namespace PhysIKA {
 		}
 	}
 
+	template<typename T, DeviceType deviceType>
+	void Array<T, deviceType>::reserve(int n)
+	{
+		if (n <= m_capacity) return;
+
+		T* data = NULL;
+		m_alloc->allocMemory1D((void**)&data, n, sizeof(T));
+		m_alloc->initMemory((void*)data, 0, n * sizeof(T));
+
+		if (m_data != NULL)
+		{
+			copyMemory(data, m_data, m_totalNum);
+			m_alloc->releaseMemory((void**)&m_data);
+		}
+
+		m_data = data;
+		m_capacity = n;
+	}
+
+	template<typename T, DeviceType deviceType>
+	void Array<T, deviceType>::append(const Array<T, deviceType>& arr)
+	{
+		assert(&arr != this);
+
+		int num = arr.m_totalNum;
+		if (num <= 0) return;
+
+		int total = m_totalNum + num;
+		if (total > m_capacity)
+		{
+			reserve(total > 2 * m_capacity ? total : 2 * m_capacity);
+		}
+
+		copyMemory(m_data + m_totalNum, arr.m_data, num);
+		m_totalNum = total;
+	}
+
+	template<typename T, DeviceType deviceType>
+	void Array<T, deviceType>::shrinkToFit()
+	{
+		if (m_capacity == m_totalNum) return;
+
+		if (m_totalNum <= 0)
+		{
+			release();
+			return;
+		}
+
+		T* data = NULL;
+		m_alloc->allocMemory1D((void**)&data, m_totalNum, sizeof(T));
+		copyMemory(data, m_data, m_totalNum);
+		m_alloc->releaseMemory((void**)&m_data);
+
+		m_data = data;
+		m_capacity = m_totalNum;
+	}
+
+	template<typename T, DeviceType deviceType>
+	void Array<T, deviceType>::copyMemory(T* dst, const T* src, int num)
+	{
+		if (num <= 0) return;
+
+		switch (deviceType)
+		{
+		case CPU:
+			memcpy((void*)dst, (const void*)src, num * sizeof(T));
+			break;
+		case GPU:
+			cudaMemcpy(dst, src, num * sizeof(T), cudaMemcpyDeviceToDevice);
+			break;
+		default:
+			break;
+		}
+	}
+
 	template<typename T, DeviceType deviceType>
 	void Array<T, deviceType>::release()
 	{
@@ -126,6 +236,7 @@ namespace PhysIKA {
 		
 		m_data = NULL;
 		m_totalNum = 0;
+		m_capacity = 0;
 	}
 
 	template<typename T, DeviceType deviceType>
@@ -143,8 +254,8 @@ namespace PhysIKA {
 // 			break;
 // 		}
 
-		printf("%d %d\n", m_totalNum, sizeof(T));
 		m_alloc->allocMemory1D((void**)&m_data, m_totalNum, sizeof(T));
+		m_capacity = m_totalNum;
 
 		reset();
 	}
@@ -0,0 +1,192 @@
+#include "PooledMemoryManager.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace PhysIKA {
+
+	template<DeviceType deviceType>
+	PooledMemoryManager<deviceType>::PooledMemoryManager()
+		: m_requests(0)
+		, m_hits(0)
+		, m_bytesInUse(0)
+		, m_peakBytes(0)
+		, m_bytesReserved(0)
+	{
+	}
+
+	template<DeviceType deviceType>
+	PooledMemoryManager<deviceType>::~PooledMemoryManager()
+	{
+		trim();
+	}
+
+	template<DeviceType deviceType>
+	std::shared_ptr<PooledMemoryManager<deviceType>> PooledMemoryManager<deviceType>::getInstance()
+	{
+		static std::shared_ptr<PooledMemoryManager<deviceType>> instance = std::make_shared<PooledMemoryManager<deviceType>>();
+		return instance;
+	}
+
+	template<DeviceType deviceType>
+	int PooledMemoryManager<deviceType>::sizeClass(size_t bytes)
+	{
+		int cls = MIN_CLASS;
+		while ((size_t(1) << cls) < bytes)
+		{
+			cls++;
+		}
+		return cls;
+	}
+
+	template<DeviceType deviceType>
+	size_t PooledMemoryManager<deviceType>::roundUp(size_t bytes)
+	{
+		return size_t(1) << sizeClass(bytes);
+	}
+
+	template<DeviceType deviceType>
+	typename PooledMemoryManager<deviceType>::FreeListStripe& PooledMemoryManager<deviceType>::currentStripe()
+	{
+		size_t id = std::hash<std::thread::id>()(std::this_thread::get_id());
+		return m_stripes[id % STRIPE_NUM];
+	}
+
+	template<DeviceType deviceType>
+	typename PooledMemoryManager<deviceType>::BlockClassShard& PooledMemoryManager<deviceType>::blockShard(void* ptr)
+	{
+		//Blocks are at least 256 byte aligned, mix the address bits before picking a shard
+		size_t h = reinterpret_cast<size_t>(ptr) * size_t(0x9E3779B97F4A7C15ull);
+		return m_blockShards[(h >> 32) % STRIPE_NUM];
+	}
+
+	template<DeviceType deviceType>
+	void PooledMemoryManager<deviceType>::allocMemory1D(void** ptr, size_t memsize, size_t valueSize)
+	{
+		int cls = sizeClass(std::max(memsize * valueSize, size_t(1)));
+		size_t blockSize = size_t(1) << cls;
+
+		m_requests++;
+
+		*ptr = nullptr;
+		if (cls < CLASS_NUM)
+		{
+			FreeListStripe& stripe = currentStripe();
+			std::lock_guard<std::mutex> lock(stripe.mutex);
+			if (!stripe.blocks[cls].empty())
+			{
+				*ptr = stripe.blocks[cls].back();
+				stripe.blocks[cls].pop_back();
+				m_hits++;
+			}
+		}
+
+		if (*ptr == nullptr)
+		{
+			m_alloc.allocMemory1D(ptr, blockSize, 1);
+			m_bytesReserved += blockSize;
+
+			BlockClassShard& shard = blockShard(*ptr);
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			shard.classes[*ptr] = cls;
+		}
+
+		size_t inUse = (m_bytesInUse += blockSize);
+		size_t peak = m_peakBytes.load();
+		while (inUse > peak && !m_peakBytes.compare_exchange_weak(peak, inUse)) {}
+	}
+
+	template<DeviceType deviceType>
+	void PooledMemoryManager<deviceType>::allocMemory2D(void** ptr, size_t& pitch, size_t height, size_t width, size_t valueSize)
+	{
+		pitch = width * valueSize;
+		allocMemory1D(ptr, height * width, valueSize);
+	}
+
+	template<DeviceType deviceType>
+	void PooledMemoryManager<deviceType>::initMemory(void* ptr, int value, size_t count)
+	{
+		m_alloc.initMemory(ptr, value, count);
+	}
+
+	template<DeviceType deviceType>
+	void PooledMemoryManager<deviceType>::releaseMemory(void** ptr)
+	{
+		BlockClassShard& shard = blockShard(*ptr);
+
+		int cls = -1;
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			auto it = shard.classes.find(*ptr);
+			if (it != shard.classes.end())
+			{
+				cls = it->second;
+			}
+		}
+
+		//Not allocated by this pool
+		if (cls < 0)
+		{
+			m_alloc.releaseMemory(ptr);
+			return;
+		}
+
+		m_bytesInUse -= size_t(1) << cls;
+
+		if (cls < CLASS_NUM)
+		{
+			FreeListStripe& stripe = currentStripe();
+			std::lock_guard<std::mutex> lock(stripe.mutex);
+			stripe.blocks[cls].push_back(*ptr);
+			*ptr = nullptr;
+		}
+		else
+		{
+			{
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				shard.classes.erase(*ptr);
+			}
+			m_bytesReserved -= size_t(1) << cls;
+			m_alloc.releaseMemory(ptr);
+		}
+	}
+
+	template<DeviceType deviceType>
+	void PooledMemoryManager<deviceType>::trim()
+	{
+		for (int s = 0; s < STRIPE_NUM; s++)
+		{
+			FreeListStripe& stripe = m_stripes[s];
+			std::lock_guard<std::mutex> stripeLock(stripe.mutex);
+			for (int cls = 0; cls < CLASS_NUM; cls++)
+			{
+				for (void* block : stripe.blocks[cls])
+				{
+					{
+						BlockClassShard& shard = blockShard(block);
+						std::lock_guard<std::mutex> lock(shard.mutex);
+						shard.classes.erase(block);
+					}
+					m_bytesReserved -= size_t(1) << cls;
+					m_alloc.releaseMemory(&block);
+				}
+				stripe.blocks[cls].clear();
+			}
+		}
+	}
+
+	template<DeviceType deviceType>
+	PoolStatistics PooledMemoryManager<deviceType>::getStatistics()
+	{
+		PoolStatistics stat;
+		stat.requests = m_requests.load();
+		stat.hits = m_hits.load();
+		stat.bytesInUse = m_bytesInUse.load();
+		stat.peakBytes = m_peakBytes.load();
+		stat.bytesReserved = m_bytesReserved.load();
+		return stat;
+	}
+
+	template class PooledMemoryManager<DeviceType::CPU>;
+	template class PooledMemoryManager<DeviceType::GPU>;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "MemoryManager.h"
+
+namespace PhysIKA {
+
+	/**
+	 * @brief Allocation statistics of a PooledMemoryManager
+	 */
+	struct PoolStatistics
+	{
+		size_t requests = 0;		//!< Number of allocMemory1D() calls
+		size_t hits = 0;			//!< Number of requests served from a free list
+		size_t bytesInUse = 0;		//!< Bytes currently handed out, rounded up to the size classes
+		size_t peakBytes = 0;		//!< Maximum of bytesInUse
+		size_t bytesReserved = 0;	//!< Bytes currently obtained from the system, including cached blocks
+
+		double hitRate() const { return requests == 0 ? 0.0 : double(hits) / double(requests); }
+	};
+
+	/**
+	 * @brief Caching allocator that rounds requests up to power-of-two size classes and keeps released blocks
+	 * in free lists, so that arrays resized every frame stop hitting malloc/cudaMalloc.
+	 *
+	 * Free lists are striped by thread id, a block released by a thread is reused by the next request from the same thread.
+	 * Cached blocks are only returned to the system by trim() or when the manager is destroyed.
+	 */
+	template<DeviceType deviceType>
+	class PooledMemoryManager : public MemoryManager<deviceType> {
+
+	public:
+		PooledMemoryManager();
+
+		~PooledMemoryManager() override;
+
+		/**
+		 * @brief A pool shared by all arrays that are constructed with it
+		 */
+		static std::shared_ptr<PooledMemoryManager<deviceType>> getInstance();
+
+		void allocMemory1D(void** ptr, size_t memsize, size_t valueSize) override;
+
+		void allocMemory2D(void** ptr, size_t& pitch, size_t height, size_t width, size_t valueSize) override;
+
+		void initMemory(void* ptr, int value, size_t count) override;
+
+		void releaseMemory(void** ptr) override;
+
+		/**
+		 * @brief Return all cached blocks to the system
+		 */
+		void trim();
+
+		PoolStatistics getStatistics();
+
+		/**
+		 * @brief Size in bytes of the block that serves a request of the given size
+		 */
+		static size_t roundUp(size_t bytes);
+
+	private:
+		static const int MIN_CLASS = 8;		// 256 bytes
+		static const int CLASS_NUM = 48;
+		static const int STRIPE_NUM = 16;
+
+		static int sizeClass(size_t bytes);
+
+		struct FreeListStripe
+		{
+			std::mutex mutex;
+			std::vector<void*> blocks[CLASS_NUM];
+		};
+
+		/**
+		 * @brief Size classes of the blocks owned by the pool, sharded by address so that a release only locks its own shard
+		 */
+		struct BlockClassShard
+		{
+			std::mutex mutex;
+			std::unordered_map<void*, int> classes;
+		};
+
+		FreeListStripe& currentStripe();
+
+		BlockClassShard& blockShard(void* ptr);
+
+		DefaultMemoryManager<deviceType> m_alloc;
+
+		FreeListStripe m_stripes[STRIPE_NUM];
+		BlockClassShard m_blockShards[STRIPE_NUM];
+
+		std::atomic<size_t> m_requests;
+		std::atomic<size_t> m_hits;
+		std::atomic<size_t> m_bytesInUse;
+		std::atomic<size_t> m_peakBytes;
+		std::atomic<size_t> m_bytesReserved;
+	};
+}
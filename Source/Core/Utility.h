@@ -10,4 +10,5 @@
 #include "Utility/Arithmetic.h"
 #include "Utility/CTimer.h"
 #include "Utility/GTimer.h"
-#include "Utility/Scan.h"
\ No newline at end of file
+#include "Utility/Scan.h"
+#include "Utility/ThreadPool.h"
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "MappedFile.h"
+
+#if (defined __unix__) || (defined __APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif (defined _WIN32)
+#include <windows.h>
+#endif
+
+namespace PhysIKA {
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	bool MappedFile::open(const std::string& filename)
+	{
+		close();
+
+#if (defined __unix__) || (defined __APPLE__)
+		int fd = ::open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) != 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		m_size = (size_t)st.st_size;
+		if (m_size > 0)
+		{
+			void* ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (ptr == MAP_FAILED)
+			{
+				::close(fd);
+				m_size = 0;
+				return false;
+			}
+			m_data = (const char*)ptr;
+		}
+
+		// the mapping stays valid after the descriptor is closed
+		::close(fd);
+#elif (defined _WIN32)
+		HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		m_file = file;
+		m_size = (size_t)size.QuadPart;
+		if (m_size > 0)
+		{
+			HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			const void* ptr = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+			if (ptr == NULL)
+			{
+				if (mapping)
+				{
+					CloseHandle(mapping);
+				}
+				CloseHandle(file);
+				m_file = nullptr;
+				m_size = 0;
+				return false;
+			}
+			m_mapping = mapping;
+			m_data = (const char*)ptr;
+		}
+#else
+		return false;
+#endif
+
+		m_open = true;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+#if (defined __unix__) || (defined __APPLE__)
+		if (m_data)
+		{
+			munmap((void*)m_data, m_size);
+		}
+#elif (defined _WIN32)
+		if (m_data)
+		{
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping)
+		{
+			CloseHandle(m_mapping);
+		}
+		if (m_file)
+		{
+			CloseHandle(m_file);
+		}
+		m_mapping = nullptr;
+		m_file = nullptr;
+#endif
+
+		m_data = nullptr;
+		m_size = 0;
+		m_open = false;
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace PhysIKA {
+
+	/*!
+	*	\class	MappedFile
+	*	\brief	Read only view of a whole file mapped into memory.
+	*
+	*	The mapping is released when the object is closed or destroyed. An empty file can be opened but
+	*	has no data.
+	*/
+	class MappedFile
+	{
+	public:
+		MappedFile() {}
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool open(const std::string& filename);
+		void close();
+
+		bool isOpen() const { return m_open; }
+		const char* data() const { return m_data; }
+		size_t size() const { return m_size; }
+
+	private:
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+		bool m_open = false;
+
+#if (defined _WIN32)
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif
+	};
+}
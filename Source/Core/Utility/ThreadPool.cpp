@@ -0,0 +1,240 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace PhysIKA {
+
+	ThreadPool::ThreadPool(unsigned int num)
+		: m_pending(0)
+		, m_nextQueue(0)
+	{
+		start(num);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		stop();
+	}
+
+	ThreadPool& ThreadPool::getInstance()
+	{
+		static ThreadPool instance;
+		return instance;
+	}
+
+	void ThreadPool::setThreadNum(unsigned int num)
+	{
+		stop();
+		start(num);
+	}
+
+	void ThreadPool::start(unsigned int num)
+	{
+		if (num == 0)
+		{
+			num = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		m_stop = false;
+
+		//The calling thread also executes tasks, so only num - 1 workers are spawned
+		unsigned int workerNum = num - 1;
+		for (unsigned int i = 0; i < workerNum; i++)
+		{
+			m_queues.emplace_back(new WorkQueue);
+		}
+
+		for (unsigned int i = 0; i < workerNum; i++)
+		{
+			m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+		}
+	}
+
+	void ThreadPool::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wakeup.notify_all();
+
+		for (auto& worker : m_workers)
+		{
+			worker.join();
+		}
+
+		m_workers.clear();
+		m_queues.clear();
+		m_pending = 0;
+	}
+
+	void ThreadPool::pushTask(unsigned int queueId, Task task)
+	{
+		WorkQueue& queue = *m_queues[queueId];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+		}
+		m_pending++;
+	}
+
+	bool ThreadPool::acquireTask(unsigned int workerId, Task& task)
+	{
+		unsigned int queueNum = (unsigned int)m_queues.size();
+
+		//Take the most recent task from the worker's own queue
+		if (workerId < queueNum)
+		{
+			WorkQueue& queue = *m_queues[workerId];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+				m_pending--;
+				return true;
+			}
+		}
+
+		//Steal the oldest task from one of the other queues
+		for (unsigned int i = 1; i <= queueNum; i++)
+		{
+			WorkQueue& queue = *m_queues[(workerId + i) % queueNum];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				m_pending--;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void ThreadPool::workerLoop(unsigned int workerId)
+	{
+		Task task;
+		while (true)
+		{
+			if (acquireTask(workerId, task))
+			{
+				task();
+				task = nullptr;
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeup.wait(lock, [this] { return m_stop || m_pending.load() > 0; });
+			if (m_stop)
+			{
+				return;
+			}
+		}
+	}
+
+	void ThreadPool::parallelRange(int size, const std::function<void(int, int)>& func, int grain)
+	{
+		if (size <= 0) return;
+
+		int threadNum = (int)getThreadNum();
+		if (grain <= 0)
+		{
+			//A few chunks per thread leaves room for stealing when the work is unbalanced
+			grain = std::max(1, size / (threadNum * 8));
+		}
+
+		if (threadNum == 1 || size <= grain)
+		{
+			func(0, size);
+			return;
+		}
+
+		int chunkNum = (size + grain - 1) / grain;
+		std::atomic<int> remaining(chunkNum);
+
+		unsigned int queueNum = (unsigned int)m_queues.size();
+		unsigned int first = m_nextQueue++;
+		for (int c = 0; c < chunkNum; c++)
+		{
+			int begin = c * grain;
+			int end = std::min(size, begin + grain);
+			pushTask((first + c) % queueNum, [&func, &remaining, begin, end] {
+				func(begin, end);
+				remaining.fetch_sub(1, std::memory_order_release);
+			});
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+		}
+		m_wakeup.notify_all();
+
+		//The caller has no queue of its own and steals until every chunk is finished
+		Task task;
+		while (remaining.load(std::memory_order_acquire) > 0)
+		{
+			if (acquireTask(queueNum, task))
+			{
+				task();
+				task = nullptr;
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	int exclusiveScanHost(int* data, int size)
+	{
+		if (size <= 0) return 0;
+
+		ThreadPool& pool = ThreadPool::getInstance();
+		int blockNum = std::min((int)pool.getThreadNum() * 4, (size + 4095) / 4096);
+		if (blockNum <= 1)
+		{
+			int sum = 0;
+			for (int i = 0; i < size; i++)
+			{
+				int val = data[i];
+				data[i] = sum;
+				sum += val;
+			}
+			return sum;
+		}
+
+		//Scan each block locally, then shift every block by the sum of the blocks in front of it
+		int blockSize = (size + blockNum - 1) / blockNum;
+		std::vector<int> blockSum(blockNum + 1, 0);
+		pool.parallelFor(blockNum, [&](int b) {
+			int begin = b * blockSize;
+			int end = std::min(size, begin + blockSize);
+			int sum = 0;
+			for (int i = begin; i < end; i++)
+			{
+				int val = data[i];
+				data[i] = sum;
+				sum += val;
+			}
+			blockSum[b + 1] = sum;
+		}, 1);
+
+		for (int b = 0; b < blockNum; b++)
+		{
+			blockSum[b + 1] += blockSum[b];
+		}
+
+		pool.parallelFor(blockNum, [&](int b) {
+			int begin = b * blockSize;
+			int end = std::min(size, begin + blockSize);
+			int offset = blockSum[b];
+			for (int i = begin; i < end; i++)
+			{
+				data[i] += offset;
+			}
+		}, 1);
+
+		return blockSum[blockNum];
+	}
+}
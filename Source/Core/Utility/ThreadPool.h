@@ -0,0 +1,174 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace PhysIKA {
+
+	/*!
+	*	\class	ThreadPool
+	*	\brief	A work-stealing thread pool used to execute per-element kernels on the host.
+	*
+	*	Every worker owns a task queue. Workers pop tasks from the back of their own queue and steal
+	*	from the front of the others' once it runs dry. The thread calling parallelFor() takes part in
+	*	the execution as well, so nested calls never deadlock.
+	*/
+	class ThreadPool
+	{
+	public:
+		/*!
+		*	\param	num	Total number of threads including the calling thread, 0 means hardware concurrency.
+		*/
+		explicit ThreadPool(unsigned int num = 0);
+		~ThreadPool();
+
+		static ThreadPool& getInstance();
+
+		/*!
+		*	\brief	Restart the pool with num threads, 0 means hardware concurrency.
+		*/
+		void setThreadNum(unsigned int num);
+		unsigned int getThreadNum() { return (unsigned int)m_workers.size() + 1; }
+
+		/*!
+		*	\brief	Call func(begin, end) over consecutive chunks of [0, size), returns after all chunks are done.
+		*	\param	grain	Number of elements per chunk, 0 lets the pool choose.
+		*/
+		void parallelRange(int size, const std::function<void(int, int)>& func, int grain = 0);
+
+		/*!
+		*	\brief	Call func(i) for each i in [0, size).
+		*/
+		template<typename Function>
+		void parallelFor(int size, Function func, int grain = 0)
+		{
+			parallelRange(size, [&func](int begin, int end) {
+				for (int i = begin; i < end; i++)
+				{
+					func(i);
+				}
+			}, grain);
+		}
+
+	private:
+		typedef std::function<void()> Task;
+
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		void start(unsigned int num);
+		void stop();
+
+		void pushTask(unsigned int queueId, Task task);
+		bool acquireTask(unsigned int workerId, Task& task);
+
+		void workerLoop(unsigned int workerId);
+
+		std::vector<std::thread> m_workers;
+		std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+		std::atomic<int> m_pending;
+		std::atomic<unsigned int> m_nextQueue;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wakeup;
+		bool m_stop = false;
+	};
+
+	/*!
+	*	\brief	Host counterpart of atomicAdd(), used by scatter-style host kernels.
+	*/
+	template<typename T>
+	inline void atomicAddHost(T* address, T val)
+	{
+		std::atomic<T>* target = reinterpret_cast<std::atomic<T>*>(address);
+		T expected = target->load(std::memory_order_relaxed);
+		while (!target->compare_exchange_weak(expected, expected + val, std::memory_order_relaxed)) {}
+	}
+
+	/*!
+	*	\class	ScatterBuffer
+	*	\brief	Host counterpart of scatter-style kernels that add to both particles of a pair, without atomics.
+	*
+	*	[0, size) is split into one block per thread, every block accumulates into its own zero-initialized copy of
+	*	the output, the copies are summed into the output afterwards. The copies are kept between calls.
+	*/
+	template<typename T>
+	class ScatterBuffer
+	{
+	public:
+		/*!
+		*	\brief	Call func(i, acc) for each i in [0, size), func may add to any of acc[0, num). The accumulations are added to data[0, num).
+		*/
+		template<typename Function>
+		void scatter(T* data, int num, int size, Function func)
+		{
+			if (num <= 0 || size <= 0) return;
+
+			ThreadPool& pool = ThreadPool::getInstance();
+			int blockNum = std::min((int)pool.getThreadNum(), (size + 1023) / 1024);
+			if (blockNum <= 1)
+			{
+				for (int i = 0; i < size; i++)
+				{
+					func(i, data);
+				}
+				return;
+			}
+
+			m_buffer.assign((size_t)blockNum * num, T());
+
+			int blockSize = (size + blockNum - 1) / blockNum;
+			pool.parallelFor(blockNum, [&](int b) {
+				T* acc = m_buffer.data() + (size_t)b * num;
+				int end = std::min(size, (b + 1) * blockSize);
+				for (int i = b * blockSize; i < end; i++)
+				{
+					func(i, acc);
+				}
+			}, 1);
+
+			//Blocks are summed in a fixed order, so the result only depends on the number of threads
+			pool.parallelFor(num, [&](int k) {
+				T sum = data[k];
+				for (int b = 0; b < blockNum; b++)
+				{
+					sum += m_buffer[(size_t)b * num + k];
+				}
+				data[k] = sum;
+			});
+		}
+
+		void release()
+		{
+			m_buffer.clear();
+			m_buffer.shrink_to_fit();
+		}
+
+	private:
+		std::vector<T> m_buffer;
+	};
+
+	/*!
+	*	\brief	In-place exclusive prefix sum over data[0, size) on ThreadPool, returns the total sum.
+	*/
+	int exclusiveScanHost(int* data, int size);
+
+	/*!
+	*	\brief	Host counterpart of cuExecute, Func is called as Func(pId, ...) for each particle.
+	*/
+#define cpuExecute(size, Func, ...){														\
+		PhysIKA::ThreadPool::getInstance().parallelFor(size, [&](int pId) {				\
+			Func(pId, __VA_ARGS__);															\
+		});																					\
+	}
+}
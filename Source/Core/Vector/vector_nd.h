@@ -225,7 +225,7 @@ namespace PhysIKA
 	inline Vectornd<T, deviceType> Vectornd<T, deviceType>::operator+(const Vectornd<T, deviceType>& v) const
 	{
 		Vectornd<T, deviceType> res(m_n);
-		for (int i = 0; i < n; ++i)
+		for (int i = 0; i < m_n; ++i)
 		{
 			res.m_data[i] = this->m_data[i] + v.m_data[i];
 		}
@@ -157,6 +157,7 @@ namespace PhysIKA
         Real dt = getParent()->getDt();
 
         int num = m_position.getElementCount();
+		assert(!m_neighborhood.getValue().isHalf());
 
 		uint pDims = cudaGridSize(num, BLOCK_SIZE);
         calcChemicalPotential<TDataType><<<pDims, BLOCK_SIZE>>>(
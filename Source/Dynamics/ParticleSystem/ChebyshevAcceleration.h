@@ -0,0 +1,52 @@
+#pragma once
+
+namespace PhysIKA {
+
+	/*!
+	*	\class	ChebyshevAcceleration
+	*	\brief	Relaxation weights of the Chebyshev semi-iterative method for Jacobi-style solvers.
+	*
+	*	An accelerated iteration computes the Jacobi update x_hat from x_k and blends it with the iterate before,
+	*		x_{k+1} = omega_{k+1} * (x_hat - x_{k-1}) + x_{k-1},
+	*	where the weights follow from the spectral radius rho of the unaccelerated iteration.
+	*	For more details, please refer to [Wang 2015] "A Chebyshev Semi-Iterative Approach for Accelerating Projective and Position-based Dynamics".
+	*	Overestimating rho makes the iteration oscillate, a rho of zero turns the acceleration off.
+	*/
+	template<typename Real>
+	class ChebyshevAcceleration
+	{
+	public:
+		/**
+		 * @brief Restart the weights, called before the first iteration of a solve
+		 */
+		void reset(Real rho)
+		{
+			m_rho = rho;
+			m_omega = Real(1);
+			m_iter = 0;
+		}
+
+		bool isEnabled() { return m_rho > Real(0); }
+
+		/**
+		 * @brief Weight of the next iteration, the first iteration is always a plain Jacobi step with a weight of one
+		 */
+		Real next()
+		{
+			if (m_rho <= Real(0) || m_iter == 0)
+				m_omega = Real(1);
+			else if (m_iter == 1)
+				m_omega = Real(2) / (Real(2) - m_rho*m_rho);
+			else
+				m_omega = Real(4) / (Real(4) - m_rho*m_rho*m_omega);
+
+			m_iter++;
+			return m_omega;
+		}
+
+	private:
+		Real m_rho = Real(0);
+		Real m_omega = Real(1);
+		int m_iter = 0;
+	};
+}
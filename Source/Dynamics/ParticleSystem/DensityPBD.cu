@@ -4,6 +4,7 @@
 #include "DensityPBD.h"
 #include "Framework/Framework/Node.h"
 #include <string>
+#include <algorithm>
 #include "SummationDensity.h"
 #include "Framework/Topology/FieldNeighbor.h"
 
@@ -11,14 +12,16 @@ namespace PhysIKA
 {
 	IMPLEMENT_CLASS_1(DensityPBD, TDataType)
 
+	template<typename Real>
+	using DensityKernel = KernelFunction<Real, SpikyPolicy<Real>>;
+
 	template<typename Real,
 			 typename Coord>
 	__global__ void K_InitKernelFunction(
 		DeviceArray<Real> weights,
 		DeviceArray<Coord> posArr,
 		NeighborList<int> neighbors,
-		SpikyKernel<Real> kernel,
-		Real smoothingLength)
+		DensityKernel<Real> kernel)
 	{
 		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
 		if (pId >= weights.size()) return;
@@ -34,7 +37,7 @@ namespace PhysIKA
 
 			if (r > EPSILON)
 			{
-				total_weight += kernel.Weight(r, smoothingLength);
+				total_weight += kernel.weight(r);
 			}
 		}
 
@@ -48,8 +51,7 @@ namespace PhysIKA
 		DeviceArray<Real> rhoArr,
 		DeviceArray<Coord> posArr,
 		NeighborList<int> neighbors,
-		SpikyKernel<Real> kern,
-		Real smoothingLength)
+		DensityKernel<Real> kern)
 	{
 		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
 		if (pId >= posArr.size()) return;
@@ -69,7 +71,7 @@ namespace PhysIKA
 
 			if (r > EPSILON)
 			{
-				Coord g = kern.Gradient(r, smoothingLength)*(pos_i - posArr[j]) * (1.0f / r);
+				Coord g = kern.gradient(r)*(pos_i - posArr[j]) * (1.0f / r);
 				grad_ci += g;
 				lamda_i += g.dot(g);
 			}
@@ -96,8 +98,7 @@ namespace PhysIKA
 		DeviceArray<Coord> posArr,
 		DeviceArray<Real> massInvArr,
 		NeighborList<int> neighbors,
-		SpikyKernel<Real> kern,
-		Real smoothingLength)
+		DensityKernel<Real> kern)
 	{
 		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
 		if (pId >= posArr.size()) return;
@@ -115,7 +116,7 @@ namespace PhysIKA
 
 			if (r > EPSILON)
 			{
-				Coord g = kern.Gradient(r, smoothingLength)*(pos_i - posArr[j]) * (1.0f / r);
+				Coord g = kern.gradient(r)*(pos_i - posArr[j]) * (1.0f / r);
 				grad_ci += g;
 				lamda_i += g.dot(g) * massInvArr[j];
 			}
@@ -137,8 +138,7 @@ namespace PhysIKA
 		DeviceArray<Real> lambdas, 
 		DeviceArray<Coord> posArr, 
 		NeighborList<int> neighbors, 
-		SpikyKernel<Real> kern,
-		Real smoothingLength,
+		DensityKernel<Real> kern,
 		Real dt)
 	{
 		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
@@ -155,7 +155,7 @@ namespace PhysIKA
 			Real r = (pos_i - posArr[j]).norm();
 			if (r > EPSILON)
 			{
-				Coord dp_ij = 10.0f*(pos_i - posArr[j])*(lamda_i + lambdas[j])*kern.Gradient(r, smoothingLength)* (1.0 / r);
+				Coord dp_ij = 10.0f*(pos_i - posArr[j])*(lamda_i + lambdas[j])*kern.gradient(r)* (1.0 / r);
 				dP_i += dp_ij;
 				
 				atomicAdd(&dPos[pId][0], dp_ij[0]);
@@ -185,8 +185,7 @@ namespace PhysIKA
 		DeviceArray<Coord> posArr,
 		DeviceArray<Real> massInvArr,
 		NeighborList<int> neighbors,
-		SpikyKernel<Real> kern,
-		Real smoothingLength,
+		DensityKernel<Real> kern,
 		Real dt)
 	{
 		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
@@ -202,7 +201,7 @@ namespace PhysIKA
 			Real r = (pos_i - posArr[j]).norm();
 			if (r > EPSILON)
 			{
-				Coord dp_ij = 10.0f*(pos_i - posArr[j])*(lamda_i + lambdas[j])*kern.Gradient(r, smoothingLength)* (1.0 / r);
+				Coord dp_ij = 10.0f*(pos_i - posArr[j])*(lamda_i + lambdas[j])*kern.gradient(r)* (1.0 / r);
 				Coord dp_ji = -dp_ij * massInvArr[j];
 				dp_ij = dp_ij * massInvArr[pId];
 				atomicAdd(&dPos[pId][0], dp_ij[0]);
@@ -223,6 +222,118 @@ namespace PhysIKA
 		}
 	}
 
+	/**
+	 * Half neighbor lists store every pair once, the gradient terms of a pair are added to both particles
+	 */
+	template <typename Real, typename Coord>
+	__global__ void K_ComputeLambdaTermsHalf(
+		DeviceArray<Coord> gradArr,
+		DeviceArray<Real> sumArr,
+		DeviceArray<Coord> posArr,
+		DeviceArray<Real> massInvArr,
+		NeighborList<int> neighbors,
+		DensityKernel<Real> kern)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= posArr.size()) return;
+
+		bool weighted = massInvArr.size() > 0;
+
+		Coord pos_i = posArr[pId];
+		Real invMass_i = weighted ? massInvArr[pId] : Real(1);
+
+		Coord grad_ci(0);
+		Real sum_i = Real(0);
+
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+
+			if (r > EPSILON)
+			{
+				Coord g = kern.gradient(r)*(pos_i - posArr[j]) * (1.0f / r);
+				Real gg = g.dot(g);
+				grad_ci += g;
+				sum_i += weighted ? gg * massInvArr[j] : gg;
+
+				atomicAdd(&gradArr[j][0], -g[0]);
+				atomicAdd(&gradArr[j][1], -g[1]);
+				atomicAdd(&gradArr[j][2], -g[2]);
+				atomicAdd(&sumArr[j], gg * invMass_i);
+			}
+		}
+
+		atomicAdd(&gradArr[pId][0], grad_ci[0]);
+		atomicAdd(&gradArr[pId][1], grad_ci[1]);
+		atomicAdd(&gradArr[pId][2], grad_ci[2]);
+		atomicAdd(&sumArr[pId], sum_i);
+	}
+
+	template <typename Real, typename Coord>
+	__global__ void K_ComputeLambdasHalf(
+		DeviceArray<Real> lambdaArr,
+		DeviceArray<Real> rhoArr,
+		DeviceArray<Coord> gradArr,
+		DeviceArray<Real> sumArr,
+		DeviceArray<Real> massInvArr)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= lambdaArr.size()) return;
+
+		Coord grad_ci = gradArr[pId];
+		Real lamda_i = sumArr[pId] + (massInvArr.size() > 0 ? grad_ci.dot(grad_ci) * massInvArr[pId] : grad_ci.dot(grad_ci));
+
+		lamda_i = -(rhoArr[pId] - 1000.0f) / (lamda_i + 0.1f);
+
+		lambdaArr[pId] = lamda_i > 0.0f ? 0.0f : lamda_i;
+	}
+
+	/**
+	 * With a full list every pair is scattered twice, once from each particle, so a half list scatters twice the displacement
+	 */
+	template <typename Real, typename Coord>
+	__global__ void K_ComputeDisplacementHalf(
+		DeviceArray<Coord> dPos,
+		DeviceArray<Real> lambdas,
+		DeviceArray<Coord> posArr,
+		DeviceArray<Real> massInvArr,
+		NeighborList<int> neighbors,
+		DensityKernel<Real> kern)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= posArr.size()) return;
+
+		bool weighted = massInvArr.size() > 0;
+
+		Coord pos_i = posArr[pId];
+		Real lamda_i = lambdas[pId];
+
+		Coord dP_i(0);
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+			if (r > EPSILON)
+			{
+				Coord dp_ij = 20.0f*(pos_i - posArr[j])*(lamda_i + lambdas[j])*kern.gradient(r)* (1.0 / r);
+				dP_i += dp_ij;
+
+				Coord dp_ji = weighted ? -dp_ij * massInvArr[j] : -dp_ij;
+				atomicAdd(&dPos[j][0], dp_ji[0]);
+				atomicAdd(&dPos[j][1], dp_ji[1]);
+				atomicAdd(&dPos[j][2], dp_ji[2]);
+			}
+		}
+
+		dP_i = weighted ? dP_i * massInvArr[pId] : dP_i;
+		atomicAdd(&dPos[pId][0], dP_i[0]);
+		atomicAdd(&dPos[pId][1], dP_i[1]);
+		atomicAdd(&dPos[pId][2], dP_i[2]);
+	}
+
 	template <typename Real, typename Coord>
 	__global__ void K_UpdatePosition(
 		DeviceArray<Coord> posArr, 
@@ -236,12 +347,46 @@ namespace PhysIKA
 		posArr[pId] += dPos[pId];
 	}
 
+	/**
+	 * Chebyshev blend of the Jacobi update with the iterate before, prevArr is shifted to the current iterate
+	 */
+	template <typename Real, typename Coord>
+	__global__ void K_ChebyshevUpdatePosition(
+		DeviceArray<Coord> posArr,
+		DeviceArray<Coord> prevArr,
+		DeviceArray<Coord> dPos,
+		Real omega)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= posArr.size()) return;
+
+		Coord pos_i = posArr[pId];
+		Coord prev_i = prevArr[pId];
+		posArr[pId] = omega*(pos_i + dPos[pId] - prev_i) + prev_i;
+		prevArr[pId] = pos_i;
+	}
+
+	template <typename Real>
+	__global__ void K_ComputeDensityError(
+		DeviceArray<Real> errArr,
+		DeviceArray<Real> rhoArr,
+		Real restDensity)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= rhoArr.size()) return;
+
+		Real err = (rhoArr[pId] - restDensity) / restDensity;
+		errArr[pId] = err > Real(0) ? err : Real(0);
+	}
+
 
 	template<typename TDataType>
 	DensityPBD<TDataType>::DensityPBD()
 		: ConstraintModule()
 	{
 		this->varIterationNumber()->setValue(3);
+		this->varTolerance()->setValue(Real(0));
+		this->varSpectralRadius()->setValue(Real(0));
 
 		this->varSamplingDistance()->setValue(Real(0.005));
 		this->varSmoothingLength()->setValue(Real(0.011));
@@ -265,13 +410,38 @@ namespace PhysIKA
 		m_lamda.release();
 		m_deltaPos.release();
 		m_position_old.release();
+		m_position_prev.release();
+		m_error.release();
+		m_gradC.release();
+		m_gradSum.release();
+
+		m_hostLamda.release();
+		m_hostDensity.release();
+		m_hostMassInv.release();
+		m_hostDeltaPos.release();
+		m_hostPositionOld.release();
+		m_hostPositionPrev.release();
+		m_hostLambdaTerms.release();
 	}
 
 	template<typename TDataType>
 	bool DensityPBD<TDataType>::constrain()
 	{
 		int num = this->inPosition()->getElementCount();
-		
+
+		if (this->isHostContext())
+		{
+			if (num == 0)
+				return true;
+
+			constrain(this->inPosition()->getHostValue(), this->inVelocity()->getHostValue(), this->inNeighborIndex()->getHostValue(), this->getParent()->getDt());
+
+			if (this->outDensity()->getElementCount() != num)
+				this->outDensity()->setElementCount(num);
+			Function1Pt::copy(this->outDensity()->getHostValue(), m_hostDensity);
+			return true;
+		}
+
 		if (m_position_old.size() != this->inPosition()->getElementCount())
 			m_position_old.resize(this->inPosition()->getElementCount());
 
@@ -286,14 +456,34 @@ namespace PhysIKA
 		if (m_lamda.size() != this->inPosition()->getElementCount())
 			m_lamda.resize(this->inPosition()->getElementCount());
 
-		int it = 0;
+		m_chebyshev.reset(this->varSpectralRadius()->getValue());
+		if (m_chebyshev.isEnabled())
+		{
+			if (m_position_prev.size() != num)
+				m_position_prev.resize(num);
 
+			Function1Pt::copy(m_position_prev, this->inPosition()->getValue());
+		}
+
+		Real tolerance = this->varTolerance()->getValue();
 		int itNum = this->varIterationNumber()->getValue();
-		while (it < itNum)
+
+		m_iterationNum = 0;
+		while (m_iterationNum < itNum)
 		{
-			takeOneIteration();
+			m_summation->update();
+
+			//The densities are up to date here, so measuring the error costs a single reduction
+			if (tolerance > Real(0))
+			{
+				m_densityError = computeDensityError();
+				if (m_densityError <= tolerance)
+					break;
+			}
+
+			projectDensity(m_chebyshev.next());
 
-			it++;
+			m_iterationNum++;
 		}
 
 		updateVelocity();
@@ -305,26 +495,82 @@ namespace PhysIKA
 	template<typename TDataType>
 	void DensityPBD<TDataType>::takeOneIteration()
 	{
-		Real dt = this->getParent()->getDt();
+		m_summation->update();
 
+		projectDensity(Real(1));
+	}
+
+	template<typename TDataType>
+	typename TDataType::Real DensityPBD<TDataType>::computeDensityError()
+	{
 		int num = this->inPosition()->getElementCount();
-		uint pDims = cudaGridSize(num, BLOCK_SIZE);
+		if (num <= 0)
+			return Real(0);
 
-		
+		if (m_error.size() != num)
+			m_error.resize(num);
+
+		cuExecute(num, K_ComputeDensityError,
+			m_error,
+			m_summation->outDensity()->getValue(),
+			this->varRestDensity()->getValue());
+
+		return m_reduce.average(m_error.getDataPtr(), num);
+	}
+
+	template<typename TDataType>
+	void DensityPBD<TDataType>::projectDensity(Real omega)
+	{
+		Real dt = this->getParent()->getDt();
+
+		int num = this->inPosition()->getElementCount();
 
 		m_deltaPos.reset();
+		m_kernel.setSmoothingLength(this->varSmoothingLength()->getValue());
 
-		m_summation->update();
+		if (this->inNeighborIndex()->getValue().isHalf())
+		{
+			DeviceArray<Real> massInv = m_massInv.isEmpty() ? DeviceArray<Real>() : m_massInv.getValue();
+
+			if (m_gradC.size() != num)
+			{
+				m_gradC.resize(num);
+				m_gradSum.resize(num);
+			}
+			m_gradC.reset();
+			m_gradSum.reset();
+
+			cuExecute(num, K_ComputeLambdaTermsHalf,
+				m_gradC,
+				m_gradSum,
+				this->inPosition()->getValue(),
+				massInv,
+				this->inNeighborIndex()->getValue(),
+				m_kernel);
+
+			cuExecute(num, K_ComputeLambdasHalf,
+				m_lamda,
+				m_summation->outDensity()->getValue(),
+				m_gradC,
+				m_gradSum,
+				massInv);
 
-		if (m_massInv.isEmpty())
+			cuExecute(num, K_ComputeDisplacementHalf,
+				m_deltaPos,
+				m_lamda,
+				this->inPosition()->getValue(),
+				massInv,
+				this->inNeighborIndex()->getValue(),
+				m_kernel);
+		}
+		else if (m_massInv.isEmpty())
 		{
 			cuExecute(num, K_ComputeLambdas,
 				m_lamda,
 				m_summation->outDensity()->getValue(),
 				this->inPosition()->getValue(),
 				this->inNeighborIndex()->getValue(),
-				m_kernel,
-				this->varSmoothingLength()->getValue());
+				m_kernel);
 
 			cuExecute(num, K_ComputeDisplacement,
 				m_deltaPos,
@@ -332,7 +578,6 @@ namespace PhysIKA
 				this->inPosition()->getValue(),
 				this->inNeighborIndex()->getValue(),
 				m_kernel,
-				this->varSmoothingLength()->getValue(),
 				dt);
 		}
 		else
@@ -343,8 +588,7 @@ namespace PhysIKA
 				this->inPosition()->getValue(),
 				m_massInv.getValue(),
 				this->inNeighborIndex()->getValue(),
-				m_kernel,
-				this->varSmoothingLength()->getValue());
+				m_kernel);
 
 			cuExecute(num, K_ComputeDisplacement,
 				m_deltaPos,
@@ -353,15 +597,26 @@ namespace PhysIKA
 				m_massInv.getValue(),
 				this->inNeighborIndex()->getValue(),
 				m_kernel,
-				this->varSmoothingLength()->getValue(),
 				dt);
 		}
 
-		cuExecute(num, K_UpdatePosition,
-			this->inPosition()->getValue(),
-			this->inVelocity()->getValue(),
-			m_deltaPos,
-			dt);
+		//A weight of one is a plain Jacobi step, it keeps the previous positions at the iterate before, as required by the second iteration
+		if (omega != Real(1))
+		{
+			cuExecute(num, K_ChebyshevUpdatePosition,
+				this->inPosition()->getValue(),
+				m_position_prev,
+				m_deltaPos,
+				omega);
+		}
+		else
+		{
+			cuExecute(num, K_UpdatePosition,
+				this->inPosition()->getValue(),
+				this->inVelocity()->getValue(),
+				m_deltaPos,
+				dt);
+		}
 	}
 
 	template <typename Real, typename Coord>
@@ -391,6 +646,302 @@ namespace PhysIKA
 			dt);
 	}
 
+	template <typename Real, typename Coord>
+	void H_ComputeLambdas(
+		int pId,
+		HostArray<Real>& lambdaArr,
+		HostArray<Real>& rhoArr,
+		HostArray<Coord>& posArr,
+		HostArray<Real>& massInvArr,
+		HostNeighborList<int>& neighbors,
+		DensityKernel<Real>& kern)
+	{
+		bool weighted = !massInvArr.isEmpty();
+
+		Coord pos_i = posArr[pId];
+
+		Real lamda_i = Real(0);
+		Coord grad_ci(0);
+
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+
+			if (r > EPSILON)
+			{
+				Coord g = kern.gradient(r)*(pos_i - posArr[j]) * (1.0f / r);
+				grad_ci += g;
+				lamda_i += weighted ? g.dot(g) * massInvArr[j] : g.dot(g);
+			}
+		}
+
+		lamda_i += weighted ? grad_ci.dot(grad_ci) * massInvArr[pId] : grad_ci.dot(grad_ci);
+
+		Real rho_i = rhoArr[pId];
+
+		lamda_i = -(rho_i - 1000.0f) / (lamda_i + 0.1f);
+
+		lambdaArr[pId] = lamda_i > 0.0f ? 0.0f : lamda_i;
+	}
+
+	/**
+	 * The device kernel scatters dp_ij to both particles of every pair with atomics. Since neighbor lists are symmetric,
+	 * each particle receives the same total by gathering twice its own contributions, which needs no atomics on the host.
+	 */
+	template <typename Real, typename Coord>
+	void H_ComputeDisplacement(
+		int pId,
+		HostArray<Coord>& dPos,
+		HostArray<Real>& lambdas,
+		HostArray<Coord>& posArr,
+		HostArray<Real>& massInvArr,
+		HostNeighborList<int>& neighbors,
+		DensityKernel<Real>& kern)
+	{
+		Coord pos_i = posArr[pId];
+		Real lamda_i = lambdas[pId];
+
+		Coord dP_i(0);
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+			if (r > EPSILON)
+			{
+				dP_i += 10.0f*(pos_i - posArr[j])*(lamda_i + lambdas[j])*kern.gradient(r)* (1.0 / r);
+			}
+		}
+
+		dPos[pId] = massInvArr.isEmpty() ? 2.0f*dP_i : 2.0f*dP_i*massInvArr[pId];
+	}
+
+	template <typename Real, typename Coord>
+	void H_ComputeLambdaTermsHalf(
+		int pId,
+		Vector<Real, 4>* terms,
+		HostArray<Coord>& posArr,
+		HostArray<Real>& massInvArr,
+		HostNeighborList<int>& neighbors,
+		DensityKernel<Real>& kern)
+	{
+		bool weighted = !massInvArr.isEmpty();
+
+		Coord pos_i = posArr[pId];
+		Real invMass_i = weighted ? massInvArr[pId] : Real(1);
+
+		Vector<Real, 4> term_i(0);
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+
+			if (r > EPSILON)
+			{
+				Coord g = kern.gradient(r)*(pos_i - posArr[j]) * (1.0f / r);
+				Real gg = g.dot(g);
+				term_i += Vector<Real, 4>(g[0], g[1], g[2], weighted ? gg * massInvArr[j] : gg);
+				terms[j] += Vector<Real, 4>(-g[0], -g[1], -g[2], gg * invMass_i);
+			}
+		}
+
+		terms[pId] += term_i;
+	}
+
+	template <typename Real>
+	void H_ComputeLambdasHalf(
+		int pId,
+		HostArray<Real>& lambdaArr,
+		HostArray<Real>& rhoArr,
+		HostArray<Vector<Real, 4>>& terms,
+		HostArray<Real>& massInvArr)
+	{
+		Vector<Real, 4> term_i = terms[pId];
+		Vector<Real, 3> grad_ci(term_i[0], term_i[1], term_i[2]);
+		Real lamda_i = term_i[3] + (massInvArr.isEmpty() ? grad_ci.dot(grad_ci) : grad_ci.dot(grad_ci) * massInvArr[pId]);
+
+		lamda_i = -(rhoArr[pId] - 1000.0f) / (lamda_i + 0.1f);
+
+		lambdaArr[pId] = lamda_i > 0.0f ? 0.0f : lamda_i;
+	}
+
+	template <typename Real, typename Coord>
+	void H_ComputeDisplacementHalf(
+		int pId,
+		Coord* dPos,
+		HostArray<Real>& lambdas,
+		HostArray<Coord>& posArr,
+		HostArray<Real>& massInvArr,
+		HostNeighborList<int>& neighbors,
+		DensityKernel<Real>& kern)
+	{
+		bool weighted = !massInvArr.isEmpty();
+
+		Coord pos_i = posArr[pId];
+		Real lamda_i = lambdas[pId];
+
+		Coord dP_i(0);
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+			if (r > EPSILON)
+			{
+				Coord dp_ij = 20.0f*(pos_i - posArr[j])*(lamda_i + lambdas[j])*kern.gradient(r)* (1.0 / r);
+				dP_i += dp_ij;
+				dPos[j] -= weighted ? dp_ij * massInvArr[j] : dp_ij;
+			}
+		}
+
+		dPos[pId] += weighted ? dP_i * massInvArr[pId] : dP_i;
+	}
+
+	template <typename Coord>
+	void H_UpdatePosition(
+		int pId,
+		HostArray<Coord>& posArr,
+		HostArray<Coord>& dPos)
+	{
+		posArr[pId] += dPos[pId];
+	}
+
+	template <typename Real, typename Coord>
+	void H_ChebyshevUpdatePosition(
+		int pId,
+		HostArray<Coord>& posArr,
+		HostArray<Coord>& prevArr,
+		HostArray<Coord>& dPos,
+		Real omega)
+	{
+		Coord pos_i = posArr[pId];
+		Coord prev_i = prevArr[pId];
+		posArr[pId] = omega*(pos_i + dPos[pId] - prev_i) + prev_i;
+		prevArr[pId] = pos_i;
+	}
+
+	template <typename Real, typename Coord>
+	void H_UpdateVelocity(
+		int pId,
+		HostArray<Coord>& velArr,
+		HostArray<Coord>& prePos,
+		HostArray<Coord>& curPos,
+		Real dt)
+	{
+		velArr[pId] += (curPos[pId] - prePos[pId]) / dt;
+	}
+
+	template<typename TDataType>
+	void DensityPBD<TDataType>::constrain(HostArray<Coord>& position, HostArray<Coord>& velocity, HostNeighborList<int>& neighbors, Real dt)
+	{
+		int num = position.size();
+		if (m_hostLamda.size() != num)
+		{
+			m_hostLamda.resize(num);
+			m_hostDensity.resize(num);
+			m_hostDeltaPos.resize(num);
+			m_hostPositionOld.resize(num);
+			m_hostLambdaTerms.resize(num);
+		}
+
+		Function1Pt::copy(m_hostPositionOld, position);
+
+		m_chebyshev.reset(this->varSpectralRadius()->getValue());
+		if (m_chebyshev.isEnabled())
+		{
+			if (m_hostPositionPrev.size() != num)
+				m_hostPositionPrev.resize(num);
+
+			Function1Pt::copy(m_hostPositionPrev, position);
+		}
+
+		m_kernel.setSmoothingLength(this->varSmoothingLength()->getValue());
+		Real restDensity = this->varRestDensity()->getValue();
+		Real tolerance = this->varTolerance()->getValue();
+
+		int itNum = this->varIterationNumber()->getValue();
+		for (m_iterationNum = 0; m_iterationNum < itNum; m_iterationNum++)
+		{
+			m_summation->compute(m_hostDensity, position, neighbors);
+
+			if (tolerance > Real(0))
+			{
+				Real err = Real(0);
+				for (int i = 0; i < num; i++)
+				{
+					err += std::max(m_hostDensity[i] - restDensity, Real(0));
+				}
+				m_densityError = num > 0 ? err / (restDensity * num) : Real(0);
+
+				if (m_densityError <= tolerance)
+					break;
+			}
+
+			Real omega = m_chebyshev.next();
+
+			if (neighbors.isHalf())
+			{
+				m_hostLambdaTerms.reset();
+				m_hostTermScatter.scatter(m_hostLambdaTerms.getDataPtr(), num, num, [&](int pId, Vector<Real, 4>* terms) {
+					H_ComputeLambdaTermsHalf(pId, terms, position, m_hostMassInv, neighbors, m_kernel);
+				});
+
+				cpuExecute(num, H_ComputeLambdasHalf,
+					m_hostLamda,
+					m_hostDensity,
+					m_hostLambdaTerms,
+					m_hostMassInv);
+
+				m_hostDeltaPos.reset();
+				m_hostDisplacementScatter.scatter(m_hostDeltaPos.getDataPtr(), num, num, [&](int pId, Coord* dPos) {
+					H_ComputeDisplacementHalf(pId, dPos, m_hostLamda, position, m_hostMassInv, neighbors, m_kernel);
+				});
+			}
+			else
+			{
+				cpuExecute(num, H_ComputeLambdas,
+					m_hostLamda,
+					m_hostDensity,
+					position,
+					m_hostMassInv,
+					neighbors,
+					m_kernel);
+
+				cpuExecute(num, H_ComputeDisplacement,
+					m_hostDeltaPos,
+					m_hostLamda,
+					position,
+					m_hostMassInv,
+					neighbors,
+					m_kernel);
+			}
+
+			if (omega != Real(1))
+			{
+				cpuExecute(num, H_ChebyshevUpdatePosition,
+					position,
+					m_hostPositionPrev,
+					m_hostDeltaPos,
+					omega);
+			}
+			else
+			{
+				cpuExecute(num, H_UpdatePosition,
+					position,
+					m_hostDeltaPos);
+			}
+		}
+
+		cpuExecute(num, H_UpdateVelocity,
+			velocity,
+			m_hostPositionOld,
+			position,
+			dt);
+	}
+
 #ifdef PRECISION_FLOAT
 	template class DensityPBD<DataType3f>;
 #else
@@ -4,7 +4,10 @@
 #include "Framework/Framework/FieldVar.h"
 #include "Framework/Framework/FieldArray.h"
 #include "Framework/Topology/FieldNeighbor.h"
+#include "Framework/Topology/HostNeighborList.h"
+#include "Core/Utility.h"
 #include "Kernel.h"
+#include "ChebyshevAcceleration.h"
 
 namespace PhysIKA {
 
@@ -25,17 +28,46 @@ namespace PhysIKA {
 		DensityPBD();
 		~DensityPBD() override;
 
+		/**
+		 * @brief Runs the host kernels below on the host data of the fields if the node runs on a CPU context
+		 */
 		bool constrain() override;
 
 		void takeOneIteration();
 
 		void updateVelocity();
 
+		/**
+		 * @brief Number of iterations of the last call to constrain(), at most the iteration number
+		 */
+		int getLastIterationNumber() { return m_iterationNum; }
+
+		/**
+		 * @brief Average relative compression measured by the last call to constrain(), only updated with a positive tolerance
+		 */
+		Real getDensityError() { return m_densityError; }
+
+		/**
+		 * @brief Host kernels executed on ThreadPool over arrays owned by the caller, no CUDA device is involved
+		 */
+		void constrain(HostArray<Coord>& position, HostArray<Coord>& velocity, HostNeighborList<int>& neighbors, Real dt);
+
+		/**
+		 * @brief Densities and Lagrange multipliers of the last iteration of the host solver
+		 */
+		HostArray<Real>& getHostDensity() { return m_hostDensity; }
+		HostArray<Real>& getHostLambda() { return m_hostLamda; }
+
 	public:
 		DeviceArrayField<Real> m_massInv; // mass^-1 as described in unified particle physics
+		HostArray<Real> m_hostMassInv; // mass^-1 read by the host kernels, left empty for unit masses
 
 	public:
-		DEF_EMPTY_VAR(IterationNumber, int, "Iteration number of the PBD solver");
+		DEF_EMPTY_VAR(IterationNumber, int, "Maximum iteration number of the PBD solver");
+
+		DEF_EMPTY_VAR(Tolerance, Real, "Average relative compression to stop the iterations at, zero runs all iterations");
+
+		DEF_EMPTY_VAR(SpectralRadius, Real, "Spectral radius estimate for Chebyshev acceleration in [0, 1), zero disables it");
 
 		DEF_EMPTY_VAR(RestDensity, Real, "Reference density");
 
@@ -77,11 +109,35 @@ namespace PhysIKA {
 		DEF_EMPTY_OUT_ARRAY(Density, Real, DeviceType::GPU, "Final particle density");
 
 	private:
-		SpikyKernel<Real> m_kernel;
+		void projectDensity(Real omega);
+		Real computeDensityError();
+
+		KernelFunction<Real, SpikyPolicy<Real>> m_kernel;
+		ChebyshevAcceleration<Real> m_chebyshev;
+
+		int m_iterationNum = 0;
+		Real m_densityError = Real(0);
 
 		DeviceArray<Real> m_lamda;
 		DeviceArray<Coord> m_deltaPos;
 		DeviceArray<Coord> m_position_old;
+		DeviceArray<Coord> m_position_prev;
+		DeviceArray<Real> m_error;
+
+		// gradient terms of the constraints, accumulated from half neighbor lists
+		DeviceArray<Coord> m_gradC;
+		DeviceArray<Real> m_gradSum;
+
+		Reduction<Real> m_reduce;
+
+		HostArray<Real> m_hostLamda;
+		HostArray<Real> m_hostDensity;
+		HostArray<Coord> m_hostDeltaPos;
+		HostArray<Coord> m_hostPositionOld;
+		HostArray<Coord> m_hostPositionPrev;
+		HostArray<Vector<Real, 4>> m_hostLambdaTerms;
+		ScatterBuffer<Vector<Real, 4>> m_hostTermScatter;
+		ScatterBuffer<Coord> m_hostDisplacementScatter;
 
 	private:
 		std::shared_ptr<SummationDensity<TDataType>> m_summation;
@@ -605,6 +605,7 @@ namespace PhysIKA
 		//printf("a");
 		int num = m_position.getElementCount();
 		uint pDims = cudaGridSize(num, BLOCK_SIZE);
+		assert(!m_neighborhood.getValue().isHalf());
 
 		m_deltaPos.reset();
 		//printf("b %d %d %d\n",m_deltaPos.size(), num, m_density.getElementCount());
@@ -238,6 +238,8 @@ namespace PhysIKA
 		int use_ghost,
 		int Start)
 	{
+		assert(!neighbors.isHalf());
+
 		cuint pDims = cudaGridSize(rho.size(), BLOCK_SIZE);
 		K_ComputeDensityMesh <Real, Coord> << <pDims, BLOCK_SIZE >> > (
 			rho, 
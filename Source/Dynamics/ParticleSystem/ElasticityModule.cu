@@ -5,12 +5,14 @@
 #include "Core/Utility.h"
 #include "Kernel.h"
 
+#include <algorithm>
+
 namespace PhysIKA
 {
 	IMPLEMENT_CLASS_1(ElasticityModule, TDataType)
 
 	template<typename Real>
-	__device__ Real D_Weight(Real r, Real h)
+	COMM_FUNC Real D_Weight(Real r, Real h)
 	{
 		SmoothKernel<Real> kernSmooth;
 		Real q = r / h;
@@ -292,6 +294,32 @@ namespace PhysIKA
 	}
 
 
+	/**
+	 * Chebyshev blend of the iterate with the one before, prevArr is shifted to the positions before the iteration
+	 */
+	template <typename Real, typename Coord>
+	__global__ void EM_RelaxIterate(
+		DeviceArray<Coord> position,
+		DeviceArray<Coord> prev_position,
+		DeviceArray<Coord> iter_position,
+		DeviceArray<Real> change,
+		Real omega)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= position.size()) return;
+
+		Coord pos_i = position[pId];
+		Coord iter_i = iter_position[pId];
+		if (omega != Real(1))
+		{
+			pos_i = omega*(pos_i - prev_position[pId]) + prev_position[pId];
+			position[pId] = pos_i;
+		}
+		prev_position[pId] = iter_i;
+
+		change[pId] = (pos_i - iter_i).norm();
+	}
+
 	template <typename Real, typename Coord>
 	__global__ void K_UpdateVelocity(
 		DeviceArray<Coord> velArr,
@@ -326,6 +354,9 @@ namespace PhysIKA
  		m_mu.setValue(0.05);
  		m_lambda.setValue(0.1);
 		m_iterNum.setValue(10);
+
+		this->varTolerance()->setValue(Real(0));
+		this->varSpectralRadius()->setValue(Real(0));
 	}
 
 
@@ -337,6 +368,18 @@ namespace PhysIKA
 		m_invK.release();
 		m_F.release();
 		m_position_old.release();
+		m_position_iter.release();
+		m_position_prev.release();
+		m_change.release();
+
+		m_hostWeights.release();
+		m_hostBulkCoefs.release();
+		m_hostDisplacement.release();
+		m_hostPositionOld.release();
+		m_hostPositionIter.release();
+		m_hostPositionPrev.release();
+		m_hostChange.release();
+		m_hostInvK.release();
 	}
 
 	template<typename TDataType>
@@ -409,15 +452,71 @@ namespace PhysIKA
 
 		this->computeInverseK();
 
-		int itor = 0;
-		while (itor < m_iterNum.getValue())
+		this->iterate(
+			[&]() { this->enforceElasticity(); },
+			[&]() { this->saveIterate(); },
+			[&](Real omega) { return this->relaxIterate(omega); });
+
+		this->updateVelocity();
+	}
+
+	template<typename TDataType>
+	void ElasticityModule<TDataType>::iterate(std::function<void()> step, std::function<void()> save, std::function<Real(Real)> relax)
+	{
+		Real tolerance = this->varTolerance()->getValue();
+		m_chebyshev.reset(this->varSpectralRadius()->getValue());
+
+		//Plain iterations with a fixed number need no bookkeeping
+		bool tracked = tolerance > Real(0) || m_chebyshev.isEnabled();
+
+		m_iterationNum = 0;
+		while (m_iterationNum < m_iterNum.getValue())
 		{
-			this->enforceElasticity();
+			if (tracked)
+			{
+				save();
+			}
+
+			step();
 
-			itor++;
+			m_iterationNum++;
+
+			if (tracked && relax(m_chebyshev.next()) <= tolerance)
+			{
+				break;
+			}
 		}
+	}
 
-		this->updateVelocity();
+	template<typename TDataType>
+	void ElasticityModule<TDataType>::saveIterate()
+	{
+		int num = this->inPosition()->getElementCount();
+		if (m_position_iter.size() != num)
+		{
+			m_position_iter.resize(num);
+			m_position_prev.resize(num);
+			m_change.resize(num);
+		}
+
+		Function1Pt::copy(m_position_iter, this->inPosition()->getValue());
+	}
+
+	template<typename TDataType>
+	typename TDataType::Real ElasticityModule<TDataType>::relaxIterate(Real omega)
+	{
+		int num = this->inPosition()->getElementCount();
+		if (num <= 0)
+			return Real(0);
+
+		cuExecute(num, EM_RelaxIterate,
+			this->inPosition()->getValue(),
+			m_position_prev,
+			m_position_iter,
+			m_change,
+			omega);
+
+		return m_reduce.maximum(m_change.getDataPtr(), num) / this->inHorizon()->getValue();
 	}
 
 	template<typename TDataType>
@@ -437,6 +536,289 @@ namespace PhysIKA
 	}
 
 
+	template <typename Real, typename Matrix, typename NPair>
+	void H_PrecomputeShape(
+		int pId,
+		HostArray<Matrix>& invK,
+		HostNeighborList<NPair>& restShapes,
+		Real smoothingLength)
+	{
+		typedef typename NPair::Coord Coord;
+
+		CorrectedKernel<Real> g_weightKernel;
+
+		NPair np_i = restShapes.getElement(pId, 0);
+		Coord rest_i = np_i.pos;
+		int size_i = restShapes.getNeighborSize(pId);
+
+		Real total_weight = 0.0f;
+		Matrix mat_i = Matrix(0);
+		for (int ne = 0; ne < size_i; ne++)
+		{
+			NPair np_j = restShapes.getElement(pId, ne);
+			Coord rest_j = np_j.pos;
+			Real r = (rest_i - rest_j).norm();
+
+			if (r > EPSILON)
+			{
+				Real weight = g_weightKernel.Weight(r, smoothingLength);
+				Coord q = (rest_j - rest_i) / smoothingLength*sqrt(weight);
+
+				mat_i(0, 0) += q[0] * q[0]; mat_i(0, 1) += q[0] * q[1]; mat_i(0, 2) += q[0] * q[2];
+				mat_i(1, 0) += q[1] * q[0]; mat_i(1, 1) += q[1] * q[1]; mat_i(1, 2) += q[1] * q[2];
+				mat_i(2, 0) += q[2] * q[0]; mat_i(2, 1) += q[2] * q[1]; mat_i(2, 2) += q[2] * q[2];
+
+				total_weight += weight;
+			}
+		}
+
+		if (total_weight > EPSILON)
+		{
+			mat_i *= (1.0f / total_weight);
+		}
+
+		Matrix R(0), U(0), D(0), V(0);
+		polarDecomposition(mat_i, R, U, D, V);
+
+		Real threshold = 0.0001f*smoothingLength;
+		D(0, 0) = D(0, 0) > threshold ? 1.0 / D(0, 0) : 1.0;
+		D(1, 1) = D(1, 1) > threshold ? 1.0 / D(1, 1) : 1.0;
+		D(2, 2) = D(2, 2) > threshold ? 1.0 / D(2, 2) : 1.0;
+
+		invK[pId] = V*D*U.transpose();
+	}
+
+	template <typename Real, typename Coord, typename Matrix, typename NPair>
+	void H_EnforceElasticity(
+		int pId,
+		HostArray<Coord>& delta_position,
+		HostArray<Real>& weights,
+		HostArray<Real>& bulkCoefs,
+		HostArray<Matrix>& invK,
+		HostArray<Coord>& position,
+		HostNeighborList<NPair>& restShapes,
+		Real horizon,
+		Real mu,
+		Real lambda)
+	{
+		CorrectedKernel<Real> g_weightKernel;
+
+		NPair np_i = restShapes.getElement(pId, 0);
+		Coord rest_i = np_i.pos;
+		int size_i = restShapes.getNeighborSize(pId);
+
+		Coord cur_pos_i = position[pId];
+
+		Coord accPos = Coord(0);
+		Real accA = Real(0);
+		Real bulk_i = bulkCoefs[pId];
+
+		Real total_weight = 0.0f;
+		Matrix deform_i = Matrix(0.0f);
+		for (int ne = 0; ne < size_i; ne++)
+		{
+			NPair np_j = restShapes.getElement(pId, ne);
+			Coord rest_j = np_j.pos;
+			int j = np_j.index;
+
+			Real r = (rest_j - rest_i).norm();
+
+			if (r > EPSILON)
+			{
+				Real weight = g_weightKernel.Weight(r, horizon);
+
+				Coord p = (position[j] - position[pId]) / horizon;
+				Coord q = (rest_j - rest_i) / horizon*weight;
+
+				deform_i(0, 0) += p[0] * q[0]; deform_i(0, 1) += p[0] * q[1]; deform_i(0, 2) += p[0] * q[2];
+				deform_i(1, 0) += p[1] * q[0]; deform_i(1, 1) += p[1] * q[1]; deform_i(1, 2) += p[1] * q[2];
+				deform_i(2, 0) += p[2] * q[0]; deform_i(2, 1) += p[2] * q[1]; deform_i(2, 2) += p[2] * q[2];
+				total_weight += weight;
+			}
+		}
+
+		if (total_weight > EPSILON)
+		{
+			deform_i *= (1.0f / total_weight);
+			deform_i = deform_i * invK[pId];
+		}
+
+		if ((deform_i.determinant()) < -0.001f)
+		{
+			deform_i = Matrix::identityMatrix();
+		}
+
+		for (int ne = 0; ne < size_i; ne++)
+		{
+			NPair np_j = restShapes.getElement(pId, ne);
+			Coord rest_j = np_j.pos;
+			int j = np_j.index;
+
+			Coord cur_pos_j = position[j];
+			Real r = (rest_j - rest_i).norm();
+
+			if (r > 0.01f*horizon)
+			{
+				Coord rest_dir_ij = deform_i*(rest_i - rest_j);
+				Coord cur_dir_ij = cur_pos_i - cur_pos_j;
+
+				cur_dir_ij = cur_dir_ij.norm() > EPSILON ? cur_dir_ij.normalize() : Coord(0);
+				rest_dir_ij = rest_dir_ij.norm() > EPSILON ? rest_dir_ij.normalize() : Coord(0, 0, 0);
+
+				Real mu_ij = mu*bulk_i* g_weightKernel.WeightRR(r, horizon);
+				Coord mu_pos_ij = position[j] + r*rest_dir_ij;
+				Coord mu_pos_ji = position[pId] - r*rest_dir_ij;
+
+				Real lambda_ij = lambda*bulk_i*g_weightKernel.WeightRR(r, horizon);
+				Coord lambda_pos_ij = position[j] + r*cur_dir_ij;
+				Coord lambda_pos_ji = position[pId] - r*cur_dir_ij;
+
+				Coord delta_pos_ij = mu_ij*mu_pos_ij + lambda_ij*lambda_pos_ij;
+				Real delta_weight_ij = mu_ij + lambda_ij;
+
+				Coord delta_pos_ji = mu_ij*mu_pos_ji + lambda_ij*lambda_pos_ji;
+
+				accA += delta_weight_ij;
+				accPos += delta_pos_ij;
+
+				atomicAddHost(&weights[j], delta_weight_ij);
+				atomicAddHost(&delta_position[j][0], delta_pos_ji[0]);
+				atomicAddHost(&delta_position[j][1], delta_pos_ji[1]);
+				atomicAddHost(&delta_position[j][2], delta_pos_ji[2]);
+			}
+		}
+
+		atomicAddHost(&weights[pId], accA);
+		atomicAddHost(&delta_position[pId][0], accPos[0]);
+		atomicAddHost(&delta_position[pId][1], accPos[1]);
+		atomicAddHost(&delta_position[pId][2], accPos[2]);
+	}
+
+	template <typename Real, typename Coord>
+	void H_UpdatePosition(
+		int pId,
+		HostArray<Coord>& position,
+		HostArray<Coord>& old_position,
+		HostArray<Coord>& delta_position,
+		HostArray<Real>& delta_weights)
+	{
+		position[pId] = (old_position[pId] + delta_position[pId]) / (1.0 + delta_weights[pId]);
+	}
+
+	template <typename Real, typename Coord>
+	void H_RelaxIterate(
+		int pId,
+		HostArray<Coord>& position,
+		HostArray<Coord>& prev_position,
+		HostArray<Coord>& iter_position,
+		HostArray<Real>& change,
+		Real omega)
+	{
+		Coord pos_i = position[pId];
+		Coord iter_i = iter_position[pId];
+		if (omega != Real(1))
+		{
+			pos_i = omega*(pos_i - prev_position[pId]) + prev_position[pId];
+			position[pId] = pos_i;
+		}
+		prev_position[pId] = iter_i;
+
+		change[pId] = (pos_i - iter_i).norm();
+	}
+
+	template <typename Real, typename Coord>
+	void H_UpdateVelocity(
+		int pId,
+		HostArray<Coord>& velArr,
+		HostArray<Coord>& prePos,
+		HostArray<Coord>& curPos,
+		Real dt)
+	{
+		velArr[pId] += (curPos[pId] - prePos[pId]) / dt;
+	}
+
+	template<typename TDataType>
+	void ElasticityModule<TDataType>::constrain(HostArray<Coord>& position, HostArray<Coord>& velocity, HostNeighborList<NPair>& restShapes, Real dt)
+	{
+		assert(!restShapes.isHalf());
+
+		int num = position.size();
+		if (m_hostInvK.size() != num)
+		{
+			m_hostInvK.resize(num);
+			m_hostWeights.resize(num);
+			m_hostDisplacement.resize(num);
+			m_hostPositionOld.resize(num);
+			m_hostBulkCoefs.resize(num);
+
+			//Same uniform bulk stiffness as computeMaterialStiffness()
+			for (int i = 0; i < num; i++)
+			{
+				m_hostBulkCoefs[i] = Real(1);
+			}
+		}
+
+		Function1Pt::copy(m_hostPositionOld, position);
+
+		Real horizon = this->inHorizon()->getValue();
+		Real mu = m_mu.getValue();
+		Real lambda = m_lambda.getValue();
+
+		cpuExecute(num, H_PrecomputeShape,
+			m_hostInvK,
+			restShapes,
+			horizon);
+
+		this->iterate(
+			[&]() {
+				m_hostDisplacement.reset();
+				m_hostWeights.reset();
+
+				cpuExecute(num, H_EnforceElasticity,
+					m_hostDisplacement,
+					m_hostWeights,
+					m_hostBulkCoefs,
+					m_hostInvK,
+					position,
+					restShapes,
+					horizon,
+					mu,
+					lambda);
+
+				cpuExecute(num, H_UpdatePosition,
+					position,
+					m_hostPositionOld,
+					m_hostDisplacement,
+					m_hostWeights);
+			},
+			[&]() {
+				if (m_hostPositionIter.size() != num)
+				{
+					m_hostPositionIter.resize(num);
+					m_hostPositionPrev.resize(num);
+					m_hostChange.resize(num);
+				}
+				Function1Pt::copy(m_hostPositionIter, position);
+			},
+			[&](Real omega) {
+				cpuExecute(num, H_RelaxIterate,
+					position,
+					m_hostPositionPrev,
+					m_hostPositionIter,
+					m_hostChange,
+					omega);
+
+				Real change = num > 0 ? *std::max_element(m_hostChange.getDataPtr(), m_hostChange.getDataPtr() + num) : Real(0);
+				return change / horizon;
+			});
+
+		cpuExecute(num, H_UpdateVelocity,
+			velocity,
+			m_hostPositionOld,
+			position,
+			dt);
+	}
+
 	template<typename TDataType>
 	bool ElasticityModule<TDataType>::constrain()
 	{
@@ -496,6 +878,9 @@ namespace PhysIKA
 	template<typename TDataType>
 	void ElasticityModule<TDataType>::resetRestShape()
 	{
+		//The rest shape of a particle lists all of its neighbors, a half list would drop the ones with a smaller id
+		assert(!this->inNeighborhood()->getValue().isHalf());
+
 		m_restShape.setElementCount(this->inNeighborhood()->getValue().size());
 		m_restShape.getValue().getIndex().resize(this->inNeighborhood()->getValue().getIndex().size());
 
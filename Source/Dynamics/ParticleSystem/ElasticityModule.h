@@ -11,7 +11,12 @@
  */
 #pragma once
 #include "Framework/Framework/ModuleConstraint.h"
+#include "Framework/Topology/HostNeighborList.h"
+#include "Core/Utility.h"
 #include "NeighborData.h"
+#include "ChebyshevAcceleration.h"
+
+#include <functional>
 
 namespace PhysIKA {
 
@@ -40,8 +45,18 @@ namespace PhysIKA {
 		void setIterationNumber(int num) { m_iterNum.setValue(num); }
 		int getIterationNumber() { return m_iterNum.getValue(); }
 
+		/**
+		 * @brief Number of iterations of the last call to solveElasticity(), at most the iteration number
+		 */
+		int getLastIterationNumber() { return m_iterationNum; }
+
 		void resetRestShape();
 
+		/**
+		 * @brief Host kernels executed on ThreadPool over arrays owned by the caller, no CUDA device is involved
+		 */
+		void constrain(HostArray<Coord>& position, HostArray<Coord>& velocity, HostNeighborList<NPair>& restShapes, Real dt);
+
 	protected:
 		bool initializeImpl() override;
 
@@ -55,6 +70,23 @@ namespace PhysIKA {
 		void updateVelocity();
 		void computeInverseK();
 
+		/**
+		 * @brief Apply the Chebyshev weight to the iterate of enforceElasticity(), returns the largest position change relative to the horizon
+		 * m_position_iter has to hold the positions before enforceElasticity()
+		 */
+		Real relaxIterate(Real omega);
+
+		/**
+		 * @brief Store the positions before an iteration for relaxIterate()
+		 */
+		void saveIterate();
+
+		/**
+		 * @brief Call step() up to the iteration number times, stop once the tolerance is reached
+		 * With a tolerance or a spectral radius, save() is called before and relax() after each step(), relax() returns the change relative to the horizon
+		 */
+		void iterate(std::function<void()> step, std::function<void()> save, std::function<Real(Real)> relax);
+
 	public:
 		/**
 			* @brief Horizon
@@ -63,6 +95,10 @@ namespace PhysIKA {
 		DEF_EMPTY_IN_VAR(Horizon, Real, "");
 		//VarField<Real> m_horizon;
 
+		DEF_EMPTY_VAR(Tolerance, Real, "Position change relative to the horizon to stop the iterations at, zero runs all iterations");
+
+		DEF_EMPTY_VAR(SpectralRadius, Real, "Spectral radius estimate for Chebyshev acceleration in [0, 1), zero disables it");
+
 		/**
 		 * @brief Particle position
 		 */
@@ -102,8 +138,25 @@ namespace PhysIKA {
 	private:
 		VarField<int> m_iterNum;
 
+		int m_iterationNum = 0;
+		ChebyshevAcceleration<Real> m_chebyshev;
+
+		DeviceArray<Coord> m_position_iter;
+		DeviceArray<Coord> m_position_prev;
+		DeviceArray<Real> m_change;
+		Reduction<Real> m_reduce;
+
 		DeviceArray<Real> m_stiffness;
 		DeviceArray<Matrix> m_F;
+
+		HostArray<Real> m_hostWeights;
+		HostArray<Real> m_hostBulkCoefs;
+		HostArray<Coord> m_hostDisplacement;
+		HostArray<Coord> m_hostPositionOld;
+		HostArray<Coord> m_hostPositionIter;
+		HostArray<Coord> m_hostPositionPrev;
+		HostArray<Real> m_hostChange;
+		HostArray<Matrix> m_hostInvK;
 	};
 
 #ifdef PRECISION_FLOAT
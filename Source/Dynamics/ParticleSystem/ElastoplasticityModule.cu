@@ -247,18 +247,17 @@ namespace PhysIKA
 
 		m_pbdModule->varIterationNumber()->setValue(1);
 
-		int iter = 0;
-		int total = this->getIterationNumber();
-		while (iter < total)
-		{
-			this->enforceElasticity();
-			if (m_incompressible.getValue() == true)
-			{
-				m_pbdModule->constrain();
-			}
-			
-			iter++;
-		}
+		//Same tolerance and Chebyshev acceleration as ElasticityModule, the change covers both projections
+		this->iterate(
+			[&]() {
+				this->enforceElasticity();
+				if (m_incompressible.getValue() == true)
+				{
+					m_pbdModule->applyConstraint();
+				}
+			},
+			[&]() { this->saveIterate(); },
+			[&](Real omega) { return this->relaxIterate(omega); });
 
 		this->updateVelocity();
 	}
@@ -485,6 +484,9 @@ namespace PhysIKA
 	{
 		//constructRestShape(m_neighborhood.getValue(), m_position.getValue());
 
+		//A rest shape needs every neighbor of a particle
+		assert(!this->inNeighborhood()->getValue().isHalf());
+
 		uint pDims = cudaGridSize(this->inPosition()->getElementCount(), BLOCK_SIZE);
 
 		if (m_reconstuct_all_neighborhood.getValue())
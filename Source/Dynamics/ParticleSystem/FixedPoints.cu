@@ -16,6 +16,7 @@ namespace PhysIKA
 	{
 		this->attachField(&m_position, "position", "Storing the particle positions!", false);
 		this->attachField(&m_velocity, "velocity", "Storing the particle velocities!", false);
+		this->attachField(&m_particleId, "particle_id", "Original index of each particle!", false);
 
 	}
 
@@ -124,6 +125,25 @@ namespace PhysIKA
 
 	}
 
+	template <typename Coord>
+	__global__ void K_DoFixPointsById(
+		DeviceArray<Coord> curPos,
+		DeviceArray<Coord> curVel,
+		DeviceArray<int> particleId,
+		DeviceArray<int> bFixed,
+		DeviceArray<Coord> fixedPts)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= curPos.size()) return;
+
+		int id = particleId[pId];
+		if (bFixed[id])
+		{
+			curPos[pId] = fixedPts[id];
+			curVel[pId] = Coord(0);
+		}
+	}
+
 	template<typename TDataType>
 	bool FixedPoints<TDataType>::constrain()
 	{
@@ -139,6 +159,12 @@ namespace PhysIKA
 
 		uint pDims = cudaGridSize(m_bFixed.size(), BLOCK_SIZE);
 
+		if (!m_particleId.isEmpty() && m_particleId.getElementCount() == m_bFixed.size())
+		{
+			K_DoFixPointsById<Coord> << < pDims, BLOCK_SIZE >> > (m_position.getValue(), m_velocity.getValue(), m_particleId.getValue(), m_bFixed, m_fixed_positions);
+			return true;
+		}
+
 		K_DoFixPoints<Coord> << < pDims, BLOCK_SIZE >> > (m_position.getValue(), m_velocity.getValue(), m_bFixed, m_fixed_positions);
 
 		return true;
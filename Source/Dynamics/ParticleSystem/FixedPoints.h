@@ -37,6 +37,12 @@ namespace PhysIKA {
 		*/
 		DeviceArrayField<Coord> m_velocity;
 
+		/**
+		* @brief Original index of each particle, optional.
+		* Once connected (e.g., to ParticleReorder::outParticleId()), fixed points are addressed by the original index.
+		*/
+		DeviceArrayField<int> m_particleId;
+
 	protected:
 		virtual bool initializeImpl() override;
 
@@ -446,6 +446,7 @@ namespace PhysIKA
 			std::cout << "Incomplete inputs for Helmholtz!" << std::endl;
 			return false;
 		}
+		assert(!neighborFd->getValue().isHalf());
 
 		int num = posFd->getReference()->size();
 
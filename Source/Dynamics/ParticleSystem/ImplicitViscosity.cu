@@ -2,20 +2,14 @@
 #include "Core/Utility.h"
 #include "Framework/Framework/Node.h"
 #include "Framework/Topology/FieldNeighbor.h"
+#include "Kernel.h"
+
+#include <algorithm>
 
 namespace PhysIKA
 {
 	template<typename Real>
-	__device__ Real VB_VisWeight(const Real r, const Real h)
-	{
-		Real q = r / h;
-		if (q > 1.0f) return 0.0;
-		else {
-			const Real d = 1.0f - q;
-			const Real RR = h*h;
-			return 45.0f / (13.0f * (Real)M_PI * RR *h) *d;
-		}
-	}
+	using ViscosityKernel = KernelFunction<Real, ViscosityPolicy<Real>>;
 
 	template<typename Real, typename Coord>
 	__global__ void K_ApplyViscosity(
@@ -24,6 +18,7 @@ namespace PhysIKA
 		NeighborList<int> neighbors,
 		DeviceArray<Coord> velOld,
 		DeviceArray<Coord> velArr,
+		ViscosityKernel<Real> kern,
 		Real viscosity,
 		Real smoothingLength,
 		Real dt)
@@ -44,7 +39,7 @@ namespace PhysIKA
 
 			if (r > EPSILON)
 			{
-				Real weight = VB_VisWeight(r, smoothingLength);
+				Real weight = kern.weight(r);
 				totalWeight += weight;
 				dv_i += weight * velArr[j];
 			}
@@ -61,6 +56,264 @@ namespace PhysIKA
 		velNew[pId] = velOld[pId] / (1.0f + b) + dv_i*b / (1.0f + b);
 	}
 
+	template<typename Real, typename Coord>
+	void H_ApplyViscosity(
+		int pId,
+		HostArray<Coord>& velNew,
+		HostArray<Coord>& posArr,
+		HostNeighborList<int>& neighbors,
+		HostArray<Coord>& velOld,
+		HostArray<Coord>& velArr,
+		ViscosityKernel<Real>& kern,
+		Real viscosity,
+		Real smoothingLength,
+		Real dt)
+	{
+		Coord dv_i(0);
+		Coord pos_i = posArr[pId];
+		Real totalWeight = 0.0f;
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+
+			if (r > EPSILON)
+			{
+				Real weight = kern.weight(r);
+				totalWeight += weight;
+				dv_i += weight * velArr[j];
+			}
+		}
+
+		Real b = dt*viscosity / smoothingLength;
+
+		b = totalWeight < EPSILON ? 0.0f : b;
+
+		totalWeight = totalWeight < EPSILON ? 1.0f : totalWeight;
+
+		dv_i /= totalWeight;
+
+		velNew[pId] = velOld[pId] / (1.0f + b) + dv_i*b / (1.0f + b);
+	}
+
+	/**
+	 * Half neighbor lists store every pair once, the symmetric weight and the velocities of a pair are added to both particles.
+	 * The weights do not change during the iterations, they are summed once.
+	 */
+	template<typename Real, typename Coord>
+	__global__ void K_ComputeViscosityWeightHalf(
+		DeviceArray<Real> weightArr,
+		DeviceArray<Coord> posArr,
+		NeighborList<int> neighbors,
+		ViscosityKernel<Real> kern)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= posArr.size()) return;
+
+		Coord pos_i = posArr[pId];
+		Real totalWeight = 0.0f;
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+
+			if (r > EPSILON)
+			{
+				Real weight = kern.weight(r);
+				totalWeight += weight;
+				atomicAdd(&weightArr[j], weight);
+			}
+		}
+		atomicAdd(&weightArr[pId], totalWeight);
+	}
+
+	template<typename Real, typename Coord>
+	__global__ void K_ComputeViscositySumHalf(
+		DeviceArray<Coord> velSum,
+		DeviceArray<Coord> posArr,
+		NeighborList<int> neighbors,
+		DeviceArray<Coord> velArr,
+		ViscosityKernel<Real> kern)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= posArr.size()) return;
+
+		Coord dv_i(0);
+		Coord pos_i = posArr[pId];
+		Coord vel_i = velArr[pId];
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+
+			if (r > EPSILON)
+			{
+				Real weight = kern.weight(r);
+				dv_i += weight * velArr[j];
+
+				Coord dv_j = weight * vel_i;
+				atomicAdd(&velSum[j][0], dv_j[0]);
+				atomicAdd(&velSum[j][1], dv_j[1]);
+				atomicAdd(&velSum[j][2], dv_j[2]);
+			}
+		}
+		atomicAdd(&velSum[pId][0], dv_i[0]);
+		atomicAdd(&velSum[pId][1], dv_i[1]);
+		atomicAdd(&velSum[pId][2], dv_i[2]);
+	}
+
+	template<typename Real, typename Coord>
+	COMM_FUNC Coord VB_ViscousVelocity(
+		Coord velOld,
+		Coord velSum,
+		Real totalWeight,
+		Real viscosity,
+		Real smoothingLength,
+		Real dt)
+	{
+		Real b = dt*viscosity / smoothingLength;
+
+		b = totalWeight < EPSILON ? 0.0f : b;
+
+		totalWeight = totalWeight < EPSILON ? 1.0f : totalWeight;
+
+		return velOld / (1.0f + b) + velSum*b / (totalWeight*(1.0f + b));
+	}
+
+	template<typename Real, typename Coord>
+	__global__ void K_UpdateViscosityHalf(
+		DeviceArray<Coord> velNew,
+		DeviceArray<Coord> velOld,
+		DeviceArray<Coord> velSum,
+		DeviceArray<Real> weightArr,
+		Real viscosity,
+		Real smoothingLength,
+		Real dt)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= velNew.size()) return;
+
+		velNew[pId] = VB_ViscousVelocity(velOld[pId], velSum[pId], weightArr[pId], viscosity, smoothingLength, dt);
+	}
+
+	template<typename Real, typename Coord>
+	void H_ComputeViscosityWeightHalf(
+		int pId,
+		Real* weightAcc,
+		HostArray<Coord>& posArr,
+		HostNeighborList<int>& neighbors,
+		ViscosityKernel<Real>& kern)
+	{
+		Coord pos_i = posArr[pId];
+		Real totalWeight = 0.0f;
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+
+			if (r > EPSILON)
+			{
+				Real weight = kern.weight(r);
+				totalWeight += weight;
+				weightAcc[j] += weight;
+			}
+		}
+		weightAcc[pId] += totalWeight;
+	}
+
+	template<typename Real, typename Coord>
+	void H_ComputeViscositySumHalf(
+		int pId,
+		Coord* velAcc,
+		HostArray<Coord>& posArr,
+		HostNeighborList<int>& neighbors,
+		HostArray<Coord>& velArr,
+		ViscosityKernel<Real>& kern)
+	{
+		Coord dv_i(0);
+		Coord pos_i = posArr[pId];
+		Coord vel_i = velArr[pId];
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+
+			if (r > EPSILON)
+			{
+				Real weight = kern.weight(r);
+				dv_i += weight * velArr[j];
+				velAcc[j] += weight * vel_i;
+			}
+		}
+		velAcc[pId] += dv_i;
+	}
+
+	template<typename Real, typename Coord>
+	void H_UpdateViscosityHalf(
+		int pId,
+		HostArray<Coord>& velNew,
+		HostArray<Coord>& velOld,
+		HostArray<Coord>& velSum,
+		HostArray<Real>& weightArr,
+		Real viscosity,
+		Real smoothingLength,
+		Real dt)
+	{
+		velNew[pId] = VB_ViscousVelocity(velOld[pId], velSum[pId], weightArr[pId], viscosity, smoothingLength, dt);
+	}
+
+	/**
+	 * Chebyshev blend of the Jacobi update with the iterate before, velPrev is shifted to velBuf, the velocities before the iteration
+	 */
+	template<typename Real, typename Coord>
+	__global__ void K_RelaxViscosity(
+		DeviceArray<Coord> velArr,
+		DeviceArray<Coord> velPrev,
+		DeviceArray<Coord> velBuf,
+		DeviceArray<Real> change,
+		Real omega)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= velArr.size()) return;
+
+		Coord vel_i = velArr[pId];
+		Coord buf_i = velBuf[pId];
+		if (omega != Real(1))
+		{
+			vel_i = omega*(vel_i - velPrev[pId]) + velPrev[pId];
+			velArr[pId] = vel_i;
+		}
+		velPrev[pId] = buf_i;
+
+		change[pId] = (vel_i - buf_i).norm();
+	}
+
+	template<typename Real, typename Coord>
+	void H_RelaxViscosity(
+		int pId,
+		HostArray<Coord>& velArr,
+		HostArray<Coord>& velPrev,
+		HostArray<Coord>& velBuf,
+		HostArray<Real>& change,
+		Real omega)
+	{
+		Coord vel_i = velArr[pId];
+		Coord buf_i = velBuf[pId];
+		if (omega != Real(1))
+		{
+			vel_i = omega*(vel_i - velPrev[pId]) + velPrev[pId];
+			velArr[pId] = vel_i;
+		}
+		velPrev[pId] = buf_i;
+
+		change[pId] = (vel_i - buf_i).norm();
+	}
+
 	template<typename Real, typename Coord>
 	__global__ void VB_UpdateVelocity(
 		DeviceArray<Coord> velArr, 
@@ -80,6 +333,8 @@ namespace PhysIKA
 	{
 		m_viscosity.setValue(Real(0.05));
 		m_smoothingLength.setValue(Real(0.011));
+		this->varTolerance()->setValue(Real(0));
+		this->varSpectralRadius()->setValue(Real(0));
 
 		attachField(&m_viscosity, "viscosity", "The viscosity of the fluid!", false);
 		attachField(&m_smoothingLength, "smoothing_length", "The smoothing length in SPH!", false);
@@ -93,12 +348,29 @@ namespace PhysIKA
 	{
 		m_velOld.release();
 		m_velBuf.release();
+		m_velPrev.release();
+		m_change.release();
+		m_velSum.release();
+		m_weightSum.release();
+
+		m_hostVelOld.release();
+		m_hostVelBuf.release();
+		m_hostVelPrev.release();
+		m_hostChange.release();
+		m_hostVelSum.release();
+		m_hostWeightSum.release();
 	}
 
 	template<typename TDataType>
 	bool ImplicitViscosity<TDataType>::constrain()
 	{
 		int num = m_position.getElementCount();
+		if (num > 0 && this->isHostContext())
+		{
+			constrain(m_position.getHostValue(), m_velocity.getHostValue(), m_neighborhood.getHostValue(), getParent()->getDt());
+			return true;
+		}
+
 		if (num > 0)
 		{
 			cuint pDims = cudaGridSize(num, BLOCK_SIZE);
@@ -106,24 +378,177 @@ namespace PhysIKA
 			m_velOld.resize(num);
 			m_velBuf.resize(num);
 
+			m_chebyshev.reset(this->varSpectralRadius()->getValue());
+			Real tolerance = this->varTolerance()->getValue();
+			bool tracked = tolerance > Real(0) || m_chebyshev.isEnabled();
+			if (tracked)
+			{
+				m_velPrev.resize(num);
+				m_change.resize(num);
+			}
+
+			ViscosityKernel<Real> kern(m_smoothingLength.getValue());
+
+			bool half = m_neighborhood.getValue().isHalf();
+			if (half)
+			{
+				m_weightSum.resize(num);
+				m_velSum.resize(num);
+
+				m_weightSum.reset();
+				cuExecute(num, K_ComputeViscosityWeightHalf,
+					m_weightSum,
+					m_position.getValue(),
+					m_neighborhood.getValue(),
+					kern);
+			}
+
 			Real vis = m_viscosity.getValue();
 			Real dt = getParent()->getDt();
 			Function1Pt::copy(m_velOld, m_velocity.getValue());
-			for (int t = 0; t < m_maxInteration; t++)
+			for (m_iterationNum = 0; m_iterationNum < m_maxInteration;)
 			{
 				Function1Pt::copy(m_velBuf, m_velocity.getValue());
-				cuExecute(num, K_ApplyViscosity,
-					m_velocity.getValue(),
-					m_position.getValue(),
-					m_neighborhood.getValue(),
-					m_velOld,
-					m_velBuf,
+				if (half)
+				{
+					m_velSum.reset();
+					cuExecute(num, K_ComputeViscositySumHalf,
+						m_velSum,
+						m_position.getValue(),
+						m_neighborhood.getValue(),
+						m_velBuf,
+						kern);
+
+					cuExecute(num, K_UpdateViscosityHalf,
+						m_velocity.getValue(),
+						m_velOld,
+						m_velSum,
+						m_weightSum,
+						vis,
+						m_smoothingLength.getValue(),
+						dt);
+				}
+				else
+				{
+					cuExecute(num, K_ApplyViscosity,
+						m_velocity.getValue(),
+						m_position.getValue(),
+						m_neighborhood.getValue(),
+						m_velOld,
+						m_velBuf,
+						kern,
+						vis,
+						m_smoothingLength.getValue(),
+						dt);
+				}
+
+				m_iterationNum++;
+
+				if (tracked)
+				{
+					cuExecute(num, K_RelaxViscosity,
+						m_velocity.getValue(),
+						m_velPrev,
+						m_velBuf,
+						m_change,
+						m_chebyshev.next());
+
+					if (m_reduce.maximum(m_change.getDataPtr(), num) <= tolerance)
+						break;
+				}
+			}
+
+			return true;
+		}
+	}
+
+	template<typename TDataType>
+	void ImplicitViscosity<TDataType>::constrain(HostArray<Coord>& position, HostArray<Coord>& velocity, HostNeighborList<int>& neighbors, Real dt)
+	{
+		int num = position.size();
+		if (m_hostVelOld.size() != num)
+		{
+			m_hostVelOld.resize(num);
+			m_hostVelBuf.resize(num);
+		}
+
+		m_chebyshev.reset(this->varSpectralRadius()->getValue());
+		Real tolerance = this->varTolerance()->getValue();
+		bool tracked = tolerance > Real(0) || m_chebyshev.isEnabled();
+		if (tracked && m_hostVelPrev.size() != num)
+		{
+			m_hostVelPrev.resize(num);
+			m_hostChange.resize(num);
+		}
+
+		Real smoothingLength = m_smoothingLength.getValue();
+		ViscosityKernel<Real> kern(smoothingLength);
+
+		bool half = neighbors.isHalf();
+		if (half)
+		{
+			if (m_hostWeightSum.size() != num)
+			{
+				m_hostWeightSum.resize(num);
+				m_hostVelSum.resize(num);
+			}
+
+			m_hostWeightSum.reset();
+			m_hostWeightScatter.scatter(m_hostWeightSum.getDataPtr(), num, num, [&](int pId, Real* weightAcc) {
+				H_ComputeViscosityWeightHalf(pId, weightAcc, position, neighbors, kern);
+			});
+		}
+
+		Real vis = m_viscosity.getValue();
+		Function1Pt::copy(m_hostVelOld, velocity);
+		for (m_iterationNum = 0; m_iterationNum < m_maxInteration;)
+		{
+			Function1Pt::copy(m_hostVelBuf, velocity);
+			if (half)
+			{
+				m_hostVelSum.reset();
+				m_hostVelScatter.scatter(m_hostVelSum.getDataPtr(), num, num, [&](int pId, Coord* velAcc) {
+					H_ComputeViscositySumHalf(pId, velAcc, position, neighbors, m_hostVelBuf, kern);
+				});
+
+				cpuExecute(num, H_UpdateViscosityHalf,
+					velocity,
+					m_hostVelOld,
+					m_hostVelSum,
+					m_hostWeightSum,
 					vis,
-					m_smoothingLength.getValue(),
+					smoothingLength,
+					dt);
+			}
+			else
+			{
+				cpuExecute(num, H_ApplyViscosity,
+					velocity,
+					position,
+					neighbors,
+					m_hostVelOld,
+					m_hostVelBuf,
+					kern,
+					vis,
+					smoothingLength,
 					dt);
 			}
 
-			return true;
+			m_iterationNum++;
+
+			if (tracked)
+			{
+				cpuExecute(num, H_RelaxViscosity,
+					velocity,
+					m_hostVelPrev,
+					m_hostVelBuf,
+					m_hostChange,
+					m_chebyshev.next());
+
+				Real change = num > 0 ? *std::max_element(m_hostChange.getDataPtr(), m_hostChange.getDataPtr() + num) : Real(0);
+				if (change <= tolerance)
+					break;
+			}
 		}
 	}
 
@@ -3,6 +3,9 @@
 #include "Framework/Framework/FieldVar.h"
 #include "Framework/Framework/FieldArray.h"
 #include "Framework/Topology/FieldNeighbor.h"
+#include "Framework/Topology/HostNeighborList.h"
+#include "Core/Utility.h"
+#include "ChebyshevAcceleration.h"
 
 namespace PhysIKA {
 	template<typename TDataType>
@@ -15,10 +18,23 @@ namespace PhysIKA {
 		ImplicitViscosity();
 		~ImplicitViscosity() override;
 		
+		/**
+		 * @brief Runs the host kernels below on the host data of the fields if the node runs on a CPU context
+		 */
 		bool constrain() override;
 
+		/**
+		 * @brief Host kernels executed on ThreadPool over arrays owned by the caller, no CUDA device is involved
+		 */
+		void constrain(HostArray<Coord>& position, HostArray<Coord>& velocity, HostNeighborList<int>& neighbors, Real dt);
+
 		void setIterationNumber(int n);
 
+		/**
+		 * @brief Number of iterations of the last call to constrain(), at most the iteration number
+		 */
+		int getLastIterationNumber() { return m_iterationNum; }
+
 		void setViscosity(Real mu);
 
 
@@ -26,6 +42,10 @@ namespace PhysIKA {
 		bool initializeImpl() override;
 
 	public:
+		DEF_EMPTY_VAR(Tolerance, Real, "Velocity change to stop the Jacobi iterations at, zero runs all iterations");
+
+		DEF_EMPTY_VAR(SpectralRadius, Real, "Spectral radius estimate for Chebyshev acceleration in [0, 1), zero disables it");
+
 		VarField<Real> m_viscosity;
 		VarField<Real> m_smoothingLength;
 
@@ -36,11 +56,28 @@ namespace PhysIKA {
 
 	private:
 		int m_maxInteration;
+		int m_iterationNum = 0;
+
+		ChebyshevAcceleration<Real> m_chebyshev;
 
 		DeviceArray<Coord> m_velOld;
 		DeviceArray<Coord> m_velBuf;
+		DeviceArray<Coord> m_velPrev;
+		DeviceArray<Real> m_change;
+		Reduction<Real> m_reduce;
 
-		
+		// sums over the pairs of half neighbor lists
+		DeviceArray<Coord> m_velSum;
+		DeviceArray<Real> m_weightSum;
+
+		HostArray<Coord> m_hostVelOld;
+		HostArray<Coord> m_hostVelBuf;
+		HostArray<Coord> m_hostVelPrev;
+		HostArray<Real> m_hostChange;
+		HostArray<Coord> m_hostVelSum;
+		HostArray<Real> m_hostWeightSum;
+		ScatterBuffer<Coord> m_hostVelScatter;
+		ScatterBuffer<Real> m_hostWeightScatter;
 	};
 
 
@@ -4,6 +4,11 @@
 
 namespace PhysIKA {
 
+	/*!
+	*	\class	Kernel
+	*	\brief	Base of the SPH kernels. The kernels are passed by value to device functions, Weight() and Gradient() are
+	*			therefore resolved at compile time instead of through a virtual table.
+	*/
 	template<typename Real>
 	class Kernel
 	{
@@ -11,12 +16,12 @@ namespace PhysIKA {
 		COMM_FUNC Kernel() {};
 		COMM_FUNC ~Kernel() {};
 
-		COMM_FUNC inline virtual Real Weight(const Real r, const Real h)
+		COMM_FUNC inline Real Weight(const Real r, const Real h)
 		{
 			return Real(0);
 		}
 
-		COMM_FUNC inline virtual Real Gradient(const Real r, const Real h)
+		COMM_FUNC inline Real Gradient(const Real r, const Real h)
 		{
 			return Real(0);
 		}
@@ -33,7 +38,7 @@ namespace PhysIKA {
 		COMM_FUNC SpikyKernel() : Kernel<Real>() {};
 		COMM_FUNC ~SpikyKernel() {};
 
-		COMM_FUNC inline Real Weight(const Real r, const Real h) override
+		COMM_FUNC inline Real Weight(const Real r, const Real h)
 		{
 			const Real q = r / h;
 			if (q > 1.0f) return 0.0f;
@@ -44,7 +49,7 @@ namespace PhysIKA {
 			}
 		}
 
-		COMM_FUNC inline Real Gradient(const Real r, const Real h) override
+		COMM_FUNC inline Real Gradient(const Real r, const Real h)
 		{
 			const Real q = r / h;
 			if (q > 1.0f) return 0.0;
@@ -65,7 +70,7 @@ namespace PhysIKA {
 		COMM_FUNC SmoothKernel() : Kernel<Real>() {};
 		COMM_FUNC ~SmoothKernel() {};
 
-		COMM_FUNC inline Real Weight(const Real r, const Real h) override
+		COMM_FUNC inline Real Weight(const Real r, const Real h)
 		{
 			const Real q = r / h;
 			if (q > 1.0f) return 0.0f;
@@ -74,7 +79,7 @@ namespace PhysIKA {
 			}
 		}
 
-		COMM_FUNC inline Real Gradient(const Real r, const Real h) override
+		COMM_FUNC inline Real Gradient(const Real r, const Real h)
 		{
 			const Real q = r / h;
 			if (q > 1.0f) return 0.0f;
@@ -96,7 +101,7 @@ namespace PhysIKA {
 		COMM_FUNC CorrectedKernel() : Kernel<Real>() {};
 		COMM_FUNC ~CorrectedKernel() {};
 
-		COMM_FUNC inline Real Weight(const Real r, const Real h) override
+		COMM_FUNC inline Real Weight(const Real r, const Real h)
 		{
 			const Real q = r / h;
 			SmoothKernel<Real> kernSmooth;
@@ -150,7 +155,7 @@ namespace PhysIKA {
 		COMM_FUNC CubicKernel() : Kernel<Real>() {};
 		COMM_FUNC ~CubicKernel() {};
 
-		COMM_FUNC inline Real Weight(const Real r, const Real h) override
+		COMM_FUNC inline Real Weight(const Real r, const Real h)
 		{
 			const Real hh = h*h;
 			const Real q = 2.0f*r / h;
@@ -173,7 +178,7 @@ namespace PhysIKA {
 			}
 		}
 
-		COMM_FUNC inline Real Gradient(const Real r, const Real h) override
+		COMM_FUNC inline Real Gradient(const Real r, const Real h)
 		{
 			const Real hh = h*h;
 			const Real q = 2.0f*r / h;
@@ -204,7 +209,7 @@ namespace PhysIKA {
 		COMM_FUNC QuarticKernel() : Kernel<Real>() {};
 		COMM_FUNC ~QuarticKernel() {};
 
-		COMM_FUNC inline Real Weight(const Real r, const Real h) override
+		COMM_FUNC inline Real Weight(const Real r, const Real h)
 		{
 			const Real hh = h*h;
 			const Real q = 2.5f*r / h;
@@ -235,7 +240,7 @@ namespace PhysIKA {
 			}
 		}
 
-		COMM_FUNC inline Real Gradient(const Real r, const Real h) override
+		COMM_FUNC inline Real Gradient(const Real r, const Real h)
 		{
 			const Real hh = h*h;
 			const Real q = 2.5f*r / h;
@@ -261,4 +266,214 @@ namespace PhysIKA {
 			}
 		}
 	};
+
+	template<typename Real>
+	COMM_FUNC inline Real KernelPositivePart(const Real x)
+	{
+		return x > Real(0) ? x : Real(0);
+	}
+
+	/**
+	 * Kernel policies, the shape of a kernel as a function of q = r/h and its scale as a function of h.
+	 * The shapes vanish for q >= 1 without a branch, so a loop over them vectorizes.
+	 * weightScale()*weight(q) and gradientScale()*gradient(q) equal Weight() and Gradient() of the kernel classes above.
+	 */
+	template<typename Real>
+	struct SpikyPolicy
+	{
+		COMM_FUNC static Real weightScale(const Real h) { return Real(15) / ((Real)M_PI * h*h*h); }
+		COMM_FUNC static Real gradientScale(const Real h) { return Real(-45) / ((Real)M_PI * h*h*h); }
+
+		COMM_FUNC static Real weight(const Real q)
+		{
+			const Real d = KernelPositivePart(Real(1) - q);
+			return d*d*d;
+		}
+
+		COMM_FUNC static Real gradient(const Real q)
+		{
+			const Real d = KernelPositivePart(Real(1) - q);
+			return d*d;
+		}
+	};
+
+	template<typename Real>
+	struct SmoothPolicy
+	{
+		COMM_FUNC static Real weightScale(const Real) { return Real(1); }
+		COMM_FUNC static Real gradientScale(const Real) { return Real(-1); }
+
+		COMM_FUNC static Real weight(const Real q) { return KernelPositivePart(Real(1) - q*q); }
+		COMM_FUNC static Real gradient(const Real q) { return KernelPositivePart(Real(1) - q*q); }
+	};
+
+	//1/6*(2-s)^3 - 4/6*(1-s)^3 with s = 2q, the two pieces of the cubic spline
+	template<typename Real>
+	struct CubicPolicy
+	{
+		COMM_FUNC static Real weightScale(const Real h) { return Real(1) / (Real(4) * (Real)M_PI * h*h*h); }
+		COMM_FUNC static Real gradientScale(const Real h) { return Real(3) / (Real(2) * (Real)M_PI * h*h*h); }
+
+		COMM_FUNC static Real weight(const Real q)
+		{
+			const Real a = KernelPositivePart(Real(2) - Real(2)*q);
+			const Real b = KernelPositivePart(Real(1) - Real(2)*q);
+			return a*a*a - Real(4)*b*b*b;
+		}
+
+		COMM_FUNC static Real gradient(const Real q)
+		{
+			const Real a = KernelPositivePart(Real(2) - Real(2)*q);
+			const Real b = KernelPositivePart(Real(1) - Real(2)*q);
+			return Real(-0.5)*a*a + Real(2)*b*b;
+		}
+	};
+
+	//Wendland C2 kernel, 21/(2 pi h^3) (1-q)^4 (1+4q), the gradient is the derivative with respect to q
+	template<typename Real>
+	struct WendlandPolicy
+	{
+		COMM_FUNC static Real weightScale(const Real h) { return Real(21) / (Real(2) * (Real)M_PI * h*h*h); }
+		COMM_FUNC static Real gradientScale(const Real h) { return Real(-210) / ((Real)M_PI * h*h*h); }
+
+		COMM_FUNC static Real weight(const Real q)
+		{
+			const Real d = KernelPositivePart(Real(1) - q);
+			const Real dd = d*d;
+			return dd*dd*(Real(1) + Real(4)*q);
+		}
+
+		COMM_FUNC static Real gradient(const Real q)
+		{
+			const Real d = KernelPositivePart(Real(1) - q);
+			return q*d*d*d;
+		}
+	};
+
+	//Viscosity weight of ImplicitViscosity, 45/(13 pi h^3) (1-q), the gradient is the derivative with respect to q
+	template<typename Real>
+	struct ViscosityPolicy
+	{
+		COMM_FUNC static Real weightScale(const Real h) { return Real(45) / (Real(13) * (Real)M_PI * h*h*h); }
+		COMM_FUNC static Real gradientScale(const Real h) { return Real(-45) / (Real(13) * (Real)M_PI * h*h*h); }
+
+		COMM_FUNC static Real weight(const Real q) { return KernelPositivePart(Real(1) - q); }
+		COMM_FUNC static Real gradient(const Real q) { return q < Real(1) ? Real(1) : Real(0); }
+	};
+
+	/*!
+	*	\class	KernelFunction
+	*	\brief	Kernel of a fixed smoothing length, the scales and 1/h are computed once in setSmoothingLength().
+	*
+	*	Usage in a neighbor loop:
+	*		KernelFunction<Real, SpikyPolicy<Real>> kern(smoothingLength);
+	*		rho_i += mass*kern.weight(r);
+	*/
+	template<typename Real, typename Policy>
+	class KernelFunction
+	{
+	public:
+		COMM_FUNC KernelFunction() {};
+		COMM_FUNC KernelFunction(const Real h, const Real scale = Real(1)) { setSmoothingLength(h, scale); }
+
+		COMM_FUNC void setSmoothingLength(const Real h, const Real scale = Real(1))
+		{
+			m_invH = Real(1) / h;
+			m_weightScale = scale*Policy::weightScale(h);
+			m_gradientScale = scale*Policy::gradientScale(h);
+		}
+
+		COMM_FUNC inline Real weight(const Real r) const { return m_weightScale*Policy::weight(r*m_invH); }
+		COMM_FUNC inline Real gradient(const Real r) const { return m_gradientScale*Policy::gradient(r*m_invH); }
+
+		/**
+		 * @brief Batched host evaluation, w[i] = weight(r[i]). The loop has no branches and is vectorized by the compiler.
+		 */
+		void evaluate(const Real* r, Real* w, const int n) const
+		{
+			const Real invH = m_invH;
+			const Real scale = m_weightScale;
+			for (int i = 0; i < n; i++)
+			{
+				w[i] = scale*Policy::weight(r[i] * invH);
+			}
+		}
+
+		void evaluateGradient(const Real* r, Real* g, const int n) const
+		{
+			const Real invH = m_invH;
+			const Real scale = m_gradientScale;
+			for (int i = 0; i < n; i++)
+			{
+				g[i] = scale*Policy::gradient(r[i] * invH);
+			}
+		}
+
+	private:
+		Real m_invH = Real(1);
+		Real m_weightScale = Real(0);
+		Real m_gradientScale = Real(0);
+	};
+
+	/*!
+	*	\class	TabulatedKernel
+	*	\brief	Lookup table version of KernelFunction, the shapes are sampled at N+1 points of [0, 1] and interpolated linearly.
+	*
+	*	The table is a member, so the kernel can be passed by value to device functions like the other kernels.
+	*	It pays off for shapes that are more expensive than a few multiplications, the interpolation error is of order 1/N^2.
+	*/
+	template<typename Real, typename Policy, int N = 128>
+	class TabulatedKernel
+	{
+	public:
+		COMM_FUNC TabulatedKernel() {};
+		COMM_FUNC TabulatedKernel(const Real h, const Real scale = Real(1)) { setSmoothingLength(h, scale); }
+
+		COMM_FUNC void setSmoothingLength(const Real h, const Real scale = Real(1))
+		{
+			const Real weightScale = scale*Policy::weightScale(h);
+			const Real gradientScale = scale*Policy::gradientScale(h);
+			for (int i = 0; i <= N; i++)
+			{
+				const Real q = Real(i) / Real(N);
+				m_weight[i] = weightScale*Policy::weight(q);
+				m_gradient[i] = gradientScale*Policy::gradient(q);
+			}
+			m_invH = Real(N) / h;
+		}
+
+		COMM_FUNC inline Real weight(const Real r) const { return lookup(m_weight, r); }
+		COMM_FUNC inline Real gradient(const Real r) const { return lookup(m_gradient, r); }
+
+		void evaluate(const Real* r, Real* w, const int n) const
+		{
+			for (int i = 0; i < n; i++)
+			{
+				w[i] = lookup(m_weight, r[i]);
+			}
+		}
+
+		void evaluateGradient(const Real* r, Real* g, const int n) const
+		{
+			for (int i = 0; i < n; i++)
+			{
+				g[i] = lookup(m_gradient, r[i]);
+			}
+		}
+
+	private:
+		//The last sample is zero, distances beyond the support are clamped to it
+		COMM_FUNC inline Real lookup(const Real* table, const Real r) const
+		{
+			Real t = r*m_invH;
+			t = t < Real(N) ? t : Real(N);
+			const int i = (int)t < N - 1 ? (int)t : N - 1;
+			const Real f = t - Real(i);
+			return table[i] + f*(table[i + 1] - table[i]);
+		}
+
+		Real m_invH = Real(0);
+		Real m_weight[N + 1] = {};
+		Real m_gradient[N + 1] = {};
+	};
 }
@@ -131,9 +131,9 @@ namespace PhysIKA
 		
 		UpdateMassInv<Real, Coord, PhaseVector><<<pDims, BLOCK_SIZE>>>(
             m_massInv.getValue(), m_concentration.getValue(), m_restDensity.getValue());
-		m_pbdModule->constrain();
+		m_pbdModule->applyConstraint();
 
-		m_visModule->constrain();
+		m_visModule->applyConstraint();
 	
 		m_integrator->end();
 
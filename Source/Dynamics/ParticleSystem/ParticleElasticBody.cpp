@@ -92,7 +92,7 @@ namespace PhysIKA
 		integrator->integrate();
 
 		if (module != nullptr)
-			module->constrain();
+			module->applyConstraint();
 
 		integrator->end();
 	}
@@ -39,6 +39,15 @@ namespace PhysIKA
 	public:
 		DEF_EMPTY_VAR(Horizon, Real, "Horizon");
 
+		/**
+		 * @brief Speed of elastic waves sqrt(E/rho) of the material, bounds the stable time step together with the horizon
+		 */
+		DEF_VAR(WaveSpeed, Real, 0, "Speed of elastic waves");
+
+	protected:
+		Real getKernelRadius() override { return this->varHorizon()->getValue(); }
+		Real getSignalSpeed() override { return this->varWaveSpeed()->getValue(); }
+
 	private:
 		std::shared_ptr<Node> m_surfaceNode;
 	};
@@ -83,7 +83,7 @@ namespace PhysIKA
 
 		module->applyPlasticity();
 
-		m_visModule->constrain();
+		m_visModule->applyConstraint();
 
 		m_integrator->end();
 	}
@@ -21,58 +21,24 @@ namespace PhysIKA
 	}
 
 	template<typename TDataType>
-	void ParticleEmitter<TDataType>::advance2(Real dt)
+	void ParticleEmitter<TDataType>::emit(DeviceArrayField<Coord>* position, DeviceArrayField<Coord>* velocity, DeviceArrayField<Coord>* force)
 	{
 		generateParticles();
 
-		int cur_size = this->currentPosition()->getElementCount();
-
-		if (cur_size > 0)
-		{
-			DeviceArray<Coord>& cur_points0 = this->currentPosition()->getValue();
-			DeviceArray<Coord>& cur_vels0 = this->currentVelocity()->getValue();
-			DeviceArray<Coord>& cur_forces0 = this->currentForce()->getValue();
-
-			pos_buf.resize(cur_size);
-			vel_buf.resize(cur_size);
-			force_buf.resize(cur_size);
-
-			Function1Pt::copy(pos_buf, cur_points0);
-			Function1Pt::copy(vel_buf, cur_vels0);
-			Function1Pt::copy(force_buf, cur_forces0);
-		}
-
-
-		int total_num = cur_size + gen_pos.size();
-
-		if (total_num > 0)
-		{
-			this->currentPosition()->setElementCount(cur_size + gen_pos.size());
-			this->currentVelocity()->setElementCount(cur_size + gen_pos.size());
-			this->currentForce()->setElementCount(cur_size + gen_pos.size());
+		int gen_size = gen_pos.size();
+		if (gen_size <= 0)
+			return;
 
-			//printf("%d %d %d\n", cur_size, gen_pos.size(), this->currentPosition()->getElementCount());
+		//Newly generated particles are appended behind the existing ones, the cost is proportional to gen_size
+		//as long as the reserved capacity of the fields is not exceeded.
+		force_buf.resize(gen_size);
+		force_buf.reset();
 
-			DeviceArray<Coord>& cur_points = this->currentPosition()->getValue();
-			DeviceArray<Coord>& cur_vels = this->currentVelocity()->getValue();
-			DeviceArray<Coord>& cur_forces = this->currentForce()->getValue();
-
-			cur_points.reset();
-			cur_vels.reset();
-			cur_forces.reset();
-
-			cudaMemcpy(cur_points.getDataPtr(), pos_buf.getDataPtr(), cur_size * sizeof(Coord), cudaMemcpyDeviceToDevice);
-			cudaMemcpy(cur_points.getDataPtr() + cur_size, gen_pos.getDataPtr(), gen_pos.size() * sizeof(Coord), cudaMemcpyDeviceToDevice);
-
-			cudaMemcpy(cur_vels.getDataPtr(), vel_buf.getDataPtr(), cur_size * sizeof(Coord), cudaMemcpyDeviceToDevice);
-			cudaMemcpy(cur_vels.getDataPtr() + cur_size, gen_vel.getDataPtr(), gen_pos.size() * sizeof(Coord), cudaMemcpyDeviceToDevice);
-
-			cudaMemcpy(cur_forces.getDataPtr(), force_buf.getDataPtr(), cur_size * sizeof(Coord), cudaMemcpyDeviceToDevice);
-			cudaMemcpy(cur_forces.getDataPtr() + cur_size, gen_pos.getDataPtr(), gen_pos.size() * sizeof(Coord), cudaMemcpyDeviceToDevice);
-
-		}
-		//return;
+		position->append(gen_pos);
+		velocity->append(gen_vel);
+		force->append(force_buf);
 	}
+
 	template<typename TDataType>
 	void ParticleEmitter<TDataType>::advance(Real dt)
 	{
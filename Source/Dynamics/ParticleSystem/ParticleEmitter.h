@@ -22,7 +22,11 @@ namespace PhysIKA
 		ParticleEmitter(std::string name = "particle emitter");
 		virtual ~ParticleEmitter();
 
-		void advance2(Real dt);
+		/**
+		 * @brief Generate the particles of this frame and append them to the given fields, the particles already stored there are not touched
+		 */
+		void emit(DeviceArrayField<Coord>* position, DeviceArrayField<Coord>* velocity, DeviceArrayField<Coord>* force);
+
 		void advance(Real dt) override;
 		virtual void generateParticles();
 
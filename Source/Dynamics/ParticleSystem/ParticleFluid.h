@@ -26,6 +26,9 @@ namespace PhysIKA
 		void advance(Real dt) override;
 		bool resetStatus() override;
 
+	protected:
+		Real getKernelRadius() override;
+
 	private:
 		DEF_NODE_PORTS(ParticleEmitter, ParticleEmitter<TDataType>, "Particle Emitters");
 	};
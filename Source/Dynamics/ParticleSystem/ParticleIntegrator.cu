@@ -6,6 +6,8 @@
 #include "Core/Utility.h"
 #include "Framework/Framework/SceneGraph.h"
 
+#include <algorithm>
+
 namespace PhysIKA
 {
 	IMPLEMENT_CLASS_1(ParticleIntegrator, TDataType)
@@ -19,6 +21,13 @@ namespace PhysIKA
 	template<typename TDataType>
 	void ParticleIntegrator<TDataType>::begin()
 	{
+		if (this->isHostContext())
+		{
+			if (!this->inPosition()->isEmpty())
+				this->inForceDensity()->getHostReference()->reset();
+			return;
+		}
+
 		if (!this->inPosition()->isEmpty())
 		{
 			int num = this->inPosition()->getElementCount();
@@ -125,10 +134,61 @@ namespace PhysIKA
 		return true;
 	}
 
+	template<typename Real, typename Coord>
+	void H_UpdateVelocity(
+		int pId,
+		HostArray<Coord>& vel,
+		HostArray<Coord>& forceDensity,
+		Coord gravity,
+		Real dt)
+	{
+		vel[pId] += dt * (forceDensity[pId] + gravity);
+	}
+
+	template<typename TDataType>
+	void ParticleIntegrator<TDataType>::updateVelocity(HostArray<Coord>& vel, HostArray<Coord>& forceDensity, Real dt)
+	{
+		Coord gravity = SceneGraph::getInstance().getGravity();
+
+		cpuExecute(vel.size(), H_UpdateVelocity,
+			vel,
+			forceDensity,
+			gravity,
+			dt);
+	}
+
+	template<typename Real, typename Coord>
+	void H_UpdatePosition(
+		int pId,
+		HostArray<Coord>& pos,
+		HostArray<Coord>& vel,
+		Real dt)
+	{
+		pos[pId] += dt * vel[pId];
+	}
+
+	template<typename TDataType>
+	void ParticleIntegrator<TDataType>::updatePosition(HostArray<Coord>& pos, HostArray<Coord>& vel, Real dt)
+	{
+		cpuExecute(pos.size(), H_UpdatePosition,
+			pos,
+			vel,
+			dt);
+	}
+
 	template<typename TDataType>
 	bool ParticleIntegrator<TDataType>::integrate()
 	{
-		if (!this->inPosition()->isEmpty())
+		if (this->inPosition()->isEmpty())
+			return true;
+
+		if (this->isHostContext())
+		{
+			Real dt = getParent()->getDt();
+			updateVelocity(this->inVelocity()->getHostValue(), this->inForceDensity()->getHostValue(), dt);
+			updatePosition(this->inPosition()->getHostValue(), this->inVelocity()->getHostValue(), dt);
+		}
+		else
 		{
 			updateVelocity();
 			updatePosition();
@@ -136,4 +196,62 @@ namespace PhysIKA
 
 		return true;
 	}
+
+	template<typename Real, typename Coord>
+	__global__ void K_ComputeMotionNorm(
+		DeviceArray<Real> speed,
+		DeviceArray<Real> acceleration,
+		DeviceArray<Coord> vel,
+		DeviceArray<Coord> forceDensity,
+		Coord gravity)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= vel.size()) return;
+
+		speed[pId] = vel[pId].norm();
+		acceleration[pId] = (forceDensity[pId] + gravity).norm();
+	}
+
+	template<typename TDataType>
+	void ParticleIntegrator<TDataType>::computeMaxMotion(Real& maxSpeed, Real& maxAcceleration)
+	{
+		maxSpeed = Real(0);
+		maxAcceleration = Real(0);
+		if (this->inVelocity()->isEmpty() || this->inForceDensity()->isEmpty())
+		{
+			return;
+		}
+
+		int num = this->inVelocity()->getElementCount();
+		if (num == 0)
+		{
+			return;
+		}
+
+		Coord gravity = SceneGraph::getInstance().getGravity();
+
+		if (this->isHostContext())
+		{
+			HostArray<Coord>& vel = this->inVelocity()->getHostValue();
+			HostArray<Coord>& forceDensity = this->inForceDensity()->getHostValue();
+			for (int i = 0; i < num; i++)
+			{
+				maxSpeed = std::max(maxSpeed, vel[i].norm());
+				maxAcceleration = std::max(maxAcceleration, (forceDensity[i] + gravity).norm());
+			}
+			return;
+		}
+
+		m_speed.resize(num);
+		m_acceleration.resize(num);
+		cuExecute(num, K_ComputeMotionNorm,
+			m_speed,
+			m_acceleration,
+			this->inVelocity()->getValue(),
+			this->inForceDensity()->getValue(),
+			gravity);
+
+		maxSpeed = m_reduce.maximum(m_speed.getDataPtr(), num);
+		maxAcceleration = m_reduce.maximum(m_acceleration.getDataPtr(), num);
+	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Framework/Framework/NumericalIntegrator.h"
 #include "Framework/Framework/FieldVar.h"
 #include "Framework/Framework/FieldArray.h"
+#include "Core/Utility/Reduction.h"
 
 namespace PhysIKA {
 	template<typename TDataType>
@@ -19,11 +20,25 @@ namespace PhysIKA {
 		void begin() override;
 		void end() override;
 
+		/**
+		 * @brief Runs the host kernels below on the host data of the fields if the node runs on a CPU context
+		 */
 		bool integrate() override;
 
 		bool updateVelocity();
 		bool updatePosition();
 
+		/**
+		* @brief Host kernels executed on ThreadPool over arrays owned by the caller, no CUDA device is involved
+		*/
+		void updateVelocity(HostArray<Coord>& vel, HostArray<Coord>& forceDensity, Real dt);
+		void updatePosition(HostArray<Coord>& pos, HostArray<Coord>& vel, Real dt);
+
+		/**
+		* @brief Largest particle speed and largest acceleration, the force density plus gravity, of the current state
+		*/
+		void computeMaxMotion(Real& maxSpeed, Real& maxAcceleration);
+
 	protected:
 		bool initializeImpl() override;
 
@@ -51,6 +66,10 @@ namespace PhysIKA {
 	private:
 		DeviceArray<Coord> m_prePosition;
 		DeviceArray<Coord> m_preVelocity;
+
+		DeviceArray<Real> m_speed;
+		DeviceArray<Real> m_acceleration;
+		Reduction<Real> m_reduce;
 	};
 
 #ifdef PRECISION_FLOAT
@@ -0,0 +1,209 @@
+#include <cuda_runtime.h>
+#include <thrust/sort.h>
+#include <thrust/execution_policy.h>
+#include "ParticleReorder.h"
+#include "Core/Utility.h"
+#include "Framework/Framework/Node.h"
+
+#include <algorithm>
+
+namespace PhysIKA
+{
+	IMPLEMENT_CLASS_1(ParticleReorder, TDataType)
+
+	COMM_FUNC inline unsigned long long RE_SplitBits(unsigned long long x)
+	{
+		x &= 0x1fffff;
+		x = (x | x << 32) & 0x1f00000000ffffull;
+		x = (x | x << 16) & 0x1f0000ff0000ffull;
+		x = (x | x << 8) & 0x100f00f00f00f00full;
+		x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+		x = (x | x << 2) & 0x1249249249249249ull;
+		return x;
+	}
+
+	/*!
+	*	Morton code of the cell containing pos, cell indices are shifted by 2^20 so that negative coordinates are ordered correctly.
+	*/
+	template<typename Real, typename Coord>
+	COMM_FUNC inline unsigned long long RE_SpatialKey(Coord pos, Real h)
+	{
+		const long long shift = 1 << 20;
+		unsigned long long i = (unsigned long long)((long long)floor(pos[0] / h) + shift);
+		unsigned long long j = (unsigned long long)((long long)floor(pos[1] / h) + shift);
+		unsigned long long k = (unsigned long long)((long long)floor(pos[2] / h) + shift);
+
+		return RE_SplitBits(i) | (RE_SplitBits(j) << 1) | (RE_SplitBits(k) << 2);
+	}
+
+	template<typename TDataType>
+	ParticleReorder<TDataType>::ParticleReorder()
+		: ComputeModule()
+	{
+	}
+
+	template<typename TDataType>
+	ParticleReorder<TDataType>::~ParticleReorder()
+	{
+		m_order.release();
+		m_keys.release();
+		m_buffer.release();
+	}
+
+	template<typename TDataType>
+	bool ParticleReorder<TDataType>::initializeImpl()
+	{
+		if (this->inPosition()->isEmpty() || this->inCellSize()->isEmpty())
+		{
+			std::cout << "Exception: " << std::string("ParticleReorder's fields are not fully initialized!") << "\n";
+			return false;
+		}
+
+		m_step = 0;
+		updateParticleId();
+
+		return true;
+	}
+
+	template<typename TDataType>
+	void ParticleReorder<TDataType>::compute()
+	{
+		updateParticleId();
+
+		int interval = this->varInterval()->getValue();
+		if (interval <= 0)
+			return;
+
+		m_step++;
+		if (m_step % interval == 0)
+		{
+			reorder();
+		}
+	}
+
+	template<typename TDataType>
+	void ParticleReorder<TDataType>::updateParticleId()
+	{
+		int num = this->inPosition()->getElementCount();
+		int idNum = this->outParticleId()->getElementCount();
+		if (idNum == num)
+			return;
+
+		//Particles appended behind the existing ones receive the next ids, any other change restarts the numbering
+		int first = num > idNum ? idNum : 0;
+		if (first == 0)
+			this->outParticleId()->setElementCount(0);
+
+		HostArray<int> hostIds(num - first);
+		for (int i = 0; i < num - first; i++)
+		{
+			hostIds[i] = first + i;
+		}
+
+		DeviceArray<int> ids(num - first);
+		Function1Pt::copy(ids, hostIds);
+		this->outParticleId()->append(ids);
+
+		hostIds.release();
+		ids.release();
+	}
+
+	template<typename Real, typename Coord>
+	__global__ void RE_ComputeKeys(
+		DeviceArray<unsigned long long> keys,
+		DeviceArray<int> order,
+		DeviceArray<Coord> position,
+		Real h)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= position.size()) return;
+
+		keys[pId] = RE_SpatialKey(position[pId], h);
+		order[pId] = pId;
+	}
+
+	template<typename TDataType>
+	void ParticleReorder<TDataType>::computeOrder()
+	{
+		int num = this->inPosition()->getElementCount();
+		Real h = this->inCellSize()->getValue();
+
+		if (m_order.size() != num)
+		{
+			m_order.resize(num);
+			m_keys.resize(num);
+		}
+
+		cuExecute(num, RE_ComputeKeys,
+			m_keys,
+			m_order,
+			this->inPosition()->getValue(),
+			h);
+
+		thrust::sort_by_key(thrust::device, m_keys.getDataPtr(), m_keys.getDataPtr() + num, m_order.getDataPtr());
+		cuSynchronize();
+	}
+
+	__global__ void RE_GatherBytes(
+		char* dst,
+		const char* src,
+		DeviceArray<int> order,
+		size_t elemSize)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= order.size()) return;
+
+		const char* from = src + order[pId] * elemSize;
+		char* to = dst + pId * elemSize;
+		for (size_t b = 0; b < elemSize; b++)
+		{
+			to[b] = from[b];
+		}
+	}
+
+	template<typename TDataType>
+	void ParticleReorder<TDataType>::permuteMemory(void* data, size_t elemSize)
+	{
+		int num = m_order.size();
+		size_t bytes = num * elemSize;
+
+		if (m_buffer.size() < bytes)
+			m_buffer.resize(bytes);
+
+		cuExecute(num, RE_GatherBytes,
+			m_buffer.getDataPtr(),
+			(const char*)data,
+			m_order,
+			elemSize);
+
+		cuSafeCall(cudaMemcpy(data, m_buffer.getDataPtr(), bytes, cudaMemcpyDeviceToDevice));
+	}
+
+	template<typename TDataType>
+	void ParticleReorder<TDataType>::reorder()
+	{
+		int num = this->inPosition()->getElementCount();
+		if (num <= 1)
+			return;
+
+		updateParticleId();
+		computeOrder();
+
+		permuteMemory(this->inPosition()->getValue().getDataPtr(), sizeof(Coord));
+
+		if (this->inVelocity()->getElementCount() == num)
+			permuteMemory(this->inVelocity()->getValue().getDataPtr(), sizeof(Coord));
+
+		if (this->inForce()->getElementCount() == num)
+			permuteMemory(this->inForce()->getValue().getDataPtr(), sizeof(Coord));
+
+		permuteMemory(this->outParticleId()->getValue().getDataPtr(), sizeof(int));
+
+		for (auto& permuter : m_permuters)
+		{
+			permuter();
+		}
+
+		m_reorderNum++;
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "Framework/Framework/ModuleCompute.h"
+#include "Framework/Framework/FieldVar.h"
+#include "Framework/Framework/FieldArray.h"
+
+#include <functional>
+#include <vector>
+
+namespace PhysIKA {
+
+	/*!
+	*	\class	ParticleReorder
+	*	\brief	Periodically permutes per-particle arrays by the Morton code of the grid cell each particle lies in.
+	*
+	*	Particles keep their creation order otherwise, so that after some frames of motion the neighbors of a particle
+	*	are scattered over the whole array. Sorting by cell key brings them back close in memory.
+	*
+	*	outParticleId() maps the current index of a particle to its original (creation) index. Modules that address
+	*	particles by id, e.g. FixedPoints or ParticleWriter, should be connected to it to stay independent of the order.
+	*/
+	template<typename TDataType>
+	class ParticleReorder : public ComputeModule
+	{
+		DECLARE_CLASS_1(ParticleReorder, TDataType)
+
+	public:
+		typedef typename TDataType::Real Real;
+		typedef typename TDataType::Coord Coord;
+
+		ParticleReorder();
+		~ParticleReorder() override;
+
+		void compute() override;
+
+		/**
+		 * @brief Sort the particles immediately, regardless of the interval
+		 */
+		void reorder();
+
+		/**
+		 * @brief Number of permutations applied so far, cached neighbor lists are stale whenever it changes
+		 */
+		int getReorderCount() { return m_reorderNum; }
+
+		/**
+		 * @brief Attach an additional per-particle field that is permuted along with the positions
+		 */
+		template<typename T>
+		void attachParticleField(DeviceArrayField<T>* field)
+		{
+			m_permuters.push_back([this, field]() {
+				if (field->getElementCount() == m_order.size())
+					permuteMemory(field->getValue().getDataPtr(), sizeof(T));
+			});
+		}
+
+	public:
+		/**
+		 * @brief Number of compute() calls between two reorderings, 0 disables reordering
+		 */
+		DEF_VAR(Interval, int, 100, "Number of steps between two reorderings");
+
+		/**
+		 * @brief Edge length of the cells used to compute the sorting key, usually the smoothing length
+		 */
+		DEF_EMPTY_IN_VAR(CellSize, Real, "Cell size");
+
+		DEF_EMPTY_IN_ARRAY(Position, Coord, DeviceType::GPU, "Particle position");
+		DEF_EMPTY_IN_ARRAY(Velocity, Coord, DeviceType::GPU, "Particle velocity");
+		DEF_EMPTY_IN_ARRAY(Force, Coord, DeviceType::GPU, "Particle force");
+
+		/**
+		 * @brief Original index of each particle
+		 */
+		DEF_EMPTY_OUT_ARRAY(ParticleId, int, DeviceType::GPU, "Original index of each particle");
+
+	protected:
+		bool initializeImpl() override;
+
+	private:
+		void updateParticleId();
+		void computeOrder();
+		void permuteMemory(void* data, size_t elemSize);
+
+		int m_step = 0;
+		int m_reorderNum = 0;
+
+		DeviceArray<int> m_order;
+		DeviceArray<unsigned long long> m_keys;
+		DeviceArray<char> m_buffer;
+
+		std::vector<std::function<void()>> m_permuters;
+	};
+
+#ifdef PRECISION_FLOAT
+	template class ParticleReorder<DataType3f>;
+#else
+	template class ParticleReorder<DataType3d>;
+#endif
+}
@@ -195,18 +195,18 @@ namespace PhysIKA
 		}
 
 		if (m_fixed != nullptr)
-			m_fixed->constrain();
+			m_fixed->applyConstraint();
 
 		if (m_integrator != nullptr)
 			m_integrator->begin();
 
 		m_integrator->integrate();
  	
-		m_one_dim_elasticity->constrain();
+		m_one_dim_elasticity->applyConstraint();
 		//m_elasticity->constrain();
 
 		if (m_damping != nullptr)
-			m_damping->constrain();
+			m_damping->applyConstraint();
 
 		if (m_integrator != nullptr)
 			m_integrator->end();
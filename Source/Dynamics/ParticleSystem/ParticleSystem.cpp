@@ -1,8 +1,14 @@
 #include "ParticleSystem.h"
 #include "PositionBasedFluidModel.h"
+#include "ParticleIntegrator.h"
 
 #include "Framework/Topology/PointSet.h"
 #include "Core/Utility.h"
+#include "IO/Particle_IO/ParticleCache.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 
 namespace PhysIKA
@@ -33,9 +39,46 @@ namespace PhysIKA
 	template<typename TDataType>
 	void ParticleSystem<TDataType>::loadParticles(std::string filename)
 	{
+		std::string ext = ".pcache";
+		if (filename.size() > ext.size() && filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0)
+		{
+			ParticleCacheFrame frame;
+			if (!ParticleCache::read(filename, frame) || !loadParticles(frame))
+			{
+				Log::sendMessage(Log::Error, "Failed to load the particle cache " + filename);
+			}
+			return;
+		}
+
 		m_pSet->loadObjFile(filename);
 	}
 
+	template<typename TDataType>
+	bool ParticleSystem<TDataType>::loadParticles(ParticleCacheFrame& frame)
+	{
+		frame.restoreOrder();
+
+		ParticleCacheColumn* pos = frame.getColumn("position");
+		if (pos == nullptr || pos->components != 3)
+			return false;
+
+		std::vector<Coord> vertList(pos->size());
+		pos->copyTo((Real*)vertList.data());
+
+		m_initialVelocity.clear();
+		ParticleCacheColumn* vel = frame.getColumn("velocity");
+		if (vel != nullptr && vel->components == 3 && vel->size() == pos->size())
+		{
+			m_initialVelocity.resize(vel->size());
+			vel->copyTo((Real*)m_initialVelocity.data());
+		}
+
+		std::vector<Coord> normalList(vertList.size());
+		setParticles(vertList, normalList);
+
+		return true;
+	}
+
 	template<typename TDataType>
 	void ParticleSystem<TDataType>::loadParticles(Coord center, Real r, Real distance)
 	{
@@ -61,8 +104,7 @@ namespace PhysIKA
 		}
 		normalList.resize(vertList.size());
 
-		m_pSet->setPoints(vertList);
-		m_pSet->setNormals(normalList);
+		setParticles(vertList, normalList);
 
 		vertList.clear();
 		normalList.clear();
@@ -87,8 +129,7 @@ namespace PhysIKA
 		}
 		normalList.resize(vertList.size());
 
-		m_pSet->setPoints(vertList);
-		m_pSet->setNormals(normalList);
+		setParticles(vertList, normalList);
 
 		std::cout << "particle number: " << vertList.size() << std::endl;
 
@@ -96,9 +137,32 @@ namespace PhysIKA
 		normalList.clear();
 	}
 
+	template<typename TDataType>
+	void ParticleSystem<TDataType>::setParticles(std::vector<Coord>& points, std::vector<Coord>& normals)
+	{
+		//The point set only has device storage, a node on a CPU context keeps its particles on the host until the reset
+		if (this->getContext()->isCPU())
+		{
+			m_initialPosition = points;
+			return;
+		}
+
+		m_pSet->setPoints(points);
+		m_pSet->setNormals(normals);
+	}
+
 	template<typename TDataType>
 	bool ParticleSystem<TDataType>::translate(Coord t)
 	{
+		if (this->getContext()->isCPU())
+		{
+			for (auto& p : m_initialPosition)
+			{
+				p += t;
+			}
+			return true;
+		}
+
 		m_pSet->translate(t);
 
 		return true;
@@ -108,6 +172,15 @@ namespace PhysIKA
 	template<typename TDataType>
 	bool ParticleSystem<TDataType>::scale(Real s)
 	{
+		if (this->getContext()->isCPU())
+		{
+			for (auto& p : m_initialPosition)
+			{
+				p *= s;
+			}
+			return true;
+		}
+
 		m_pSet->scale(s);
 
 		return true;
@@ -134,6 +207,10 @@ namespace PhysIKA
 	template<typename TDataType>
 	void ParticleSystem<TDataType>::updateTopology()
 	{
+		//No point set to update on a CPU context, the positions stay in the host field
+		if (this->getContext()->isCPU())
+			return;
+
 		if (!this->currentPosition()->isEmpty())
 		{
 			int num = this->currentPosition()->getElementCount();
@@ -151,6 +228,22 @@ namespace PhysIKA
 	template<typename TDataType>
 	bool ParticleSystem<TDataType>::resetStatus()
 	{
+		if (this->getContext()->isCPU())
+		{
+			int num = m_initialPosition.size();
+			if (num > 0)
+			{
+				this->currentPosition()->setValue(m_initialPosition);
+				this->currentVelocity()->setElementCount(num);
+				this->currentForce()->setElementCount(num);
+
+				if (m_initialVelocity.size() == num)
+					this->currentVelocity()->setValue(m_initialVelocity);
+			}
+
+			return Node::resetStatus();
+		}
+
 		auto pts = m_pSet->getPoints();
 
 		if (pts.size() > 0)
@@ -160,7 +253,10 @@ namespace PhysIKA
 			this->currentForce()->setElementCount(pts.size());
 
 			Function1Pt::copy(this->currentPosition()->getValue(), pts);
-			this->currentVelocity()->getReference()->reset();
+			if (m_initialVelocity.size() == pts.size())
+				Function1Pt::copy(this->currentVelocity()->getValue(), m_initialVelocity);
+			else
+				this->currentVelocity()->getReference()->reset();
 		}
 
 		return Node::resetStatus();
@@ -177,4 +273,31 @@ namespace PhysIKA
 // 
 // 		return m_pointsRender;
 // 	}
+
+	template<typename TDataType>
+	typename TDataType::Real ParticleSystem<TDataType>::getStableDt()
+	{
+		auto integrator = TypeInfo::CastPointerDown<ParticleIntegrator<TDataType>>(this->getNumericalIntegrator());
+		Real h = this->getKernelRadius();
+		if (integrator == nullptr || h <= Real(0) || this->currentPosition()->isEmpty())
+		{
+			return Node::getStableDt();
+		}
+
+		Real maxSpeed, maxAcceleration;
+		integrator->computeMaxMotion(maxSpeed, maxAcceleration);
+
+		Real dt = FLT_MAX;
+		Real speed = maxSpeed + this->getSignalSpeed();
+		if (speed > Real(0))
+		{
+			dt = h / speed;
+		}
+		if (maxAcceleration > Real(0))
+		{
+			dt = std::min(dt, std::sqrt(h / maxAcceleration));
+		}
+
+		return this->varCourantNumber()->getValue() * dt;
+	}
 }
\ No newline at end of file
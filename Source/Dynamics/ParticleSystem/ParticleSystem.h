@@ -5,6 +5,7 @@
 namespace PhysIKA
 {
 	template <typename TDataType> class PointSet;
+	class ParticleCacheFrame;
 	/*!
 	*	\class	ParticleSystem
 	*	\brief	Position-based fluids.
@@ -30,6 +31,11 @@ namespace PhysIKA
 		void loadParticles(Coord center, Real r, Real distance);
 		void loadParticles(std::string filename);
 
+		/**
+		 * @brief Load positions and, if present, velocities from a particle cache frame written by ParticleWriter
+		 */
+		bool loadParticles(ParticleCacheFrame& frame);
+
 		virtual bool translate(Coord t);
 		virtual bool scale(Real s);
 
@@ -37,6 +43,12 @@ namespace PhysIKA
 		void updateTopology() override;
 		bool resetStatus() override;
 
+		/**
+		 * @brief CFL condition, dt = C * min(h / (v_max + c), sqrt(h / a_max)) with the Courant number C,
+		 * the kernel radius h, the signal speed c, the largest particle speed v_max and acceleration a_max
+		 */
+		Real getStableDt() override;
+
 //		std::shared_ptr<PointRenderModule> getRenderModule();
 
 		/**
@@ -55,13 +67,35 @@ namespace PhysIKA
 		 */
 		DEF_EMPTY_CURRENT_ARRAY(Force, Coord, DeviceType::GPU, "Force on each particle");
 
-		
+		/**
+		 * @brief Courant number of the stable time step
+		 */
+		DEF_VAR(CourantNumber, Real, 0.4, "Courant number of the stable time step");
+
 	public:
 		bool initialize() override;
 //		virtual void setVisible(bool visible) override;
 
 	protected:
+		/**
+		 * @brief Kernel radius and signal speed of the stable time step, a radius of zero imposes no limit
+		 */
+		virtual Real getKernelRadius() { return Real(0); }
+		virtual Real getSignalSpeed() { return Real(0); }
+
+		/**
+		 * @brief Initial particles of the next reset, kept on the host instead of the point set if the node runs on a CPU context.
+		 * The context has to be set before the particles are loaded.
+		 */
+		void setParticles(std::vector<Coord>& points, std::vector<Coord>& normals);
+
 		std::shared_ptr<PointSet<TDataType>> m_pSet;
+
+		/**
+		 * @brief Velocities restored from a particle cache, applied on reset
+		 */
+		std::vector<Coord> m_initialVelocity;
+		std::vector<Coord> m_initialPosition;
 //		std::shared_ptr<PointRenderModule> m_pointsRender;
 	};
 
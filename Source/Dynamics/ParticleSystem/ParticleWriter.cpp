@@ -1,12 +1,10 @@
 #include "ParticleWriter.h"
 #include "Framework/Framework/MechanicalState.h"
 #include "Framework/Framework/ModuleIO.h"
-#include "Core/Utility/Function1Pt.h"
+#include "Framework/Framework/SceneGraph.h"
+#include "Core/Utility.h"
 
 #include <sstream>
-#include <iostream>
-#include <fstream>
-#include <iomanip>
 
 namespace PhysIKA
 {
@@ -17,7 +15,11 @@ namespace PhysIKA
 	: IOModule()
 	{
 		attachField(&m_position, MechanicalState::position(), "Storing the particle positions!", false);
+		attachField(&m_velocity, MechanicalState::velocity(), "Storing the particle velocities!", false);
 		attachField(&m_color_mapping, "ColorMapping", "Storing the particle properties!", false);
+		attachField(&m_particle_id, "ParticleId", "Storing the original particle indices!", false);
+
+		this->setAsynchronous(true);
 	}
 
 	template<typename TDataType>
@@ -38,55 +40,62 @@ namespace PhysIKA
 	}
 
 	template<typename TDataType>
-	bool PhysIKA::ParticleWriter<TDataType>::execute()
+	void ParticleWriter<TDataType>::setCacheOptions(const ParticleCacheOptions& options)
 	{
+		m_options = options;
+	}
 
-		printf("===========WRITER============\n");
-		assert(m_position.getElementCount() == m_color_mapping.getElementCount());
-
-		
-
-		std::stringstream ss; ss << m_output_index;
-		std::string filename = m_output_path + std::string("D:\\info\\0918\\test_") + ss.str() + std::string(".txt");
-		std::ofstream output(filename.c_str(), std::ios::out | std::ios::binary);
-
-		int total_num = m_position.getElementCount();
-
-		output.write((char*)&total_num, sizeof(int));
-
-		if (total_num == 0)
-		{
-			m_output_index++;
-			output.close();
-			return true;
-		}
+	template<typename TDataType>
+	void ParticleWriter<TDataType>::flush()
+	{
+		IOPipeline::getInstance().flush();
+	}
 
+	template<typename Scalar>
+	void stageColumn(ParticleCacheFrame& frame, std::string name, int components, void* data, int num)
+	{
+		ParticleCacheColumn& col = frame.addColumn<Scalar>(name, components, num);
+		cuSafeCall(cudaMemcpy(col.getDataPtr(), data, col.data.size(), cudaMemcpyDeviceToHost));
+	}
 
-		HostArray<Coord> host_position;
-		HostArray<Real> host_mapping;
-		host_position.resize(total_num);
-		host_mapping.resize(total_num);
+	template<typename T>
+	void stageColumn(ParticleCacheFrame& frame, std::string name, DeviceArrayField<T>& field, int num)
+	{
+		if (!field.isEmpty() && field.getElementCount() == num)
+			stageColumn<T>(frame, name, 1, field.getValue().getDataPtr(), num);
+	}
 
-		Function1Pt::copy(host_position, m_position.getValue());
-		Function1Pt::copy(host_mapping, m_color_mapping.getValue());
+	template<typename T>
+	void stageColumn(ParticleCacheFrame& frame, std::string name, DeviceArrayField<Vector<T, 3>>& field, int num)
+	{
+		if (!field.isEmpty() && field.getElementCount() == num)
+			stageColumn<T>(frame, name, 3, field.getValue().getDataPtr(), num);
+	}
 
-		
-		for (int i = 0; i < total_num; i++)
-		{
-			output.write((char*)&(host_position[i][0]), sizeof(Real));
-			output.write((char*)&(host_position[i][1]), sizeof(Real));
-			output.write((char*)&(host_position[i][2]), sizeof(Real));
-			output.write((char*)&(host_mapping[i]), sizeof(Real));
-		}
+	template<typename TDataType>
+	bool PhysIKA::ParticleWriter<TDataType>::execute()
+	{
+		int total_num = m_position.isEmpty() ? 0 : m_position.getElementCount();
 
-		output.close();
+		std::shared_ptr<ParticleCacheFrame> frame = m_framePool.acquire();
+		frame->clear();
+		frame->frame = m_output_index;
+		frame->time = SceneGraph::getInstance().getElapsedTime();
 
-		host_position.release();
-		host_mapping.release();
+		stageColumn(*frame, "position", m_position, total_num);
+		stageColumn(*frame, "velocity", m_velocity, total_num);
+		stageColumn(*frame, "ColorMapping", m_color_mapping, total_num);
+		stageColumn(*frame, "id", m_particle_id, total_num);
+		frame->particleNum = total_num;
 
+		std::stringstream ss; ss << m_output_index;
+		std::string filename = m_output_path + m_name_prefix + ss.str() + std::string(".pcache");
+		ParticleCacheOptions options = m_options;
 
 		m_output_index++;
 
-		return true;
+		return this->dispatch([frame, filename, options]() {
+			return ParticleCache::write(filename, *frame, options);
+		});
 	}
 }
\ No newline at end of file
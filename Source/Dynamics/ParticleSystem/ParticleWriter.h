@@ -1,6 +1,8 @@
 #pragma once
 #include "Framework/Framework/ModuleIO.h"
 #include "Framework/Framework/ModuleTopology.h"
+#include "Framework/Framework/IOPipeline.h"
+#include "IO/Particle_IO/ParticleCache.h"
 
 #include <string>
 
@@ -8,6 +10,14 @@ namespace PhysIKA
 {
 
 	template <typename TDataType> class TriangleSet;
+
+	/*!
+	*	\class	ParticleWriter
+	*	\brief	Writes the connected particle attributes to one binary cache file per frame, see ParticleCache.
+	*
+	*	The attributes are copied into a pooled host staging frame, encoding and writing are dispatched to the
+	*	IOPipeline unless the writer is switched to synchronous mode with setAsynchronous(false).
+	*/
 	template<typename TDataType>
 	class ParticleWriter : public IOModule
 	{
@@ -22,12 +32,29 @@ namespace PhysIKA
 		void setNamePrefix(std::string prefix);
 		void setOutputPath(std::string path);
 
+		/**
+		 * @brief Quantization, compression and chunk size of the cache files
+		 */
+		void setCacheOptions(const ParticleCacheOptions& options);
+
+		/**
+		 * @brief Wait until all queued frames are on disk
+		 */
+		void flush();
+
 		bool execute() override;
 
 	public:
 		DeviceArrayField<Coord> m_position;
+		DeviceArrayField<Coord> m_velocity;
 		DeviceArrayField<Real> m_color_mapping;
 
+		/**
+		 * @brief Original index of each particle, optional.
+		 * Once connected, it is stored as the "id" column and ParticleCacheFrame::restoreOrder() recovers the original order.
+		 */
+		DeviceArrayField<int> m_particle_id;
+
 		DeviceArrayField<Triangle> m_triangle_index;
 		DeviceArrayField<Coord> m_triangle_pos;
 
@@ -35,6 +62,9 @@ namespace PhysIKA
 		int m_output_index = 0;
 		std::string m_output_path;
 		std::string m_name_prefix;
+
+		ParticleCacheOptions m_options;
+		IOBufferPool<ParticleCacheFrame> m_framePool;
 	};
 
 #ifdef PRECISION_FLOAT
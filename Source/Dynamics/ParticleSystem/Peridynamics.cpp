@@ -74,7 +74,7 @@ namespace PhysIKA
 
 		m_integrator->integrate();
 
-		m_elasticity->constrain();
+		m_elasticity->applyConstraint();
 
 		m_integrator->end();
 	}
@@ -4,6 +4,7 @@
 #include "ParticleIntegrator.h"
 #include "SummationDensity.h"
 #include "ImplicitViscosity.h"
+#include "ParticleReorder.h"
 #include "Framework/Framework/MechanicalState.h"
 #include "Framework/Mapping/PointSetToPointSet.h"
 #include "Framework/Topology/FieldNeighbor.h"
@@ -40,14 +41,34 @@ namespace PhysIKA
 	template<typename TDataType>
 	bool PositionBasedFluidModel<TDataType>::initializeImpl()
 	{
-		cuSynchronize();
+		//The modules below initialize on the host data of the fields on a CPU context, where there is no device to synchronize
+		bool host = this->isHostContext();
+		if (!host)
+			cuSynchronize();
+
+		if (m_reorderInterval > 0 && host)
+		{
+			Log::sendMessage(Log::Warning, "Particle reordering is not supported on a CPU context");
+		}
+		else if (m_reorderInterval > 0)
+		{
+			m_reorder = this->getParent()->addComputeModule<ParticleReorder<TDataType>>("reorder");
+			m_reorder->varInterval()->setValue(m_reorderInterval);
+			m_smoothingLength.connect(m_reorder->inCellSize());
+			m_position.connect(m_reorder->inPosition());
+			m_velocity.connect(m_reorder->inVelocity());
+			m_forceDensity.connect(m_reorder->inForce());
+			m_reorder->initialize();
+		}
 
 		m_nbrQuery = this->getParent()->addComputeModule<NeighborQuery<TDataType>>("neighborhood");
 		m_smoothingLength.connect(m_nbrQuery->inRadius());
 		m_position.connect(m_nbrQuery->inPosition());
+		m_nbrQuery->varSkin()->setValue(m_neighborSkin);
 		m_nbrQuery->initialize();
 
-		cuSynchronize();
+		if (!host)
+			cuSynchronize();
 
 		m_pbdModule = this->getParent()->addConstraintModule<DensityPBD<TDataType>>("density_constraint");
 		m_smoothingLength.connect(m_pbdModule->varSmoothingLength());
@@ -56,7 +77,8 @@ namespace PhysIKA
 		m_nbrQuery->outNeighborhood()->connect(m_pbdModule->inNeighborIndex());
 		m_pbdModule->initialize();
 
-		cuSynchronize();
+		if (!host)
+			cuSynchronize();
 
 		m_integrator = this->getParent()->setNumericalIntegrator<ParticleIntegrator<TDataType>>("integrator");
 		m_position.connect(m_integrator->inPosition());
@@ -64,7 +86,8 @@ namespace PhysIKA
 		m_forceDensity.connect(m_integrator->inForceDensity());
 		m_integrator->initialize();
 
-		cuSynchronize();
+		if (!host)
+			cuSynchronize();
 
 		m_visModule = this->getParent()->addConstraintModule<ImplicitViscosity<TDataType>>("viscosity");
 		m_visModule->setViscosity(Real(1));
@@ -74,7 +97,8 @@ namespace PhysIKA
 		m_nbrQuery->outNeighborhood()->connect(&m_visModule->m_neighborhood);
 		m_visModule->initialize();
 
-		cuSynchronize();
+		if (!host)
+			cuSynchronize();
 
 		return true;
 	}
@@ -88,14 +112,25 @@ namespace PhysIKA
 			Log::sendMessage(Log::Error, "Parent not set for ParticleSystem!");
 			return;
 		}
+
+		if (m_reorder != nullptr)
+		{
+			int reorderNum = m_reorder->getReorderCount();
+			m_reorder->compute();
+
+			//The cached neighbor ids refer to the old particle order
+			if (m_reorder->getReorderCount() != reorderNum)
+				m_nbrQuery->invalidate();
+		}
+
 		m_integrator->begin();
 
  		m_nbrQuery->compute();
  		m_integrator->integrate();
 		
-		m_pbdModule->constrain();
+		m_pbdModule->applyConstraint();
 
- 		m_visModule->constrain();
+ 		m_visModule->applyConstraint();
 		
 		m_integrator->end();
 	}
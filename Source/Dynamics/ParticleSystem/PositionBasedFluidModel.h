@@ -11,6 +11,7 @@ namespace PhysIKA
 	template<typename TDataType> class NeighborQuery;
 	template<typename TDataType> class DensityPBD;
 	template<typename TDataType> class ImplicitViscosity;
+	template<typename TDataType> class ParticleReorder;
 	class ForceModule;
 	class ConstraintModule;
 	/*!
@@ -41,6 +42,22 @@ namespace PhysIKA
 		void setViscositySolver(std::shared_ptr<ConstraintModule> solver);
 		void setSurfaceTensionSolver(std::shared_ptr<ForceModule> solver);
 
+		/**
+		 * @brief Sort the particles by grid cell every n steps to improve memory locality, 0 (default) disables sorting.
+		 * Must be called before initialization.
+		 */
+		void setReorderInterval(int n) { m_reorderInterval = n; }
+
+		std::shared_ptr<ParticleReorder<TDataType>> getReorderModule() { return m_reorder; }
+
+		/**
+		 * @brief Reuse the neighbor list across steps with a Verlet skin of the given width, 0 (default) rebuilds every step.
+		 * Must be called before initialization.
+		 */
+		void setNeighborSkin(Real skin) { m_neighborSkin = skin; }
+
+		std::shared_ptr<NeighborQuery<TDataType>> getNeighborQuery() { return m_nbrQuery; }
+
 		DeviceArrayField<Real>* getDensityField()
 		{
 			return m_pbdModule->outDensity();
@@ -59,6 +76,8 @@ namespace PhysIKA
 	private:
 		int m_pNum;
 		Real m_restRho;
+		int m_reorderInterval = 0;
+		Real m_neighborSkin = Real(0);
 
 		std::shared_ptr<ForceModule> m_surfaceTensionSolver;
 		std::shared_ptr<ConstraintModule> m_viscositySolver;
@@ -70,6 +89,7 @@ namespace PhysIKA
 		std::shared_ptr<PointSetToPointSet<TDataType>> m_mapping;
 		std::shared_ptr<ParticleIntegrator<TDataType>> m_integrator;
 		std::shared_ptr<NeighborQuery<TDataType>>m_nbrQuery;
+		std::shared_ptr<ParticleReorder<TDataType>> m_reorder;
 	};
 
 #ifdef PRECISION_FLOAT
@@ -1371,6 +1371,7 @@ namespace PhysIKA
 		//return true; 
 
 		Real dt = getParent()->getDt();
+		assert(!m_neighborhood_particles.getValue().isHalf());
 
 //		int start_f = Start.getValue();
 //		cudaMemcpy(m_velocityAll.getValue().getDataPtr() + start_f, m_particle_velocity.getValue().getDataPtr(), num_f * sizeof(Coord), cudaMemcpyDeviceToDevice);
@@ -182,10 +182,10 @@ namespace  PhysIKA
 		m_meshCollision->doCollision();
 		
 		
-		m_visModule->constrain();
+		m_visModule->applyConstraint();
 		
 		
-		m_pbdModule->constrain();
+		m_pbdModule->applyConstraint();
 		
 		m_integrator->end();
 	}
@@ -238,7 +238,7 @@ namespace PhysIKA
 		m_nbrQuery->compute();
 
 		auto module = this->template getModule<DensityPBD<TDataType>>("collision");
-		module->constrain();
+		module->applyConstraint();
 
 // 		auto module2 = this->template getModule<ImplicitViscosity<TDataType>>("viscosity");
 // 		module2->constrain();
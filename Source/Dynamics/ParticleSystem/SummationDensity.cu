@@ -9,19 +9,21 @@ namespace PhysIKA
 {
 	IMPLEMENT_CLASS_1(SummationDensity, TDataType)
 
+	template<typename Real>
+	using DensityKernel = KernelFunction<Real, SpikyPolicy<Real>>;
+
 	template<typename Real, typename Coord>
 	__global__ void K_ComputeDensity(
 		DeviceArray<Real> rhoArr,
 		DeviceArray<Coord> posArr,
 		NeighborList<int> neighbors,
-		Real smoothingLength,
+		DensityKernel<Real> kern,
 		Real mass
 	)
 	{
 		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
 		if (pId >= posArr.size()) return;
 
-		SpikyKernel<Real> kern;
 		Real r;
 		Real rho_i = Real(0);
 		Coord pos_i = posArr[pId];
@@ -30,11 +32,100 @@ namespace PhysIKA
 		{
 			int j = neighbors.getElement(pId, ne);
 			r = (pos_i - posArr[j]).norm();
-			rho_i += mass*kern.Weight(r, smoothingLength);
+			rho_i += mass*kern.weight(r);
 		}
 		rhoArr[pId] = rho_i;
 	}
 
+	/**
+	 * The distances are gathered in batches and the weights evaluated in one vectorized loop
+	 */
+	template<typename Real, typename Coord>
+	void H_ComputeDensity(
+		int pId,
+		HostArray<Real>& rhoArr,
+		HostArray<Coord>& posArr,
+		HostNeighborList<int>& neighbors,
+		DensityKernel<Real>& kern,
+		Real mass)
+	{
+		const int batch = 32;
+		Real r[batch];
+		Real w[batch];
+
+		Real rho_i = Real(0);
+		Coord pos_i = posArr[pId];
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne += batch)
+		{
+			int num = nbSize - ne < batch ? nbSize - ne : batch;
+			for (int k = 0; k < num; k++)
+			{
+				int j = neighbors.getElement(pId, ne + k);
+				r[k] = (pos_i - posArr[j]).norm();
+			}
+
+			kern.evaluate(r, w, num);
+			for (int k = 0; k < num; k++)
+			{
+				rho_i += w[k];
+			}
+		}
+		rhoArr[pId] = mass*rho_i;
+	}
+
+	/**
+	 * Half neighbor lists store every pair once, the pair weight is added to both particles
+	 */
+	template<typename Real, typename Coord>
+	__global__ void K_ComputeDensityHalf(
+		DeviceArray<Real> rhoArr,
+		DeviceArray<Coord> posArr,
+		NeighborList<int> neighbors,
+		DensityKernel<Real> kern,
+		Real mass
+	)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= posArr.size()) return;
+
+		Real rho_i = mass*kern.weight(Real(0));
+		Coord pos_i = posArr[pId];
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+			Real rho_ij = mass*kern.weight(r);
+			rho_i += rho_ij;
+			atomicAdd(&rhoArr[j], rho_ij);
+		}
+		atomicAdd(&rhoArr[pId], rho_i);
+	}
+
+	template<typename Real, typename Coord>
+	void H_ComputeDensityHalf(
+		int pId,
+		Real* rhoAcc,
+		HostArray<Coord>& posArr,
+		HostNeighborList<int>& neighbors,
+		DensityKernel<Real>& kern,
+		Real mass)
+	{
+		Real rho_i = mass*kern.weight(Real(0));
+		Coord pos_i = posArr[pId];
+		int nbSize = neighbors.getNeighborSize(pId);
+		for (int ne = 0; ne < nbSize; ne++)
+		{
+			int j = neighbors.getElement(pId, ne);
+			Real r = (pos_i - posArr[j]).norm();
+			Real rho_ij = mass*kern.weight(r);
+			rho_i += rho_ij;
+			rhoAcc[j] += rho_ij;
+		}
+		rhoAcc[pId] += rho_i;
+	}
+
 	template<typename TDataType>
 	SummationDensity<TDataType>::SummationDensity()
 		: ComputeModule()
@@ -101,14 +192,54 @@ namespace PhysIKA
 		Real smoothingLength,
 		Real mass)
 	{
+		DensityKernel<Real> kern(smoothingLength);
+		if (neighbors.isHalf())
+		{
+			rho.reset();
+			cuExecute(rho.size(), K_ComputeDensityHalf,
+				rho,
+				pos,
+				neighbors,
+				kern,
+				m_factor*mass);
+			return;
+		}
+
 		cuExecute(rho.size(), K_ComputeDensity,
 			rho, 
 			pos, 
 			neighbors, 
-			smoothingLength, 
+			kern, 
 			m_factor*mass);
 	}
 
+	template<typename TDataType>
+	void SummationDensity<TDataType>::compute(
+		HostArray<Real>& rho,
+		HostArray<Coord>& pos,
+		HostNeighborList<int>& neighbors)
+	{
+		Real smoothingLength = this->varSmoothingLength()->getValue();
+		Real mass = m_factor*m_particle_mass;
+		DensityKernel<Real> kern(smoothingLength);
+
+		if (neighbors.isHalf())
+		{
+			rho.reset();
+			m_hostScatter.scatter(rho.getDataPtr(), rho.size(), rho.size(), [&](int pId, Real* rhoAcc) {
+				H_ComputeDensityHalf(pId, rhoAcc, pos, neighbors, kern, mass);
+			});
+			return;
+		}
+
+		cpuExecute(rho.size(), H_ComputeDensity,
+			rho,
+			pos,
+			neighbors,
+			kern,
+			mass);
+	}
+
 	template<typename TDataType>
 	void SummationDensity<TDataType>::calculateScalingFactor()
 	{
@@ -3,6 +3,8 @@
 #include "Framework/Framework/FieldVar.h"
 #include "Framework/Framework/FieldArray.h"
 #include "Framework/Topology/FieldNeighbor.h"
+#include "Framework/Topology/HostNeighborList.h"
+#include "Core/Utility/ThreadPool.h"
 
 namespace PhysIKA {
 
@@ -24,6 +26,14 @@ namespace PhysIKA {
 		~SummationDensity() override {};
 
 		void compute() override;
+
+		/**
+		 * @brief Host kernel executed on ThreadPool over arrays owned by the caller, no CUDA device is involved
+		 */
+		void compute(
+			HostArray<Real>& rho,
+			HostArray<Coord>& pos,
+			HostNeighborList<int>& neighbors);
 	
 	protected:
 		void calculateScalingFactor();
@@ -64,6 +74,8 @@ namespace PhysIKA {
 	private:
 		Real m_particle_mass;
 		Real m_factor;
+
+		ScatterBuffer<Real> m_hostScatter;
 	};
 
 #ifdef PRECISION_FLOAT
@@ -2,7 +2,8 @@
 #include "Core/Utility.h"
 #include "SurfaceTension.h"
 #include "Framework/Framework/MechanicalState.h"
-#include "Framework/Topology/NeighborList.h"
+#include "Framework/Framework/Node.h"
+#include "Framework/Topology/FieldNeighbor.h"
 #include "Kernel.h"
 
 namespace PhysIKA
@@ -110,6 +111,11 @@ namespace PhysIKA
 	template<typename TDataType>
 	bool SurfaceTension<TDataType>::execute()
 	{
+		//The surface energy and the tension below gather over full neighbor lists
+		auto mstate = this->getParent()->getMechanicalState();
+		auto neighborFd = mstate ? mstate->getField<NeighborField<int>>(m_neighborhoodID) : nullptr;
+		assert(neighborFd == nullptr || !neighborFd->getValue().isHalf());
+
 // 		m_energy = DeviceBuffer<Real>::create(num);
 // 
 // 		DeviceArray<Coord>* posArr = m_parent->GetNewPositionBuffer()->getDataPtr();
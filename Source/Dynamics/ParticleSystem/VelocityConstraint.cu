@@ -356,13 +356,43 @@ namespace PhysIKA
 		}
 	}
 
-	// compute Ax;
+	// count the valid pairs of each row
+	template <typename Coord>
+	__global__ void VC_CountPairs
+	(
+		DeviceArray<int> count,
+		DeviceArray<Coord> position,
+		DeviceArray<Attribute> attribute,
+		NeighborList<int> neighbor
+	)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= position.size()) return;
+
+		int num = 0;
+		if (attribute[pId].IsDynamic())
+		{
+			Coord pos_i = position[pId];
+			int nbSize = neighbor.getNeighborSize(pId);
+			for (int ne = 0; ne < nbSize; ne++)
+			{
+				int j = neighbor.getElement(pId, ne);
+				if ((pos_i - position[j]).norm() > EPSILON && attribute[j].IsDynamic())
+				{
+					num++;
+				}
+			}
+		}
+		count[pId] = num;
+	}
+
+	// compute the off-diagonal elements a_ij + a_ji, the neighborhood is symmetric
 	template <typename Real, typename Coord>
-	__global__ void VC_ComputeAx
+	__global__ void VC_ComputePairWeights
 	(
-		DeviceArray<Real> residual,
-		DeviceArray<Real> pressure,
-		DeviceArray<Real> aiiSymArr,
+		DeviceArray<int> column,
+		DeviceArray<Real> weight,
+		DeviceArray<int> index,
 		DeviceArray<Real> alpha,
 		DeviceArray<Coord> position,
 		DeviceArray<Attribute> attribute,
@@ -377,9 +407,7 @@ namespace PhysIKA
 		Coord pos_i = position[pId];
 		Real invAlpha_i = 1.0f / alpha[pId];
 
-		atomicAdd(&residual[pId], aiiSymArr[pId] * pressure[pId]);
-		Real con1 = 1.0f;// PARAMS.mass / PARAMS.restDensity / PARAMS.restDensity;
-
+		int k = index[pId];
 		int nbSize = neighbor.getNeighborSize(pId);
 		for (int ne = 0; ne < nbSize; ne++)
 		{
@@ -389,14 +417,58 @@ namespace PhysIKA
 			if (r > EPSILON && attribute[j].IsDynamic())
 			{
 				Real wrr_ij = kernWRR(r, smoothingLength);
-				Real a_ij = -invAlpha_i*wrr_ij;
-				//				residual += con1*a_ij*preArr[j];
-				atomicAdd(&residual[pId], con1*a_ij*pressure[j]);
-				atomicAdd(&residual[j], con1*a_ij*pressure[pId]);
+				column[k] = j;
+				weight[k] = -(invAlpha_i + 1.0f / alpha[j])*wrr_ij;
+				k++;
 			}
 		}
 	}
 
+	// compute Ax;
+	template <typename Real>
+	__global__ void VC_ComputeAx
+	(
+		DeviceArray<Real> residual,
+		DeviceArray<Real> pressure,
+		DeviceArray<Real> aiiSymArr,
+		DeviceArray<int> index,
+		DeviceArray<int> column,
+		DeviceArray<Real> weight,
+		DeviceArray<Attribute> attribute
+	)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= pressure.size()) return;
+		if (!attribute[pId].IsDynamic())
+		{
+			residual[pId] = 0.0f;
+			return;
+		}
+
+		Real sum = aiiSymArr[pId] * pressure[pId];
+		int end = index[pId + 1];
+		for (int k = index[pId]; k < end; k++)
+		{
+			sum += weight[k] * pressure[column[k]];
+		}
+		residual[pId] = sum;
+	}
+
+	template <typename Real>
+	__global__ void VC_ComputeInverseDiagonal
+	(
+		DeviceArray<Real> invDiagonal,
+		DeviceArray<Real> aiiSymArr,
+		DeviceArray<Attribute> attribute
+	)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= invDiagonal.size()) return;
+
+		Real aii = aiiSymArr[pId];
+		invDiagonal[pId] = attribute[pId].IsDynamic() && abs(aii) > EPSILON ? 1.0f / aii : 0.0f;
+	}
+
 	template <typename Real, typename Coord>
 	__global__ void VC_UpdateVelocityBoundaryCorrected(
 		DeviceArray<Real> pressure,
@@ -562,6 +634,12 @@ namespace PhysIKA
 		m_y.release();
 		m_r.release();
 		m_p.release();
+		m_z.release();
+		m_invDiagonal.release();
+
+		m_pairIndex.release();
+		m_pairColumn.release();
+		m_pairWeight.release();
 
 		m_pressure.release();
 
@@ -578,6 +656,9 @@ namespace PhysIKA
 	template<typename TDataType>
 	bool VelocityConstraint<TDataType>::constrain()
 	{
+		//Alpha, the pair weights and the velocity corrections gather over full neighbor lists
+		assert(!m_neighborhood.getValue().isHalf());
+
 		Real dt = getParent()->getDt();
 
 		uint pDims = cudaGridSize(m_position.getElementCount(), BLOCK_SIZE);
@@ -648,52 +729,63 @@ namespace PhysIKA
 			dt);
 		
 		//solve the linear system of equations with a conjugate gradient method.
-		m_y.reset();
-		VC_ComputeAx << <pDims, BLOCK_SIZE >> > (
-			m_y, 
-			m_pressure, 
-			m_Aii, 
-			m_alpha, 
-			m_position.getValue(),
-			m_attribute.getValue(),
-			m_neighborhood.getValue(),
-			m_smoothingLength.getValue());
+		buildPairWeights();
+
+		bool preconditioned = m_preconditioner == Jacobi;
+		if (preconditioned)
+		{
+			VC_ComputeInverseDiagonal << <pDims, BLOCK_SIZE >> > (
+				m_invDiagonal,
+				m_Aii,
+				m_attribute.getValue());
+		}
+
+		multiply(m_y, m_pressure);
 
 		m_r.reset();
 		Function2Pt::subtract(m_r, m_divergence, m_y);
-		Function1Pt::copy(m_p, m_r);
+
+		//z = M^-1 r, the residual itself without a preconditioner
+		DeviceArray<Real>& z = preconditioned ? m_z : m_r;
+		if (preconditioned)
+		{
+			Function2Pt::multiply(m_z, m_invDiagonal, m_r);
+		}
+		Function1Pt::copy(m_p, z);
+
 		Real rr = m_arithmetic->Dot(m_r, m_r);
+		Real rz = preconditioned ? m_arithmetic->Dot(m_r, m_z) : rr;
 		Real err = sqrt(rr / m_r.size());
 
 		while (itor < 1000 && err > 1.0f)
 		{
-			m_y.reset();
-			//VC_ComputeAx << <pDims, BLOCK_SIZE >> > (*yArr, *pArr, *aiiArr, *alphaArr, *posArr, *attArr, *neighborArr);
-			VC_ComputeAx << <pDims, BLOCK_SIZE >> > (
-				m_y, 
-				m_p, 
-				m_Aii, 
-				m_alpha, 
-				m_position.getValue(),
-				m_attribute.getValue(),
-				m_neighborhood.getValue(),
-				m_smoothingLength.getValue());
-
-			float alpha = rr / m_arithmetic->Dot(m_p, m_y);
+			multiply(m_y, m_p);
+
+			float alpha = rz / m_arithmetic->Dot(m_p, m_y);
 			Function2Pt::saxpy(m_pressure, m_p, m_pressure, alpha);
 			Function2Pt::saxpy(m_r, m_y, m_r, -alpha);
 
-			Real rr_old = rr;
-
 			rr = m_arithmetic->Dot(m_r, m_r);
 
-			Real beta = rr / rr_old;
-			Function2Pt::saxpy(m_p, m_p, m_r, beta);
+			Real rz_old = rz;
+			if (preconditioned)
+			{
+				Function2Pt::multiply(m_z, m_invDiagonal, m_r);
+				rz = m_arithmetic->Dot(m_r, m_z);
+			}
+			else
+			{
+				rz = rr;
+			}
+
+			Real beta = rz / rz_old;
+			Function2Pt::saxpy(m_p, m_p, z, beta);
 
 			err = sqrt(rr / m_r.size());
 
 			itor++;
 		}
+		m_iterationNum = itor;
 
 		//update the each particle's velocity
 		VC_UpdateVelocityBoundaryCorrected << <pDims, BLOCK_SIZE >> > (
@@ -715,6 +807,59 @@ namespace PhysIKA
 		return true;
 	}
 
+	template<typename TDataType>
+	void VelocityConstraint<TDataType>::multiply(DeviceArray<Real>& y, DeviceArray<Real>& x)
+	{
+		uint pDims = cudaGridSize(x.size(), BLOCK_SIZE);
+
+		VC_ComputeAx << <pDims, BLOCK_SIZE >> > (
+			y,
+			x,
+			m_Aii,
+			m_pairIndex,
+			m_pairColumn,
+			m_pairWeight,
+			m_attribute.getValue());
+	}
+
+	template<typename TDataType>
+	void VelocityConstraint<TDataType>::buildPairWeights()
+	{
+		int num = m_position.getElementCount();
+		uint pDims = cudaGridSize(num, BLOCK_SIZE);
+
+		if (m_pairIndex.size() != num + 1)
+		{
+			m_pairIndex.resize(num + 1);
+		}
+
+		m_pairIndex.reset();
+		VC_CountPairs << <pDims, BLOCK_SIZE >> > (
+			m_pairIndex,
+			m_position.getValue(),
+			m_attribute.getValue(),
+			m_neighborhood.getValue());
+
+		int sum = m_pairReduce.accumulate(m_pairIndex.getDataPtr(), num);
+		m_pairScan.exclusive(m_pairIndex, true);
+
+		if (m_pairColumn.size() < sum)
+		{
+			m_pairColumn.resize(sum);
+			m_pairWeight.resize(sum);
+		}
+
+		VC_ComputePairWeights << <pDims, BLOCK_SIZE >> > (
+			m_pairColumn,
+			m_pairWeight,
+			m_pairIndex,
+			m_alpha,
+			m_position.getValue(),
+			m_attribute.getValue(),
+			m_neighborhood.getValue(),
+			m_smoothingLength.getValue());
+	}
+
 	template<typename TDataType>
 	bool VelocityConstraint<TDataType>::initializeImpl()
 	{
@@ -743,6 +888,8 @@ namespace PhysIKA
 		m_y.resize(num);
 		m_r.resize(num);
 		m_p.resize(num);
+		m_z.resize(num);
+		m_invDiagonal.resize(num);
 
 		m_pressure.resize(num);
 
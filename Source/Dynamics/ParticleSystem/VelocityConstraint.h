@@ -17,11 +17,44 @@ namespace PhysIKA {
 		typedef typename TDataType::Real Real;
 		typedef typename TDataType::Coord Coord;
 
+		enum Preconditioner
+		{
+			None,
+			Jacobi
+		};
+
 		VelocityConstraint();
 		~VelocityConstraint() override;
 		
 		bool constrain() override;
 
+		/**
+		 * @brief Preconditioner of the conjugate gradient solve of the pressure, None by default
+		 */
+		void setPreconditioner(Preconditioner type) { m_preconditioner = type; }
+		Preconditioner getPreconditioner() { return m_preconditioner; }
+
+		/**
+		 * @brief Number of conjugate gradient iterations of the last call to constrain()
+		 */
+		int getIterationNumber() { return m_iterationNum; }
+
+		/**
+		 * @brief y = A x with the coefficient matrix assembled by the last call to constrain()
+		 */
+		void multiply(DeviceArray<Real>& y, DeviceArray<Real>& x);
+
+		/**
+		 * @brief Pressures solved by the last call to constrain(), they are the initial guess of the next solve
+		 */
+		DeviceArray<Real>& getPressure() { return m_pressure; }
+
+		/**
+		 * @brief Corrected alpha and the diagonal of the coefficient matrix of the last call to constrain()
+		 */
+		DeviceArray<Real>& getAlpha() { return m_alpha; }
+		DeviceArray<Real>& getDiagonal() { return m_Aii; }
+
 	public:
 		VarField<Real> m_smoothingLength;
 
@@ -35,6 +68,8 @@ namespace PhysIKA {
 		bool initializeImpl() override;
 
 	private:
+		void buildPairWeights();
+
 		bool m_bConfigured = false;
 		Real m_maxAlpha;
 		Real m_maxA;
@@ -62,6 +97,18 @@ namespace PhysIKA {
 		DeviceArray<Real> m_y;
 		DeviceArray<Real> m_r;
 		DeviceArray<Real> m_p;
+		DeviceArray<Real> m_z;
+		DeviceArray<Real> m_invDiagonal;
+
+		//Off-diagonal elements of the coefficient matrix in CSR format, the positions do not change during the solve
+		DeviceArray<int> m_pairIndex;
+		DeviceArray<int> m_pairColumn;
+		DeviceArray<Real> m_pairWeight;
+		Reduction<int> m_pairReduce;
+		Scan m_pairScan;
+
+		Preconditioner m_preconditioner = None;
+		int m_iterationNum = 0;
 
 		Reduction<Real>* m_reduce;
 		Arithmetic<Real>* m_arithmetic;
@@ -0,0 +1,419 @@
+#include "Dynamics/RigidBody/AABBTreeDetector.h"
+#include "Framework/Framework/Profiler.h"
+#include "Core/Utility/ThreadPool.h"
+#include <algorithm>
+
+namespace PhysIKA
+{
+	template<typename T>
+	BoxAABB3d<T> _combine(const BoxAABB3d<T>& a, const BoxAABB3d<T>& b)
+	{
+		return BoxAABB3d<T>(
+			std::min(a.m_l[0], b.m_l[0]), std::min(a.m_l[1], b.m_l[1]), std::min(a.m_l[2], b.m_l[2]),
+			std::max(a.m_u[0], b.m_u[0]), std::max(a.m_u[1], b.m_u[1]), std::max(a.m_u[2], b.m_u[2]));
+	}
+
+	template<typename T>
+	T _area(const BoxAABB3d<T>& a)
+	{
+		T dx = a.m_u[0] - a.m_l[0];
+		T dy = a.m_u[1] - a.m_l[1];
+		T dz = a.m_u[2] - a.m_l[2];
+		return 2 * (dx * dy + dy * dz + dz * dx);
+	}
+
+	template<typename T>
+	bool _contains(const BoxAABB3d<T>& a, const BoxAABB3d<T>& b)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (b.m_l[axis] < a.m_l[axis] || b.m_u[axis] > a.m_u[axis])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// same test as BoxAABB3d::isIntersect, inlined for the tree traversal
+	template<typename T>
+	inline bool _overlap(const BoxAABB3d<T>& a, const BoxAABB3d<T>& b)
+	{
+		return a.m_l[0] <= b.m_u[0] && a.m_u[0] >= b.m_l[0]
+			&& a.m_l[1] <= b.m_u[1] && a.m_u[1] >= b.m_l[1]
+			&& a.m_l[2] <= b.m_u[2] && a.m_u[2] >= b.m_l[2];
+	}
+
+	template<typename T>
+	void AABBTreeDetector<T>::reset()
+	{
+		m_nodes.clear();
+		m_root = -1;
+		m_free_list = -1;
+		m_leaf.clear();
+		m_moved.clear();
+		m_pairs.clear();
+		m_pair_index.clear();
+		m_collision_pairs.clear();
+	}
+
+	template<typename T>
+	const std::vector<std::pair<int, int>>& AABBTreeDetector<T>::detect(const std::vector<BoxAABB3d<T>>& boxes)
+	{
+		ProfileScope scope("AABBTreeDetector::detect");
+
+		int n = boxes.size();
+
+		// boxes that are gone
+		for (int i = n; i < m_leaf.size(); ++i)
+		{
+			removeLeaf(m_leaf[i]);
+			freeNode(m_leaf[i]);
+		}
+		m_leaf.resize(n, -1);
+
+		// new boxes and boxes that left their fattened bounds
+		m_moved.clear();
+		for (int i = 0; i < n; ++i)
+		{
+			int leaf = m_leaf[i];
+			if (leaf < 0)
+			{
+				leaf = allocateNode();
+				m_nodes[leaf].box_id = i;
+				m_leaf[i] = leaf;
+			}
+			else if (_contains(m_nodes[leaf].box, boxes[i]))
+			{
+				continue;
+			}
+			else
+			{
+				removeLeaf(leaf);
+			}
+
+			m_nodes[leaf].box = fatten(boxes[i]);
+			insertLeaf(leaf);
+			m_moved.push_back(i);
+		}
+
+		// only the moved leaves can have new overlaps of the fattened bounds
+		ThreadPool& pool = ThreadPool::getInstance();
+		int moved_num = m_moved.size();
+		int grain = std::max(256, moved_num / ((int)pool.getThreadNum() * 4));
+		int chunk_num = (moved_num + grain - 1) / grain;
+		if (m_buffers.size() < chunk_num)
+		{
+			m_buffers.resize(chunk_num);
+		}
+
+		pool.parallelRange(moved_num, [&](int begin, int end) {
+			QueryBuffer& buffer = m_buffers[begin / grain];
+			buffer.pairs.clear();
+			for (int i = begin; i < end; ++i)
+			{
+				query(m_moved[i], buffer);
+			}
+		}, grain);
+
+		for (int c = 0; c < chunk_num; ++c)
+		{
+			const std::vector<std::pair<int, int>>& pairs = m_buffers[c].pairs;
+			for (int i = 0; i < pairs.size(); ++i)
+			{
+				PairKey key = ((PairKey)pairs[i].first << 32) | (PairKey)pairs[i].second;
+				if (m_pair_index.find(key) == m_pair_index.end())
+				{
+					m_pair_index[key] = m_pairs.size();
+					m_pairs.push_back(pairs[i]);
+				}
+			}
+		}
+
+		// drop the cached pairs whose fattened bounds separated, test the others with the actual boxes
+		m_collision_pairs.clear();
+		int i = 0;
+		while (i < m_pairs.size())
+		{
+			int id0 = m_pairs[i].first;
+			int id1 = m_pairs[i].second;
+			if (id1 >= n || !_overlap(m_nodes[m_leaf[id0]].box, m_nodes[m_leaf[id1]].box))
+			{
+				m_pair_index.erase(((PairKey)id0 << 32) | (PairKey)id1);
+				if (i != m_pairs.size() - 1)
+				{
+					m_pairs[i] = m_pairs.back();
+					m_pair_index[((PairKey)m_pairs[i].first << 32) | (PairKey)m_pairs[i].second] = i;
+				}
+				m_pairs.pop_back();
+				continue;
+			}
+
+			if (_overlap(boxes[id0], boxes[id1]))
+			{
+				m_collision_pairs.push_back(m_pairs[i]);
+			}
+			++i;
+		}
+
+		return m_collision_pairs;
+	}
+
+	template<typename T>
+	void AABBTreeDetector<T>::query(int box_id, QueryBuffer& buffer) const
+	{
+		const BoxAABB3d<T>& box = m_nodes[m_leaf[box_id]].box;
+
+		std::vector<int>& stack = buffer.stack;
+		stack.clear();
+		stack.push_back(m_root);
+		while (!stack.empty())
+		{
+			const TreeNode& node = m_nodes[stack.back()];
+			stack.pop_back();
+
+			if (!_overlap(node.box, box))
+			{
+				continue;
+			}
+
+			if (node.isLeaf())
+			{
+				if (node.box_id != box_id)
+				{
+					buffer.pairs.push_back(std::make_pair(std::min(box_id, node.box_id), std::max(box_id, node.box_id)));
+				}
+			}
+			else
+			{
+				stack.push_back(node.child[0]);
+				stack.push_back(node.child[1]);
+			}
+		}
+	}
+
+	template<typename T>
+	BoxAABB3d<T> AABBTreeDetector<T>::fatten(const BoxAABB3d<T>& box) const
+	{
+		BoxAABB3d<T> fat = box;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			T margin = m_margin + m_relative_margin * (box.m_u[axis] - box.m_l[axis]);
+			fat.m_l[axis] -= margin;
+			fat.m_u[axis] += margin;
+		}
+		return fat;
+	}
+
+	template<typename T>
+	int AABBTreeDetector<T>::allocateNode()
+	{
+		int id = m_free_list;
+		if (id >= 0)
+		{
+			m_free_list = m_nodes[id].parent;
+		}
+		else
+		{
+			id = m_nodes.size();
+			m_nodes.push_back(TreeNode());
+		}
+
+		TreeNode& node = m_nodes[id];
+		node.parent = -1;
+		node.child[0] = -1;
+		node.child[1] = -1;
+		node.height = 0;
+		node.box_id = -1;
+		return id;
+	}
+
+	template<typename T>
+	void AABBTreeDetector<T>::freeNode(int id)
+	{
+		m_nodes[id].parent = m_free_list;
+		m_nodes[id].height = -1;
+		m_free_list = id;
+	}
+
+	template<typename T>
+	void AABBTreeDetector<T>::insertLeaf(int leaf)
+	{
+		if (m_root < 0)
+		{
+			m_root = leaf;
+			m_nodes[leaf].parent = -1;
+			return;
+		}
+
+		// find the best sibling with the surface area heuristic
+		BoxAABB3d<T> leaf_box = m_nodes[leaf].box;
+		int index = m_root;
+		while (!m_nodes[index].isLeaf())
+		{
+			const TreeNode& node = m_nodes[index];
+
+			T area = _area(node.box);
+			T combined_area = _area(_combine(node.box, leaf_box));
+
+			// cost of a new parent for this node and the leaf
+			T cost = 2 * combined_area;
+
+			// minimum cost of pushing the leaf further down the tree
+			T inheritance_cost = 2 * (combined_area - area);
+
+			T child_cost[2];
+			for (int k = 0; k < 2; ++k)
+			{
+				const TreeNode& child = m_nodes[node.child[k]];
+				T new_area = _area(_combine(leaf_box, child.box));
+				child_cost[k] = (child.isLeaf() ? new_area : new_area - _area(child.box)) + inheritance_cost;
+			}
+
+			if (cost < child_cost[0] && cost < child_cost[1])
+			{
+				break;
+			}
+
+			index = child_cost[0] < child_cost[1] ? node.child[0] : node.child[1];
+		}
+
+		int sibling = index;
+
+		// create a new parent
+		int old_parent = m_nodes[sibling].parent;
+		int new_parent = allocateNode();
+		m_nodes[new_parent].parent = old_parent;
+		m_nodes[new_parent].box = _combine(leaf_box, m_nodes[sibling].box);
+		m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+		m_nodes[new_parent].child[0] = sibling;
+		m_nodes[new_parent].child[1] = leaf;
+		m_nodes[sibling].parent = new_parent;
+		m_nodes[leaf].parent = new_parent;
+
+		if (old_parent >= 0)
+		{
+			TreeNode& parent = m_nodes[old_parent];
+			parent.child[parent.child[0] == sibling ? 0 : 1] = new_parent;
+		}
+		else
+		{
+			m_root = new_parent;
+		}
+
+		// refit and balance the ancestors
+		index = m_nodes[leaf].parent;
+		while (index >= 0)
+		{
+			rotate(index);
+
+			TreeNode& node = m_nodes[index];
+			const TreeNode& child0 = m_nodes[node.child[0]];
+			const TreeNode& child1 = m_nodes[node.child[1]];
+			node.height = 1 + std::max(child0.height, child1.height);
+			node.box = _combine(child0.box, child1.box);
+
+			index = node.parent;
+		}
+	}
+
+	template<typename T>
+	void AABBTreeDetector<T>::removeLeaf(int leaf)
+	{
+		if (leaf == m_root)
+		{
+			m_root = -1;
+			return;
+		}
+
+		int parent = m_nodes[leaf].parent;
+		int grand_parent = m_nodes[parent].parent;
+		int sibling = m_nodes[parent].child[0] == leaf ? m_nodes[parent].child[1] : m_nodes[parent].child[0];
+
+		if (grand_parent >= 0)
+		{
+			// replace the parent by the sibling
+			TreeNode& node = m_nodes[grand_parent];
+			node.child[node.child[0] == parent ? 0 : 1] = sibling;
+			m_nodes[sibling].parent = grand_parent;
+			freeNode(parent);
+
+			int index = grand_parent;
+			while (index >= 0)
+			{
+				rotate(index);
+
+				TreeNode& cur = m_nodes[index];
+				const TreeNode& child0 = m_nodes[cur.child[0]];
+				const TreeNode& child1 = m_nodes[cur.child[1]];
+				cur.box = _combine(child0.box, child1.box);
+				cur.height = 1 + std::max(child0.height, child1.height);
+
+				index = cur.parent;
+			}
+		}
+		else
+		{
+			m_root = sibling;
+			m_nodes[sibling].parent = -1;
+			freeNode(parent);
+		}
+	}
+
+	template<typename T>
+	void AABBTreeDetector<T>::rotate(int id_a)
+	{
+		TreeNode& a = m_nodes[id_a];
+		if (a.height < 2)
+		{
+			return;
+		}
+
+		// Swap a child of a with a grandchild under the other child, if that shrinks the other child the most
+		T best_gain = 0;
+		int best_child = -1;
+		int best_grand = -1;
+		for (int k = 0; k < 2; ++k)
+		{
+			const TreeNode& x = m_nodes[a.child[k]];
+			const TreeNode& y = m_nodes[a.child[1 - k]];
+			if (y.isLeaf())
+			{
+				continue;
+			}
+
+			T area = _area(y.box);
+			for (int g = 0; g < 2; ++g)
+			{
+				// x replaces the grandchild g, y then bounds x and the other grandchild
+				T gain = area - _area(_combine(x.box, m_nodes[y.child[1 - g]].box));
+				if (gain > best_gain)
+				{
+					best_gain = gain;
+					best_child = k;
+					best_grand = g;
+				}
+			}
+		}
+
+		if (best_child < 0)
+		{
+			return;
+		}
+
+		int id_x = a.child[best_child];
+		int id_y = a.child[1 - best_child];
+		TreeNode& y = m_nodes[id_y];
+		int id_z = y.child[best_grand];
+
+		a.child[best_child] = id_z;
+		m_nodes[id_z].parent = id_a;
+		y.child[best_grand] = id_x;
+		m_nodes[id_x].parent = id_y;
+
+		const TreeNode& child0 = m_nodes[y.child[0]];
+		const TreeNode& child1 = m_nodes[y.child[1]];
+		y.box = _combine(child0.box, child1.box);
+		y.height = 1 + std::max(child0.height, child1.height);
+	}
+}
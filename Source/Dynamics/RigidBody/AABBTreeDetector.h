@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include "Dynamics/RigidBody/BroadPhaseDetector.h"
+
+namespace PhysIKA
+{
+	/*!
+	*	\class	AABBTreeDetector
+	*	\brief	Broad phase on a dynamic bounding volume hierarchy.
+	*
+	*	Every box is stored in a leaf with a fattened copy of its bounds. A box is only reinserted when it leaves its
+	*	fattened bounds, so slowly moving boxes cost one containment test per call. The pairs of overlapping fattened
+	*	bounds are cached, only reinserted leaves are queried for new ones, and the cached pairs are tested with the
+	*	actual boxes on every call. New leaves are placed with the
+	*	surface area heuristic, and the ancestors of a changed leaf are improved with tree rotations that swap a child
+	*	with a grandchild whenever this reduces the surface area of the inner node.
+	*	Unlike sort and sweep it does not degenerate for clustered scenes or boxes of very different sizes.
+	*	The tree queries of the reinserted leaves run on the ThreadPool.
+	*/
+	template<typename T>
+	class AABBTreeDetector : public BroadPhaseDetector<T>
+	{
+	public:
+		AABBTreeDetector() {}
+
+		void reset() override;
+
+		const std::vector<std::pair<int, int>>& detect(const std::vector<BoxAABB3d<T>>& boxes) override;
+
+		/**
+		* @brief The fattened bounds extend each side of a box by absolute + relative * (box size on that axis)
+		*/
+		void setMargin(T absolute, T relative) { m_margin = absolute; m_relative_margin = relative; }
+
+		int getHeight() const { return m_root < 0 ? 0 : m_nodes[m_root].height; }
+
+		/**
+		* @brief Number of leaves reinserted in the last call to detect()
+		*/
+		int getMovedNum() const { return m_moved.size(); }
+
+	private:
+		struct TreeNode
+		{
+			BoxAABB3d<T> box;
+			int parent;					// next free node if the node is not used
+			int child[2];
+			int height;					// -1 if the node is not used
+			int box_id;
+
+			bool isLeaf() const { return child[0] < 0; }
+		};
+
+		struct QueryBuffer
+		{
+			std::vector<int> stack;
+			std::vector<std::pair<int, int>> pairs;
+		};
+
+		int allocateNode();
+		void freeNode(int id);
+
+		void insertLeaf(int leaf);
+		void removeLeaf(int leaf);
+		void rotate(int id);
+
+		BoxAABB3d<T> fatten(const BoxAABB3d<T>& box) const;
+
+		/**
+		* @brief Collect the leaves whose fattened bounds overlap those of a box
+		*/
+		void query(int box_id, QueryBuffer& buffer) const;
+
+	private:
+		std::vector<TreeNode> m_nodes;
+		int m_root = -1;
+		int m_free_list = -1;
+
+		// leaf node of each box
+		std::vector<int> m_leaf;
+
+		// boxes reinserted in the current call
+		std::vector<int> m_moved;
+
+		// Cached pairs with overlapping fattened bounds, m_pair_index maps a pair to its position in m_pairs
+		typedef unsigned long long PairKey;
+		std::vector<std::pair<int, int>> m_pairs;
+		std::unordered_map<PairKey, int> m_pair_index;
+
+		// cached pairs whose actual boxes intersect, the result of detect()
+		std::vector<std::pair<int, int>> m_collision_pairs;
+
+		std::vector<QueryBuffer> m_buffers;
+
+		T m_margin = 0;
+		T m_relative_margin = 0.1;
+	};
+
+
+#ifdef PRECISION_FLOAT
+	template class AABBTreeDetector<float>;
+#else
+	template class AABBTreeDetector<double>;
+#endif
+}
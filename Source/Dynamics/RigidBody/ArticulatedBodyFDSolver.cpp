@@ -1,162 +1,87 @@
 #include "ArticulatedBodyFDSolver.h"
 #include "RigidBodyRoot.h"
 #include "SpatialVector.h"
+#include "SpatialMatrix.h"
 #include <vector>
 #include "RigidUtil.h"
 
 namespace PhysIKA
 {
 
-	template<typename T>
-	const SpatialVector<T> _Ixs(const MatrixMN<T>& m, const SpatialVector<T>& v)
-	{
-		SpatialVector<T> res;
-		for (int i = 0; i < 6; ++i)
-		{
-			res[i] = 0;
-			for (int j = 0; j < 6; ++j)
-			{
-				res[i] += m(i, j) * v[j];
-			}
-		}
-		return res;
-	}
-	
-
-	/**
-	* @brief Calculate matrix transformation. U * D * U^T
-	* @param U
-	* @param dof dof of U
-	* @param D
-	* @return U * D * U^T
-	*/
-	template<typename T>
-	const MatrixMN<T> UxDxUT(const SpatialVector<T>* U, int dof, const MatrixMN<T>& D)
+	bool ArticulatedBodyFDSolver::solve(const SystemState & s_system, const SystemMotionState & s, Vectornd<float>& ddq)
 	{
-		MatrixMN<float> res(6, 6);
-
-		for (int i = 0; i < 6; ++i)
-		{
-			for (int j = 0; j < dof; ++j)
-			{
-				res(i, j) = 0;
-				for (int k = 0; k < dof; ++k)
-				{
-					res(i, j) += U[k][i] * D(k, j);
-				}
-			}
-		}
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(s.m_root);
 
-		T tmp[6];
-		for (int i = 0; i < 6; ++i)
-		{
-			for (int j = 0; j < 6; ++j)
-			{
-				tmp[j] = 0;
-				for (int k = 0; k < dof; ++k)
-				{
-					tmp[j] += res(i, k) * U[k][j];
-				}
-			}
-			res(i, 0) = tmp[0]; res(i, 1) = tmp[1]; res(i, 2) = tmp[2];
-			res(i, 3) = tmp[3]; res(i, 4) = tmp[4]; res(i, 5) = tmp[5];
-		}
+		resize(root->getAllParentidNodePair().size(), root->getJointDof());
+		ddq.resize(root->getJointDof());
 
-		return res;
+		return solveNodes(s_system, s, ddq, 0, root->getAllParentidNodePair().size());
 	}
 
-	/**
-	* @brief Calculate matrix transformation. U * D * ui
-	* @param U
-	* @param D
-	* @param ui
-	* @param dof dof of U, D and ui
-	* @return U * D * U^T
-	*/
-	template<typename T>
-	const SpatialVector<T> UxDxui(const SpatialVector<T>* U, const MatrixMN<T>& D, const T* ui, int dof)
+	bool ArticulatedBodyFDSolver::solve(const SystemState & s_system, const SystemMotionState & s, Vectornd<float>& ddq, const std::vector<int>& nodes)
 	{
-		SpatialVector<T> res;
-		T tmpv[6];
-		for (int i = 0; i < 6; ++i)
-		{
-			for (int j = 0; j < dof; ++j)
-			{
-				tmpv[j] = 0;
-				for (int k = 0; k < dof; ++k)
-				{
-					tmpv[j] += U[k][i] * D(k, j);
-				}
-			}
-
-			res[i] = 0;
-			for (int j = 0; j < dof; ++j)
-			{
-				res[i] += tmpv[j] * ui[j];
-			}
-		}
-
-		return res;
+		return solveNodes(s_system, s, ddq, nodes.data(), nodes.size());
 	}
 
-
-	bool ArticulatedBodyFDSolver::solve(const SystemState & s_system, const SystemMotionState & s, Vectornd<float>& ddq)
+	void ArticulatedBodyFDSolver::resize(int n_rigid, int n_dof)
 	{
-		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(s.m_root);
-		const std::vector<int>& idx_map = root->getJointIdxMap();
-
-		auto all_bodies = root->getAllParentidNodePair();
-		int n_rigid = all_bodies.size();
-
 		m_IA.resize(n_rigid);
 		m_pA.resize(n_rigid);
 		m_U.resize(n_rigid);
 		m_D_inv.resize(n_rigid);
-		m_ui.resize(root->getJointDof());
+		m_ui.resize(n_dof);
 		m_a.resize(n_rigid);
+		m_vi.resize(n_rigid);
+		m_ci.resize(n_rigid);
+	}
 
-		ddq.resize(root->getJointDof());
+	bool ArticulatedBodyFDSolver::solveNodes(const SystemState & s_system, const SystemMotionState & s, Vectornd<float>& ddq, const int* nodes, int n)
+	{
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(s.m_root);
+		const std::vector<int>& idx_map = root->getJointIdxMap();
+
+		const auto& all_bodies = root->getAllParentidNodePair();
 
 
-		std::vector<SpatialVector<float>> vi(n_rigid);
-		std::vector<SpatialVector<float>> ci(n_rigid);
 		//std::vector<Transform3d<float>> X0(n_rigid);
-		for (int i = 0; i < n_rigid; ++i)
+		for (int k = 0; k < n; ++k)
 		{
-			RigidBody2_ptr cur_node = all_bodies[i].second;
+			int i = nodes ? nodes[k] : k;
+			const RigidBody2_ptr& cur_node = all_bodies[i].second;
 			Joint* parent_joint = cur_node->getParentJoint();
 			int parent_id = all_bodies[i].first;
 			int cur_id = cur_node->getId();
 
 			if (parent_id >= 0)
 			{
-				vi[cur_id] = s.m_X[cur_id].transformM(vi[parent_id]) + s.m_v[cur_id];
+				m_vi[cur_id] = s.m_X[cur_id].transformM(m_vi[parent_id]) + s.m_v[cur_id];
 
 				//X0[cur_id] = X0[parent_id] * 
 			}
 			else
 			{
-				vi[cur_id] = s.m_v[cur_id];
+				m_vi[cur_id] = s.m_v[cur_id];
 			}
 
-			ci[cur_id] = vi[cur_id].crossM(s.m_v[cur_id]);
+			m_ci[cur_id] = m_vi[cur_id].crossM(s.m_v[cur_id]);
 
 			cur_node->getI().getTensor(m_IA[cur_id]);
 
 			Transform3d<float> X0(Vector3f(0, 0, 0), s.m_global_q[cur_id].getConjugate());
-			m_pA[cur_id] = vi[cur_id].crossF(cur_node->getI()*vi[cur_id]);
+			m_pA[cur_id] = m_vi[cur_id].crossF(cur_node->getI()*m_vi[cur_id]);
 			m_pA[cur_id] -= X0.transformF(s_system.m_externalForce[cur_id]);
 		}
 
 
-		MatrixMN<float> D(6, 6);
+		SpatialMatrix<float> D;
 		//Vectornd<float> ui(6);
-		MatrixMN<float> Ia(6, 6);
+		SpatialInertia<float> Ia;
 		SpatialVector<float> pa;
 
-		for (int i = n_rigid - 1; i >= 0; --i)
+		for (int k = n - 1; k >= 0; --k)
 		{
-			RigidBody2_ptr cur_node = all_bodies[i].second;
+			int i = nodes ? nodes[k] : k;
+			const RigidBody2_ptr& cur_node = all_bodies[i].second;
 			Joint* parent_joint = cur_node->getParentJoint();
 			int parent_id = all_bodies[i].first;
 			int cur_id = cur_node->getId();
@@ -182,12 +107,12 @@ namespace PhysIKA
 			if (parent_id >= 0)
 			{
 				
-				MatrixMN<float>& D_inv = this->m_D_inv[cur_id];
+				const SpatialMatrix<float>& D_inv = this->m_D_inv[cur_id];
 
 				if (cur_dof > 0)
 				{
 					Ia = m_IA[cur_id] - UxDxUT(U, cur_dof, D_inv);
-					pa = m_pA[cur_id] + UxDxui(U, D_inv, &(m_ui[idx_map[cur_id]]), cur_dof) + _Ixs(Ia, ci[cur_id]);
+					pa = m_pA[cur_id] + UxDxui(U, D_inv, &(m_ui[idx_map[cur_id]]), cur_dof) + Ia * m_ci[cur_id];
 
 					m_IA[parent_id] += s.m_X[cur_id].inverseTransform().transformI(Ia);
 					m_pA[parent_id] += s.m_X[cur_id].inverseTransform().transformF(pa);
@@ -204,9 +129,10 @@ namespace PhysIKA
 
 		}
 
-		for (int i = 0; i < n_rigid; ++i)
+		for (int k = 0; k < n; ++k)
 		{
-			RigidBody2_ptr cur_node = all_bodies[i].second;
+			int i = nodes ? nodes[k] : k;
+			const RigidBody2_ptr& cur_node = all_bodies[i].second;
 			Joint* parent_joint = cur_node->getParentJoint();
 			int parent_id = all_bodies[i].first;
 			int cur_id = cur_node->getId();
@@ -219,12 +145,12 @@ namespace PhysIKA
 			{
 				Transform3d<float> toNode(Vector3f(), s.m_global_q[i].getConjugate());
 				a_p = SpatialVector<float>(Vector3f(), -(root->getGravity()));
-				a_p = toNode.transformM(a_p) + ci[cur_id];
+				a_p = toNode.transformM(a_p) + m_ci[cur_id];
 
 			}
 			else
 			{
-				a_p = s.m_X[cur_id].transformM(m_a[parent_id]) + ci[cur_id];
+				a_p = s.m_X[cur_id].transformM(m_a[parent_id]) + m_ci[cur_id];
 			}
 
 			if (cur_dof > 0)
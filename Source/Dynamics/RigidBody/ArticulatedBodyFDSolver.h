@@ -5,6 +5,7 @@
 #include <vector>
 #include "Core/Matrix/matrix_mxn.h"
 #include "SpatialVector.h"
+#include "SpatialMatrix.h"
 #include "JointSpace.h"
 
 namespace PhysIKA
@@ -29,6 +30,17 @@ namespace PhysIKA
 		*/
 		virtual bool solve(const SystemState& s_system, const SystemMotionState& s, Vectornd<float>& ddq);
 
+		/**
+		* @brief Solve forward dynamics of a part of the tree
+		* @details The nodes have to be in ascending order and closed under parents up to the root, e.g. the union of some subtrees of the root.
+		* ddq and the buffers have to be sized by resize() beforehand, only the entries of the nodes are used.
+		* Calls with disjoint node sets may run concurrently.
+		* @param nodes Indices into RigidBodyRoot::getAllParentidNodePair()
+		*/
+		bool solve(const SystemState& s_system, const SystemMotionState& s, Vectornd<float>& ddq, const std::vector<int>& nodes);
+
+		void resize(int n_rigid, int n_dof);
+
 		void setValidtiy(bool isValid)
 		{
 			m_isValid = isValid;
@@ -37,12 +49,16 @@ namespace PhysIKA
 		virtual void init();
 
 	private:
+		bool solveNodes(const SystemState& s_system, const SystemMotionState& s, Vectornd<float>& ddq, const int* nodes, int n);
+
 		std::vector<SpatialVector<float>> m_pA;
-		std::vector<MatrixMN<float>> m_IA;
+		std::vector<SpatialInertia<float>> m_IA;
 		std::vector<JointSpace<float, 6>> m_U;
-		std::vector<MatrixMN<float>> m_D_inv;
+		std::vector<SpatialMatrix<float>> m_D_inv;
 		Vectornd<float> m_ui;
 		std::vector<SpatialVector<float>> m_a;
+		std::vector<SpatialVector<float>> m_vi;				// absolute velocities, node frame
+		std::vector<SpatialVector<float>> m_ci;				// velocity product accelerations
 
 		bool m_isValid = false;
 	};
@@ -1,162 +1,224 @@
 #include "Dynamics/RigidBody/BroadPhaseDetector.h"
-#include <set>
+#include "Framework/Framework/Profiler.h"
 #include <algorithm>
 
-namespace PhysIKA 
+namespace PhysIKA
 {
 	template<typename T>
 	void SortSweepDetector<T>::reset()
 	{
 		this->m_n = 0;
-		//this->m_sorted_x.clear();
-		//this->m_sorted_y.clear();
-		//this->m_sorted_z.clear();
 
-		this->m_sorted_pair.clear();
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			this->m_endpoints[axis].clear();
+		}
+
+		this->m_pairs.clear();
+		this->m_pair_index.clear();
+		this->m_changed.clear();
+		this->m_added.clear();
+		this->m_removed.clear();
 	}
 
 
 	template<typename T>
-	inline bool SortSweepDetector<T>::detect(const std::vector<BoxAABB3d<T>>& boxes, std::vector<std::pair<int, int>>& collision_pairs)
+	const std::vector<std::pair<int, int>>& SortSweepDetector<T>::detect(const std::vector<BoxAABB3d<T>>& boxes)
 	{
-		
-		//for (int axis = 0; axis < 3; ++axis)
+		ProfileScope scope("SortSweepDetector::detect");
+
+		m_changed.clear();
+		m_added.clear();
+		m_removed.clear();
+
+		if (m_n != boxes.size())
 		{
-			int axis = m_sort_axis;
-			std::vector<std::pair<int, T>>& sorted_pair = m_sorted_pair;
-			//std::vector<std::pair<int, T>>& sorted_pair = ( axis == 0 ? (m_sorted_x) : (axis == 1 ? m_sorted_y : m_sorted_z) );
-			//std::vector<bool>& is_begin_value = (axis == 0 ? (m_is_begin_x) : (axis == 1 ? m_is_begin_y : m_is_begin_z));
+			rebuild(boxes);
+		}
+		else
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				sortAxis(axis, boxes);
+			}
+		}
 
-			double t0 = clock() / 1000.0;
+		// report the net changes, a pair may have been added and removed again by different swaps
+		for (auto iter = m_changed.begin(); iter != m_changed.end(); ++iter)
+		{
+			bool was_overlapping = iter->second;
+			bool is_overlapping = m_pair_index.find(iter->first) != m_pair_index.end();
+			if (was_overlapping == is_overlapping)
+			{
+				continue;
+			}
 
-			// sort the beginning and end value of intervals
-			if (m_n == 0)
+			std::pair<int, int> pair((int)(iter->first >> 32), (int)(iter->first & 0xffffffff));
+			if (is_overlapping)
+			{
+				m_added.push_back(pair);
+			}
+			else
 			{
-				this->m_n = boxes.size();
+				m_removed.push_back(pair);
+			}
+		}
 
-				sorted_pair.resize(boxes.size());
-				for (int i = 0; i < boxes.size(); ++i)
-				{
-					sorted_pair[i] = std::make_pair(i, boxes[i].getl(axis));
+		return m_pairs;
+	}
 
-				}
+	template<typename T>
+	void SortSweepDetector<T>::rebuild(const std::vector<BoxAABB3d<T>>& boxes)
+	{
+		for (auto iter = m_pair_index.begin(); iter != m_pair_index.end(); ++iter)
+		{
+			recordChange(iter->first);
+		}
+		m_pairs.clear();
+		m_pair_index.clear();
+
+		m_n = boxes.size();
+		updateAxis(boxes);
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			std::vector<EndPoint>& endpoints = m_endpoints[axis];
+			endpoints.resize(2 * m_n);
+			for (int i = 0; i < m_n; ++i)
+			{
+				endpoints[2 * i].value = boxes[i].getl(axis);
+				endpoints[2 * i].data = 2 * i;
+				endpoints[2 * i + 1].value = boxes[i].getu(axis);
+				endpoints[2 * i + 1].data = 2 * i + 1;
+			}
+			std::sort(endpoints.begin(), endpoints.end());
+		}
 
-				// sort
-				std::sort(sorted_pair.begin(), sorted_pair.end(), 
-					[](std::pair<int, T>& p1, std::pair<int, T>& p2) {
-						return p1.second < p2.second;
-					});
+		// sweep along the sort axis, every box is tested against the boxes whose interval is open
+		std::vector<int> active;
+		std::vector<int> active_pos(m_n, -1);
+
+		const std::vector<EndPoint>& endpoints = m_endpoints[m_sort_axis];
+		for (int i = 0; i < endpoints.size(); ++i)
+		{
+			int cur_id = endpoints[i].id();
+			if (endpoints[i].isEnd())
+			{
+				int pos = active_pos[cur_id];
+				active[pos] = active.back();
+				active_pos[active[pos]] = pos;
+				active.pop_back();
+				active_pos[cur_id] = -1;
 			}
 			else
 			{
-				// update the interval value of in sorted_pair
-				for (int i = 0; i < (boxes.size()); ++i)
-				{
-					int cur_id = sorted_pair[i].first;
-					
-					sorted_pair[i].second = boxes[cur_id].getl(axis);
-					
-				}
-
-				// insertion sort
-				for (int i = 1; i < (boxes.size()); ++i)
+				for (int j = 0; j < active.size(); ++j)
 				{
-					for (int j = i; j > 0; --j)
+					if (boxes[cur_id].isIntersect(boxes[active[j]]))
 					{
-						if (sorted_pair[j].second < sorted_pair[j - 1].second)
-						{
-							auto tmp_pair = sorted_pair[j];
-							sorted_pair[j] = sorted_pair[j - 1];
-							sorted_pair[j - 1] = tmp_pair;
-						}
-						else
-						{
-							break;
-						}
+						addPair(pairKey(cur_id, active[j]));
 					}
 				}
+				active_pos[cur_id] = active.size();
+				active.push_back(cur_id);
 			}
+		}
+	}
 
-			double t1 = clock() / 1000.0;
-			std::cout << "TIME insertion sort:   " << t1 - t0 << std::endl;
-
-
-			// find intersections
-			collision_pairs.clear();
+	template<typename T>
+	void SortSweepDetector<T>::sortAxis(int axis, const std::vector<BoxAABB3d<T>>& boxes)
+	{
+		std::vector<EndPoint>& endpoints = m_endpoints[axis];
 
-			//std::vector<bool> is_active(boxes.size(), false);
-			//std::set<int> active_id;
+		// update the values in place, the order of the last call is almost sorted
+		for (int i = 0; i < endpoints.size(); ++i)
+		{
+			const BoxAABB3d<T>& box = boxes[endpoints[i].id()];
+			endpoints[i].value = endpoints[i].isEnd() ? box.getu(axis) : box.getl(axis);
+		}
 
-			int n_intersect_test = 0;
-			for (int i = 0; i < (boxes.size()); ++i)
+		// insertion sort, every swap of a begin and an end value changes the overlap on this axis
+		for (int i = 1; i < endpoints.size(); ++i)
+		{
+			EndPoint cur = endpoints[i];
+			int j = i;
+			while (j > 0 && cur < endpoints[j - 1])
 			{
-				int cur_id = sorted_pair[i].first;
-				
-				for (int j = i + 1; j < boxes.size(); ++j)
+				const EndPoint& prev = endpoints[j - 1];
+				if (!cur.isEnd() && prev.isEnd())
 				{
-					int id_j = sorted_pair[j].first;
-					if (boxes[cur_id].getu(axis) < boxes[id_j].getl(axis))
+					// a begin passes an end to the left: the intervals start to overlap
+					int id0 = cur.id(), id1 = prev.id();
+					if (boxes[id0].isIntersect(boxes[id1]))
 					{
-						break;
-					}
-
-					++n_intersect_test;
-					if (boxes[cur_id].isIntersect(boxes[id_j]))
-					{
-						if (cur_id < id_j)
-						{
-							collision_pairs.push_back(std::make_pair(cur_id, id_j));
-						}
-						else
-						{
-							collision_pairs.push_back(std::make_pair(id_j, cur_id));
-						}
+						addPair(pairKey(id0, id1));
 					}
 				}
+				else if (cur.isEnd() && !prev.isEnd())
+				{
+					// an end passes a begin to the left: the intervals are separated
+					removePair(pairKey(cur.id(), prev.id()));
+				}
 
-				////if (is_beginning)
-				//{
-				//	// record all potential collision pair
-				//	for (auto iter = active_id.begin(); iter != active_id.end(); ++iter)
-				//	{
-				//		int collide_to = (*iter);
-
-				//		++n_intersect_test;
-				//		if (boxes[cur_id].isIntersect(boxes[collide_to]))
-				//		{
-				//			if (cur_id < collide_to)
-				//			{
-				//				collision_pairs.push_back(std::make_pair(cur_id, collide_to));
-				//			}
-				//			else
-				//			{
-				//				collision_pairs.push_back(std::make_pair(collide_to, cur_id));
-				//			}
-				//		}
-
-				//	}
-
-				//	//active_id.insert(cur_id);
-				//}
-				//else
-				//{
-				//	active_id.erase(cur_id);
-				//}
+				endpoints[j] = prev;
+				--j;
 			}
-			std::cout << n_intersect_test << std::endl;
+			endpoints[j] = cur;
+		}
+	}
 
-			double t2 = clock() / 1000.0;
-			std::cout << "TIME find intersection:    " << t2 - t1 << std::endl;
+	template<typename T>
+	void SortSweepDetector<T>::addPair(PairKey key)
+	{
+		if (m_pair_index.find(key) != m_pair_index.end())
+		{
+			return;
 		}
 
+		recordChange(key);
+		m_pair_index[key] = m_pairs.size();
+		m_pairs.push_back(std::make_pair((int)(key >> 32), (int)(key & 0xffffffff)));
+	}
+
+	template<typename T>
+	void SortSweepDetector<T>::removePair(PairKey key)
+	{
+		auto iter = m_pair_index.find(key);
+		if (iter == m_pair_index.end())
+		{
+			return;
+		}
 
+		recordChange(key);
 
-		return !collision_pairs.empty();
+		// move the last pair into the free slot
+		int pos = iter->second;
+		m_pair_index.erase(iter);
+		if (pos != m_pairs.size() - 1)
+		{
+			m_pairs[pos] = m_pairs.back();
+			m_pair_index[pairKey(m_pairs[pos].first, m_pairs[pos].second)] = pos;
+		}
+		m_pairs.pop_back();
+	}
+
+	template<typename T>
+	void SortSweepDetector<T>::recordChange(PairKey key)
+	{
+		if (m_changed.find(key) == m_changed.end())
+		{
+			m_changed[key] = m_pair_index.find(key) != m_pair_index.end();
+		}
 	}
 
 	template<typename T>
 	void SortSweepDetector<T>::updateAxis(const std::vector<BoxAABB3d<T>>& boxes)
 	{
+		if (boxes.empty())
+		{
+			return;
+		}
+
 		// compute variance
 		T sx = 0, sy = 0, sz = 0;
 		T s2x = 0, s2y = 0, s2z = 0;
@@ -177,7 +239,7 @@ namespace PhysIKA
 		variance[1] = (s2y - (sy * sy) / boxes.size());
 		variance[2] = (s2z - (sz * sz) / boxes.size());
 
-		int new_axis = m_sort_axis;
+		int new_axis = 0;
 		if (variance[1] > variance[0])
 		{
 			new_axis = 1;
@@ -187,32 +249,7 @@ namespace PhysIKA
 			new_axis = 2;
 		}
 
-		// update the array of sorted pairs
-		if ((new_axis != m_sort_axis) || (m_n != boxes.size()))
-		{
-			m_sort_axis = new_axis;
-			m_n = boxes.size();
-			int axis = m_sort_axis;
-			std::vector<std::pair<int, T>>& sorted_pair = m_sorted_pair;
-			
-			// sort the beginning and end value of intervals		
-			{
-				this->m_n = boxes.size();
-
-				sorted_pair.resize(boxes.size());
-				for (int i = 0; i < boxes.size(); ++i)
-				{
-					sorted_pair[i] = std::make_pair(i, boxes[i].getl(axis));
-				}
-
-				// sort
-				std::sort(sorted_pair.begin(), sorted_pair.end(),
-					[](std::pair<int, T>& p1, std::pair<int, T>& p2) {
-						return p1.second < p2.second;
-					});
-			}
-		}
-
+		m_sort_axis = new_axis;
 	}
 
-}
\ No newline at end of file
+}
@@ -1,37 +1,109 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
 #include "Dynamics/RigidBody/BoxAABB3d.h"
 
 namespace PhysIKA
 {
-	template<typename T> 
-	class SortSweepDetector
+	/*!
+	*	\class	BroadPhaseDetector
+	*	\brief	Interface of the broad phase detectors, so that the implementations can be exchanged.
+	*/
+	template<typename T>
+	class BroadPhaseDetector
+	{
+	public:
+		virtual ~BroadPhaseDetector() {}
+
+		virtual void reset() = 0;
+
+		/**
+		* @brief Find all pairs of intersecting boxes, pairs are stored as (smaller id, larger id).
+		* @details The box ids are the indices into boxes, they have to stay the same between calls.
+		* @return The pairs are owned by the detector and stay valid until the next call to detect() or reset().
+		*/
+		virtual const std::vector<std::pair<int, int>>& detect(const std::vector<BoxAABB3d<T>>& boxes) = 0;
+	};
+
+	/*!
+	*	\class	SortSweepDetector
+	*	\brief	Incremental sort and sweep (sweep and prune) broad phase.
+	*
+	*	The begin and end values of all boxes are kept sorted on the three axes. Between two calls the arrays are
+	*	re-sorted with insertion sort, and every swap of a begin and an end value updates the cached set of
+	*	overlapping pairs. With temporal coherence the cost of detect() is linear in the number of boxes for the
+	*	value refresh plus the number of swaps, instead of a full sweep per call.
+	*	The full sweep is only done when the number of boxes changes, on the axis with the largest variance.
+	*/
+	template<typename T>
+	class SortSweepDetector : public BroadPhaseDetector<T>
 	{
 	public:
 		SortSweepDetector() {}
 
-		void reset();
+		void reset() override;
 
-		bool detect(const std::vector<BoxAABB3d<T>>& boxes, std::vector<std::pair<int, int>>& collision_pairs);
+		const std::vector<std::pair<int, int>>& detect(const std::vector<BoxAABB3d<T>>& boxes) override;
 
+		/**
+		* @brief Choose the axis with the largest variance of box centers for the full sweep.
+		*/
 		void updateAxis(const std::vector<BoxAABB3d<T>>& boxes);
 
+		/**
+		* @brief Pairs that started or stopped intersecting in the last call to detect()
+		*/
+		const std::vector<std::pair<int, int>>& getAddedPairs() const { return m_added; }
+		const std::vector<std::pair<int, int>>& getRemovedPairs() const { return m_removed; }
+
+		int getSortAxis() const { return m_sort_axis; }
+
+	private:
+		struct EndPoint
+		{
+			T value;
+			int data;			// box id * 2, plus one for the end of the interval
+
+			int id() const { return data >> 1; }
+			bool isEnd() const { return (data & 1) != 0; }
+
+			// On equal values begins go first, so touching boxes are reported as in BoxAABB3d::isIntersect
+			bool operator<(const EndPoint& p) const
+			{
+				return value < p.value || (value == p.value && !isEnd() && p.isEnd());
+			}
+		};
+
+		typedef unsigned long long PairKey;
+
+		static PairKey pairKey(int i, int j)
+		{
+			return i < j ? ((PairKey)i << 32) | (PairKey)j : ((PairKey)j << 32) | (PairKey)i;
+		}
+
+		void rebuild(const std::vector<BoxAABB3d<T>>& boxes);
+		void sortAxis(int axis, const std::vector<BoxAABB3d<T>>& boxes);
+
+		void addPair(PairKey key);
+		void removePair(PairKey key);
+		void recordChange(PairKey key);
+
 	private:
 		int m_n=0;
-		
+
 		int m_sort_axis=0;
 
-		// pair: first -- interval id, it will be negative if the value is the beginning of the interval;
-		// pair: second -- beginning or end value of the interval
-		std::vector<std::pair<int, T>> m_sorted_pair;			
-		//std::vector<bool> m_is_begin_x;
+		std::vector<EndPoint> m_endpoints[3];
+
+		// Cached overlapping pairs, m_pair_index maps a pair to its position in m_pairs
+		std::vector<std::pair<int, int>> m_pairs;
+		std::unordered_map<PairKey, int> m_pair_index;
 
-		//std::vector<std::pair<int, T>> m_sorted_y;
-		////std::vector<bool> m_is_begin_y;
-		//
-		//std::vector<std::pair<int, T>> m_sorted_z;
-		////std::vector<bool> m_is_begin_z;
+		// Pairs touched in the current call and whether they were in the cache before it
+		std::unordered_map<PairKey, bool> m_changed;
+		std::vector<std::pair<int, int>> m_added;
+		std::vector<std::pair<int, int>> m_removed;
 	};
 
 
@@ -40,4 +112,4 @@ namespace PhysIKA
 #else
 	template class SortSweepDetector<double>;
 #endif
-}
\ No newline at end of file
+}
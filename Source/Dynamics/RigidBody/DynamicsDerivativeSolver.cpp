@@ -0,0 +1,337 @@
+#include "Dynamics/RigidBody/DynamicsDerivativeSolver.h"
+#include "Dynamics/RigidBody/RigidBodyRoot.h"
+#include "Dynamics/RigidBody/SparseInertiaMatrixFDSolver.h"
+#include "Transform3d.h"
+
+namespace PhysIKA
+{
+	DynamicsDerivativeSolver::DynamicsDerivativeSolver(Node * parent_node) : m_parent_node(parent_node)
+	{
+	}
+
+	void DynamicsDerivativeSolver::resize(int n_rigid, int n_dof)
+	{
+		m_parent.resize(n_rigid);
+		m_vJ.resize(n_rigid);
+		m_v.resize(n_rigid);
+		m_c.resize(n_rigid);
+		m_a.resize(n_rigid);
+		m_Xa.resize(n_rigid);
+		m_f.resize(n_rigid);
+		m_fext.resize(n_rigid);
+
+		m_affected.resize(n_rigid);
+		m_dv.resize(n_rigid);
+		m_da.resize(n_rigid);
+		m_df.resize(n_rigid);
+		m_dframe.resize(n_rigid);
+
+		m_tau.resize(n_dof);
+		m_col.resize(n_dof);
+		m_dtau_dq.resize(n_dof, n_dof);
+		m_dtau_ddqdot.resize(n_dof, n_dof);
+		m_M.resize(n_dof, n_dof);
+	}
+
+	void DynamicsDerivativeSolver::inverseDynamics(const SystemState & system_state, const Vectornd<float>& ddq, Vectornd<float>& tau)
+	{
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(this->m_parent_node);
+		const auto& all_node = root->getAllParentidNodePair();
+		const std::vector<int>& idx_map = root->getJointIdxMap();
+		const SystemMotionState& s = *(system_state.m_motionState);
+		m_state = &s;
+
+		int n_rigid = all_node.size();
+		SpatialVector<float> a0(Vector3f(), -(system_state.m_gravity));
+
+		for (int i = 0; i < n_rigid; ++i)
+		{
+			int parent_id = all_node[i].first;
+			const RigidBody2_ptr& cur_node = all_node[i].second;
+			Joint* cur_joint = cur_node->getParentJoint();
+			const JointSpaceBase<float>& Si = cur_joint->getJointSpace();
+			int dof = cur_joint->getJointDOF();
+
+			m_parent[i] = parent_id;
+			m_vJ[i] = dof > 0 ? Si.mul(&(s.m_dq[idx_map[i]])) : SpatialVector<float>();
+
+			SpatialVector<float> Xv = parent_id >= 0 ? s.m_X[i].transformM(m_v[parent_id]) : SpatialVector<float>();
+			m_v[i] = Xv + m_vJ[i];
+			m_c[i] = m_v[i].crossM(m_vJ[i]);
+
+			/// the base is accelerated against gravity
+			m_Xa[i] = s.m_X[i].transformM(parent_id >= 0 ? m_a[parent_id] : a0);
+			m_a[i] = m_Xa[i] + m_c[i];
+			if (dof > 0)
+			{
+				m_a[i] += Si.mul(&(ddq[idx_map[i]]));
+			}
+
+			Transform3d<float> X0(Vector3f(0, 0, 0), s.m_global_q[i].getConjugate());
+			m_fext[i] = X0.transformF(system_state.m_externalForce[i]);
+
+			const Inertia<float>& I = cur_node->getI();
+			m_f[i] = I * m_a[i] + m_v[i].crossF(I * m_v[i]) - m_fext[i];
+		}
+
+		tau.resize(root->getJointDof());
+		for (int i = n_rigid - 1; i >= 0; --i)
+		{
+			int parent_id = m_parent[i];
+			Joint* cur_joint = all_node[i].second->getParentJoint();
+
+			if (cur_joint->getJointDOF() > 0)
+			{
+				cur_joint->getJointSpace().transposeMul(m_f[i], &(tau[idx_map[i]]));
+			}
+
+			if (parent_id >= 0)
+			{
+				m_f[parent_id] += s.m_X[i].inverseTransform().transformF(m_f[i]);
+			}
+		}
+	}
+
+	void DynamicsDerivativeSolver::perturb(int node_id, const SpatialVector<float>& s, Variable var, MatrixMN<float>& res, int col)
+	{
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(this->m_parent_node);
+		const auto& all_node = root->getAllParentidNodePair();
+		const std::vector<int>& idx_map = root->getJointIdxMap();
+		const std::vector<Transform3d<float>>& X = m_state->m_X;
+
+		int n_rigid = all_node.size();
+		for (int i = 0; i < res.rows(); ++i)
+		{
+			res(i, col) = 0;
+		}
+
+		/// outwards: only the subtree of node_id is affected
+		for (int i = 0; i < n_rigid; ++i)
+		{
+			int parent_id = m_parent[i];
+			if (i == node_id)
+			{
+				switch (var)
+				{
+				case Position:
+					/// the joint transform changes by -(s x)
+					m_dv[i] = -s.crossM(m_v[i] - m_vJ[i]);
+					m_da[i] = -s.crossM(m_Xa[i]) + m_dv[i].crossM(m_vJ[i]);
+					break;
+				case Velocity:
+					m_dv[i] = s;
+					m_da[i] = s.crossM(m_vJ[i]) + m_v[i].crossM(s);
+					break;
+				default:
+					m_dv[i] = SpatialVector<float>();
+					m_da[i] = s;
+					break;
+				}
+				m_dframe[i] = s;
+			}
+			else if (i > node_id && parent_id >= 0 && m_affected[parent_id])
+			{
+				m_dv[i] = X[i].transformM(m_dv[parent_id]);
+				m_da[i] = X[i].transformM(m_da[parent_id]) + m_dv[i].crossM(m_vJ[i]);
+				m_dframe[i] = X[i].transformM(m_dframe[parent_id]);
+			}
+			else
+			{
+				m_affected[i] = 0;
+				continue;
+			}
+			m_affected[i] = 1;
+
+			const Inertia<float>& I = all_node[i].second->getI();
+			m_df[i] = I * m_da[i] + m_dv[i].crossF(I * m_v[i]) + m_v[i].crossF(I * m_dv[i]);
+
+			if (var == Position)
+			{
+				/// the world oriented external force rotates in the body frame
+				const SpatialVector<float>& w = m_dframe[i];
+				const SpatialVector<float>& fe = m_fext[i];
+				m_df[i][0] += w[1] * fe[2] - w[2] * fe[1];
+				m_df[i][1] += w[2] * fe[0] - w[0] * fe[2];
+				m_df[i][2] += w[0] * fe[1] - w[1] * fe[0];
+				m_df[i][3] += w[1] * fe[5] - w[2] * fe[4];
+				m_df[i][4] += w[2] * fe[3] - w[0] * fe[5];
+				m_df[i][5] += w[0] * fe[4] - w[1] * fe[3];
+			}
+		}
+
+		/// inwards over the subtree
+		float tmp[6];
+		for (int i = n_rigid - 1; i >= node_id; --i)
+		{
+			if (!m_affected[i])
+			{
+				continue;
+			}
+
+			Joint* cur_joint = all_node[i].second->getParentJoint();
+			int dof = cur_joint->getJointDOF();
+			if (dof > 0)
+			{
+				cur_joint->getJointSpace().transposeMul(m_df[i], tmp);
+				for (int k = 0; k < dof; ++k)
+				{
+					res(idx_map[i] + k, col) = tmp[k];
+				}
+			}
+
+			if (i != node_id)
+			{
+				m_df[m_parent[i]] += X[i].inverseTransform().transformF(m_df[i]);
+			}
+		}
+
+		/// inwards along the ancestors
+		SpatialVector<float> dF = m_df[node_id];
+		if (var == Position)
+		{
+			dF += s.crossF(m_f[node_id]);
+		}
+
+		int child_id = node_id;
+		int cur_id = m_parent[node_id];
+		while (cur_id >= 0)
+		{
+			dF = X[child_id].inverseTransform().transformF(dF);
+
+			Joint* cur_joint = all_node[cur_id].second->getParentJoint();
+			int dof = cur_joint->getJointDOF();
+			if (dof > 0)
+			{
+				cur_joint->getJointSpace().transposeMul(dF, tmp);
+				for (int k = 0; k < dof; ++k)
+				{
+					res(idx_map[cur_id] + k, col) = tmp[k];
+				}
+			}
+
+			child_id = cur_id;
+			cur_id = m_parent[cur_id];
+		}
+	}
+
+	void DynamicsDerivativeSolver::computeDerivatives(const SystemState & system_state, const Vectornd<float>& ddq, bool derivatives, bool inertia)
+	{
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(this->m_parent_node);
+		const auto& all_node = root->getAllParentidNodePair();
+		const std::vector<int>& idx_map = root->getJointIdxMap();
+
+		resize(all_node.size(), root->getJointDof());
+		inverseDynamics(system_state, ddq, m_tau);
+
+		for (int i = 0; i < all_node.size(); ++i)
+		{
+			/// joints without dof have no joint space
+			Joint* cur_joint = all_node[i].second->getParentJoint();
+			if (cur_joint->getJointDOF() == 0)
+			{
+				continue;
+			}
+			const SpatialVector<float>* S = cur_joint->getJointSpace().getBases();
+
+			for (int k = 0; k < cur_joint->getJointDOF(); ++k)
+			{
+				int col = idx_map[i] + k;
+				if (derivatives)
+				{
+					perturb(i, S[k], Position, m_dtau_dq, col);
+					perturb(i, S[k], Velocity, m_dtau_ddqdot, col);
+				}
+				if (inertia)
+				{
+					perturb(i, S[k], Acceleration, m_M, col);
+				}
+			}
+		}
+	}
+
+	void DynamicsDerivativeSolver::computeInverseDynamicsDerivatives(const SystemState & system_state, const Vectornd<float>& ddq)
+	{
+		computeDerivatives(system_state, ddq, true, true);
+	}
+
+	bool DynamicsDerivativeSolver::computeForwardDynamicsDerivatives(const SystemState & system_state, const Vectornd<float>& tau)
+	{
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(this->m_parent_node);
+		const auto& all_node = root->getAllParentidNodePair();
+		int n_dof = root->getJointDof();
+
+		/// bias forces, inverse dynamics with zero acceleration, and M, which does not depend on ddq
+		m_ddq.resize(n_dof);
+		m_ddq.setZeros();
+		computeDerivatives(system_state, m_ddq, false, true);
+
+		/// factorize M = L^T * D * L
+		std::vector<std::pair<int, int>> parent_dof(all_node.size());
+		for (int i = 0; i < all_node.size(); ++i)
+		{
+			parent_dof[i] = std::make_pair(all_node[i].first, all_node[i].second->getParentJoint()->getJointDOF());
+		}
+		SparseInertiaMatrixFDSolver::buildParentDof(parent_dof, root->getJointIdxMap(), m_lambda);
+
+		m_L.resize(n_dof, n_dof);
+		for (int i = 0; i < n_dof; ++i)
+		{
+			for (int j = 0; j < n_dof; ++j)
+			{
+				m_L(i, j) = m_M(i, j);
+			}
+		}
+		if (!SparseInertiaMatrixFDSolver::factorize(m_L, m_lambda))
+		{
+			return false;
+		}
+
+		/// ddq = M^-1 * (tau - bias)
+		for (int i = 0; i < n_dof; ++i)
+		{
+			m_ddq[i] = (tau.size() == n_dof ? tau[i] : 0.0f) - m_tau[i];
+		}
+		SparseInertiaMatrixFDSolver::backSubstitute(m_L, m_lambda, m_ddq);
+
+		/// derivatives of the inverse dynamics at the solution, tau = ID(q, dq, ddq)
+		computeDerivatives(system_state, m_ddq, true, false);
+
+		m_dddq_dq.resize(n_dof, n_dof);
+		m_dddq_ddqdot.resize(n_dof, n_dof);
+		m_dddq_dtau.resize(n_dof, n_dof);
+		for (int i = 0; i < n_dof; ++i)
+		{
+			for (int j = 0; j < n_dof; ++j)
+			{
+				m_dddq_dq(i, j) = m_dtau_dq(i, j);
+				m_dddq_ddqdot(i, j) = m_dtau_ddqdot(i, j);
+				m_dddq_dtau(i, j) = i == j ? 1.0f : 0.0f;
+			}
+		}
+
+		solveInertia(m_dddq_dq, -1.0f);
+		solveInertia(m_dddq_ddqdot, -1.0f);
+		solveInertia(m_dddq_dtau, 1.0f);
+
+		return true;
+	}
+
+	void DynamicsDerivativeSolver::solveInertia(MatrixMN<float>& m, float scale)
+	{
+		int n_dof = m.rows();
+		for (int j = 0; j < m.cols(); ++j)
+		{
+			for (int i = 0; i < n_dof; ++i)
+			{
+				m_col[i] = scale * m(i, j);
+			}
+
+			SparseInertiaMatrixFDSolver::backSubstitute(m_L, m_lambda, m_col);
+
+			for (int i = 0; i < n_dof; ++i)
+			{
+				m(i, j) = m_col[i];
+			}
+		}
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Core/Matrix/matrix_mxn.h"
+#include "Core/Vector/vector_nd.h"
+#include "Framework/Framework/Node.h"
+#include "SystemState.h"
+#include "SpatialVector.h"
+
+#include <vector>
+
+namespace PhysIKA
+{
+	/**
+	* @brief Analytical partial derivatives of the inverse and forward dynamics.
+	* @details The inverse dynamics tau = ID(q, dq, ddq) is evaluated with the recursive Newton-Euler algorithm.
+	* Its derivatives are obtained by propagating the perturbation of each joint coordinate through the same
+	* recursion: outwards over the subtree of the joint, then inwards to the base. No finite differences are used.
+	* The forward dynamics ddq = FD(q, dq, tau) is differentiated with
+	*     d(ddq)/dq = -M^-1 * d(ID)/dq, d(ddq)/d(dq) = -M^-1 * d(ID)/d(dq), d(ddq)/d(tau) = M^-1,
+	* where the joint space inertia matrix M = d(ID)/d(ddq) is factorized with the sparse LTDL of SparseInertiaMatrixFDSolver.
+	*
+	* The derivative with respect to q is taken along the joint motion subspace: perturbing dof k moves the
+	* successor body of its joint by the spatial motion S_k, expressed in the successor frame.
+	* External forces follow ArticulatedBodyFDSolver, they are given in world orientation and act at the body origin.
+	* Matrices are dof x dof, row i holds the derivatives of tau[i] (or ddq[i]).
+	*/
+	class DynamicsDerivativeSolver
+	{
+	public:
+		DynamicsDerivativeSolver(Node* parent_node = 0);
+
+		Node* getParent() { return m_parent_node; }
+		void setParent(Node* parent_node) { m_parent_node = parent_node; }
+
+		/**
+		* @brief Inverse dynamics tau = ID(q, dq, ddq) and its derivatives with respect to q, dq and ddq.
+		*/
+		void computeInverseDynamicsDerivatives(const SystemState& system_state, const Vectornd<float>& ddq);
+
+		/**
+		* @brief Forward dynamics ddq = FD(q, dq, tau) and its derivatives with respect to q, dq and tau.
+		* @param tau Joint forces, an empty vector is taken as zero.
+		* @return False if the joint space inertia matrix is not positive definite.
+		*/
+		bool computeForwardDynamicsDerivatives(const SystemState& system_state, const Vectornd<float>& tau);
+
+		/**
+		* @brief Results of computeInverseDynamicsDerivatives(): tau, d(tau)/dq and d(tau)/d(dq)
+		*/
+		const Vectornd<float>& getTau() const { return m_tau; }
+		const MatrixMN<float>& getDtauDq() const { return m_dtau_dq; }
+		const MatrixMN<float>& getDtauDdqdot() const { return m_dtau_ddqdot; }
+
+		/**
+		* @brief Joint space inertia matrix, the derivative of tau with respect to ddq
+		*/
+		const MatrixMN<float>& getInertiaMatrix() const { return m_M; }
+
+		/**
+		* @brief Results of computeForwardDynamicsDerivatives(): ddq, d(ddq)/dq, d(ddq)/d(dq) and d(ddq)/d(tau)
+		*/
+		const Vectornd<float>& getDdq() const { return m_ddq; }
+		const MatrixMN<float>& getDddqDq() const { return m_dddq_dq; }
+		const MatrixMN<float>& getDddqDdqdot() const { return m_dddq_ddqdot; }
+		const MatrixMN<float>& getDddqDtau() const { return m_dddq_dtau; }
+
+	private:
+		enum Variable
+		{
+			Position,
+			Velocity,
+			Acceleration
+		};
+
+		void resize(int n_rigid, int n_dof);
+
+		/// velocities, accelerations and forces of the recursive Newton-Euler algorithm
+		void inverseDynamics(const SystemState& system_state, const Vectornd<float>& ddq, Vectornd<float>& tau);
+
+		/// column of the derivative of tau with respect to one dof
+		void perturb(int node_id, const SpatialVector<float>& s, Variable var, MatrixMN<float>& res, int col);
+
+		/// tau = ID(q, dq, ddq), with the columns of d(tau)/dq and d(tau)/d(dq) if derivatives is set and M if inertia is set
+		void computeDerivatives(const SystemState& system_state, const Vectornd<float>& ddq, bool derivatives, bool inertia);
+
+		void solveInertia(MatrixMN<float>& m, float scale);
+
+	private:
+		Node* m_parent_node = 0;
+		const SystemMotionState* m_state = 0;
+
+		std::vector<int> m_parent;
+		std::vector<SpatialVector<float>> m_vJ;		// joint velocities
+		std::vector<SpatialVector<float>> m_v;		// body velocities
+		std::vector<SpatialVector<float>> m_c;		// velocity product accelerations
+		std::vector<SpatialVector<float>> m_a;		// body accelerations
+		std::vector<SpatialVector<float>> m_Xa;		// parent accelerations in the body frame
+		std::vector<SpatialVector<float>> m_f;		// total forces of the subtrees
+		std::vector<SpatialVector<float>> m_fext;	// external forces in the body frame
+
+		// perturbations
+		std::vector<char> m_affected;
+		std::vector<SpatialVector<float>> m_dv;
+		std::vector<SpatialVector<float>> m_da;
+		std::vector<SpatialVector<float>> m_df;
+		std::vector<SpatialVector<float>> m_dframe;
+
+		std::vector<int> m_lambda;
+		Vectornd<float> m_col;
+
+		Vectornd<float> m_tau;
+		MatrixMN<float> m_dtau_dq;
+		MatrixMN<float> m_dtau_ddqdot;
+		MatrixMN<float> m_M;
+
+		Vectornd<float> m_ddq;
+		MatrixMN<float> m_dddq_dq;
+		MatrixMN<float> m_dddq_ddqdot;
+		MatrixMN<float> m_dddq_dtau;
+		MatrixMN<float> m_L;
+	};
+}
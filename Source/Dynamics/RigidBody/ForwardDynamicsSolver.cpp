@@ -45,21 +45,6 @@ namespace PhysIKA
 		std::cout << std::endl;
 	}
 
-	const SpatialVector<float> _v2p(const MatrixMN<float>& m, const SpatialVector<float>& v)
-	{
-		SpatialVector<float> res;
-		for (int i = 0; i < 6; ++i)
-		{
-			res[i] = 0;
-			for (int j = 0; j < 6; ++j)
-			{
-				res[i] += m(i, j) * v[j];
-			}
-		}
-		return res;
-	}
-
-
 	template<typename T> 
 	void setStxS(const SpatialVector<T>* S1, int dof1, const SpatialVector<T>* S2, int dof2, MatrixMN<T>& H, int idxi, int idxj)
 	{
@@ -93,54 +78,6 @@ namespace PhysIKA
 		}
 	}
 
-	template<typename T>
-	void transformI(const Transform3d<T>& trans, const MatrixMN<T>& inertia, MatrixMN<T>& res)
-	{
-		//MatrixMN<T> res(6, 6);
-		res.resize(6, 6);
-
-		// I_tmp = X_12f * I_1
-		for (int i = 0; i < 6; ++i)
-		{
-			SpatialVector<T> tmpv(inertia(0, i), inertia(1, i), inertia(2, i), inertia(3, i), inertia(4, i), inertia(5, i));
-			//res[i] = this->transformF(tmpv);
-			SpatialVector<T> tmpres = this->transformF(tmpv);
-
-			res(i, 0) = tmpres[0]; res(i, 1) = tmpres[1]; res(i, 2) = tmpres[2];
-			res(i, 3) = tmpres[3]; res(i, 4) = tmpres[4]; res(i, 5) = tmpres[5];
-		}
-
-		// I_2 = I_tmp * X_21m 
-		// ==> I_2 = I_2^T = (I_tmp * X_21m)^T = X_12f * I_tmp^T
-		for (int i = 0; i < 6; ++i)
-		{
-			SpatialVector<T> tmpv(res(0, i), res(1, i), res(2, i), res(3, i), res(4, i), res(5, i));
-			SpatialVector<T> tmpres = this->transformF(tmpv);
-
-			res(0, i) = tmpres[0]; res(1, i) = tmpres[1]; res(2, i) = tmpres[2];
-			res(3, i) = tmpres[3]; res(4, i) = tmpres[4]; res(5, i) = tmpres[5];
-		}
-
-	}
-
-	template<typename T>
-	void IxS(const MatrixMN<T>& inertia, const JointSpaceBase<T>& S, SpatialVector<T>* res)
-	{
-		int joint_dof = S.dof();
-
-		for (int i = 0; i < joint_dof; ++i)
-		{
-			for (int j = 0; j < 6; ++j)
-			{
-				res[i][j] = 0;
-				for (int k = 0; k < 6; ++k)
-				{
-					res[i][j] += inertia(j, k) * S(k, i);
-				}
-			}
-		}
-	}
-
 	IMPLEMENT_CLASS(InertiaMatrixFDSolver)
 
 	inline InertiaMatrixFDSolver::InertiaMatrixFDSolver()
@@ -153,7 +90,7 @@ namespace PhysIKA
 		//const std::vector<SpatialVector<float>>& external_force = s_system.m_externalForce;
 
 		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(this->getParent());
-		std::vector< std::pair<int, std::shared_ptr<RigidBody2<DataType3f>>>> all_node = root->getAllParentidNodePair();
+		const std::vector< std::pair<int, std::shared_ptr<RigidBody2<DataType3f>>>>& all_node = root->getAllParentidNodePair();
 		const std::vector<int>& idx_map = root->getJointIdxMap();
 		int joint_dof = root->getJointDof();
 
@@ -161,7 +98,7 @@ namespace PhysIKA
 		std::vector<SpatialVector<float>> avp(all_node.size());			// velocity, node frame
 		std::vector<SpatialVector<float>> fvp(all_node.size());
 
-		std::vector<MatrixMN<float>> IC(all_node.size());
+		std::vector<SpatialInertia<float>> IC(all_node.size());
 
 		/// ***  calculate C, using inverse dynamics *************
 		/// This part consists of 2 passes. 
@@ -170,7 +107,7 @@ namespace PhysIKA
 		for (int i = 0; i < all_node.size(); ++i)
 		{
 			int parent_id = all_node[i].first;
-			std::shared_ptr<RigidBody2<DataType3f>> cur_node = all_node[i].second;
+			const std::shared_ptr<RigidBody2<DataType3f>>& cur_node = all_node[i].second;
 			Joint* cur_joint = cur_node->getParentJoint();
 
 
@@ -236,7 +173,7 @@ namespace PhysIKA
 		for (int i = all_node.size() - 1; i >= 0; --i)
 		{
 			int parent_id = all_node[i].first;
-			std::shared_ptr<RigidBody2<DataType3f>> cur_node = all_node[i].second;
+			const std::shared_ptr<RigidBody2<DataType3f>>& cur_node = all_node[i].second;
 			Joint* cur_joint = cur_node->getParentJoint();
 
 			if (cur_joint->getJointDOF() > 0)
@@ -271,20 +208,20 @@ namespace PhysIKA
 		for (int i = all_node.size() - 1; i >= 0; --i)
 		{
 			int parent_id = all_node[i].first;
-			std::shared_ptr<RigidBody2<DataType3f>> cur_node = all_node[i].second;
+			const std::shared_ptr<RigidBody2<DataType3f>>& cur_node = all_node[i].second;
 			Joint* cur_joint = cur_node->getParentJoint();
 
 			//if (cur_joint->getJointDOF() > 0)
 			if(parent_id>=0)
 			{
-				IC[parent_id] = IC[parent_id] + motion_state.m_X[i].inverseTransform().transformI(IC[i]);
+				IC[parent_id] += motion_state.m_X[i].inverseTransform().transformI(IC[i]);
 			}
 		}
 
 		for (int i = 0; i < all_node.size(); ++i)
 		{
 			int parent_id = all_node[i].first;
-			std::shared_ptr<RigidBody2<DataType3f>> cur_node = all_node[i].second;
+			const std::shared_ptr<RigidBody2<DataType3f>>& cur_node = all_node[i].second;
 			Joint* cur_joint = cur_node->getParentJoint();
 
 			if (cur_joint->getJointDOF() > 0)
@@ -296,10 +233,7 @@ namespace PhysIKA
 				SpatialVector<float> F[6];
 
 				// F = Ic_i * S_i
-				IxS(IC[i], Si, &(F[0]));
-
-				/// ***** debug
-				SpatialVector<float> tmp_f = _v2p(IC[i], Si.getBases()[0]);
+				RigidUtil::IxS(IC[i], Si, &(F[0]));
 
 				// H_ii = S_i^T * F
 				setStxS(Si.getBases(), dofi,
@@ -316,7 +250,7 @@ namespace PhysIKA
 					transformFs(motion_state.m_X[j].inverseTransform(), F, dofi);
 
 					j = all_node[j].first;
-					std::shared_ptr<RigidBody2<DataType3f>> nodej = all_node[j].second;
+					const std::shared_ptr<RigidBody2<DataType3f>>& nodej = all_node[j].second;
 					Joint* jointj = nodej->getParentJoint();
 
 					if (jointj->getJointDOF() > 0)
@@ -1,6 +0,0 @@
-#include "Dynamics/RigidBody/HostNeighborList.h"
-
-namespace PhysIKA
-{
-
-}
\ No newline at end of file
@@ -1,61 +1,220 @@
 #pragma once
 
 #include "SystemMotionState.h"
+
+#include <algorithm>
+#include <cmath>
+
 namespace PhysIKA
 {
+	/**
+	* @brief Classical fourth order Runge-Kutta integrator.
+	* @details The stage states and derivatives are kept between calls, so once the buffers have been sized
+	* by the first step no further memory is allocated.
+	*/
 	class RK4Integrator
 	{
 	public:
+		template<typename DYDT>
+		void solve(SystemMotionState& s0, DYDT& dydt, double dt)
+		{
+			const DSystemMotionState* k[4] = { &m_k[0], &m_k[1], &m_k[2], &m_k[3] };
+			const double half = 0.5, one = 1.0;
+
+			dydt(s0, m_k[0]);
+
+			m_s.setSum(s0, &k[0], &half, 1, dt);
+			dydt(m_s, m_k[1]);
+
+			m_s.setSum(s0, &k[1], &half, 1, dt);
+			dydt(m_s, m_k[2]);
+
+			m_s.setSum(s0, &k[2], &one, 1, dt);
+			dydt(m_s, m_k[3]);
+
+			const double weights[4] = { 1.0 / 6.0, 2.0 / 6.0, 2.0 / 6.0, 1.0 / 6.0 };
+			s0.setSum(s0, k, weights, 4, dt);
+		}
+
+	private:
+		SystemMotionState m_s;
+		DSystemMotionState m_k[4];
+	};
+
+	/**
+	* @brief Second order Runge-Kutta integrator, midpoint method.
+	*/
+	class RK2Integrator
+	{
+	public:
+		template<typename DYDT>
+		void solve(SystemMotionState& s0, DYDT& dydt, double dt)
+		{
+			const DSystemMotionState* k[2] = { &m_k[0], &m_k[1] };
+			const double half = 0.5, one = 1.0;
+
+			dydt(s0, m_k[0]);
+
+			m_s.setSum(s0, &k[0], &half, 1, dt);
+			dydt(m_s, m_k[1]);
+
+			s0.setSum(s0, &k[1], &one, 1, dt);
+		}
+
+	private:
+		SystemMotionState m_s;
+		DSystemMotionState m_k[2];
+	};
+
+	/**
+	* @brief Adaptive Runge-Kutta integrator, Dormand-Prince 5(4) with error control.
+	* @details solve() advances the state by the full dt with as many substeps as the error tolerance requires.
+	* The accepted step size is carried over to the next call, so smooth motions are integrated with a few large
+	* substeps and only stiff phases are refined.
+	*/
+	class RK45Integrator
+	{
+	public:
+		/**
+		* @brief The error of a substep is accepted if |err| <= atol + rtol * |y| holds for every component.
+		*/
+		void setTolerance(double rtol, double atol) { m_rtol = rtol; m_atol = atol; }
+
+		/**
+		* @brief Substeps below min_dt are accepted regardless of the error.
+		*/
+		void setMinimumStep(double min_dt) { m_minDt = min_dt; }
+
+		double getRelativeTolerance() { return m_rtol; }
+		double getAbsoluteTolerance() { return m_atol; }
+		double getMinimumStep() { return m_minDt; }
+
+		/**
+		* @brief Number of substeps and rejected substeps of the last call to solve()
+		*/
+		int getStepNum() { return m_stepNum; }
+		int getRejectedNum() { return m_rejectedNum; }
 
-		//template<typename State, template DState>
-		//State solve(const State& s0, void(*dydt)(const State&, DState&), double dt)
-		//SystemMotionState solve(const State& s0, void(*dydt)(const State&, DState&), double dt)
-		//void solve(SystemMotionState& s0, void(*dydt)(const SystemMotionState&, DSystemMotionState&), double dt)
 		template<typename DYDT>
 		void solve(SystemMotionState& s0, DYDT& dydt, double dt)
 		{
-			//return s0 + dydt(s0) * dt;
+			static const double a[6][6] = {
+				{ 1.0 / 5.0 },
+				{ 3.0 / 40.0, 9.0 / 40.0 },
+				{ 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0 },
+				{ 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0 },
+				{ 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0 },
+				{ 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0 } };
 
-			//State k1 = dydt(s0);
-			//State k2 = dydt(s0 + k1*(dt * 0.5));
-			//State k3 = dydt(s0 + k2*(dt*0.5));
-			//State k4 = dydt(s0 + k3 * dt);
+			// difference between the fifth and the fourth order weights
+			static const double e[7] = { 71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0, -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0 };
 
-			SystemMotionState s;
-			//DSystemMotionState k;
+			m_stepNum = 0;
+			m_rejectedNum = 0;
 
-			s = s0;
-			DSystemMotionState k1;
-			dydt(s, k1);
+			if (m_h <= 0.0)
+			{
+				m_h = dt;
+			}
 
-			s = s0;
-			s.addDs(k1, dt*0.5);
-			DSystemMotionState k2;
-			dydt(s, k2);
+			DSystemMotionState* k[7];
+			for (int i = 0; i < 7; ++i)
+			{
+				k[i] = &m_k[i];
+			}
 
-			s = s0;
-			s.addDs(k2, dt*0.5);
-			DSystemMotionState k3;
-			dydt(s, k3);
+			double t = 0.0;
+			dydt(s0, *k[0]);
+			while (t < dt * (1.0 - 1e-9))
+			{
+				double h = std::min(m_h, dt - t);
 
-			s = s0;
-			s.addDs(k3, dt);
-			DSystemMotionState k4;
-			dydt(s, k4);
+				// the last stage is evaluated at the fifth order solution
+				for (int i = 0; i < 6; ++i)
+				{
+					m_s.setSum(s0, k, a[i], i + 1, h);
+					dydt(m_s, *k[i + 1]);
+				}
 
-			double newdt = dt / 6.0;
-			s0.addDs(k1, newdt);
-			s0.addDs(k2, newdt*2.0);
-			s0.addDs(k3, newdt*2.0);
-			s0.addDs(k4, newdt);
+				double err = errorNorm(s0, m_s, k, e, h);
+				if (err <= 1.0 || h <= m_minDt)
+				{
+					s0 = m_s;
+					t += h;
+					m_stepNum++;
 
-			//DSystemMotionState k;
-			//dydt(s0, k);
-			//s0.addDs(k, dt);
+					// first same as last
+					std::swap(k[0], k[6]);
 
-			//return s0;// +(k1 + (k2*2.0) + (k3*2.0) + k4)*(dt / 6.0);
+					// a step shortened to hit the end of the frame keeps the previous estimate unless it was too large
+					double factor = err > 0.0 ? std::min(5.0, std::max(0.2, 0.9 * std::pow(err, -0.2))) : 5.0;
+					if (h == m_h || factor < 1.0)
+					{
+						m_h = h * factor;
+					}
+				}
+				else
+				{
+					m_h = h * std::max(0.2, 0.9 * std::pow(err, -0.25));
+					m_rejectedNum++;
+				}
+			}
+		}
 
+	private:
+		double scaled(double err, double y0, double y1)
+		{
+			return std::abs(err) / (m_atol + m_rtol * std::max(std::abs(y0), std::abs(y1)));
+		}
+
+		double errorNorm(const SystemMotionState& s0, const SystemMotionState& s1, DSystemMotionState* const* k, const double* e, double h)
+		{
+			double err = 0.0;
+
+			int n_rigid = s0.m_rel_r.size();
+			for (int i = 0; i < n_rigid; ++i)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					double er = 0.0;
+					for (int j = 0; j < 7; ++j) er += e[j] * k[j]->m_rel_r[i][c];
+					err = std::max(err, scaled(h * er, s0.m_rel_r[i][c], s1.m_rel_r[i][c]));
+				}
+				for (int c = 0; c < 4; ++c)
+				{
+					double eq = 0.0;
+					for (int j = 0; j < 7; ++j) eq += e[j] * k[j]->m_rel_q[i][c];
+					err = std::max(err, scaled(h * eq, s0.m_rel_q[i][c], s1.m_rel_q[i][c]));
+				}
+				for (int c = 0; c < 6; ++c)
+				{
+					double ev = 0.0;
+					for (int j = 0; j < 7; ++j) ev += e[j] * k[j]->m_v[i][c];
+					err = std::max(err, scaled(h * ev, s0.m_v[i][c], s1.m_v[i][c]));
+				}
+			}
+
+			int dof = s0.m_dq.size();
+			for (int i = 0; i < dof; ++i)
+			{
+				double edq = 0.0;
+				for (int j = 0; j < 7; ++j) edq += e[j] * k[j]->m_dq[i];
+				err = std::max(err, scaled(h * edq, s0.m_dq[i], s1.m_dq[i]));
+			}
+
+			return err;
 		}
 
+		double m_rtol = 1e-4;
+		double m_atol = 1e-6;
+		double m_minDt = 1e-6;
+
+		double m_h = 0.0;
+
+		int m_stepNum = 0;
+		int m_rejectedNum = 0;
+
+		SystemMotionState m_s;
+		DSystemMotionState m_k[7];
 	};
 }
@@ -0,0 +1,193 @@
+#include "RigidBatchIntegrator.h"
+#include "ArticulatedBodyFDSolver.h"
+#include "RigidTimeIntegrationModule.h"
+#include "Core/Utility/ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace PhysIKA
+{
+	RigidBatchIntegrator::RigidBatchIntegrator(RigidBodyRoot<DataType3f>* model)
+	{
+		m_creator = []() { return std::make_shared<ArticulatedBodyFDSolver>(); };
+		setModel(model);
+	}
+
+	void RigidBatchIntegrator::setModel(RigidBodyRoot<DataType3f>* model)
+	{
+		m_model = model;
+		m_rigidNum = model ? (int)model->getAllNode().size() : 0;
+		m_dof = model ? model->getJointDof() : 0;
+		m_workspaces.clear();
+
+		int num = m_envNum;
+		m_envNum = 0;
+		setEnvironmentNum(num);
+	}
+
+	void RigidBatchIntegrator::setSolverCreator(SolverCreator creator)
+	{
+		m_creator = creator;
+		m_workspaces.clear();
+	}
+
+	void RigidBatchIntegrator::setEnvironmentNum(int num)
+	{
+		int oldNum = m_envNum;
+		m_envNum = m_model ? num : 0;
+
+		m_rel_r.resize(m_envNum * m_rigidNum);
+		m_rel_q.resize(m_envNum * m_rigidNum);
+		m_v.resize(m_envNum * m_rigidNum);
+		m_externalForce.resize(m_envNum * m_rigidNum);
+		m_dq.resize(m_envNum * m_dof);
+
+		for (int env = oldNum; env < m_envNum; env++)
+		{
+			resetEnvironment(env);
+		}
+	}
+
+	void RigidBatchIntegrator::resetEnvironment(int env)
+	{
+		loadState(env, *(m_model->getSystemState()->m_motionState));
+
+		for (int i = 0; i < m_rigidNum; i++)
+		{
+			m_externalForce[env * m_rigidNum + i] = SpatialVector<float>();
+		}
+	}
+
+	void RigidBatchIntegrator::loadState(int env, const SystemMotionState& s)
+	{
+		int offset = env * m_rigidNum;
+		for (int i = 0; i < m_rigidNum; i++)
+		{
+			m_rel_r[offset + i] = s.m_rel_r[i];
+			m_rel_q[offset + i] = s.m_rel_q[i];
+			m_v[offset + i] = s.m_v[i];
+		}
+
+		for (int i = 0; i < m_dof; i++)
+		{
+			m_dq[env * m_dof + i] = s.m_dq[i];
+		}
+	}
+
+	void RigidBatchIntegrator::storeState(int env, SystemMotionState& s)
+	{
+		s.setRoot(m_model);
+		s.setNum(m_rigidNum, m_dof);
+
+		int offset = env * m_rigidNum;
+		for (int i = 0; i < m_rigidNum; i++)
+		{
+			s.m_rel_r[i] = m_rel_r[offset + i];
+			s.m_rel_q[i] = m_rel_q[offset + i];
+			s.m_v[i] = m_v[offset + i];
+		}
+
+		for (int i = 0; i < m_dof; i++)
+		{
+			s.m_dq[i] = m_dq[env * m_dof + i];
+		}
+
+		s.updateGlobalInfo();
+	}
+
+	void RigidBatchIntegrator::gather(int env, Workspace& ws)
+	{
+		storeState(env, ws.state);
+
+		int offset = env * m_rigidNum;
+		for (int i = 0; i < m_rigidNum; i++)
+		{
+			ws.system.m_externalForce[i] = m_externalForce[offset + i];
+		}
+	}
+
+	void RigidBatchIntegrator::scatter(int env, const Workspace& ws)
+	{
+		loadState(env, ws.state);
+	}
+
+	void RigidBatchIntegrator::buildWorkspaces(int num)
+	{
+		while ((int)m_workspaces.size() < num)
+		{
+			std::unique_ptr<Workspace> ws(new Workspace);
+			ws->solver = m_creator();
+			ws->solver->setParent(m_model);
+
+			ws->system.m_root = m_model;
+			ws->system.m_gravity = m_model->getSystemState()->m_gravity;
+			ws->system.setNum(m_rigidNum, m_dof);
+
+			ws->state.setRoot(m_model);
+			ws->state.setNum(m_rigidNum, m_dof);
+
+			m_workspaces.push_back(std::move(ws));
+		}
+	}
+
+	bool RigidBatchIntegrator::step(double dt, int substeps)
+	{
+		if (m_envNum == 0)
+			return true;
+
+		auto t0 = std::chrono::steady_clock::now();
+
+		ThreadPool& pool = ThreadPool::getInstance();
+		int threadNum = (int)pool.getThreadNum();
+		buildWorkspaces(threadNum);
+
+		//One chunk per worker, so a chunk can use its workspace without locking
+		int grain = (m_envNum + threadNum - 1) / threadNum;
+		std::atomic<bool> success(true);
+
+		pool.parallelRange(m_envNum, [&](int begin, int end) {
+			Workspace& ws = *m_workspaces[begin / grain];
+			ForwardDynamicsSolver& solver = *ws.solver;
+			const SystemState& system = ws.system;
+
+			bool solved = true;
+			auto dydt = [&](const SystemMotionState& s0, DSystemMotionState& ds) {
+				if (!RigidTimeIntegrationModule::dydt(solver, system, s0, ds))
+				{
+					//Zero derivatives keep the integrator in bounds, the environment is not written back
+					ds.setRigidNum(m_rigidNum);
+					ds.setDof(m_dof);
+					ds.m_dq.setZeros();
+					for (int i = 0; i < m_rigidNum; i++)
+					{
+						ds.m_rel_r[i] = Vector3f();
+						ds.m_rel_q[i] = Quaternion<float>(0, 0, 0, 0);
+						ds.m_v[i] = SpatialVector<float>();
+					}
+					solved = false;
+				}
+			};
+
+			for (int env = begin; env < end; env++)
+			{
+				solved = true;
+				gather(env, ws);
+				for (int i = 0; i < substeps && solved; i++)
+				{
+					ws.rk4.solve(ws.state, dydt, dt);
+				}
+
+				if (solved)
+					scatter(env, ws);
+				else
+					success = false;
+			}
+		}, grain);
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		m_throughput = seconds > 0 ? m_envNum * substeps / seconds : 0.0;
+
+		return success;
+	}
+}
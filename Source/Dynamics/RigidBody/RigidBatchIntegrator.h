@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Dynamics/RigidBody/RigidBodyRoot.h"
+#include "Dynamics/RigidBody/ForwardDynamicsSolver.h"
+#include "Dynamics/RigidBody/SystemState.h"
+#include "Dynamics/RigidBody/SystemMotionState.h"
+#include "Dynamics/RigidBody/RKIntegrator.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace PhysIKA
+{
+	/*!
+	*	\class	RigidBatchIntegrator
+	*	\brief	Steps many independent copies (environments) of one articulated model in a single call.
+	*
+	*	The model only provides the topology, joints and inertias. The motion states of all environments are stored
+	*	field by field (structure of arrays), the block of environment k starts at k * getRigidNum() (k * getDof() for
+	*	joint velocities). Environments are distributed over the ThreadPool, every worker owns a forward dynamics
+	*	solver and the scratch states of the integrator.
+	*/
+	class RigidBatchIntegrator
+	{
+	public:
+		typedef std::function<std::shared_ptr<ForwardDynamicsSolver>()> SolverCreator;
+
+		RigidBatchIntegrator(RigidBodyRoot<DataType3f>* model = 0);
+
+		/**
+		 * @brief Set the articulated model, updateTree() must have been called on it
+		 */
+		void setModel(RigidBodyRoot<DataType3f>* model);
+		RigidBodyRoot<DataType3f>* getModel() { return m_model; }
+
+		/**
+		 * @brief Forward dynamics solver used by the workers, ArticulatedBodyFDSolver by default
+		 */
+		void setSolverCreator(SolverCreator creator);
+
+		/**
+		 * @brief Resize the batch, new environments start from the current state of the model
+		 */
+		void setEnvironmentNum(int num);
+		int getEnvironmentNum() { return m_envNum; }
+
+		int getRigidNum() { return m_rigidNum; }
+		int getDof() { return m_dof; }
+
+		/**
+		 * @brief Copy the current state of the model into an environment and clear its external forces
+		 */
+		void resetEnvironment(int env);
+
+		void loadState(int env, const SystemMotionState& s);
+		void storeState(int env, SystemMotionState& s);
+
+		Vector3f* getRelativePositions(int env) { return &m_rel_r[env * m_rigidNum]; }
+		Quaternion<float>* getRelativeRotations(int env) { return &m_rel_q[env * m_rigidNum]; }
+		SpatialVector<float>* getVelocities(int env) { return &m_v[env * m_rigidNum]; }
+		float* getJointVelocities(int env) { return &m_dq[env * m_dof]; }
+
+		/**
+		 * @brief Controls of an environment, external forces in world orientation as in SystemState
+		 */
+		SpatialVector<float>* getExternalForces(int env) { return &m_externalForce[env * m_rigidNum]; }
+
+		/**
+		 * @brief Advance all environments by substeps RK4 steps of dt
+		 * @return False if the forward dynamics failed in any environment, the state of such an environment is left unchanged
+		 */
+		bool step(double dt, int substeps = 1);
+
+		/**
+		 * @brief Environment steps per second of the last call to step()
+		 */
+		double getThroughput() { return m_throughput; }
+
+	private:
+		struct Workspace
+		{
+			std::shared_ptr<ForwardDynamicsSolver> solver;
+			SystemState system;
+			SystemMotionState state;
+			RK4Integrator rk4;
+		};
+
+		void gather(int env, Workspace& ws);
+		void scatter(int env, const Workspace& ws);
+
+		void buildWorkspaces(int num);
+
+		RigidBodyRoot<DataType3f>* m_model = 0;
+		SolverCreator m_creator;
+
+		int m_envNum = 0;
+		int m_rigidNum = 0;
+		int m_dof = 0;
+
+		std::vector<Vector3f> m_rel_r;
+		std::vector<Quaternion<float>> m_rel_q;
+		std::vector<SpatialVector<float>> m_v;
+		std::vector<float> m_dq;
+		std::vector<SpatialVector<float>> m_externalForce;
+
+		std::vector<std::unique_ptr<Workspace>> m_workspaces;
+
+		double m_throughput = 0.0;
+	};
+}
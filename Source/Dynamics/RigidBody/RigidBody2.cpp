@@ -48,8 +48,13 @@ namespace PhysIKA
 	template<typename TDataType>
 	void RigidBody2<TDataType>::loadShape(std::string filename)
 	{
+		m_shape_file = filename;
+
 		std::shared_ptr<TriangleSet<TDataType>> surface = m_triSet;// TypeInfo::CastPointerDown<TriangleSet<TDataType>>(m_surfaceNode->getTopologyModule());
-		surface->loadObjFile(filename);
+		if (surface)
+		{
+			surface->loadObjFile(filename);
+		}
 	}
 
 	template<typename TDataType>
@@ -180,10 +185,18 @@ namespace PhysIKA
 	{
 		
 		m_triSet = std::make_shared<PhysIKA::TriangleSet<TDataType>>();
-		m_triSet->loadObjFile("../../Media/standard/standard_cube.obj");
-		
-		m_triSet->translate(Vector3f(0.0, 0.0, 0.0));
-		m_triSet->scale(Vector3f(m_sizex, m_sizey, m_sizez)* m_global_scale /2.0);
+		if (m_shape_file.empty())
+		{
+			m_triSet->loadObjFile("../../Media/standard/standard_cube.obj");
+
+			m_triSet->translate(Vector3f(0.0, 0.0, 0.0));
+			m_triSet->scale(Vector3f(m_sizex, m_sizey, m_sizez)* m_global_scale /2.0);
+		}
+		else
+		{
+			m_triSet->loadObjFile(m_shape_file);
+			m_triSet->scale(m_shape_scale * m_global_scale);
+		}
 		//m_triSet->setIsRigid(true);
 		this->setTopologyModule(m_triSet);
 
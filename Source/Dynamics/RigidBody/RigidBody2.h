@@ -72,6 +72,18 @@ namespace PhysIKA
 			m_sizey = sy;
 			m_sizez = sz;
 		}
+		Vector3f getGeometrySize() const { return Vector3f(m_sizex, m_sizey, m_sizez); }
+
+		/**
+		* @brief Wavefront obj file of the surface and its scale, the default cube scaled by the geometry size is used if the file is empty
+		*/
+		void setShapeFile(const std::string& filename, const Vector3f& scale = Vector3f(1, 1, 1))
+		{
+			m_shape_file = filename;
+			m_shape_scale = scale;
+		}
+		const std::string& getShapeFile() const { return m_shape_file; }
+		const Vector3f& getShapeScale() const { return m_shape_scale; }
 
 		Vector3f getGlobalR() const { return m_global_r; }
 		Quaternion<float> getGlobalQ() const { return m_global_q; }
@@ -105,6 +117,8 @@ namespace PhysIKA
 		float m_sizey = 1.0;
 		float m_sizez = 1.0;
 		double m_global_scale = 0.1;
+		std::string m_shape_file;
+		Vector3f m_shape_scale = Vector3f(1, 1, 1);
 
 		// state info
 		Vector3f m_global_r;
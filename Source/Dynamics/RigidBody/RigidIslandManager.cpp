@@ -0,0 +1,216 @@
+#include "Dynamics/RigidBody/RigidIslandManager.h"
+
+#include <algorithm>
+
+namespace PhysIKA
+{
+	void RigidIslandManager::setSleepThreshold(float sleep_energy, float wake_energy)
+	{
+		m_sleep_energy = sleep_energy;
+		m_wake_energy = std::max(sleep_energy, wake_energy);
+	}
+
+	void RigidIslandManager::wakeUp()
+	{
+		std::fill(m_awake.begin(), m_awake.end(), 1);
+		std::fill(m_rest_time.begin(), m_rest_time.end(), 0.0f);
+	}
+
+	void RigidIslandManager::wakeUp(int node_id)
+	{
+		if (node_id < 0 || node_id >= m_awake.size())
+			return;
+
+		/// the other bodies of the island follow in the next update
+		m_wake_request[node_id] = 1;
+	}
+
+	bool RigidIslandManager::isSleeping(int node_id) const
+	{
+		return node_id >= 0 && node_id < m_awake.size() && !m_awake[node_id];
+	}
+
+	int RigidIslandManager::find(int i)
+	{
+		while (m_set[i] != i)
+		{
+			m_set[i] = m_set[m_set[i]];
+			i = m_set[i];
+		}
+		return i;
+	}
+
+	void RigidIslandManager::unite(int i, int j)
+	{
+		i = find(i);
+		j = find(j);
+		if (i != j)
+		{
+			/// the smaller id stays the representative
+			if (i < j)
+				m_set[j] = i;
+			else
+				m_set[i] = j;
+		}
+	}
+
+	void RigidIslandManager::computeEnergy(RigidBodyRoot<DataType3f>* root, const SystemMotionState & s)
+	{
+		const auto& all_nodes = root->getAllParentidNodePair();
+
+		for (int i = 0; i < all_nodes.size(); ++i)
+		{
+			int parent_id = all_nodes[i].first;
+			m_v[i] = parent_id >= 0 ? s.m_X[i].transformM(m_v[parent_id]) + s.m_v[i] : s.m_v[i];
+
+			const Inertia<float>& I = all_nodes[i].second->getI();
+			float mass = I.getMass();
+			m_energy[i] = mass > 0 ? 0.5f * (m_v[i] * (I * m_v[i])) / mass : 0.0f;
+		}
+	}
+
+	void RigidIslandManager::update(RigidBodyRoot<DataType3f>* root, SystemState & system_state, float dt)
+	{
+		const auto& all_nodes = root->getAllParentidNodePair();
+		const std::vector<int>& idx_map = root->getJointIdxMap();
+		SystemMotionState& s = *(system_state.m_motionState);
+
+		int n_rigid = all_nodes.size();
+		if (m_awake.size() != n_rigid)
+		{
+			/// the tree has changed, everything starts awake
+			m_awake.assign(n_rigid, 1);
+			m_wake_request.assign(n_rigid, 0);
+			m_rest_time.assign(n_rigid, 0.0f);
+		}
+		m_set.resize(n_rigid);
+		m_island_id.resize(n_rigid);
+		m_energy.resize(n_rigid);
+		m_v.resize(n_rigid);
+
+		/// joints and contacts connect bodies
+		for (int i = 0; i < n_rigid; ++i)
+		{
+			m_set[i] = i;
+		}
+		for (int i = 0; i < n_rigid; ++i)
+		{
+			if (all_nodes[i].first >= 0)
+			{
+				unite(i, all_nodes[i].first);
+			}
+		}
+		for (int i = 0; i < m_contacts.size(); ++i)
+		{
+			int a = m_contacts[i].first;
+			int b = m_contacts[i].second;
+			if (a >= 0 && a < n_rigid && b >= 0 && b < n_rigid)
+			{
+				unite(a, b);
+			}
+		}
+
+		/// representatives are the smallest ids, so the islands are numbered in order of their first node
+		m_island_num = 0;
+		for (int i = 0; i < n_rigid; ++i)
+		{
+			int rep = find(i);
+			if (rep == i)
+			{
+				if (m_island_num == m_islands.size())
+				{
+					m_islands.push_back(Island());
+				}
+				m_islands[m_island_num].nodes.clear();
+				m_islands[m_island_num].dof = 0;
+				m_island_id[i] = m_island_num++;
+			}
+			else
+			{
+				m_island_id[i] = m_island_id[rep];
+			}
+
+			Island& island = m_islands[m_island_id[i]];
+			island.nodes.push_back(i);
+			island.dof += all_nodes[i].second->getParentJoint()->getJointDOF();
+		}
+
+		computeEnergy(root, s);
+
+		m_awake_island_num = 0;
+		m_active_body_num = 0;
+		m_sleeping_body_num = 0;
+		for (int k = 0; k < m_island_num; ++k)
+		{
+			Island& island = m_islands[k];
+
+			bool any_awake = false;
+			bool any_sleeping = false;
+			bool forced = false;
+			float max_energy = 0.0f;
+			float min_rest_time = m_time_to_sleep;
+			for (int j = 0; j < island.nodes.size(); ++j)
+			{
+				int i = island.nodes[j];
+				forced |= m_wake_request[i] || system_state.m_externalForce[i].normSquared() > 0;
+				m_wake_request[i] = 0;
+
+				if (m_awake[i])
+				{
+					any_awake = true;
+					max_energy = std::max(max_energy, m_energy[i]);
+
+					m_rest_time[i] = m_energy[i] < m_sleep_energy ? m_rest_time[i] + dt : 0.0f;
+					min_rest_time = std::min(min_rest_time, m_rest_time[i]);
+				}
+				else
+				{
+					any_sleeping = true;
+				}
+			}
+
+			if (!m_sleeping_enabled || forced)
+				island.awake = true;
+			else if (!any_sleeping)
+				island.awake = min_rest_time < m_time_to_sleep;
+			else if (any_awake)
+				island.awake = max_energy > m_wake_energy;
+			else
+				island.awake = false;
+
+			for (int j = 0; j < island.nodes.size(); ++j)
+			{
+				int i = island.nodes[j];
+				if (island.awake)
+				{
+					if (!m_awake[i] || forced)
+					{
+						m_rest_time[i] = 0.0f;
+					}
+					m_awake[i] = 1;
+				}
+				else
+				{
+					m_awake[i] = 0;
+					s.m_v[i] = SpatialVector<float>();
+
+					int dof = all_nodes[i].second->getParentJoint()->getJointDOF();
+					for (int d = 0; d < dof; ++d)
+					{
+						s.m_dq[idx_map[i] + d] = 0;
+					}
+				}
+			}
+
+			if (island.awake)
+			{
+				++m_awake_island_num;
+				m_active_body_num += island.nodes.size();
+			}
+			else
+			{
+				m_sleeping_body_num += island.nodes.size();
+			}
+		}
+	}
+}
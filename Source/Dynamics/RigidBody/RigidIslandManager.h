@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Dynamics/RigidBody/RigidBodyRoot.h"
+#include "Dynamics/RigidBody/SystemState.h"
+
+#include <vector>
+
+namespace PhysIKA
+{
+	/*!
+	*	\class	RigidIslandManager
+	*	\brief	Island decomposition and sleeping of the bodies of a RigidBodyRoot.
+	*
+	*	Bodies connected by joints or by contact pairs form an island. As the root is the world, every subtree of
+	*	the root is an independent articulated system, contact pairs merge such subtrees.
+	*
+	*	A body is at rest while its kinetic energy per unit mass is below the sleep threshold. An island falls asleep
+	*	when all of its bodies have rested for the time to sleep, its velocities are then set to zero and it is no
+	*	longer integrated. A sleeping island wakes up when an external force is applied to one of its bodies, or when
+	*	it touches an awake island with a body moving above the wake threshold. A slow body that comes to rest on a
+	*	sleeping island joins it. The wake threshold is larger than the sleep threshold, so resting contacts do not
+	*	toggle the state every frame.
+	*/
+	class RigidIslandManager
+	{
+	public:
+		struct Island
+		{
+			std::vector<int> nodes;			// node ids in ascending order
+			int dof = 0;
+			bool awake = true;
+		};
+
+		/**
+		* @brief Pairs of node ids in contact, e.g. the collision pairs of a broad phase. They are used by the next update().
+		*/
+		void setContactPairs(const std::vector<std::pair<int, int>>& pairs) { m_contacts = pairs; }
+
+		void setSleepingEnabled(bool enabled) { m_sleeping_enabled = enabled; }
+		bool isSleepingEnabled() { return m_sleeping_enabled; }
+
+		/**
+		* @brief Kinetic energies per unit mass to fall asleep and to wake up a touching island, wake >= sleep
+		*/
+		void setSleepThreshold(float sleep_energy, float wake_energy);
+		void setTimeToSleep(float time) { m_time_to_sleep = time; }
+
+		void wakeUp();
+		void wakeUp(int node_id);
+		bool isSleeping(int node_id) const;
+
+		/**
+		* @brief Build the islands and update the sleep states, the velocities of sleeping islands are set to zero
+		* @details Call before the integration of a frame, after RigidBodyRoot::updateTree().
+		*/
+		void update(RigidBodyRoot<DataType3f>* root, SystemState& system_state, float dt);
+
+		int getIslandNum() const { return m_island_num; }
+		const Island& getIsland(int i) const { return m_islands[i]; }
+
+		int getAwakeIslandNum() const { return m_awake_island_num; }
+		int getActiveBodyNum() const { return m_active_body_num; }
+		int getSleepingBodyNum() const { return m_sleeping_body_num; }
+
+	private:
+		int find(int i);
+		void unite(int i, int j);
+
+		void computeEnergy(RigidBodyRoot<DataType3f>* root, const SystemMotionState& s);
+
+		std::vector<std::pair<int, int>> m_contacts;
+
+		bool m_sleeping_enabled = true;
+		float m_sleep_energy = 1e-3f;
+		float m_wake_energy = 4e-3f;
+		float m_time_to_sleep = 0.5f;
+
+		// per node
+		std::vector<int> m_set;
+		std::vector<int> m_island_id;
+		std::vector<char> m_awake;
+		std::vector<char> m_wake_request;
+		std::vector<float> m_rest_time;
+		std::vector<float> m_energy;
+		std::vector<SpatialVector<float>> m_v;		// absolute velocities, node frame
+
+		// islands are reused between frames, only the first m_island_num are valid
+		std::vector<Island> m_islands;
+		int m_island_num = 0;
+
+		int m_awake_island_num = 0;
+		int m_active_body_num = 0;
+		int m_sleeping_body_num = 0;
+	};
+}
@@ -0,0 +1,357 @@
+#include "Dynamics/RigidBody/RigidModelCache.h"
+#include "Dynamics/RigidBody/FixedJoint.h"
+#include "Dynamics/RigidBody/RevoluteJoint.h"
+#include "Dynamics/RigidBody/PrismaticJoint.h"
+#include "Dynamics/RigidBody/HelicalJoint.h"
+#include "Dynamics/RigidBody/CylindricalJoint.h"
+#include "Dynamics/RigidBody/PlanarJoint.h"
+#include "Dynamics/RigidBody/SphericalJoint.h"
+#include "Dynamics/RigidBody/FreeJoint.h"
+#include "Core/Utility/MappedFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <vector>
+
+namespace PhysIKA
+{
+	namespace
+	{
+		const char CacheMagic[8] = { 'P', 'K', 'R', 'I', 'G', 'I', 'D', '\0' };
+
+		void toArray(const Vector3f& v, float* res)
+		{
+			res[0] = v[0]; res[1] = v[1]; res[2] = v[2];
+		}
+
+		void toArray(const Quaternion<float>& q, float* res)
+		{
+			res[0] = q.x(); res[1] = q.y(); res[2] = q.z(); res[3] = q.w();
+		}
+
+		void toArray(const Matrix3f& m, float* res)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				for (int j = 0; j < 3; ++j)
+				{
+					res[3 * i + j] = m(i, j);
+				}
+			}
+		}
+
+		Transform3d<float> toTransform(const float* r, const float* rotation)
+		{
+			Matrix3f m(rotation[0], rotation[1], rotation[2],
+				rotation[3], rotation[4], rotation[5],
+				rotation[6], rotation[7], rotation[8]);
+			return Transform3d<float>(Vector3f(r[0], r[1], r[2]), m);
+		}
+
+		template<unsigned int Dof>
+		void setJointSpace(Joint& joint, const float* bases)
+		{
+			JointSpace<float, Dof> S;
+			SpatialVector<float>* S_bases = S.getBases();
+			for (int i = 0; i < Dof; ++i)
+			{
+				for (int j = 0; j < 6; ++j)
+				{
+					S_bases[i][j] = bases[6 * i + j];
+				}
+			}
+			joint.setJointSpace(S);
+		}
+	}
+
+	uint64_t RigidModelCache::hash(const char* data, size_t size)
+	{
+		uint64_t h = 14695981039346656037ULL;
+		for (size_t i = 0; i < size; ++i)
+		{
+			h ^= (unsigned char)data[i];
+			h *= 1099511628211ULL;
+		}
+		return h;
+	}
+
+	bool RigidModelCache::hashFile(const std::string& filename, uint64_t& key)
+	{
+		MappedFile file;
+		if (!file.open(filename))
+		{
+			return false;
+		}
+		key = hash(file.data(), file.size());
+		return true;
+	}
+
+	std::string RigidModelCache::getFileName(const std::string& directory, uint64_t key)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.pkrb", (unsigned long long)key);
+
+		if (directory.empty())
+		{
+			return name;
+		}
+		char last = directory[directory.size() - 1];
+		return (last == '/' || last == '\\') ? directory + name : directory + "/" + name;
+	}
+
+	int RigidModelCache::getJointType(const Joint* joint)
+	{
+		if (dynamic_cast<const FixedJoint*>(joint))			return Fixed;
+		if (dynamic_cast<const RevoluteJoint*>(joint))		return Revolute;
+		if (dynamic_cast<const PrismaticJoint*>(joint))		return Prismatic;
+		if (dynamic_cast<const HelicalJoint*>(joint))		return Helical;
+		if (dynamic_cast<const CylindricalJoint*>(joint))	return Cylindrical;
+		if (dynamic_cast<const PlanarJoint*>(joint))		return Planar;
+		if (dynamic_cast<const SphericalJoint*>(joint))		return Spherical;
+		if (dynamic_cast<const FreeJoint*>(joint))			return Free;
+		return -1;
+	}
+
+	std::shared_ptr<Joint> RigidModelCache::createJoint(int joint_type)
+	{
+		switch (joint_type)
+		{
+		case Fixed:			return std::make_shared<FixedJoint>();
+		case Revolute:		return std::make_shared<RevoluteJoint>();
+		case Prismatic:		return std::make_shared<PrismaticJoint>();
+		case Helical:		return std::make_shared<HelicalJoint>();
+		case Cylindrical:	return std::make_shared<CylindricalJoint>();
+		case Planar:		return std::make_shared<PlanarJoint>();
+		case Spherical:		return std::make_shared<SphericalJoint>();
+		case Free:			return std::make_shared<FreeJoint>();
+		default:			return std::shared_ptr<Joint>();
+		}
+	}
+
+	bool RigidModelCache::save(const std::string& filename, RigidBodyRoot<DataType3f>& root, uint64_t key)
+	{
+		const auto& all_node = root.getAllParentidNodePair();
+		const SystemState& system_state = *(root.getSystemState());
+		const SystemMotionState& motion_state = *(system_state.m_motionState);
+
+		int n_rigid = all_node.size();
+		if (motion_state.m_rel_r.size() != n_rigid)
+		{
+			return false;
+		}
+
+		std::string strings;
+		auto addString = [&strings](const std::string& str) {
+			uint32_t offset = strings.size();
+			strings.append(str.c_str(), str.size() + 1);
+			return offset;
+		};
+
+		Header header;
+		memset(&header, 0, sizeof(Header));
+		memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+		header.version = Version;
+		header.header_size = sizeof(Header);
+		header.key = key;
+		header.body_num = n_rigid;
+		header.dof = root.getJointDof();
+		header.root_name = addString(root.getName());
+		toArray(system_state.m_gravity, header.gravity);
+
+		std::vector<BodyRecord> bodies(n_rigid);
+		std::vector<StateRecord> states(n_rigid);
+		memset(bodies.data(), 0, n_rigid * sizeof(BodyRecord));
+		memset(states.data(), 0, n_rigid * sizeof(StateRecord));
+
+		for (int i = 0; i < n_rigid; ++i)
+		{
+			const RigidBody2_ptr& cur_node = all_node[i].second;
+			const Joint* cur_joint = cur_node->getParentJoint();
+
+			BodyRecord& body = bodies[i];
+			body.parent = all_node[i].first;
+			body.joint_type = getJointType(cur_joint);
+			if (body.joint_type < 0)
+			{
+				return false;
+			}
+			body.dof = cur_joint->getJointDOF();
+			body.name = addString(cur_node->getName());
+			body.shape_file = addString(cur_node->getShapeFile());
+
+			const Inertia<float>& I = cur_node->getI();
+			body.mass = I.getMass();
+			toArray(I.getInertiaDiagonal(), body.inertia);
+			toArray(cur_node->getGeometrySize(), body.size);
+			toArray(cur_node->getShapeScale(), body.shape_scale);
+
+			toArray(cur_joint->getXT().getTranslation(), body.xt_r);
+			toArray(cur_joint->getXT().getRotationMatrix(), body.xt_rotation);
+			toArray(cur_joint->getXJ().getTranslation(), body.xj_r);
+			toArray(cur_joint->getXJ().getRotationMatrix(), body.xj_rotation);
+
+			/// joints without dof have no joint space
+			if (body.dof > 0)
+			{
+				const SpatialVector<float>* bases = cur_joint->getJointSpace().getBases();
+				for (int k = 0; k < body.dof; ++k)
+				{
+					for (int j = 0; j < 6; ++j)
+					{
+						body.bases[6 * k + j] = bases[k][j];
+					}
+				}
+			}
+
+			StateRecord& state = states[i];
+			toArray(motion_state.m_rel_r[i], state.rel_r);
+			toArray(motion_state.m_rel_q[i], state.rel_q);
+			toArray(motion_state.m_global_r[i], state.global_r);
+			toArray(motion_state.m_global_q[i], state.global_q);
+			toArray(motion_state.m_X[i].getTranslation(), state.x_r);
+			toArray(motion_state.m_X[i].getRotationMatrix(), state.x_rotation);
+		}
+
+		header.body_offset = sizeof(Header);
+		header.state_offset = header.body_offset + n_rigid * sizeof(BodyRecord);
+		header.string_offset = header.state_offset + n_rigid * sizeof(StateRecord);
+		header.string_size = strings.size();
+		header.file_size = header.string_offset + header.string_size;
+
+		// write to a temporary file first, readers only ever see complete images
+		std::random_device rd;
+		std::stringstream tmp_name;
+		tmp_name << filename << ".tmp" << std::hex << rd();
+		{
+			std::ofstream out(tmp_name.str(), std::ios::binary | std::ios::trunc);
+			if (!out)
+			{
+				return false;
+			}
+			out.write((const char*)&header, sizeof(Header));
+			out.write((const char*)bodies.data(), n_rigid * sizeof(BodyRecord));
+			out.write((const char*)states.data(), n_rigid * sizeof(StateRecord));
+			out.write(strings.data(), strings.size());
+			if (!out)
+			{
+				out.close();
+				std::remove(tmp_name.str().c_str());
+				return false;
+			}
+		}
+
+		// rename() does not replace an existing file on every platform
+		bool renamed = std::rename(tmp_name.str().c_str(), filename.c_str()) == 0;
+		if (!renamed)
+		{
+			std::remove(filename.c_str());
+			renamed = std::rename(tmp_name.str().c_str(), filename.c_str()) == 0;
+		}
+		if (!renamed)
+		{
+			std::remove(tmp_name.str().c_str());
+		}
+		return renamed;
+	}
+
+	RigidBodyRoot_ptr RigidModelCache::load(const std::string& filename, uint64_t key)
+	{
+		MappedFile file;
+		if (!file.open(filename) || file.size() < sizeof(Header))
+		{
+			return RigidBodyRoot_ptr();
+		}
+
+		const char* data = file.data();
+		const Header& header = *(const Header*)data;
+		if (memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0
+			|| header.version != Version
+			|| header.header_size != sizeof(Header)
+			|| header.key != key
+			|| header.file_size != file.size())
+		{
+			return RigidBodyRoot_ptr();
+		}
+
+		int n_rigid = header.body_num;
+		if (header.body_offset != sizeof(Header)
+			|| header.state_offset != header.body_offset + n_rigid * sizeof(BodyRecord)
+			|| header.string_offset != header.state_offset + n_rigid * sizeof(StateRecord)
+			|| header.string_offset + (uint64_t)header.string_size != header.file_size
+			|| header.string_size == 0 || data[file.size() - 1] != '\0')
+		{
+			return RigidBodyRoot_ptr();
+		}
+
+		const BodyRecord* bodies = (const BodyRecord*)(data + header.body_offset);
+		const StateRecord* states = (const StateRecord*)(data + header.state_offset);
+		const char* strings = data + header.string_offset;
+		auto getString = [&](uint32_t offset) {
+			return std::string(offset < header.string_size ? strings + offset : "");
+		};
+
+		RigidBodyRoot_ptr root = std::make_shared<RigidBodyRoot<DataType3f>>(getString(header.root_name));
+
+		// bodies are stored in the breadth first order of updateTree(), parents come first
+		std::vector<RigidBody2_ptr> all_node(n_rigid);
+		for (int i = 0; i < n_rigid; ++i)
+		{
+			const BodyRecord& body = bodies[i];
+			std::shared_ptr<Joint> cur_joint = createJoint(body.joint_type);
+			if (!cur_joint || body.parent >= i || body.dof != cur_joint->getJointDOF())
+			{
+				return RigidBodyRoot_ptr();
+			}
+
+			RigidBody2_ptr cur_node = std::make_shared<RigidBody2<DataType3f>>(getString(body.name));
+			cur_node->setI(Inertia<float>(body.mass, Vector3f(body.inertia[0], body.inertia[1], body.inertia[2])));
+			cur_node->setGeometrySize(body.size[0], body.size[1], body.size[2]);
+			cur_node->setShapeFile(getString(body.shape_file), Vector3f(body.shape_scale[0], body.shape_scale[1], body.shape_scale[2]));
+
+			switch (body.dof)
+			{
+			case 1: setJointSpace<1>(*cur_joint, body.bases); break;
+			case 2: setJointSpace<2>(*cur_joint, body.bases); break;
+			case 3: setJointSpace<3>(*cur_joint, body.bases); break;
+			case 6: setJointSpace<6>(*cur_joint, body.bases); break;
+			default: break;
+			}
+			cur_joint->setXT(toTransform(body.xt_r, body.xt_rotation));
+			cur_joint->setXJ(toTransform(body.xj_r, body.xj_rotation));
+
+			RigidBody2_ptr parent_node = body.parent >= 0 ? all_node[body.parent] : RigidBody2_ptr(root);
+			cur_joint->setRigidBody(parent_node.get(), cur_node.get());
+			parent_node->addChildJoint(cur_joint);
+			parent_node->addChild(cur_node);
+			cur_node->setParentJoint(cur_joint.get());
+
+			all_node[i] = cur_node;
+		}
+
+		root->updateTree();
+
+		std::shared_ptr<SystemState> system_state = root->getSystemState();
+		SystemMotionState& motion_state = *(system_state->m_motionState);
+		system_state->m_gravity = Vector3f(header.gravity[0], header.gravity[1], header.gravity[2]);
+
+		for (int i = 0; i < n_rigid; ++i)
+		{
+			const StateRecord& state = states[i];
+			motion_state.m_rel_r[i] = Vector3f(state.rel_r[0], state.rel_r[1], state.rel_r[2]);
+			motion_state.m_rel_q[i] = Quaternion<float>(state.rel_q[0], state.rel_q[1], state.rel_q[2], state.rel_q[3]);
+			motion_state.m_global_r[i] = Vector3f(state.global_r[0], state.global_r[1], state.global_r[2]);
+			motion_state.m_global_q[i] = Quaternion<float>(state.global_q[0], state.global_q[1], state.global_q[2], state.global_q[3]);
+			motion_state.m_X[i] = toTransform(state.x_r, state.x_rotation);
+			motion_state.m_v[i] = SpatialVector<float>();
+		}
+		if (header.dof > 0)
+		{
+			motion_state.m_dq.setZeros();
+		}
+
+		return root;
+	}
+}
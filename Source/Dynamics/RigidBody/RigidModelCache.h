@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Dynamics/RigidBody/RigidBodyRoot.h"
+
+#include <cstdint>
+#include <string>
+
+namespace PhysIKA
+{
+	/*!
+	*	\class	RigidModelCache
+	*	\brief	Versioned binary image of a loaded articulated body.
+	*
+	*	The image stores the tree topology, joint types with their joint spaces and tree transforms,
+	*	inertias, geometry sizes, mesh file references with their scale and the initial motion state. Every record has a fixed size
+	*	and is 4-byte aligned, so a file is read through a single memory mapping without any parsing.
+	*	An image is tagged with a hash of the source model, load() rejects images of another source or another format version.
+	*
+	*	Layout: Header | BodyRecord[body_num] | StateRecord[body_num] | string table (zero terminated names)
+	*/
+	class RigidModelCache
+	{
+	public:
+		static const uint32_t Version = 2;
+
+		/**
+		* @brief 64-bit FNV-1a hash of a memory block, used as the key of a source model
+		*/
+		static uint64_t hash(const char* data, size_t size);
+
+		/**
+		* @brief Hash of the content of a file
+		* @return False if the file cannot be read
+		*/
+		static bool hashFile(const std::string& filename, uint64_t& key);
+
+		/**
+		* @brief Write the image of a tree built by RigidBodyRoot::updateTree()
+		* @details The file is written under a temporary name and then renamed, concurrent readers never see a partial image.
+		* @return False if a joint type is not supported or the file cannot be written
+		*/
+		static bool save(const std::string& filename, RigidBodyRoot<DataType3f>& root, uint64_t key);
+
+		/**
+		* @brief Rebuild a tree from an image
+		* @return Null if the file is missing, has another version or another key, or is corrupted
+		*/
+		static RigidBodyRoot_ptr load(const std::string& filename, uint64_t key);
+
+		/**
+		* @brief Cache file name of a key in a directory
+		*/
+		static std::string getFileName(const std::string& directory, uint64_t key);
+
+	private:
+		enum JointType
+		{
+			Fixed = 0,
+			Revolute,
+			Prismatic,
+			Helical,
+			Cylindrical,
+			Planar,
+			Spherical,
+			Free
+		};
+
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t header_size;
+			uint64_t key;
+			uint64_t file_size;
+			uint32_t body_num;
+			uint32_t dof;
+			uint32_t body_offset;
+			uint32_t state_offset;
+			uint32_t string_offset;
+			uint32_t string_size;
+			uint32_t root_name;
+			float gravity[3];
+		};
+
+		struct BodyRecord
+		{
+			int32_t parent;
+			int32_t joint_type;
+			int32_t dof;
+			uint32_t name;
+			uint32_t shape_file;
+			float mass;
+			float inertia[3];
+			float size[3];
+			float shape_scale[3];
+			float xt_r[3];
+			float xt_rotation[9];
+			float xj_r[3];
+			float xj_rotation[9];
+			float bases[36];
+		};
+
+		struct StateRecord
+		{
+			float rel_r[3];
+			float rel_q[4];
+			float global_r[3];
+			float global_q[4];
+			float x_r[3];
+			float x_rotation[9];
+		};
+
+		static int getJointType(const Joint* joint);
+		static std::shared_ptr<Joint> createJoint(int joint_type);
+	};
+}
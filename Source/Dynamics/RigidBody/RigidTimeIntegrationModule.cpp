@@ -10,6 +10,8 @@
 #include "Framework/Action/Action.h"
 #include "Dynamics/RigidBody/RKIntegrator.h"
 #include "Core/Utility/CTimer.h"
+#include "Core/Utility/ThreadPool.h"
+#include <atomic>
 #include <iostream>
 #include <queue>
 #include<memory>
@@ -25,6 +27,179 @@ namespace PhysIKA
 
 	IMPLEMENT_CLASS(RigidTimeIntegrationModule)
 
+	namespace
+	{
+		/// d_rel_q and d_rel_r of a node from its relative velocity v, Xup is the transformation from the parent
+		void nodePositionDerivative(Joint* joint, const Transform3d<float>& Xup, const SpatialVector<float>& v,
+			const Quaternion<float>& rel_q, const Vector3f& rel_r, Quaternion<float>& d_q, Vector3f& d_r)
+		{
+			if (joint->getJointDOF() > 0)
+			{
+				Transform3d<float> Xupinv = Xup.inverseTransform();
+
+				SpatialVector<float> cur_v6 = v;
+
+				/// d_rel_q
+				d_q = rel_q * Quaternion<float>(cur_v6[0], cur_v6[1], cur_v6[2], 0) * 0.5;
+
+				/// d_rel_r
+				cur_v6 = Xupinv.transformM(cur_v6);
+				Vector3f cur_w;	cur_w[0] = cur_v6[0];	cur_w[1] = cur_v6[1];	cur_w[2] = cur_v6[2];
+				Vector3f dr; dr[0] = cur_v6[3]; dr[1] = cur_v6[4]; dr[2] = cur_v6[5];
+				d_r = dr + cur_w.cross(rel_r);					///< 3dim velocity: v = v0 + w x r;
+			}
+			else
+			{
+				d_q = Quaternion<float>(0, 0, 0, 0);
+				d_r = Vector3f();
+			}
+		}
+
+		/**
+		* @brief Derivative of the local motion state of an island.
+		* @details The local state holds the nodes of the island in their order, the joint velocities are packed.
+		* It is written into the system motion state before every evaluation, islands only touch their own entries.
+		*/
+		class IslandDydt
+		{
+		public:
+			IslandDydt(RigidBodyRoot<DataType3f>* root, const SystemState& system_state, const RigidIslandManager::Island& island,
+				ArticulatedBodyFDSolver& fd_solver, Vectornd<float>& ddq) :
+				m_root(root), m_system_state(system_state), m_state(*(system_state.m_motionState)), m_island(island),
+				m_fd_solver(fd_solver), m_ddq(ddq)
+			{}
+
+			void gather(SystemMotionState& ls)
+			{
+				const auto& all_nodes = m_root->getAllParentidNodePair();
+				const std::vector<int>& idx_map = m_root->getJointIdxMap();
+
+				int n = m_island.nodes.size();
+				ls.setNum(n, m_island.dof);
+
+				int offset = 0;
+				for (int k = 0; k < n; ++k)
+				{
+					int i = m_island.nodes[k];
+					ls.m_rel_r[k] = m_state.m_rel_r[i];
+					ls.m_rel_q[k] = m_state.m_rel_q[i];
+					ls.m_v[k] = m_state.m_v[i];
+
+					int dof = all_nodes[i].second->getParentJoint()->getJointDOF();
+					for (int d = 0; d < dof; ++d)
+					{
+						ls.m_dq[offset + d] = m_state.m_dq[idx_map[i] + d];
+					}
+					offset += dof;
+				}
+			}
+
+			void scatter(const SystemMotionState& ls)
+			{
+				const auto& all_nodes = m_root->getAllParentidNodePair();
+				const std::vector<int>& idx_map = m_root->getJointIdxMap();
+
+				int offset = 0;
+				for (int k = 0; k < m_island.nodes.size(); ++k)
+				{
+					int i = m_island.nodes[k];
+					m_state.m_rel_r[i] = ls.m_rel_r[k];
+					m_state.m_rel_q[i] = ls.m_rel_q[k];
+					m_state.m_v[i] = ls.m_v[k];
+
+					int dof = all_nodes[i].second->getParentJoint()->getJointDOF();
+					for (int d = 0; d < dof; ++d)
+					{
+						m_state.m_dq[idx_map[i] + d] = ls.m_dq[offset + d];
+					}
+					offset += dof;
+				}
+
+				m_state.updateGlobalInfo(m_island.nodes);
+			}
+
+			void operator()(const SystemMotionState& ls, DSystemMotionState& ds)
+			{
+				scatter(ls);
+
+				int n = m_island.nodes.size();
+				ds.setRigidNum(n);
+				ds.setDof(m_island.dof);
+
+				/// the island is held for this evaluation, the failure is reported after the step
+				if (!m_fd_solver.solve(m_system_state, m_state, m_ddq, m_island.nodes))
+				{
+					m_failed = true;
+					for (int k = 0; k < n; ++k)
+					{
+						ds.m_rel_r[k] = Vector3f();
+						ds.m_rel_q[k] = Quaternion<float>(0, 0, 0, 0);
+						ds.m_v[k] = SpatialVector<float>();
+					}
+					ds.m_dq.setZeros();
+					return;
+				}
+
+				const auto& all_nodes = m_root->getAllParentidNodePair();
+				const std::vector<int>& idx_map = m_root->getJointIdxMap();
+
+				int offset = 0;
+				for (int k = 0; k < n; ++k)
+				{
+					int i = m_island.nodes[k];
+					Joint* cur_joint = all_nodes[i].second->getParentJoint();
+
+					int dof = cur_joint->getJointDOF();
+					if (dof > 0)
+					{
+						for (int d = 0; d < dof; ++d)
+						{
+							ds.m_dq[offset + d] = m_ddq[idx_map[i] + d];
+						}
+						ds.m_v[k] = cur_joint->getJointSpace().mul(&(ds.m_dq[offset]));
+					}
+					else
+					{
+						ds.m_v[k] = SpatialVector<float>();
+					}
+					offset += dof;
+				}
+
+				localPositionDerivative(ls, ds);
+			}
+
+			void positionDerivative(const SystemMotionState& ls, DSystemMotionState& ds)
+			{
+				scatter(ls);
+				ds.setRigidNum(m_island.nodes.size());
+				localPositionDerivative(ls, ds);
+			}
+
+			bool failed() const { return m_failed; }
+
+		private:
+			void localPositionDerivative(const SystemMotionState& ls, DSystemMotionState& ds)
+			{
+				const auto& all_nodes = m_root->getAllParentidNodePair();
+
+				for (int k = 0; k < m_island.nodes.size(); ++k)
+				{
+					int i = m_island.nodes[k];
+					nodePositionDerivative(all_nodes[i].second->getParentJoint(), m_state.m_X[i], ls.m_v[k],
+						ls.m_rel_q[k], ls.m_rel_r[k], ds.m_rel_q[k], ds.m_rel_r[k]);
+				}
+			}
+
+			RigidBodyRoot<DataType3f>* m_root;
+			const SystemState& m_system_state;
+			SystemMotionState& m_state;
+			const RigidIslandManager::Island& m_island;
+			ArticulatedBodyFDSolver& m_fd_solver;
+			Vectornd<float>& m_ddq;
+			bool m_failed = false;
+		};
+	}
+
 
 		inline RigidTimeIntegrationModule::RigidTimeIntegrationModule()
 	{
@@ -62,61 +237,111 @@ namespace PhysIKA
 		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(this->getParent());
 		SystemState& s = *(static_cast<RigidBodyRoot<DataType3f>*>(this->getParent())->getSystemState());
 
-		RK4Integrator rk4;
-		//*(s.m_motionState) = rk4.solve(*(s.m_motionState), dydt, m_dt);
-		rk4.solve(*(s.m_motionState), DydtAdapter(this), m_dt);
-
-		//s = s + RigidState::dydt(s) * m_dt;
-
-		//SemiImplicitEulerIntegrator semi;
-		//semi.solve(s, m_dt);
+		if (m_island_solving)
+		{
+			return executeIslands(root, s);
+		}
 
+		SystemMotionState& motion_state = *(s.m_motionState);
+		DydtAdapter adapter(this);
+		switch (m_integratorType)
+		{
+		case SemiImplicitEuler:
+			m_semiEuler.solve(motion_state, adapter, m_dt);
+			break;
+		case RK2:
+			m_rk2.solve(motion_state, adapter, m_dt);
+			break;
+		case RK45:
+			m_rk45.solve(motion_state, adapter, m_dt);
+			break;
+		default:
+			m_rk4.solve(motion_state, adapter, m_dt);
+			break;
+		}
 
 		//updateSystemState(s);
 		return true;
 	}
 
+	bool RigidTimeIntegrationModule::executeIslands(RigidBodyRoot<DataType3f>* root, SystemState & s)
+	{
+		m_islands.update(root, s, (float)m_dt);
 
+		/// the solver buffers are shared, islands write disjoint entries
+		m_island_fd.resize(root->getAllParentidNodePair().size(), root->getJointDof());
+		m_island_ddq.resize(root->getJointDof());
 
-	void RigidTimeIntegrationModule::dydt(const SystemMotionState & s0, DSystemMotionState & ds)
+		m_awake_islands.clear();
+		for (int k = 0; k < m_islands.getIslandNum(); ++k)
+		{
+			if (m_islands.getIsland(k).awake)
+			{
+				m_awake_islands.push_back(k);
+			}
+		}
+
+		while (m_island_ws.size() < m_awake_islands.size())
+		{
+			m_island_ws.push_back(std::unique_ptr<IslandWorkspace>(new IslandWorkspace));
+		}
+
+		std::atomic<bool> solve_ok(true);
+		ThreadPool::getInstance().parallelFor(m_awake_islands.size(), [&](int k) {
+			if (!stepIsland(root, s, m_islands.getIsland(m_awake_islands[k]), *m_island_ws[k]))
+			{
+				solve_ok = false;
+			}
+		}, 1);
+
+		return solve_ok;
+	}
+
+	bool RigidTimeIntegrationModule::stepIsland(RigidBodyRoot<DataType3f>* root, SystemState & s, const RigidIslandManager::Island & island, IslandWorkspace & ws)
 	{
-		CTimer timer;
-		timer.start();
+		IslandDydt dydt(root, s, island, m_island_fd, m_island_ddq);
+		dydt.gather(ws.state);
 
-		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(s0.m_root);
-		std::shared_ptr<SystemState> system_state = root->getSystemState();
+		switch (m_integratorType)
+		{
+		case SemiImplicitEuler:
+			ws.semiEuler.solve(ws.state, dydt, m_dt);
+			break;
+		case RK2:
+			ws.rk2.solve(ws.state, dydt, m_dt);
+			break;
+		case RK45:
+			ws.rk45.setTolerance(m_rk45.getRelativeTolerance(), m_rk45.getAbsoluteTolerance());
+			ws.rk45.setMinimumStep(m_rk45.getMinimumStep());
+			ws.rk45.solve(ws.state, dydt, m_dt);
+			break;
+		default:
+			ws.rk4.solve(ws.state, dydt, m_dt);
+			break;
+		}
 
-		
-		CTimer timer_solve_FD;
-		timer_solve_FD.start();
+		dydt.scatter(ws.state);
+		return !dydt.failed();
+	}
 
-		/// Use InertiaMatrix forward dynamics solver
-		//InertiaMatrixFDSolver fd_solver;
-		//ArticulatedBodyFDSolver& fd_solver = m_fd_solver;
-		//ArticulatedBodyFDSolver fd_solver;
-		//fd_solver.setParent(root);
 
 
-		/// Solve general acceleration.
-		bool solve_ok = m_fd_solver->solve(*system_state, s0, ds.m_dq);
+	void RigidTimeIntegrationModule::dydt(const SystemMotionState & s0, DSystemMotionState & ds)
+	{
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(s0.m_root);
 
-		timer_solve_FD.stop();
-		//std::cout << "  TIME * solve FD: " << timer_solve_FD.getElapsedTime() << std::endl;
+		dydt(*m_fd_solver, *(root->getSystemState()), s0, ds);
+	}
 
+	bool RigidTimeIntegrationModule::dydt(ForwardDynamicsSolver& fd_solver, const SystemState& system_state, const SystemMotionState & s0, DSystemMotionState & ds)
+	{
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(s0.m_root);
 
-		/// ********************** debug
-		//for (int i = 0; i < ds.m_dq.size(); ++i)
-		//{
-		//	ds.m_dq[i] = 1.0;
-		//}
+		/// Solve general acceleration.
+		bool solve_ok = fd_solver.solve(system_state, s0, ds.m_dq);
 
-		//if (H.linearSolve(C.negative(), ddq))
 		if (solve_ok)
 		{
-
-			CTimer timer_dy;
-			timer_dy.start();
-
 			const std::vector< std::pair<int, std::shared_ptr<RigidBody2<DataType3f>>>>& all_nodes = root->getAllParentidNodePair();
 
 			/// joint index map
@@ -126,51 +351,37 @@ namespace PhysIKA
 
 			for (int i = 0; i < all_nodes.size(); ++i)
 			{
-				int parent_id = all_nodes[i].first;
-				std::shared_ptr<RigidBody2<DataType3f>> cur_node = all_nodes[i].second;
-				Joint* cur_joint = cur_node->getParentJoint();
+				Joint* cur_joint = all_nodes[i].second->getParentJoint();
 
+				/// d_vJ, expressed in node frame
 				int dof = cur_joint->getJointDOF();
 				if (dof > 0)
 				{
-					const Transform3d<float>& Xup = s0.m_X[i];
-					Transform3d<float> Xupinv = Xup.inverseTransform();
-
-					/// d_vJ
 					ds.m_v[i] = cur_joint->getJointSpace().mul(&(ds.m_dq[idx_map[i]]));
-
-					SpatialVector<float> cur_v6 = s0.m_v[i];
-
-					/// d_rel_q
-					ds.m_rel_q[i] = s0.m_rel_q[i] * Quaternion<float>(cur_v6[0], cur_v6[1], cur_v6[2], 0) * 0.5;
-
-					/// d_rel_r
-					cur_v6 = Xupinv.transformM(cur_v6);
-					Vector3f cur_w;	cur_w[0] = cur_v6[0];	cur_w[1] = cur_v6[1];	cur_w[2] = cur_v6[2];
-					Vector3f d_r; d_r[0] = cur_v6[3]; d_r[1] = cur_v6[4]; d_r[2] = cur_v6[5];
-					ds.m_rel_r[i] = d_r + cur_w.cross(s0.m_rel_r[i]);					///< 3dim velocity: v = v0 + w x r;
-
 				}
 				else
 				{
-				
-					/// d_vJ
-					ds.m_v[i] = SpatialVector<float>();					// d_vJ, expressed in node frame
-
-																		// d_r, d_quaternion
-					ds.m_rel_q[i] = Quaternion<float>(0, 0, 0, 0);
-					ds.m_rel_r[i] = Vector3f();
+					ds.m_v[i] = SpatialVector<float>();
 				}
 			}
 
-			timer_dy.stop();
-			//std::cout << "  TIME * ddq to dr&dQ: " << timer_dy.getElapsedTime() << std::endl;
+			positionDerivative(s0, ds);
+		}
+
+		return solve_ok;
+	}
 
-			timer.stop();
-			//std::cout << "TIME * dydt:  " << timer.getElapsedTime() << std::endl;
+	void RigidTimeIntegrationModule::positionDerivative(const SystemMotionState & s0, DSystemMotionState & ds)
+	{
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(s0.m_root);
+		const std::vector< std::pair<int, std::shared_ptr<RigidBody2<DataType3f>>>>& all_nodes = root->getAllParentidNodePair();
 
-			//return ds;
+		ds.setRigidNum(all_nodes.size());
 
+		for (int i = 0; i < all_nodes.size(); ++i)
+		{
+			nodePositionDerivative(all_nodes[i].second->getParentJoint(), s0.m_X[i], s0.m_v[i],
+				s0.m_rel_q[i], s0.m_rel_r[i], ds.m_rel_q[i], ds.m_rel_r[i]);
 		}
 	}
 
@@ -8,6 +8,9 @@
 #include "Dynamics/RigidBody/RigidState.h"
 
 #include "Dynamics/RigidBody/ArticulatedBodyFDSolver.h"
+#include "Dynamics/RigidBody/RKIntegrator.h"
+#include "Dynamics/RigidBody/SemiImplicitEuler.h"
+#include "Dynamics/RigidBody/RigidIslandManager.h"
 #include "ForwardDynamicsSolver.h"
 
 #include<memory>
@@ -24,7 +27,13 @@ namespace PhysIKA
 		DECLARE_CLASS(RigidTimeIntegrationModule)
 	
 	public:
-		
+		enum IntegratorType
+		{
+			SemiImplicitEuler,
+			RK2,
+			RK4,
+			RK45
+		};
 
 	public:
 
@@ -47,16 +56,76 @@ namespace PhysIKA
 
 		void dydt(const SystemMotionState& s0, DSystemMotionState& ds);
 
+		/**
+		* @brief Time derivative of a motion state
+		* @details Stateless apart from fd_solver, so it can be evaluated concurrently with one solver per thread.
+		* @param fd_solver Forward dynamics solver, its parent must be the root of s0.
+		* @param system_state Force state, external forces and gravity.
+		* @return False if the forward dynamics failed, ds is not set then.
+		*/
+		static bool dydt(ForwardDynamicsSolver& fd_solver, const SystemState& system_state, const SystemMotionState& s0, DSystemMotionState& ds);
+
+		/**
+		* @brief Time derivatives of the relative positions and rotations, computed from the velocities of s0
+		*/
+		static void positionDerivative(const SystemMotionState& s0, DSystemMotionState& ds);
+
+		/**
+		* @brief Integration scheme used by execute(), RK4 by default
+		*/
+		void setIntegratorType(IntegratorType type) { m_integratorType = type; }
+		IntegratorType getIntegratorType() { return m_integratorType; }
+
+		RK45Integrator& getAdaptiveIntegrator() { return m_rk45; }
+
 		void setFDSolver(std::shared_ptr<ForwardDynamicsSolver> fd_solver);
+
+		/**
+		* @brief Integrate the islands of the island manager one by one on the ThreadPool, sleeping islands are skipped
+		* @details Islands are always solved with the articulated body algorithm, the solver of setFDSolver() is not used then. Off by default.
+		* An island whose forward dynamics fails keeps a zero derivative for that evaluation and execute() returns false.
+		*/
+		void setIslandSolving(bool enabled) { m_island_solving = enabled; }
+		bool isIslandSolving() { return m_island_solving; }
+
+		RigidIslandManager& getIslandManager() { return m_islands; }
 		
 	private:
+		// Local motion state of an island and the integrators stepping it
+		struct IslandWorkspace
+		{
+			SystemMotionState state;
+			SemiImplicitEulerIntegrator semiEuler;
+			RK2Integrator rk2;
+			RK4Integrator rk4;
+			RK45Integrator rk45;
+		};
+
+		bool executeIslands(RigidBodyRoot<DataType3f>* root, SystemState& s);
+		bool stepIsland(RigidBodyRoot<DataType3f>* root, SystemState& s, const RigidIslandManager::Island& island, IslandWorkspace& ws);
+
 		std::shared_ptr<ForwardDynamicsSolver> m_fd_solver;
 
 		Vectornd<float> m_ddq;
 		double m_dt = 0;
 
+		IntegratorType m_integratorType = RK4;
+
+		// The integrators keep their scratch states between frames
+		SemiImplicitEulerIntegrator m_semiEuler;
+		RK2Integrator m_rk2;
+		RK4Integrator m_rk4;
+		RK45Integrator m_rk45;
+
 		double m_last_time = 0;
 		bool m_time_init = false;
+
+		bool m_island_solving = false;
+		RigidIslandManager m_islands;
+		ArticulatedBodyFDSolver m_island_fd;
+		Vectornd<float> m_island_ddq;
+		std::vector<int> m_awake_islands;
+		std::vector<std::unique_ptr<IslandWorkspace>> m_island_ws;
 	};
 
 
@@ -79,6 +148,11 @@ namespace PhysIKA
 			}
 		}
 
+		void positionDerivative(const SystemMotionState& s0, DSystemMotionState& ds)
+		{
+			RigidTimeIntegrationModule::positionDerivative(s0, ds);
+		}
+
 	public:
 		RigidTimeIntegrationModule* m_integrator;
 
@@ -9,6 +9,7 @@
 
 #include "JointSpace.h"
 #include "SpatialVector.h"
+#include "SpatialMatrix.h"
 
 #ifndef RIGID_ABS
 #define RIGID_ABS(x) (x)>0?(x):(-(x))
@@ -52,7 +53,19 @@ namespace PhysIKA
 		}
 
 		template<typename T>
-		static void setStxS(const SpatialVector<T>* S1, int dof1, const SpatialVector<T>* S2, int dof2, MatrixMN<T>& H, int idxi, int idxj)
+		static void IxS(const SpatialMatrix<T>& inertia, const JointSpaceBase<T>& S, SpatialVector<T>* res)
+		{
+			int joint_dof = S.dof();
+			const SpatialVector<T>* bases = S.getBases();
+
+			for (int i = 0; i < joint_dof; ++i)
+			{
+				res[i] = inertia * bases[i];
+			}
+		}
+
+		template<typename T, typename MAT>
+		static void setStxS(const SpatialVector<T>* S1, int dof1, const SpatialVector<T>* S2, int dof2, MAT& H, int idxi, int idxj)
 		{
 			for (int i = 0; i < dof1; ++i)
 			{
@@ -84,11 +97,28 @@ namespace PhysIKA
 		template<typename T> 
 		static const MatrixMN<T> inverse(const MatrixMN<T>& m, int dim)
 		{
-			T eps = 1e-6;
-
 			MatrixMN<T> res(dim, dim);
 			MatrixMN<T> cop(dim, dim);
-			
+			inverse<T>(m, dim, res, cop);
+			return res;
+		}
+
+		/// Inverse of the top left dim x dim block
+		template<typename T>
+		static const SpatialMatrix<T> inverse(const SpatialMatrix<T>& m, int dim)
+		{
+			SpatialMatrix<T> res;
+			SpatialMatrix<T> cop;
+			inverse<T>(m, dim, res, cop);
+			return res;
+		}
+
+		/// Gauss-Jordan elimination with partial pivoting, cop is used as scratch
+		template<typename T, typename MAT>
+		static void inverse(const MAT& m, int dim, MAT& res, MAT& cop)
+		{
+			T eps = 1e-6;
+
 			/// initialze matrix
 			for (int i = 0; i < dim; i++)
 			{
@@ -122,7 +152,7 @@ namespace PhysIKA
 
 					if (max_value < eps)
 					{
-						return res;
+						return;
 					}
 					
 					if (idx != i)
@@ -162,13 +192,11 @@ namespace PhysIKA
 					}
 				}
 			}
-
-			return res;
 		}
 
 
-		template<typename T>
-		static void setMul(const MatrixMN<T>& m, int nx, int ny, const T* v, T* res)
+		template<typename T, typename MAT>
+		static void setMul(const MAT& m, int nx, int ny, const T* v, T* res)
 		{
 			for (int i = 0; i < nx; ++i)
 			{
@@ -0,0 +1,129 @@
+#include "SparseInertiaMatrixFDSolver.h"
+#include "RigidBodyRoot.h"
+
+namespace PhysIKA
+{
+	IMPLEMENT_CLASS(SparseInertiaMatrixFDSolver)
+
+	SparseInertiaMatrixFDSolver::SparseInertiaMatrixFDSolver()
+	{
+	}
+
+	bool SparseInertiaMatrixFDSolver::solve(const SystemState& s_system, const SystemMotionState& s, Vectornd<float>& ddq)
+	{
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*>(this->getParent());
+		const auto& all_node = root->getAllParentidNodePair();
+
+		// (parent id, joint dof) of each node, the parent dof array is only rebuilt when the tree changes
+		bool changed = m_parent_dof.size() != all_node.size();
+		m_parent_dof.resize(all_node.size());
+		for (int i = 0; i < all_node.size(); ++i)
+		{
+			std::pair<int, int> cur(all_node[i].first, all_node[i].second->getParentJoint()->getJointDOF());
+			if (cur != m_parent_dof[i])
+			{
+				m_parent_dof[i] = cur;
+				changed = true;
+			}
+		}
+		if (changed)
+		{
+			buildParentDof(m_parent_dof, root->getJointIdxMap(), m_lambda);
+		}
+
+		this->buildJointSpaceMotionEquation(s_system, s, m_H, m_C);
+
+		if (!factorize(m_H, m_lambda))
+		{
+			return false;
+		}
+
+		ddq = m_C;
+		backSubstitute(m_H, m_lambda, ddq);
+
+		return true;
+	}
+
+	void SparseInertiaMatrixFDSolver::buildParentDof(const std::vector<std::pair<int, int>>& parent_dof_pairs, const std::vector<int>& idx_map, std::vector<int>& lambda)
+	{
+		int n_node = parent_dof_pairs.size();
+		int n_dof = n_node > 0 ? idx_map[n_node - 1] + parent_dof_pairs[n_node - 1].second : 0;
+		lambda.resize(n_dof);
+
+		/// last dof on the path from the base to each node, nodes are sorted so that parents come first
+		std::vector<int> last_dof(n_node, -1);
+		for (int i = 0; i < n_node; ++i)
+		{
+			int parent_id = parent_dof_pairs[i].first;
+			int dof = parent_dof_pairs[i].second;
+			int inherited = parent_id >= 0 ? last_dof[parent_id] : -1;
+
+			for (int k = 0; k < dof; ++k)
+			{
+				lambda[idx_map[i] + k] = k == 0 ? inherited : idx_map[i] + k - 1;
+			}
+			last_dof[i] = dof > 0 ? idx_map[i] + dof - 1 : inherited;
+		}
+	}
+
+	// Featherstone, Rigid Body Dynamics Algorithms, Table 6.3
+	bool SparseInertiaMatrixFDSolver::factorize(MatrixMN<float>& H, const std::vector<int>& lambda)
+	{
+		int n = lambda.size();
+		for (int k = n - 1; k >= 0; --k)
+		{
+			if (H(k, k) <= 0)
+			{
+				return false;
+			}
+
+			int i = lambda[k];
+			while (i >= 0)
+			{
+				float a = H(k, i) / H(k, k);
+				int j = i;
+				while (j >= 0)
+				{
+					H(i, j) -= a * H(k, j);
+					j = lambda[j];
+				}
+				H(k, i) = a;
+				i = lambda[i];
+			}
+		}
+		return true;
+	}
+
+	void SparseInertiaMatrixFDSolver::backSubstitute(const MatrixMN<float>& H, const std::vector<int>& lambda, Vectornd<float>& b)
+	{
+		int n = lambda.size();
+
+		/// b = L^-T * b
+		for (int i = n - 1; i >= 0; --i)
+		{
+			int j = lambda[i];
+			while (j >= 0)
+			{
+				b[j] -= H(i, j) * b[i];
+				j = lambda[j];
+			}
+		}
+
+		/// b = D^-1 * b
+		for (int i = 0; i < n; ++i)
+		{
+			b[i] /= H(i, i);
+		}
+
+		/// b = L^-1 * b
+		for (int i = 0; i < n; ++i)
+		{
+			int j = lambda[i];
+			while (j >= 0)
+			{
+				b[i] -= H(i, j) * b[j];
+				j = lambda[j];
+			}
+		}
+	}
+}
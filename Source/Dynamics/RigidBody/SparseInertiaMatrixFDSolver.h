@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ForwardDynamicsSolver.h"
+
+#include <vector>
+#include "Core/Matrix/matrix_mxn.h"
+#include "Core/Vector/vector_nd.h"
+
+namespace PhysIKA
+{
+	/**
+	* @brief Inertia matrix forward dynamics solver with a sparse LTDL factorization.
+	* @details The joint space inertia matrix H is built as in InertiaMatrixFDSolver. H(i, j) is nonzero only
+	* if dof i and dof j lie on the same branch of the kinematic tree, so H = L^T * D * L is factorized
+	* without fill-in by following the parent dof array. The cost is O(n * d^2) instead of O(n^3),
+	* where d is the depth of the tree in dofs.
+	*/
+	class SparseInertiaMatrixFDSolver :public InertiaMatrixFDSolver
+	{
+	public:
+		DECLARE_CLASS(SparseInertiaMatrixFDSolver)
+
+		SparseInertiaMatrixFDSolver();
+
+		bool solve(const SystemState& s_system, const SystemMotionState& s, Vectornd<float>& ddq);
+
+		/**
+		* @brief Factorize H = L^T * D * L in place.
+		* @param H Joint space inertia matrix. On return, D is stored on the diagonal and L below it.
+		* @param lambda Parent dof of each dof, lambda[i] < i, -1 for a dof without parent.
+		* @return False if H is not positive definite.
+		*/
+		static bool factorize(MatrixMN<float>& H, const std::vector<int>& lambda);
+
+		/**
+		* @brief Solve H * x = b with the factors from factorize(), x overwrites b.
+		*/
+		static void backSubstitute(const MatrixMN<float>& H, const std::vector<int>& lambda, Vectornd<float>& b);
+
+		/**
+		* @brief Build the parent dof array of the kinematic tree.
+		*/
+		static void buildParentDof(const std::vector<std::pair<int, int>>& parent_dof_pairs, const std::vector<int>& idx_map, std::vector<int>& lambda);
+
+	private:
+		MatrixMN<float> m_H;
+		Vectornd<float> m_C;
+
+		/// (parent id, joint dof) of each node that m_lambda was built from
+		std::vector<std::pair<int, int>> m_parent_dof;
+		std::vector<int> m_lambda;
+	};
+}
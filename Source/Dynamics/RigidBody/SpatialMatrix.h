@@ -0,0 +1,235 @@
+#pragma once
+
+#include "Core/Platform.h"
+#include "SpatialVector.h"
+
+namespace PhysIKA
+{
+	/*!
+	*	\class	SpatialMatrix
+	*	\brief	Stack allocated 6x6 matrix of the spatial algebra, stored row-major in an aligned array.
+	*
+	*	Replaces MatrixMN(6, 6) in the articulated body solvers, which allocated on the heap for every temporary.
+	*/
+	template<typename T>
+	class SpatialMatrix
+	{
+	public:
+		COMM_FUNC SpatialMatrix() { setZeros(); }
+
+		COMM_FUNC unsigned int rows() const { return 6; }
+		COMM_FUNC unsigned int cols() const { return 6; }
+
+		COMM_FUNC inline T& operator() (unsigned int i, unsigned int j) { return m_data[i * 6 + j]; }
+		COMM_FUNC inline const T operator() (unsigned int i, unsigned int j) const { return m_data[i * 6 + j]; }
+
+		COMM_FUNC void setZeros()
+		{
+			for (int i = 0; i < 36; ++i)
+				m_data[i] = 0;
+		}
+
+		COMM_FUNC void setIdentity()
+		{
+			for (int i = 0; i < 36; ++i)
+				m_data[i] = (i % 7 == 0) ? 1 : 0;
+		}
+
+		COMM_FUNC const SpatialMatrix<T> operator+ (const SpatialMatrix<T>& m) const
+		{
+			SpatialMatrix<T> res(*this);
+			res += m;
+			return res;
+		}
+
+		COMM_FUNC const SpatialMatrix<T> operator- (const SpatialMatrix<T>& m) const
+		{
+			SpatialMatrix<T> res(*this);
+			res -= m;
+			return res;
+		}
+
+		COMM_FUNC SpatialMatrix<T>& operator+= (const SpatialMatrix<T>& m)
+		{
+			for (int i = 0; i < 36; ++i)
+				m_data[i] += m.m_data[i];
+			return *this;
+		}
+
+		COMM_FUNC SpatialMatrix<T>& operator-= (const SpatialMatrix<T>& m)
+		{
+			for (int i = 0; i < 36; ++i)
+				m_data[i] -= m.m_data[i];
+			return *this;
+		}
+
+		COMM_FUNC const SpatialMatrix<T> operator* (T s) const
+		{
+			SpatialMatrix<T> res(*this);
+			for (int i = 0; i < 36; ++i)
+				res.m_data[i] *= s;
+			return res;
+		}
+
+		COMM_FUNC const SpatialMatrix<T> operator* (const SpatialMatrix<T>& m) const
+		{
+			SpatialMatrix<T> res;
+			for (int i = 0; i < 6; ++i)
+			{
+				for (int k = 0; k < 6; ++k)
+				{
+					T a = m_data[i * 6 + k];
+					for (int j = 0; j < 6; ++j)
+						res.m_data[i * 6 + j] += a * m.m_data[k * 6 + j];
+				}
+			}
+			return res;
+		}
+
+		COMM_FUNC const SpatialVector<T> operator* (const SpatialVector<T>& v) const
+		{
+			T x[6] = { v.m_angular[0], v.m_angular[1], v.m_angular[2], v.m_linear[0], v.m_linear[1], v.m_linear[2] };
+			T y[6];
+			for (int i = 0; i < 6; ++i)
+			{
+				const T* row = m_data + i * 6;
+				y[i] = row[0] * x[0] + row[1] * x[1] + row[2] * x[2] + row[3] * x[3] + row[4] * x[4] + row[5] * x[5];
+			}
+			return SpatialVector<T>(y[0], y[1], y[2], y[3], y[4], y[5]);
+		}
+
+		COMM_FUNC const SpatialMatrix<T> transpose() const
+		{
+			SpatialMatrix<T> res;
+			for (int i = 0; i < 6; ++i)
+				for (int j = 0; j < 6; ++j)
+					res.m_data[j * 6 + i] = m_data[i * 6 + j];
+			return res;
+		}
+
+		COMM_FUNC T* getDataPtr() { return m_data; }
+		COMM_FUNC const T* getDataPtr() const { return m_data; }
+
+	protected:
+		alignas(16) T m_data[36];
+	};
+
+	/*!
+	*	\class	SpatialInertia
+	*	\brief	Symmetric 6x6 spatial (articulated) inertia.
+	*
+	*	The full matrix is kept so that it can be used wherever a SpatialMatrix is expected,
+	*	operations that preserve symmetry only evaluate the upper triangle.
+	*/
+	template<typename T>
+	class SpatialInertia : public SpatialMatrix<T>
+	{
+	public:
+		COMM_FUNC SpatialInertia() : SpatialMatrix<T>() {}
+
+		/**
+		 * @brief Take the upper triangle of m, the lower triangle is mirrored
+		 */
+		COMM_FUNC explicit SpatialInertia(const SpatialMatrix<T>& m)
+		{
+			for (int i = 0; i < 6; ++i)
+				for (int j = i; j < 6; ++j)
+					set(i, j, m(i, j));
+		}
+
+		/**
+		 * @brief Set both (i, j) and (j, i)
+		 */
+		COMM_FUNC inline void set(unsigned int i, unsigned int j, T value)
+		{
+			this->m_data[i * 6 + j] = value;
+			this->m_data[j * 6 + i] = value;
+		}
+
+		COMM_FUNC const SpatialInertia<T> operator+ (const SpatialInertia<T>& m) const
+		{
+			SpatialInertia<T> res(*this);
+			res += m;
+			return res;
+		}
+
+		COMM_FUNC const SpatialInertia<T> operator- (const SpatialInertia<T>& m) const
+		{
+			SpatialInertia<T> res(*this);
+			res -= m;
+			return res;
+		}
+
+		using SpatialMatrix<T>::operator*;
+	};
+
+	/**
+	* @brief Calculate U * D * U^T, where D is a symmetric dof x dof block stored in the top left corner of a SpatialMatrix
+	* @param U Bases of U, U has 6 rows and dof columns
+	* @param dof
+	* @param D
+	* @return U * D * U^T
+	*/
+	template<typename T>
+	const SpatialInertia<T> UxDxUT(const SpatialVector<T>* U, int dof, const SpatialMatrix<T>& D)
+	{
+		// UD = U * D, 6 x dof
+		T UD[6][6];
+		for (int i = 0; i < 6; ++i)
+		{
+			for (int j = 0; j < dof; ++j)
+			{
+				T sum = 0;
+				for (int k = 0; k < dof; ++k)
+				{
+					sum += U[k][i] * D(k, j);
+				}
+				UD[i][j] = sum;
+			}
+		}
+
+		SpatialInertia<T> res;
+		for (int i = 0; i < 6; ++i)
+		{
+			for (int j = i; j < 6; ++j)
+			{
+				T sum = 0;
+				for (int k = 0; k < dof; ++k)
+				{
+					sum += UD[i][k] * U[k][j];
+				}
+				res.set(i, j, sum);
+			}
+		}
+		return res;
+	}
+
+	/**
+	* @brief Calculate U * D * u
+	* @param U Bases of U, U has 6 rows and dof columns
+	* @param D
+	* @param u
+	* @param dof dof of U, D and u
+	* @return U * D * u
+	*/
+	template<typename T>
+	const SpatialVector<T> UxDxui(const SpatialVector<T>* U, const SpatialMatrix<T>& D, const T* u, int dof)
+	{
+		T Du[6];
+		for (int i = 0; i < dof; ++i)
+		{
+			Du[i] = 0;
+			for (int j = 0; j < dof; ++j)
+			{
+				Du[i] += D(i, j) * u[j];
+			}
+		}
+
+		SpatialVector<T> res(0, 0, 0, 0, 0, 0);
+		for (int k = 0; k < dof; ++k)
+		{
+			res += U[k] * Du[k];
+		}
+		return res;
+	}
+}
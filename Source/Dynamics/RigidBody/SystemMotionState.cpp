@@ -4,60 +4,53 @@
 namespace PhysIKA
 {
 	
-	template<typename T>
-	void _addDvec(std::vector<T>& v, const std::vector<T>& dv, double dt)
+	SystemMotionState & SystemMotionState::addDs(const DSystemMotionState & ds, double dt)
 	{
-		int n = v.size();
-		for (int i = 0; i < n; ++i)
-		{
-			v[i] = v[i] + dv[i] * dt;
-		}
+		const DSystemMotionState* pds = &ds;
+		double weight = 1.0;
+		return this->setSum(*this, &pds, &weight, 1, dt);
 	}
 
-	template<typename T>
-	void _addDvec(Vectornd<T>& v, const Vectornd<T>& dv, double dt)
+	SystemMotionState & SystemMotionState::setSum(const SystemMotionState & s0, const DSystemMotionState * const * ds, const double * weights, int n, double dt)
 	{
-		int n = v.size();
-		for (int i = 0; i < n; ++i)
+		if (this != &s0)
 		{
-			v[i] += dv[i] * dt;
+			this->m_root = s0.m_root;
+			this->setNum(s0.m_rel_r.size(), s0.m_dq.size());
 		}
-	}
-
-	
-	SystemMotionState & SystemMotionState::addDs(const DSystemMotionState & ds, double dt)
-	{
-		_addDvec(this->m_rel_r, ds.m_rel_r, dt);
-		_addDvec(this->m_rel_q, ds.m_rel_q, dt);
-		_addDvec(this->m_v, ds.m_v, dt);
-		_addDvec(this->m_dq, ds.m_dq, dt);
 
-
-		// /
-		if (this->m_root)
+		int n_rigid = s0.m_rel_r.size();
+		for (int i = 0; i < n_rigid; ++i)
 		{
-			auto all_node_pairs = static_cast<RigidBodyRoot<DataType3f>*>(this->m_root)->getAllParentidNodePair();
+			Vector3f r = s0.m_rel_r[i];
+			Quaternion<float> q = s0.m_rel_q[i];
+			SpatialVector<float> v = s0.m_v[i];
+			for (int j = 0; j < n; ++j)
+			{
+				float w = (float)(weights[j] * dt);
+				r += ds[j]->m_rel_r[i] * w;
+				q += ds[j]->m_rel_q[i] * w;
+				v += ds[j]->m_v[i] * w;
+			}
+			this->m_rel_r[i] = r;
+			this->m_rel_q[i] = q;
+			this->m_v[i] = v;
+		}
 
-			for (int i = 0; i < all_node_pairs.size(); ++i)
+		int dof = s0.m_dq.size();
+		for (int i = 0; i < dof; ++i)
+		{
+			float dq = s0.m_dq[i];
+			for (int j = 0; j < n; ++j)
 			{
-				RigidBody2_ptr cur_node = all_node_pairs[i].second;
-				int parent_id = all_node_pairs[i].first;
-				
-				this->m_X[i] = Transform3d<float>(this->m_rel_r[i], this->m_rel_q[i].getConjugate());
-
-
-				if (parent_id >= 0)
-				{
-					this->m_global_r[i] = this->m_global_r[parent_id] + this->m_global_q[parent_id].rotate(this->m_rel_r[i]);
-					this->m_global_q[i] = this->m_global_q[parent_id] * this->m_rel_q[i];
-				}
-				else
-				{
-					this->m_global_r[i] = this->m_rel_r[i];
-					this->m_global_q[i] = this->m_rel_q[i];
-				}
-				this->m_global_q[i].normalize();
+				dq += ds[j]->m_dq[i] * (float)(weights[j] * dt);
 			}
+			this->m_dq[i] = dq;
+		}
+
+		if (this->m_root)
+		{
+			this->updateGlobalInfo();
 		}
 
 		return *this;
@@ -67,27 +60,45 @@ namespace PhysIKA
 	{
 		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*> (m_root);
 
-		auto nodePairs = root->getAllParentidNodePair();
+		const auto& nodePairs = root->getAllParentidNodePair();
 
 		for (int i = 0; i < nodePairs.size(); ++i)
 		{
-			RigidBody2_ptr cur_node = nodePairs[i].second;
-			int cur_id = cur_node->getId();
-			int parent_id = nodePairs[i].first;
+			updateNodeGlobalInfo(i);
+		}
+	}
 
-			this->m_X[cur_id].set(this->m_rel_r[cur_id], this->m_rel_q[cur_id].getConjugate());
+	void SystemMotionState::updateGlobalInfo(const std::vector<int>& nodes)
+	{
+		for (int k = 0; k < nodes.size(); ++k)
+		{
+			updateNodeGlobalInfo(nodes[k]);
+		}
+	}
 
-			if (parent_id >= 0)
-			{
-				m_global_r[cur_id] = m_global_r[parent_id] + m_global_q[parent_id].rotate(m_rel_r[cur_id]);
-				m_global_q[cur_id] = m_global_q[parent_id] * m_rel_q[cur_id];
-			}
-			else
-			{
-				m_global_r[cur_id] = m_rel_r[cur_id];
-				m_global_q[cur_id] = m_rel_q[cur_id];
-			}
+	void SystemMotionState::updateNodeGlobalInfo(int i)
+	{
+		RigidBodyRoot<DataType3f>* root = static_cast<RigidBodyRoot<DataType3f>*> (m_root);
+
+		const auto& nodePairs = root->getAllParentidNodePair();
+
+		const RigidBody2_ptr& cur_node = nodePairs[i].second;
+		int cur_id = cur_node->getId();
+		int parent_id = nodePairs[i].first;
+
+		this->m_X[cur_id].set(this->m_rel_r[cur_id], this->m_rel_q[cur_id].getConjugate());
+
+		if (parent_id >= 0)
+		{
+			m_global_r[cur_id] = m_global_r[parent_id] + m_global_q[parent_id].rotate(m_rel_r[cur_id]);
+			m_global_q[cur_id] = m_global_q[parent_id] * m_rel_q[cur_id];
+		}
+		else
+		{
+			m_global_r[cur_id] = m_rel_r[cur_id];
+			m_global_q[cur_id] = m_rel_q[cur_id];
 		}
+		m_global_q[cur_id].normalize();
 	}
 
 }
\ No newline at end of file
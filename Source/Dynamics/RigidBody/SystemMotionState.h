@@ -53,8 +53,20 @@ namespace PhysIKA
 		//void build();
 		SystemMotionState& addDs(const DSystemMotionState& ds, double dt);
 
+		/**
+		* @brief this = s0 + dt * (weights[0] * ds[0] + ... + weights[n-1] * ds[n-1]), s0 may be *this.
+		* @details Works in place on the existing buffers and updates the global information once.
+		*/
+		SystemMotionState& setSum(const SystemMotionState& s0, const DSystemMotionState* const* ds, const double* weights, int n, double dt);
+
 		void updateGlobalInfo();
 
+		/**
+		* @brief Update the global information of some nodes only
+		* @param nodes Node ids in ascending order, the parent of a node has to be updated already or be in the list.
+		*/
+		void updateGlobalInfo(const std::vector<int>& nodes);
+
 		void setRigidNum(int n)
 		{
 
@@ -82,7 +94,7 @@ namespace PhysIKA
 
 
 	private:
-
+		void updateNodeGlobalInfo(int i);
 
 
 	public:
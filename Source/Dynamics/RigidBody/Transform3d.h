@@ -6,6 +6,7 @@
 #include "Core/Matrix/matrix_3x3.h"
 #include "Core/Quaternion/quaternion.h"
 #include "Inertia.h"
+#include "SpatialMatrix.h"
 
 #include<memory>
 
@@ -36,15 +37,17 @@ namespace PhysIKA
 		void setTranslation(const VectorBase<float>& r);
 		void setRotation(const Quaternion<float>& q);
 
-		const SpatialVector<T>& transformF(const SpatialVector<T>& f) const;
+		const SpatialVector<T> transformF(const SpatialVector<T>& f) const;
 		
 
 		//MatrixMN<T> transformF(const MatrixMN<T>& f);
 
-		const SpatialVector<T>& transformM(const SpatialVector<T>& m) const;
+		const SpatialVector<T> transformM(const SpatialVector<T>& m) const;
 
 		const Inertia<T> transformI(const Inertia<T>& inertia)const;
 		const MatrixMN<T> transformI(const MatrixMN<T>& inertia)const;
+		const SpatialMatrix<T> transformI(const SpatialMatrix<T>& inertia)const;
+		const SpatialInertia<T> transformI(const SpatialInertia<T>& inertia)const;
 
 		//MatrixMN<T> transformM(const MatrixMN<T>& m);
 
@@ -117,7 +120,7 @@ namespace PhysIKA
 		m_rotation_q = q;
 	}
 	template<typename T>
-	inline const SpatialVector<T>& Transform3d<T>::transformF(const SpatialVector<T>& f)const 
+	inline const SpatialVector<T> Transform3d<T>::transformF(const SpatialVector<T>& f)const 
 	{
 		SpatialVector<T> res;
 		// translation:  new_torque = torque - r x f;
@@ -145,7 +148,7 @@ namespace PhysIKA
 		return res;
 	}
 	template<typename T>
-	inline const SpatialVector<T>& Transform3d<T>::transformM(const SpatialVector<T>& m)const
+	inline const SpatialVector<T> Transform3d<T>::transformM(const SpatialVector<T>& m)const
 	{
 		SpatialVector<T> res;
 		// translation: new_w = w;
@@ -205,6 +208,102 @@ namespace PhysIKA
 
 	}
 
+	template<typename T>
+	inline const SpatialMatrix<T> Transform3d<T>::transformI(const SpatialMatrix<T>& inertia) const
+	{
+		SpatialMatrix<T> res;
+
+		/// res = X_12f * I_1, column by column
+		for (int i = 0; i < 6; ++i)
+		{
+			SpatialVector<T> tmpres = this->transformF(SpatialVector<T>(inertia(0, i), inertia(1, i), inertia(2, i), inertia(3, i), inertia(4, i), inertia(5, i)));
+			for (int j = 0; j < 6; ++j)
+				res(j, i) = tmpres[j];
+		}
+
+		/// I_2 = res * X_21m, row by row
+		for (int i = 0; i < 6; ++i)
+		{
+			SpatialVector<T> tmpres = this->transformF(SpatialVector<T>(res(i, 0), res(i, 1), res(i, 2), res(i, 3), res(i, 4), res(i, 5)));
+			for (int j = 0; j < 6; ++j)
+				res(i, j) = tmpres[j];
+		}
+
+		return res;
+	}
+
+	// Transformation of a symmetric inertia, I_1 = [A B; B^T M]
+	// X_12f = [E  -E*rx]   ==>   I_2 = [E*Z*E^T   E*Y*E^T]
+	//         [0   E   ]               [  ...     E*M*E^T]
+	// with Y = B - rx*M and Z = A - rx*B^T + Y*rx, only the upper triangles of the diagonal blocks are evaluated.
+	template<typename T>
+	inline const SpatialInertia<T> Transform3d<T>::transformI(const SpatialInertia<T>& inertia) const
+	{
+		T E[3][3], r[3] = { m_translation[0], m_translation[1], m_translation[2] };
+		T A[3][3], B[3][3], M[3][3];
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				E[i][j] = m_rotation(i, j);
+				A[i][j] = inertia(i, j);
+				B[i][j] = inertia(i, j + 3);
+				M[i][j] = inertia(i + 3, j + 3);
+			}
+		}
+
+		/// Y = B - rx*M, column j is B_j - r x M_j
+		T Y[3][3];
+		for (int j = 0; j < 3; ++j)
+		{
+			Y[0][j] = B[0][j] - (r[1] * M[2][j] - r[2] * M[1][j]);
+			Y[1][j] = B[1][j] - (r[2] * M[0][j] - r[0] * M[2][j]);
+			Y[2][j] = B[2][j] - (r[0] * M[1][j] - r[1] * M[0][j]);
+		}
+
+		/// Z = A - rx*B^T + Y*rx, (rx*B^T)(i, j) = (r x B_row_j)_i and (Y*rx)(i, j) = (Y_row_i x r)_j
+		T Z[3][3];
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = i; j < 3; ++j)
+			{
+				int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+				int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+				T rxBt = r[i1] * B[j][i2] - r[i2] * B[j][i1];
+				T Yxr = Y[i][j1] * r[j2] - Y[i][j2] * r[j1];
+				Z[i][j] = A[i][j] - rxBt + Yxr;
+				Z[j][i] = Z[i][j];
+			}
+		}
+
+		T EZ[3][3], EY[3][3], EM[3][3];
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				EZ[i][j] = E[i][0] * Z[0][j] + E[i][1] * Z[1][j] + E[i][2] * Z[2][j];
+				EY[i][j] = E[i][0] * Y[0][j] + E[i][1] * Y[1][j] + E[i][2] * Y[2][j];
+				EM[i][j] = E[i][0] * M[0][j] + E[i][1] * M[1][j] + E[i][2] * M[2][j];
+			}
+		}
+
+		SpatialInertia<T> res;
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				res.set(i, j + 3, EY[i][0] * E[j][0] + EY[i][1] * E[j][1] + EY[i][2] * E[j][2]);
+				if (j >= i)
+				{
+					res.set(i, j, EZ[i][0] * E[j][0] + EZ[i][1] * E[j][1] + EZ[i][2] * E[j][2]);
+					res.set(i + 3, j + 3, EM[i][0] * E[j][0] + EM[i][1] * E[j][1] + EM[i][2] * E[j][2]);
+				}
+			}
+		}
+
+		return res;
+	}
+
 	// Merge tow transformation into one
 	// X1 = [ E1      0 ]       X2 = [ E2      0 ]
 	//		[-E1*r1x  E1]            [-E2*r2x  E2]
@@ -2,7 +2,7 @@
 
 #include "Core/Array/Array.h"
 #include "Framework/Framework/ModuleTopology.h"
-#include "Dynamics/RigidBody/HostNeighborList.h"
+#include "Framework/Topology/HostNeighborList.h"
 #include <vector>
 #include <string>
 
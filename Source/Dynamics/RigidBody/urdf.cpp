@@ -5,11 +5,13 @@
 #include "Core/Quaternion/quaternion.h"
 #include "Dynamics/RigidBody/RigidUtil.h"
 #include "Dynamics/RigidBody/FixedJoint.h"
+#include "Dynamics/RigidBody/RigidModelCache.h"
 
 #include "SystemState.h"
 
 #include "Transform3d.h"
 
+#include <cctype>
 #include <queue>
 #include <map>
 #include <string>
@@ -20,7 +22,62 @@
 
 namespace PhysIKA {
 
+	namespace
+	{
+		/// directory of a file including the trailing separator, empty if the name has no directory
+		std::string getDirectory(const std::string& filename)
+		{
+			std::string::size_type pos = filename.find_last_of("/\\");
+			return pos == std::string::npos ? std::string() : filename.substr(0, pos + 1);
+		}
+
+		bool isAbsolutePath(const std::string& filename)
+		{
+			return !filename.empty() && (filename[0] == '/' || filename[0] == '\\' || (filename.size() > 1 && filename[1] == ':'));
+		}
+
+		/// a local Wavefront obj file, URIs such as package:// cannot be resolved
+		bool isObjFile(const std::string& filename)
+		{
+			if (filename.find("://") != std::string::npos)
+			{
+				return false;
+			}
+
+			std::string::size_type pos = filename.find_last_of('.');
+			if (pos == std::string::npos)
+			{
+				return false;
+			}
+
+			std::string ext = filename.substr(pos + 1);
+			return ext.size() == 3 && tolower(ext[0]) == 'o' && tolower(ext[1]) == 'b' && tolower(ext[2]) == 'j';
+		}
+	}
+
 	RigidBodyRoot_ptr PhysIKA::Urdf::loadFile(std::string filename)
+	{
+		uint64_t key = 0;
+		if (m_cache_dir.empty() || !RigidModelCache::hashFile(filename, key))
+		{
+			return parseFile(filename);
+		}
+
+		/// mesh files are stored resolved against the directory of the URDF file
+		std::string directory = getDirectory(filename);
+		key ^= RigidModelCache::hash(directory.c_str(), directory.size());
+
+		std::string cache_file = RigidModelCache::getFileName(m_cache_dir, key);
+		RigidBodyRoot_ptr rigid_root = RigidModelCache::load(cache_file, key);
+		if (!rigid_root)
+		{
+			rigid_root = parseFile(filename);
+			RigidModelCache::save(cache_file, *rigid_root, key);
+		}
+		return rigid_root;
+	}
+
+	RigidBodyRoot_ptr PhysIKA::Urdf::parseFile(std::string filename)
 	{
 		// ------  load urdf file  -------
 
@@ -127,6 +184,25 @@ namespace PhysIKA {
 							sssize >> sx >> sy >> sz;
 							cur_rigid->setGeometrySize(sx, sy, sz);
 						}
+
+						/// other mesh formats keep the box
+						auto geometry_mesh = visual_geometry->FirstChildElement("mesh");
+						if (geometry_mesh && geometry_mesh->Attribute("filename") && isObjFile(geometry_mesh->Attribute("filename")))
+						{
+							std::string mesh_file = geometry_mesh->Attribute("filename");
+							if (!isAbsolutePath(mesh_file))
+							{
+								mesh_file = getDirectory(filename) + mesh_file;
+							}
+
+							Vector3f mesh_scale(1, 1, 1);
+							if (geometry_mesh->Attribute("scale"))
+							{
+								std::stringstream ssscale(geometry_mesh->Attribute("scale"));
+								ssscale >> mesh_scale[0] >> mesh_scale[1] >> mesh_scale[2];
+							}
+							cur_rigid->setShapeFile(mesh_file, mesh_scale);
+						}
 					}
 				}
 
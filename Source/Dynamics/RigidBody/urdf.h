@@ -11,9 +11,23 @@ namespace PhysIKA{
 
 class Urdf{
 public:
+/**
+* @brief Load a URDF file
+* @details If a cache directory is set, the model is read from the binary image keyed by the hash of the file content and directory,
+* and the image is written after the file has been parsed when there is none. See RigidModelCache.
+*/
 RigidBodyRoot_ptr loadFile(std::string filename);
 
+/**
+* @brief Directory of the binary model images, an empty directory disables the cache
+*/
+void setCacheDirectory(const std::string& directory) { m_cache_dir = directory; }
+const std::string& getCacheDirectory() const { return m_cache_dir; }
 
+private:
+RigidBodyRoot_ptr parseFile(std::string filename);
+
+std::string m_cache_dir;
 };
 
 }
\ No newline at end of file
@@ -9,9 +9,10 @@
 namespace PhysIKA
 {
 	
-	AnimateAct::AnimateAct(float dt)
+	AnimateAct::AnimateAct(float dt, bool assignDt)
 	{
 		m_dt = dt;
+		m_assignDt = assignDt;
 	}
 
 	AnimateAct::~AnimateAct()
@@ -28,9 +29,21 @@ namespace PhysIKA
 		}
 		if (node->isActive())
 		{
+			//The modules read the step from their node, it is set for the advance only
+			Real dt = node->getDt();
+			if (m_assignDt)
+			{
+				node->setDt(m_dt);
+			}
+
 			node->advance(node->getDt());
 			node->updateTopology();
 
+			if (m_assignDt)
+			{
+				node->setDt(dt);
+			}
+
 			/*if (node->getAnimationController() != nullptr)
 			{
 				node->getAnimationController()->execute();
@@ -6,13 +6,17 @@ namespace PhysIKA
 	class AnimateAct : public Action
 	{
 	public:
-		AnimateAct(float dt);
+		/**
+		 * @brief With assignDt, every node is advanced by dt, its own time step is restored afterwards
+		 */
+		AnimateAct(float dt, bool assignDt = false);
 		virtual ~AnimateAct();
 
 	private:
 		void process(Node* node) override;
 
 		float m_dt;
+		bool m_assignDt;
 	};
 }
 
@@ -1,5 +1,8 @@
 #include "ActQueryTimeStep.h"
 
+#include <algorithm>
+#include <cfloat>
+
 namespace PhysIKA
 {
 	
@@ -22,12 +25,21 @@ namespace PhysIKA
 
 	void QueryTimeStep::reset()
 	{
-		m_timestep = 0.033f;
+		m_timestep = m_stable ? FLT_MAX : 0.033f;
 	}
 
 	void QueryTimeStep::process(Node* node)
 	{
-		m_timestep = min(node->getDt(), m_timestep);
+		if (m_stable)
+		{
+			if (node->isActive())
+			{
+				m_timestep = std::min(node->getStableDt(), m_timestep);
+			}
+			return;
+		}
+
+		m_timestep = std::min(node->getDt(), m_timestep);
 	}
 
 }
\ No newline at end of file
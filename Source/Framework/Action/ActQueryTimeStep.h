@@ -12,9 +12,15 @@ namespace PhysIKA
 		float getTimeStep();
 		void reset();
 
+		/**
+		 * @brief Query Node::getStableDt() of the active nodes instead of Node::getDt(), the result is then not limited to 0.033
+		 */
+		void setStableTimeStep(bool stable) { m_stable = stable; }
+
 	private:
 		void process(Node* node) override;
 
 		float m_timestep;
+		bool m_stable = false;
 	};
 }
\ No newline at end of file
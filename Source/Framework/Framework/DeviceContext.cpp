@@ -27,6 +27,8 @@ DeviceContext::~DeviceContext()
 
 void DeviceContext::enable()
 {
+	if (isCPU()) return;
+
 	cudaSetDevice(m_deviceID);
 }
 
@@ -44,4 +46,14 @@ int DeviceContext::getDevice()
 	return m_deviceID;
 }
 
+void DeviceContext::setDeviceType(DeviceType type)
+{
+	m_deviceType = type;
+}
+
+DeviceType DeviceContext::getDeviceType()
+{
+	return m_deviceType;
+}
+
 }
\ No newline at end of file
@@ -23,6 +23,15 @@ public:
 	bool setDevice(int i);
 	int getDevice();
 
+	/**
+	 * @brief Run the modules of the owning node with CUDA (GPU) or with the host kernels on ThreadPool (CPU).
+	 * Must be selected before the context is passed to Node::setContext(), which moves the fields of the node to the host.
+	 */
+	void setDeviceType(DeviceType type);
+	DeviceType getDeviceType();
+
+	bool isCPU() { return m_deviceType == DeviceType::CPU; }
+
 /*	template<typename T>
 	std::shared_ptr< DeviceVariable<T> > allocDeviceVariable(std::string name, std::string description)
 	{
@@ -50,6 +50,11 @@ public:
 
 	virtual bool isEmpty() = 0;
 
+	/**
+	 * @brief Keep the data in host memory, called on all fields of a node running on a CPU context. Fields without device data ignore it.
+	 */
+	virtual void setHostStorage(bool host) {}
+
 	void setAutoDestroy(bool autoDestroy);
 	void setDerived(bool derived);
 
@@ -23,11 +23,28 @@ public:
 	~ArrayField() override;
 
 	inline size_t getElementCount() override {
+		if (isHostStorage())
+		{
+			auto hostRef = this->getHostReference();
+			return hostRef == nullptr ? 0 : hostRef->size();
+		}
+
 		auto ref = this->getReference();
 		return ref == nullptr ? 0 : ref->size();
 	}
 
 	void setElementCount(size_t num);
+
+	/**
+	 * @brief Capacity management of the source array, setElementCount() reuses the reserved memory without reallocation.
+	 */
+	void reserve(size_t num);
+	void shrinkToFit();
+
+	/**
+	 * @brief Append the elements of arr to the source array in amortized O(arr.size()), existing elements are kept.
+	 */
+	void append(Array<T, deviceType>& arr);
 //	void resize(int num);
 	const std::string getTemplateName() override { return std::string(typeid(T).name()); }
 	const std::string getClassName() override { return std::string("ArrayBuffer"); }
@@ -44,9 +61,25 @@ public:
 	Array<T, deviceType>& getValue() { return *(getReference()); }
 	void setValue(std::vector<T>& vals);
 
+	/**
+	 * @brief Keep the data of the source field in host memory, used by the nodes running on a CPU context.
+	 * Existing elements are copied over. Fields of host arrays already live on the host and ignore it.
+	 */
+	void setHostStorage(bool host) override;
+	bool isHostStorage();
+
+	/**
+	 * @brief Host counterparts of getReference() and getValue(), only valid if isHostStorage() is true.
+	 */
+	std::shared_ptr<Array<T, DeviceType::CPU>> getHostReference();
+	Array<T, DeviceType::CPU>& getHostValue() { return *(getHostReference()); }
+
 //	void reset() override { m_data->reset(); }
 
 	inline bool isEmpty() override {
+		if (isHostStorage())
+			return getHostReference() == nullptr;
+
 		return getReference() == nullptr;
 	}
 
@@ -55,7 +88,18 @@ public:
 	ArrayField<T, deviceType>* getSourceArrayField();
 
 private:
+	template<typename TArray>
+	static void resizeArray(std::shared_ptr<TArray>& data, size_t num)
+	{
+		if (data != nullptr)
+			data->resize(num);
+		else
+			data = num <= 0 ? nullptr : std::make_shared<TArray>(num);
+	}
+
 	std::shared_ptr<Array<T, deviceType>> m_data = nullptr;
+	std::shared_ptr<Array<T, DeviceType::CPU>> m_hostData = nullptr;
+	bool m_hostStorage = false;
 };
 
 template<typename T, DeviceType deviceType>
@@ -104,6 +148,11 @@ ArrayField<T, deviceType>::~ArrayField()
 	{
 		m_data->release();
 	}
+
+	if (m_hostData.use_count() == 1)
+	{
+		m_hostData->release();
+	}
 }
 
 template<typename T, DeviceType deviceType>
@@ -112,21 +161,78 @@ void ArrayField<T, deviceType>::setElementCount(size_t num)
 	auto arr = this->getSourceArrayField();
 	if (arr == nullptr)
 	{
-		if (m_data != nullptr)
-			m_data->resize(num);
+		if (m_hostStorage)
+			resizeArray(m_hostData, num);
 		else
-			m_data = num <= 0 ? nullptr : std::make_shared<Array<T, deviceType>>(num);
+			resizeArray(m_data, num);
 	}
 	else
 	{
 		//if (arr->m_data != nullptr && arr->m_data->size() == num)
 		//	return;
-		if(arr->m_data != nullptr)
-			arr->m_data->resize(num);
+		if (arr->m_hostStorage)
+			resizeArray(arr->m_hostData, num);
 		else
-			arr->m_data = num <= 0 ? nullptr : std::make_shared<Array<T, deviceType>>(num);
-		
+			resizeArray(arr->m_data, num);
+	}
+}
+
+template<typename T, DeviceType deviceType>
+void ArrayField<T, deviceType>::reserve(size_t num)
+{
+	auto arr = this->getSourceArrayField();
+	if (arr == nullptr) arr = this;
+
+	if (arr->m_hostStorage)
+	{
+		if (arr->m_hostData == nullptr)
+			arr->m_hostData = std::make_shared<Array<T, DeviceType::CPU>>();
+
+		arr->m_hostData->reserve(num);
+		return;
+	}
+
+	if (arr->m_data == nullptr)
+		arr->m_data = std::make_shared<Array<T, deviceType>>();
+
+	arr->m_data->reserve(num);
+}
+
+template<typename T, DeviceType deviceType>
+void ArrayField<T, deviceType>::shrinkToFit()
+{
+	auto arr = this->getSourceArrayField();
+	if (arr == nullptr) arr = this;
+
+	if (arr->m_data != nullptr)
+		arr->m_data->shrinkToFit();
+
+	if (arr->m_hostData != nullptr)
+		arr->m_hostData->shrinkToFit();
+}
+
+template<typename T, DeviceType deviceType>
+void ArrayField<T, deviceType>::append(Array<T, deviceType>& data)
+{
+	auto arr = this->getSourceArrayField();
+	if (arr == nullptr) arr = this;
+
+	if (arr->m_hostStorage)
+	{
+		if (arr->m_hostData == nullptr)
+			arr->m_hostData = std::make_shared<Array<T, DeviceType::CPU>>();
+
+		Array<T, DeviceType::CPU> hostData(data.size());
+		Function1Pt::copy(hostData, data);
+		arr->m_hostData->append(hostData);
+		hostData.release();
+		return;
 	}
+
+	if (arr->m_data == nullptr)
+		arr->m_data = std::make_shared<Array<T, deviceType>>();
+
+	arr->m_data->append(data);
 }
 
 template<typename T, DeviceType deviceType>
@@ -141,6 +247,16 @@ bool ArrayField<T, deviceType>::connect(ArrayField<T, deviceType>* field2)
 template<typename T, DeviceType deviceType>
 void ArrayField<T, deviceType>::setValue(std::vector<T>& vals)
 {
+	if (isHostStorage())
+	{
+		if (getHostReference() == nullptr || getHostReference()->size() != vals.size())
+			setElementCount(vals.size());
+
+		if (vals.size() > 0)
+			Function1Pt::copy(getHostValue(), vals);
+		return;
+	}
+
 	std::shared_ptr<Array<T, deviceType>> data = getReference();
 	if (data == nullptr)
 	{
@@ -184,6 +300,53 @@ std::shared_ptr<Array<T, deviceType>> ArrayField<T, deviceType>::getReference()
 	}
 }
 
+template<typename T, DeviceType deviceType>
+void ArrayField<T, deviceType>::setHostStorage(bool host)
+{
+	auto arr = this->getSourceArrayField();
+	if (deviceType == DeviceType::CPU || arr == nullptr || arr->m_hostStorage == host)
+		return;
+
+	if (host)
+	{
+		if (arr->m_data != nullptr)
+		{
+			arr->m_hostData = std::make_shared<Array<T, DeviceType::CPU>>(arr->m_data->size());
+			Function1Pt::copy(*arr->m_hostData, *arr->m_data);
+			if (arr->m_data.use_count() == 1)
+				arr->m_data->release();
+			arr->m_data = nullptr;
+		}
+	}
+	else
+	{
+		if (arr->m_hostData != nullptr)
+		{
+			arr->m_data = std::make_shared<Array<T, deviceType>>(arr->m_hostData->size());
+			Function1Pt::copy(*arr->m_data, *arr->m_hostData);
+			if (arr->m_hostData.use_count() == 1)
+				arr->m_hostData->release();
+			arr->m_hostData = nullptr;
+		}
+	}
+
+	arr->m_hostStorage = host;
+}
+
+template<typename T, DeviceType deviceType>
+bool ArrayField<T, deviceType>::isHostStorage()
+{
+	auto arr = this->getSourceArrayField();
+	return arr != nullptr && arr->m_hostStorage;
+}
+
+template<typename T, DeviceType deviceType>
+std::shared_ptr<Array<T, DeviceType::CPU>> ArrayField<T, deviceType>::getHostReference()
+{
+	auto arr = this->getSourceArrayField();
+	return arr == nullptr ? nullptr : arr->m_hostData;
+}
+
 template<typename T, DeviceType deviceType>
 ArrayField<T, deviceType>* ArrayField<T, deviceType>::getSourceArrayField()
 {
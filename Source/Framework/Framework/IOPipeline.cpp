@@ -0,0 +1,157 @@
+#include "IOPipeline.h"
+#include <chrono>
+
+namespace PhysIKA {
+
+	IOPipeline& IOPipeline::getInstance()
+	{
+		static IOPipeline instance;
+		return instance;
+	}
+
+	IOPipeline::IOPipeline()
+	{
+	}
+
+	IOPipeline::~IOPipeline()
+	{
+		stop();
+	}
+
+	void IOPipeline::setThreadNumber(int num)
+	{
+		stop();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_threadNum = num > 0 ? num : 1;
+	}
+
+	void IOPipeline::setCapacity(size_t capacity)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_capacity = capacity > 0 ? capacity : 1;
+		}
+		m_slotCond.notify_all();
+	}
+
+	bool IOPipeline::submit(std::function<bool()> task)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (m_workers.empty())
+		{
+			start();
+		}
+
+		m_submitted++;
+
+		bool dropped = false;
+		if (m_queue.size() >= m_capacity)
+		{
+			if (m_policy == Block)
+			{
+				auto t0 = std::chrono::steady_clock::now();
+				m_slotCond.wait(lock, [this] { return m_queue.size() < m_capacity; });
+				m_blockedTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+			}
+			else if (m_policy == DropNewest)
+			{
+				m_dropped++;
+				return false;
+			}
+			else
+			{
+				m_queue.pop_front();
+				m_dropped++;
+				dropped = true;
+			}
+		}
+
+		m_queue.push_back(std::move(task));
+		if (m_queue.size() > m_peakDepth)
+			m_peakDepth = m_queue.size();
+
+		lock.unlock();
+		m_taskCond.notify_one();
+
+		return !dropped;
+	}
+
+	void IOPipeline::flush()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_slotCond.wait(lock, [this] { return m_queue.empty() && m_running == 0; });
+	}
+
+	size_t IOPipeline::getQueueDepth()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_queue.size();
+	}
+
+	void IOPipeline::resetMetrics()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_peakDepth = m_queue.size();
+		m_submitted = 0;
+		m_completed = 0;
+		m_dropped = 0;
+		m_failed = 0;
+		m_blockedTime = 0.0;
+	}
+
+	void IOPipeline::start()
+	{
+		m_quit = false;
+		for (int i = 0; i < m_threadNum; i++)
+		{
+			m_workers.emplace_back(&IOPipeline::run, this);
+		}
+	}
+
+	void IOPipeline::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_taskCond.notify_all();
+
+		for (auto& worker : m_workers)
+		{
+			worker.join();
+		}
+		m_workers.clear();
+	}
+
+	void IOPipeline::run()
+	{
+		while (true)
+		{
+			std::function<bool()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_taskCond.wait(lock, [this] { return !m_queue.empty() || m_quit; });
+
+				//Queued tasks are still finished when the pipeline is stopped
+				if (m_queue.empty())
+					return;
+
+				task = std::move(m_queue.front());
+				m_queue.pop_front();
+				m_running++;
+			}
+			m_slotCond.notify_all();
+
+			bool success = task();
+			task = nullptr;
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_running--;
+				m_completed++;
+				if (!success) m_failed++;
+			}
+			m_slotCond.notify_all();
+		}
+	}
+}
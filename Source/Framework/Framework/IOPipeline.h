@@ -0,0 +1,140 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace PhysIKA {
+
+	/*!
+	*	\class	IOPipeline
+	*	\brief	Writer threads fed through a bounded task queue.
+	*
+	*	Tasks must only touch data they own, usually a host snapshot taken on the simulation thread. If the queue is full,
+	*	submit() either blocks until a writer frees a slot (backpressure) or drops a task, depending on the overflow policy.
+	*/
+	class IOPipeline
+	{
+	public:
+		enum OverflowPolicy
+		{
+			Block,			//!< Wait for a free slot
+			DropNewest,		//!< Discard the submitted task
+			DropOldest		//!< Discard the oldest queued task
+		};
+
+		static IOPipeline& getInstance();
+
+		/**
+		 * @brief Number of writer threads, waits for the queued tasks before restarting the writers
+		 */
+		void setThreadNumber(int num);
+		int getThreadNumber() { return m_threadNum; }
+
+		void setCapacity(size_t capacity);
+		size_t getCapacity() { return m_capacity; }
+
+		void setOverflowPolicy(OverflowPolicy policy) { m_policy = policy; }
+		OverflowPolicy getOverflowPolicy() { return m_policy; }
+
+		/**
+		 * @brief Queue a task, returns false if a task was dropped because the queue is full
+		 */
+		bool submit(std::function<bool()> task);
+
+		/**
+		 * @brief Wait until all queued tasks are finished
+		 */
+		void flush();
+
+		size_t getQueueDepth();
+		size_t getPeakQueueDepth() { return m_peakDepth; }
+		size_t getSubmittedNumber() { return m_submitted; }
+		size_t getCompletedNumber() { return m_completed; }
+		size_t getDroppedNumber() { return m_dropped; }
+		size_t getFailedNumber() { return m_failed; }
+
+		/**
+		 * @brief Milliseconds submit() spent waiting for a free slot
+		 */
+		double getBlockedTime() { return m_blockedTime; }
+
+		void resetMetrics();
+
+	private:
+		IOPipeline();
+		~IOPipeline();
+
+		IOPipeline(const IOPipeline&) = delete;
+		IOPipeline& operator=(const IOPipeline&) = delete;
+
+		void start();
+		void stop();
+		void run();
+
+		int m_threadNum = 2;
+		size_t m_capacity = 8;
+		OverflowPolicy m_policy = Block;
+
+		std::deque<std::function<bool()>> m_queue;
+		std::vector<std::thread> m_workers;
+		size_t m_running = 0;
+		bool m_quit = false;
+
+		size_t m_peakDepth = 0;
+		size_t m_submitted = 0;
+		size_t m_completed = 0;
+		size_t m_dropped = 0;
+		size_t m_failed = 0;
+		double m_blockedTime = 0.0;
+
+		std::mutex m_mutex;
+		std::condition_variable m_taskCond;
+		std::condition_variable m_slotCond;
+	};
+
+	/*!
+	*	\class	IOBufferPool
+	*	\brief	Recycles host staging buffers, a buffer returns to the pool once the last reference to it is released.
+	*/
+	template<typename T>
+	class IOBufferPool
+	{
+	public:
+		IOBufferPool() : m_free(std::make_shared<FreeList>()) {}
+
+		std::shared_ptr<T> acquire()
+		{
+			T* buffer = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(m_free->mutex);
+				if (!m_free->buffers.empty())
+				{
+					buffer = m_free->buffers.back().release();
+					m_free->buffers.pop_back();
+				}
+			}
+			if (buffer == nullptr)
+				buffer = new T();
+
+			//The free list is shared with the deleter, so buffers may still be released after the pool is gone
+			std::shared_ptr<FreeList> freeList = m_free;
+			return std::shared_ptr<T>(buffer, [freeList](T* ptr) {
+				std::lock_guard<std::mutex> lock(freeList->mutex);
+				freeList->buffers.emplace_back(ptr);
+			});
+		}
+
+	private:
+		struct FreeList
+		{
+			std::mutex mutex;
+			std::vector<std::unique_ptr<T>> buffers;
+		};
+
+		std::shared_ptr<FreeList> m_free;
+	};
+}
@@ -1,5 +1,6 @@
 #include "Module.h"
 #include "Framework/Framework/Node.h"
+#include "Framework/Framework/Profiler.h"
 
 namespace PhysIKA
 {
@@ -12,6 +13,7 @@ Module::Module(std::string name)
 
 //	m_module_name.setValue(name);
 	m_module_name = name;
+	m_profile_name.clear();
 }
 
 Module::~Module(void)
@@ -41,7 +43,10 @@ void Module::update()
 	if (m_update_required)
 	{
 		//do execution if any field is modified
-		this->execute();
+		{
+			ProfileScope scope(this->getProfileName(), "::execute");
+			this->execute();
+		}
 
 		//reset input fields
 		for each (auto f_in in fields_input)
@@ -92,6 +97,22 @@ std::string Module::getName()
 	return m_module_name;
 }
 
+const std::string& Module::getProfileName()
+{
+	//Cached since getModuleType() builds a new string on every call
+	if (m_profile_name.empty())
+	{
+		bool unnamed = m_module_name.empty() || m_module_name == "default";
+		m_profile_name = unnamed ? this->getModuleType() : m_module_name;
+	}
+	return m_profile_name;
+}
+
+bool Module::isHostContext()
+{
+	return m_node != nullptr && m_node->getContext()->isCPU();
+}
+
 bool Module::isInitialized()
 {
 	return m_initialized;
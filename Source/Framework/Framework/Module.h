@@ -45,6 +45,11 @@ public:
 
 	std::string getName();
 
+	/**
+	 * @brief Name used to label the module in profiling reports, falls back to the module type for unnamed modules
+	 */
+	const std::string& getProfileName();
+
 	Node* getParent()
 	{
 		if (m_node == NULL)
@@ -56,6 +61,12 @@ public:
 
 	bool isInitialized();
 
+	/**
+	 * @brief Whether the parent node runs on a CPU context, modules with a host path then work on the host data of their fields.
+	 * Modules without a parent run on the GPU.
+	 */
+	bool isHostContext();
+
 	virtual std::string getModuleType() { return "Module"; }
 
 	bool findInputField(Field* field);
@@ -95,6 +106,7 @@ protected:
 private:
 	Node* m_node;
 	std::string m_module_name;
+	std::string m_profile_name;
 	bool m_initialized;
 
 	bool m_update_required = true;
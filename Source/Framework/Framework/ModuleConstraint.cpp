@@ -1,5 +1,6 @@
 #include "ModuleConstraint.h"
 #include "Framework/Framework/Node.h"
+#include "Framework/Framework/Profiler.h"
 
 namespace PhysIKA
 {
@@ -14,4 +15,10 @@ ConstraintModule::~ConstraintModule()
 {
 }
 
+bool ConstraintModule::applyConstraint()
+{
+	ProfileScope scope(this->getProfileName(), "::constrain");
+	return this->constrain();
+}
+
 }
\ No newline at end of file
@@ -21,6 +21,11 @@ public:
 
 	virtual bool constrain() { return true; }
 
+	/**
+	 * @brief Call constrain() within a profiling scope, numerical models should use this entry
+	 */
+	bool applyConstraint();
+
 	std::string getModuleType() override { return "ConstraintModule"; }
 protected:
 	FieldID m_posID;
@@ -1,5 +1,6 @@
 #include "Framework/Framework/ModuleIO.h"
 #include "Framework/Framework/Node.h"
+#include "Framework/Framework/IOPipeline.h"
 
 namespace PhysIKA
 {
@@ -14,4 +15,14 @@ IOModule::~IOModule()
 {
 }
 
+bool IOModule::dispatch(std::function<bool()> task)
+{
+	if (m_async)
+	{
+		return IOPipeline::getInstance().submit(std::move(task));
+	}
+
+	return task();
+}
+
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "Module.h"
+#include <functional>
 
 namespace PhysIKA
 {
@@ -15,9 +16,22 @@ public:
 	void enable(bool bEnable) { m_enabled = bEnable; }
 	bool isEnabled() { return m_enabled; }
 
+	/**
+	 * @brief Run the write tasks of this module on the IOPipeline instead of inside the animation traversal
+	 */
+	void setAsynchronous(bool async) { m_async = async; }
+	bool isAsynchronous() { return m_async; }
+
 	std::string getModuleType() override { return "IOModule"; }
 protected:
+	/**
+	 * @brief Run a write task either on the IOPipeline or immediately.
+	 * The task must only access data it owns, e.g. a host snapshot of the fields taken in execute().
+	 */
+	bool dispatch(std::function<bool()> task);
+
 	bool m_enabled;
+	bool m_async = false;
 };
 
 }
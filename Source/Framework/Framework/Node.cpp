@@ -2,6 +2,9 @@
 #include "NodeIterator.h"
 
 #include "Framework/Action/Action.h"
+#include "Framework/Framework/Profiler.h"
+
+#include <cfloat>
 
 
 namespace PhysIKA
@@ -103,6 +106,11 @@ void Node::setDt(Real dt)
 	m_dt = dt;
 }
 
+float Node::getStableDt()
+{
+	return FLT_MAX;
+}
+
 void Node::setMass(Real mass)
 {
 	m_mass = mass;
@@ -157,6 +165,8 @@ void Node::removeAllChildren()
 
 void Node::advance(Real dt)
 {
+	ProfileScope nodeScope(m_node_name);
+
 	auto nModel = this->getNumericalModel();
 	if (nModel == NULL)
 	{
@@ -164,6 +174,7 @@ void Node::advance(Real dt)
 	}
 	else
 	{
+		ProfileScope scope(nModel->getProfileName(), "::step");
 		nModel->step(this->getDt());
 	}
 }
@@ -188,6 +199,11 @@ void Node::setContext(std::shared_ptr<DeviceContext> context)
 
 	m_context = context; 
 	addModule(m_context);
+
+	for (auto module : m_module_list)
+	{
+		applyContext(module);
+	}
 }
 
 std::shared_ptr<MechanicalState> Node::getMechanicalState()
@@ -529,12 +545,25 @@ bool Node::addToModuleList(std::shared_ptr<Module> module)
 	{
 		m_module_list.push_back(module);
 		module->setParent(this);
+		if (m_context != nullptr && m_context->isCPU())
+		{
+			applyContext(module);
+		}
 		return true;
 	}
 
 	return false;
 }
 
+void Node::applyContext(std::shared_ptr<Module> module)
+{
+	bool host = m_context->isCPU();
+	for (auto field : module->getAllFields())
+	{
+		field->setHostStorage(host);
+	}
+}
+
 bool Node::deleteFromModuleList(std::shared_ptr<Module> module)
 {
 	auto found = std::find(m_module_list.begin(), m_module_list.end(), module);
@@ -73,6 +73,10 @@ public:
 
 	void setDt(Real dt);
 
+	/// Largest timestep the current state can be advanced with, used by adaptive time stepping (see SceneGraph::setAdaptiveTimeStep).
+	/// Nodes without a stability limit return FLT_MAX and follow the other nodes.
+	virtual Real getStableDt();
+
 	void setMass(Real mass);
 	Real getMass();
 
@@ -353,6 +357,11 @@ private:
 	bool addToModuleList(std::shared_ptr<Module> module);
 	bool deleteFromModuleList(std::shared_ptr<Module> module);
 
+	/**
+	 * @brief Move the fields of the module to the memory of the current context, the host for a CPU context
+	 */
+	void applyContext(std::shared_ptr<Module> module);
+
 #define NODE_ADD_SPECIAL_MODULE_LIST( CLASSNAME, SEQUENCENAME ) \
 	virtual void addTo##CLASSNAME##List( std::shared_ptr<CLASSNAME> module) { SEQUENCENAME.push_back(module); } \
 	virtual void deleteFrom##CLASSNAME##List( std::shared_ptr<CLASSNAME> module) { SEQUENCENAME.remove(module); } \
@@ -0,0 +1,288 @@
+#include "NodeScheduler.h"
+#include "Framework/Framework/Node.h"
+#include "Framework/Framework/Module.h"
+#include "Framework/Framework/Field.h"
+#include "Framework/Action/Action.h"
+#include "Core/Utility/ThreadPool.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace PhysIKA
+{
+	void NodeScheduler::build(Node* root)
+	{
+		m_root = root;
+		m_signature = signature(root);
+
+		m_nodes.clear();
+		m_parents.clear();
+		m_subtreeEnds.clear();
+		m_childNum.clear();
+		m_owners.clear();
+		m_visits.clear();
+		m_successors.clear();
+		m_predecessorNum.clear();
+
+		if (root == nullptr)
+		{
+			return;
+		}
+
+		collect(root, -1);
+
+		int num = (int)m_nodes.size();
+		m_successors.resize(num);
+		m_predecessorNum.assign(num, 0);
+
+		for (int i = 0; i < num; i++)
+		{
+			Node* node = m_nodes[i];
+
+			//A node visited twice by the serial traversal is processed twice, in the same order
+			const std::vector<int>& visits = m_visits[node];
+			for (int k = 1; k < visits.size(); k++)
+			{
+				if (visits[k] == i)
+				{
+					addDependency(visits[k - 1], i);
+				}
+			}
+
+			ListPtr<Node>& children = node->getChildren();
+			for (auto iter = children.begin(); iter != children.end(); iter++)
+			{
+				for (int j : m_visits[iter->get()])
+				{
+					if (j > i)
+					{
+						addDependency(i, j);
+					}
+				}
+			}
+
+			std::vector<NodePort*>& ports = node->getAllNodePorts();
+			for (int p = 0; p < ports.size(); p++)
+			{
+				std::vector<std::shared_ptr<Node>>& portNodes = ports[p]->getNodes();
+				for (int k = 0; k < portNodes.size(); k++)
+				{
+					auto found = m_visits.find(portNodes[k].get());
+					if (found == m_visits.end())
+					{
+						continue;
+					}
+					for (int j : found->second)
+					{
+						addDependency(std::min(i, j), std::max(i, j));
+					}
+				}
+			}
+		}
+
+		//Field connections, the owner of a field is a node or one of its modules
+		for (auto owner = m_owners.begin(); owner != m_owners.end(); owner++)
+		{
+			std::vector<Field*>& fields = owner->first->getAllFields();
+			for (int f = 0; f < fields.size(); f++)
+			{
+				std::vector<Field*>& sinks = fields[f]->getSinkFields();
+				for (int s = 0; s < sinks.size(); s++)
+				{
+					auto sinkOwner = m_owners.find(sinks[s]->getParent());
+					if (sinkOwner == m_owners.end() || sinkOwner->second == owner->second)
+					{
+						continue;
+					}
+
+					for (int i : m_visits[owner->second])
+					{
+						for (int j : m_visits[sinkOwner->second])
+						{
+							addDependency(std::min(i, j), std::max(i, j));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	bool NodeScheduler::update(Node* root)
+	{
+		if (root == m_root && signature(root) == m_signature)
+		{
+			return false;
+		}
+
+		build(root);
+		return true;
+	}
+
+	std::size_t NodeScheduler::signature(Node* root)
+	{
+		//Everything build() looks at: children, modules, node ports and field sinks
+		std::size_t seed = 0;
+		auto combine = [&](const void* p) {
+			seed ^= std::hash<const void*>()(p) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		};
+		auto combineFields = [&](Base* owner) {
+			std::vector<Field*>& fields = owner->getAllFields();
+			for (int f = 0; f < fields.size(); f++)
+			{
+				std::vector<Field*>& sinks = fields[f]->getSinkFields();
+				for (int s = 0; s < sinks.size(); s++)
+				{
+					combine(sinks[s]);
+				}
+			}
+		};
+
+		if (root == nullptr)
+		{
+			return seed;
+		}
+
+		std::vector<Node*> stack(1, root);
+		while (!stack.empty())
+		{
+			Node* node = stack.back();
+			stack.pop_back();
+
+			combine(node);
+			combineFields(node);
+
+			std::list<std::shared_ptr<Module>>& modules = node->getModuleList();
+			for (auto iter = modules.begin(); iter != modules.end(); iter++)
+			{
+				combine(iter->get());
+				combineFields(iter->get());
+			}
+
+			std::vector<NodePort*>& ports = node->getAllNodePorts();
+			for (int p = 0; p < ports.size(); p++)
+			{
+				std::vector<std::shared_ptr<Node>>& portNodes = ports[p]->getNodes();
+				for (int k = 0; k < portNodes.size(); k++)
+				{
+					combine(portNodes[k].get());
+				}
+			}
+
+			//Closes the list of the node, so moving a child to another parent changes the signature
+			ListPtr<Node>& children = node->getChildren();
+			for (auto iter = children.begin(); iter != children.end(); iter++)
+			{
+				stack.push_back(iter->get());
+			}
+			combine(nullptr);
+		}
+
+		return seed;
+	}
+
+	void NodeScheduler::collect(Node* node, int parent)
+	{
+		int index = (int)m_nodes.size();
+		m_visits[node].push_back(index);
+		m_nodes.push_back(node);
+		m_parents.push_back(parent);
+		m_subtreeEnds.push_back(index + 1);
+		m_childNum.push_back(0);
+		if (parent >= 0)
+		{
+			m_childNum[parent]++;
+		}
+
+		m_owners[node] = node;
+		std::list<std::shared_ptr<Module>>& modules = node->getModuleList();
+		for (auto iter = modules.begin(); iter != modules.end(); iter++)
+		{
+			m_owners[iter->get()] = node;
+		}
+
+		ListPtr<Node>& children = node->getChildren();
+		for (auto iter = children.begin(); iter != children.end(); iter++)
+		{
+			collect(iter->get(), index);
+		}
+		m_subtreeEnds[index] = (int)m_nodes.size();
+	}
+
+	void NodeScheduler::addDependency(int first, int second)
+	{
+		std::vector<int>& successors = m_successors[first];
+		if (first != second && std::find(successors.begin(), successors.end(), second) == successors.end())
+		{
+			successors.push_back(second);
+			m_predecessorNum[second]++;
+		}
+	}
+
+	void NodeScheduler::release(int node, int begin, int end)
+	{
+		std::vector<int>& successors = m_successors[node];
+		for (int s = 0; s < successors.size(); s++)
+		{
+			int next = successors[s];
+			if (next >= begin && next < end && --m_waiting[next] == 0)
+			{
+				m_next.push_back(next);
+			}
+		}
+	}
+
+	void NodeScheduler::traverse(Action* act)
+	{
+		int num = (int)m_nodes.size();
+		m_waiting = m_predecessorNum;
+		m_unfinished = m_childNum;
+		m_ready.clear();
+		for (int i = 0; i < num; i++)
+		{
+			if (m_waiting[i] == 0)
+			{
+				m_ready.push_back(i);
+			}
+		}
+
+		m_roundNum = 0;
+		while (!m_ready.empty())
+		{
+			ThreadPool::getInstance().parallelFor((int)m_ready.size(), [&](int k) {
+				int i = m_ready[k];
+				act->start(m_nodes[i]);
+				act->process(m_nodes[i]);
+				if (m_childNum[i] == 0)
+				{
+					act->end(m_nodes[i]);
+				}
+			}, 1);
+
+			//Successors are released in a fixed order, so the rounds are the same for every run.
+			//Nodes inside the subtree wait for process(), the others for end() as in the serial traversal.
+			m_next.clear();
+			for (int k = 0; k < m_ready.size(); k++)
+			{
+				int i = m_ready[k];
+				release(i, i + 1, m_subtreeEnds[i]);
+
+				int finished = m_childNum[i] == 0 ? i : -1;
+				while (finished >= 0)
+				{
+					release(finished, m_subtreeEnds[finished], num);
+
+					int parent = m_parents[finished];
+					finished = -1;
+					if (parent >= 0 && --m_unfinished[parent] == 0)
+					{
+						act->end(m_nodes[parent]);
+						finished = parent;
+					}
+				}
+			}
+			std::sort(m_next.begin(), m_next.end());
+			m_ready.swap(m_next);
+			m_roundNum++;
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace PhysIKA
+{
+	class Base;
+	class Node;
+	class Action;
+
+	/*!
+	*	\class	NodeScheduler
+	*	\brief	Runs an action on the nodes of a scene graph, independent nodes concurrently.
+	*
+	*	build() collects the nodes in the order of Node::traverseTopDown() and orders
+	*	- a parent before its children,
+	*	- two nodes whose fields, or fields of their modules, are connected by Field::connectPtr(),
+	*	- a node before the nodes of its node ports,
+	*	in the order of the serial traversal. Nodes without such a relation run concurrently on the ThreadPool,
+	*	interacting nodes (e.g. SolidFluidInteraction and its particle systems) run one after another exactly as in the
+	*	serial traversal, so the results do not depend on the number of threads.
+	*
+	*	The nodes are dispatched in rounds: every round runs all nodes whose predecessors have finished.
+	*	As in the serial traversal, end() of a node is called after the ends of all its children, and a node that
+	*	depends on another node outside of its subtree waits for that end().
+	*	Dependencies that are not expressed by the tree, fields or ports are not seen by the scheduler.
+	*/
+	class NodeScheduler
+	{
+	public:
+		/**
+		 * @brief Rebuild the dependency graph, required after the tree, the modules or the field connections have changed
+		 */
+		void build(Node* root);
+
+		/**
+		 * @brief Rebuild the dependency graph only if the tree, the modules, the node ports or the field connections have changed
+		 * @return true if the graph was rebuilt
+		 */
+		bool update(Node* root);
+
+		/**
+		 * @brief Call start(), process() and end() of act for every node
+		 * @details end() of a leaf is called by the worker right after process(), end() of an inner node is called
+		 * by the calling thread once the ends of its children have been called.
+		 */
+		void traverse(Action* act);
+		template<class Act, class ... Args>
+		void traverse(Args&& ... args) {
+			Act action(std::forward<Args>(args)...);
+			traverse(&action);
+		}
+
+		int getNodeNum() { return (int)m_nodes.size(); }
+
+		/**
+		 * @brief Number of rounds of the last traverse(), the length of the longest dependency chain
+		 */
+		int getRoundNum() { return m_roundNum; }
+
+	private:
+		void collect(Node* node, int parent);
+		void addDependency(int first, int second);
+		void release(int node, int begin, int end);
+		std::size_t signature(Node* root);
+
+		std::vector<Node*> m_nodes;						// serial traversal order
+		std::vector<int> m_parents;						// visit of the parent, -1 for the root
+		std::vector<int> m_subtreeEnds;					// visits of the subtree are [i, m_subtreeEnds[i])
+		std::vector<int> m_childNum;
+		std::vector<std::vector<int>> m_successors;
+		std::vector<int> m_predecessorNum;
+
+		std::unordered_map<Base*, Node*> m_owners;		// nodes and modules to their node
+		std::unordered_map<Node*, std::vector<int>> m_visits;
+
+		Node* m_root = nullptr;
+		std::size_t m_signature = 0;
+
+		std::vector<int> m_waiting;
+		std::vector<int> m_unfinished;					// children whose end() has not been called yet
+		std::vector<int> m_ready;
+		std::vector<int> m_next;
+		int m_roundNum = 0;
+	};
+}
@@ -0,0 +1,216 @@
+#include "Profiler.h"
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace PhysIKA {
+
+	namespace
+	{
+		struct OpenScope
+		{
+			std::string name;
+			std::string path;
+			int depth;
+			double start;
+			double childTime;
+		};
+
+		thread_local std::vector<OpenScope> t_scopes;
+
+		std::string escapeJson(const std::string& str)
+		{
+			std::string ret;
+			for (char c : str)
+			{
+				if (c == '"' || c == '\\') ret.push_back('\\');
+				ret.push_back(c);
+			}
+			return ret;
+		}
+	}
+
+	Profiler::Profiler()
+		: m_epoch(std::chrono::steady_clock::now())
+	{
+	}
+
+	Profiler& Profiler::getInstance()
+	{
+		static Profiler instance;
+		return instance;
+	}
+
+	double Profiler::now()
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_epoch).count();
+	}
+
+	void Profiler::setMaxRecordedFrames(int num)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_maxFrames = num;
+		while ((int)m_frames.size() > m_maxFrames)
+		{
+			m_frames.pop_front();
+		}
+	}
+
+	void Profiler::beginFrame(int frame)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_current = FrameData();
+		m_current.frame = frame;
+	}
+
+	void Profiler::endFrame()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_maxFrames > 0)
+		{
+			m_frames.push_back(std::move(m_current));
+			while ((int)m_frames.size() > m_maxFrames)
+			{
+				m_frames.pop_front();
+			}
+		}
+		m_current = FrameData();
+	}
+
+	void Profiler::beginScope(const std::string& name)
+	{
+		OpenScope scope;
+		scope.name = name;
+		scope.path = t_scopes.empty() ? name : t_scopes.back().path + "/" + name;
+		scope.depth = (int)t_scopes.size();
+		scope.start = now();
+		scope.childTime = 0.0;
+
+		t_scopes.push_back(scope);
+	}
+
+	void Profiler::endScope()
+	{
+		if (t_scopes.empty())
+			return;
+
+		OpenScope scope = t_scopes.back();
+		t_scopes.pop_back();
+
+		double duration = now() - scope.start;
+		if (!t_scopes.empty())
+		{
+			t_scopes.back().childTime += duration;
+		}
+
+		TraceEvent event;
+		event.name = scope.name;
+		event.path = scope.path;
+		event.start = scope.start;
+		event.duration = duration;
+		event.thread = (int)(std::hash<std::thread::id>()(std::this_thread::get_id()) % 1024);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto accumulate = [&](std::map<std::string, ProfileRecord>& records) {
+			ProfileRecord& rec = records[scope.path];
+			rec.path = scope.path;
+			rec.name = scope.name;
+			rec.depth = scope.depth;
+			rec.calls++;
+			rec.inclusive += duration / 1000.0;
+			rec.exclusive += (duration - scope.childTime) / 1000.0;
+		};
+
+		accumulate(m_current.records);
+		accumulate(m_total);
+
+		if (m_maxFrames > 0)
+			m_current.events.push_back(event);
+	}
+
+	std::vector<ProfileRecord> Profiler::getStatistics()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		std::vector<ProfileRecord> ret;
+		for (auto& rec : m_total)
+		{
+			ret.push_back(rec.second);
+		}
+		return ret;
+	}
+
+	std::vector<ProfileRecord> Profiler::getFrameStatistics()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		std::vector<ProfileRecord> ret;
+		if (!m_frames.empty())
+		{
+			for (auto& rec : m_frames.back().records)
+			{
+				ret.push_back(rec.second);
+			}
+		}
+		return ret;
+	}
+
+	void Profiler::reset()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_current = FrameData();
+		m_frames.clear();
+		m_total.clear();
+	}
+
+	bool Profiler::exportChromeTrace(std::string filename)
+	{
+		std::ofstream output(filename.c_str(), std::ios::out);
+		if (!output.is_open())
+			return false;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		output << "{\"traceEvents\":[";
+		bool first = true;
+		for (auto& frame : m_frames)
+		{
+			for (auto& event : frame.events)
+			{
+				output << (first ? "\n" : ",\n");
+				output << "{\"name\":\"" << escapeJson(event.name) << "\",\"cat\":\"frame\",\"ph\":\"X\""
+					<< ",\"ts\":" << event.start << ",\"dur\":" << event.duration
+					<< ",\"pid\":0,\"tid\":" << event.thread
+					<< ",\"args\":{\"frame\":" << frame.frame << ",\"path\":\"" << escapeJson(event.path) << "\"}}";
+				first = false;
+			}
+		}
+		output << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+		output.close();
+		return true;
+	}
+
+	bool Profiler::exportCSV(std::string filename)
+	{
+		std::ofstream output(filename.c_str(), std::ios::out);
+		if (!output.is_open())
+			return false;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		output << "frame,path,calls,inclusive_ms,exclusive_ms\n";
+		for (auto& frame : m_frames)
+		{
+			for (auto& rec : frame.records)
+			{
+				output << frame.frame << ",\"" << rec.second.path << "\"," << rec.second.calls << ","
+					<< rec.second.inclusive << "," << rec.second.exclusive << "\n";
+			}
+		}
+
+		output.close();
+		return true;
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace PhysIKA {
+
+	/*!
+	*	\brief	Accumulated timing of one profiling scope, identified by the path of nested scope names.
+	*/
+	struct ProfileRecord
+	{
+		std::string path;			//!< Names of the enclosing scopes joined by '/'
+		std::string name;
+		int depth = 0;
+		size_t calls = 0;
+		double inclusive = 0.0;		//!< Milliseconds, including nested scopes
+		double exclusive = 0.0;		//!< Milliseconds, excluding nested scopes
+	};
+
+	/*!
+	*	\class	Profiler
+	*	\brief	Hierarchical wall-clock profiler for scene graph traversals, modules and numerical models.
+	*
+	*	Scopes are opened with ProfileScope and nest per thread. Timings are aggregated per frame (between
+	*	beginFrame() and endFrame()) as well as over the whole run. Recorded frames can be exported as
+	*	Chrome trace JSON (chrome://tracing, Perfetto) or CSV.
+	*
+	*	The profiler is disabled by default, a disabled ProfileScope costs a single relaxed load and branch.
+	*/
+	class Profiler
+	{
+	public:
+		static Profiler& getInstance();
+
+		void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+		bool isEnabled() { return m_enabled.load(std::memory_order_relaxed); }
+
+		/*!
+		*	\brief	Number of frames kept for export, older frames are dropped. Accumulated statistics are not affected.
+		*/
+		void setMaxRecordedFrames(int num);
+
+		void beginFrame(int frame);
+		void endFrame();
+
+		void beginScope(const std::string& name);
+		void endScope();
+
+		/*!
+		*	\brief	Statistics accumulated over all frames, sorted by path.
+		*/
+		std::vector<ProfileRecord> getStatistics();
+
+		/*!
+		*	\brief	Statistics of the last finished frame, sorted by path.
+		*/
+		std::vector<ProfileRecord> getFrameStatistics();
+
+		void reset();
+
+		bool exportChromeTrace(std::string filename);
+
+		/*!
+		*	\brief	One row per frame and scope: frame, path, calls, inclusive_ms, exclusive_ms.
+		*/
+		bool exportCSV(std::string filename);
+
+	private:
+		Profiler();
+
+		struct TraceEvent
+		{
+			std::string name;
+			std::string path;
+			double start;		// microseconds since the profiler was created
+			double duration;	// microseconds
+			int thread;
+		};
+
+		struct FrameData
+		{
+			int frame = -1;
+			std::vector<TraceEvent> events;
+			std::map<std::string, ProfileRecord> records;
+		};
+
+		double now();
+
+		// read by every ProfileScope, including those opened on ThreadPool and scheduler threads
+		std::atomic<bool> m_enabled{ false };
+		int m_maxFrames = 1000;
+
+		std::chrono::steady_clock::time_point m_epoch;
+
+		std::mutex m_mutex;
+		FrameData m_current;
+		std::deque<FrameData> m_frames;
+		std::map<std::string, ProfileRecord> m_total;
+	};
+
+	/*!
+	*	\class	ProfileScope
+	*	\brief	Times the enclosing C++ scope under the given name if the profiler is enabled.
+	*
+	*	The name is only built once the profiler is known to be enabled, pass literals as const char*
+	*	and composed names as a prefix and a suffix to keep a disabled scope free of allocations.
+	*/
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(const char* name)
+			: m_active(Profiler::getInstance().isEnabled())
+		{
+			if (m_active) Profiler::getInstance().beginScope(name);
+		}
+
+		explicit ProfileScope(const std::string& name)
+			: m_active(Profiler::getInstance().isEnabled())
+		{
+			if (m_active) Profiler::getInstance().beginScope(name);
+		}
+
+		ProfileScope(const std::string& prefix, const char* suffix)
+			: m_active(Profiler::getInstance().isEnabled())
+		{
+			if (m_active) Profiler::getInstance().beginScope(prefix + suffix);
+		}
+
+		~ProfileScope()
+		{
+			if (m_active) Profiler::getInstance().endScope();
+		}
+
+	private:
+		bool m_active;
+	};
+}
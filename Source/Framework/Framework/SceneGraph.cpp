@@ -6,6 +6,13 @@
 #include "Framework/Action/ActQueryTimestep.h"
 #include "Framework/Action/ActPostProcessing.h"
 #include "Framework/Framework/SceneLoaderFactory.h"
+#include "Framework/Framework/Profiler.h"
+#include "Framework/Framework/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
 
 
 namespace PhysIKA
@@ -26,6 +33,12 @@ void SceneGraph::setAdaptiveInterval(bool adaptive)
 	m_advative_interval = adaptive;
 }
 
+void SceneGraph::setTimeStepLimits(float minDt, float maxDt)
+{
+	m_minDt = minDt;
+	m_maxDt = maxDt;
+}
+
 void SceneGraph::setGravity(Vector3f g)
 {
 	m_gravity = g;
@@ -83,57 +96,173 @@ void SceneGraph::takeOneFrame()
 		return;
 	}
 	m_root->traverseTopDown<AnimateAct>();*/
-	std::cout << "****************Frame " << m_frameNumber << " Started" << std::endl;
-
 	if (m_root == nullptr)
 	{
 		return;
 	}
 
-	
+	auto frameStart = std::chrono::steady_clock::now();
+
+	//The enabled state is sampled once so that begin and end calls stay paired
+	Profiler& profiler = Profiler::getInstance();
+	bool profiling = profiler.isEnabled();
+	if (profiling)
+	{
+		profiler.beginFrame(m_frameNumber);
+		profiler.beginScope("Frame");
+	}
 
 	float t = 0.0f;
 	float dt = 0.0f;
 
-	QueryTimeStep time;
-
-	time.reset();
-	m_root->traverseTopDown(&time);
-	dt = time.getTimeStep();
+	//The dependency graph is rebuilt only after the scene has changed
+	if (m_parallelTraversal)
+	{
+		m_scheduler.update(m_root.get());
+	}
 
-	if (m_advative_interval)
+	if (m_adaptiveTimeStep && m_advative_interval)
 	{
-		m_root->traverseTopDown<AnimateAct>(dt);
+		//The frame lasts one stable substep, as the fixed step does with an adaptive interval
+		m_stableDt = queryStableTimeStep();
+		dt = m_stableDt;
+
+		animate(dt);
+
+		m_dt = dt;
+		m_substepNum = 1;
 		m_elapsedTime += dt;
 	}
-	else
+	else if (m_adaptiveTimeStep)
 	{
 		float interval = 1.0f / m_frameRate;
-		while (t + dt < interval)
+		float minStep = interval;
+		float maxStep = 0.0f;
+
+		m_substepNum = 0;
+		while (interval - t > 1e-5f * interval)
 		{
-			m_root->traverseTopDown<AnimateAct>(dt);
+			//The smoothed stable step is kept apart from the evened out step, a short last step does not slow down the next frame
+			m_stableDt = queryStableTimeStep();
+
+			float remaining = interval - t;
+			dt = remaining / std::ceil(remaining / m_stableDt - 1e-4f);
+
+			animate(dt);
 
 			t += dt;
-			time.reset();
-			m_root->traverseTopDown(&time);
-			dt = time.getTimeStep();
+			m_dt = dt;
+			m_substepNum++;
+			minStep = std::min(minStep, dt);
+			maxStep = std::max(maxStep, dt);
 		}
 
-		m_root->traverseTopDown<AnimateAct>(interval - t);
-
 		m_elapsedTime += interval;
+
+		std::stringstream ss;
+		ss << "Frame " << m_frameNumber << ": " << m_substepNum << " substeps, dt in [" << minStep << ", " << maxStep << "]";
+		Log::sendMessage(Log::Info, ss.str());
+	}
+	else
+	{
+		QueryTimeStep time;
+
+		time.reset();
+		m_root->traverseTopDown(&time);
+		dt = time.getTimeStep();
+
+		if (m_advative_interval)
+		{
+			animate(dt);
+			m_elapsedTime += dt;
+		}
+		else
+		{
+			float interval = 1.0f / m_frameRate;
+			while (t + dt < interval)
+			{
+				animate(dt);
+
+				t += dt;
+				time.reset();
+				m_root->traverseTopDown(&time);
+				dt = time.getTimeStep();
+			}
+
+			animate(interval - t);
+
+			m_elapsedTime += interval;
+		}
+	}
+
+	{
+		ProfileScope scope("PostProcessing");
+		m_root->traverseTopDown<PostProcessing>();
+	}
+
+	if (profiling)
+	{
+		profiler.endScope();
+		profiler.endFrame();
 	}
-	
-	m_root->traverseTopDown<PostProcessing>();
 
-	std::cout << "****************Frame " << m_frameNumber << " Ended" << std::endl << std::endl;
+	m_frameCost = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
 
 	m_frameNumber++;
 }
 
+void SceneGraph::animate(float dt)
+{
+	if (m_parallelTraversal)
+	{
+		m_scheduler.traverse<AnimateAct>(dt, m_adaptiveTimeStep);
+	}
+	else
+	{
+		m_root->traverseTopDown<AnimateAct>(dt, m_adaptiveTimeStep);
+	}
+}
+
+float SceneGraph::queryStableTimeStep()
+{
+	QueryTimeStep time;
+	time.setStableTimeStep(true);
+	time.reset();
+	m_root->traverseTopDown(&time);
+
+	float dt = time.getTimeStep();
+	if (m_stableDt > 0.0f)
+	{
+		dt = std::min(dt, m_dtGrowth * m_stableDt);
+	}
+
+	if (dt < m_minDt)
+	{
+		Log::sendMessage(Log::Warning, "SceneGraph: the stable time step is below the minimum time step!");
+		dt = m_minDt;
+	}
+
+	return std::min(dt, m_maxDt);
+}
+
 void SceneGraph::run()
 {
+	if (m_maxTime <= 0)
+	{
+		Log::sendMessage(Log::Warning, "SceneGraph::run(): total time is not set!");
+		return;
+	}
+
+	if (!this->initialize())
+	{
+		Log::sendMessage(Log::Error, "SceneGraph::run(): scene graph cannot be initialized!");
+		return;
+	}
 
+	while (m_elapsedTime < m_maxTime)
+	{
+		this->takeOneFrame();
+	}
 }
 
 void SceneGraph::reset()
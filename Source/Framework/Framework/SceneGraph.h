@@ -2,6 +2,7 @@
 #include "Base.h"
 #include "Node.h"
 #include "NodeIterator.h"
+#include "NodeScheduler.h"
 
 namespace PhysIKA {
 
@@ -23,6 +24,10 @@ public:
 	virtual void draw();
 	virtual void advance(float dt);
 	virtual void takeOneFrame();
+
+	/**
+	 * @brief Take frames until the total time set by setTotalTime() has elapsed, no rendering is involved
+	 */
 	virtual void run();
 
 	void reset();
@@ -47,13 +52,44 @@ public:
 
 	inline void setFrameRate(float frameRate) { m_frameRate = frameRate; }
 	inline float getFrameRate() { return m_frameRate; }
+	/**
+	 * @brief Wall-clock time of the last takeOneFrame() in milliseconds
+	 */
 	inline float getTimeCostPerFrame() { return m_frameCost; }
+	inline float getElapsedTime() { return m_elapsedTime; }
 	inline float getFrameInterval() { return 1.0f / m_frameRate; }
 	inline int getFrameNumber() { return m_frameNumber; }
 
 	bool isIntervalAdaptive();
 	void setAdaptiveInterval(bool adaptive);
 
+	/**
+	 * @brief Fill every frame with substeps chosen from the stable time steps of the nodes, see Node::getStableDt()
+	 * @details Each substep takes the smallest stable step of the active nodes. It grows by at most the growth
+	 * factor per substep, and it is clamped to [minDt, maxDt]. The steps that remain in a frame are
+	 * evened out, so a frame never ends with a tiny step. With an adaptive interval, see setAdaptiveInterval(),
+	 * a frame is a single substep instead. The substeps are passed to AnimateAct, the time steps of the nodes
+	 * are left unchanged. Disabled by default.
+	 */
+	void setAdaptiveTimeStep(bool adaptive) { m_adaptiveTimeStep = adaptive; }
+	bool isAdaptiveTimeStep() { return m_adaptiveTimeStep; }
+
+	void setTimeStepLimits(float minDt, float maxDt);
+	void setTimeStepGrowth(float factor) { m_dtGrowth = factor; }
+
+	/**
+	 * @brief Last substep and number of substeps of the last frame
+	 */
+	inline float getTimeStep() { return m_dt; }
+	inline int getSubstepNum() { return m_substepNum; }
+
+	/**
+	 * @brief Animate independent subtrees concurrently, see NodeScheduler. Disabled by default, since
+	 * the modules of the nodes must be thread safe, which e.g. Log::sendMessage() is not.
+	 */
+	void setParallelTraversal(bool parallel) { m_parallelTraversal = parallel; }
+	bool isParallelTraversal() { return m_parallelTraversal; }
+
 	void setGravity(Vector3f g);
 	Vector3f getGravity();
 
@@ -86,9 +122,21 @@ private:
 	SceneGraph(const SceneGraph&) {};
 	SceneGraph& operator=(const SceneGraph&) {};
 
+	void animate(float dt);
+	float queryStableTimeStep();
+
 private:
 	bool m_initialized;
 	bool m_advative_interval = true;
+	bool m_parallelTraversal = false;
+	bool m_adaptiveTimeStep = false;
+
+	float m_minDt = 1e-5f;
+	float m_maxDt = 0.01f;
+	float m_dtGrowth = 1.2f;
+	float m_dt = 0.0f;
+	float m_stableDt = 0.0f;
+	int m_substepNum = 0;
 
 	float m_elapsedTime;
 	float m_maxTime;
@@ -104,6 +152,8 @@ private:
 
 private:
 	std::shared_ptr<Node> m_root = nullptr;
+
+	NodeScheduler m_scheduler;
 };
 
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Framework/Framework/Field.h"
 #include "Framework/Framework/Base.h"
 #include "Framework/Topology/NeighborList.h"
+#include "Framework/Topology/HostNeighborList.h"
 
 namespace PhysIKA {
 
@@ -22,6 +23,12 @@ public:
 	~NeighborField() override;
 
 	size_t getElementCount() override {
+		if (isHostStorage())
+		{
+			auto hostRef = this->getHostReference();
+			return hostRef == nullptr ? 0 : hostRef->size();
+		}
+
 		auto ref = this->getReference();
 		return ref == nullptr ? 0 : ref->size();;
 	}
@@ -35,7 +42,23 @@ public:
 
 	NeighborList<T>& getValue() { return *getReference(); }
 
+	/**
+	 * @brief Keep the list of the source field in host memory, used by the nodes running on a CPU context.
+	 * The current list is dropped, it is rebuilt by the module producing it.
+	 */
+	void setHostStorage(bool host) override;
+	bool isHostStorage();
+
+	/**
+	 * @brief Host counterparts of getReference() and getValue(), only valid if isHostStorage() is true.
+	 */
+	std::shared_ptr<HostNeighborList<T>> getHostReference();
+	HostNeighborList<T>& getHostValue() { return *getHostReference(); }
+
 	bool isEmpty() override {
+		if (isHostStorage())
+			return getHostReference() == nullptr;
+
 		return getReference() == nullptr;
 	}
 
@@ -45,6 +68,8 @@ public:
 
 private:
 	std::shared_ptr<NeighborList<T>> m_data = nullptr;
+	std::shared_ptr<HostNeighborList<T>> m_hostData = nullptr;
+	bool m_hostStorage = false;
 };
 
 template<typename T>
@@ -80,6 +105,12 @@ void NeighborField<T>::setElementCount(int num, int nbrSize /*= 0*/)
 	{
 		m_data = num <= 0 ? nullptr : std::make_shared<NeighborList<T>>(num, nbrSize);
 	}
+	else if (arr->m_hostStorage)
+	{
+		if (arr->m_hostData != nullptr)
+			arr->m_hostData->release();
+		arr->m_hostData = num <= 0 ? nullptr : std::make_shared<HostNeighborList<T>>(num, nbrSize);
+	}
 	else
 	{
 		if(arr->m_data != nullptr)
@@ -126,6 +157,11 @@ NeighborField<T>::~NeighborField()
 	{
 		m_data->release();
 	}
+
+	if (m_hostData.use_count() == 1)
+	{
+		m_hostData->release();
+	}
 }
 
 template<typename T>
@@ -172,6 +208,49 @@ std::shared_ptr<NeighborList<T>> NeighborField<T>::getReference()
 	}
 }
 
+template<typename T>
+void NeighborField<T>::setHostStorage(bool host)
+{
+	auto arr = this->getSourceNeighborField();
+	if (arr == nullptr || arr->m_hostStorage == host)
+		return;
+
+	int num = 0, nbrSize = 0;
+	if (arr->m_data != nullptr)
+	{
+		num = arr->m_data->size();
+		nbrSize = arr->m_data->getNeighborLimit();
+		if (arr->m_data.use_count() == 1)
+			arr->m_data->release();
+	}
+	if (arr->m_hostData != nullptr)
+	{
+		num = arr->m_hostData->size();
+		nbrSize = arr->m_hostData->getNeighborLimit();
+		if (arr->m_hostData.use_count() == 1)
+			arr->m_hostData->release();
+	}
+	arr->m_data = nullptr;
+	arr->m_hostData = nullptr;
+
+	arr->m_hostStorage = host;
+	arr->setElementCount(num, nbrSize);
+}
+
+template<typename T>
+bool NeighborField<T>::isHostStorage()
+{
+	auto arr = this->getSourceNeighborField();
+	return arr != nullptr && arr->m_hostStorage;
+}
+
+template<typename T>
+std::shared_ptr<HostNeighborList<T>> NeighborField<T>::getHostReference()
+{
+	auto arr = this->getSourceNeighborField();
+	return arr == nullptr ? nullptr : arr->m_hostData;
+}
+
 template<typename T>
 NeighborField<T>* PhysIKA::NeighborField<T>::getSourceNeighborField()
 {
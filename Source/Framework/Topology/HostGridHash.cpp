@@ -0,0 +1,148 @@
+#include "HostGridHash.h"
+#include "Core/Utility/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace PhysIKA {
+
+	template<typename TDataType>
+	HostGridHash<TDataType>::HostGridHash()
+	{
+	}
+
+	template<typename TDataType>
+	HostGridHash<TDataType>::~HostGridHash()
+	{
+		release();
+	}
+
+	template<typename TDataType>
+	unsigned long long HostGridHash<TDataType>::mortonCode(unsigned int i, unsigned int j, unsigned int k)
+	{
+		auto split = [](unsigned long long x) {
+			x &= 0x1fffff;
+			x = (x | x << 32) & 0x1f00000000ffffull;
+			x = (x | x << 16) & 0x1f0000ff0000ffull;
+			x = (x | x << 8) & 0x100f00f00f00f00full;
+			x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+			x = (x | x << 2) & 0x1249249249249249ull;
+			return x;
+		};
+
+		return split(i) | (split(j) << 1) | (split(k) << 2);
+	}
+
+	template<typename TDataType>
+	void HostGridHash<TDataType>::setSpace(Real _h, Coord _lo, Coord _hi)
+	{
+		//The grid and its Morton ranks only depend on h and the bounds, repeated queries keep them and all buffers
+		if (num > 0 && _h == m_spaceH && _lo == m_spaceLo && _hi == m_spaceHi)
+			return;
+
+		m_spaceH = _h;
+		m_spaceLo = _lo;
+		m_spaceHi = _hi;
+
+		int padding = 2;
+		ds = _h;
+		lo = _lo - padding * ds;
+
+		Coord nSeg = (_hi - _lo) / ds;
+
+		nx = ceil(nSeg[0]) + 1 + 2 * padding;
+		ny = ceil(nSeg[1]) + 1 + 2 * padding;
+		nz = ceil(nSeg[2]) + 1 + 2 * padding;
+		hi = lo + Coord(nx, ny, nz) * ds;
+
+		num = nx * ny * nz;
+
+		//Rank the cells along the Z-curve, this only depends on the grid dimensions
+		std::vector<unsigned long long> codes(num);
+		std::vector<int> order(num);
+		ThreadPool::getInstance().parallelFor(num, [&](int c) {
+			int i = c % nx;
+			int j = (c / nx) % ny;
+			int k = c / (nx * ny);
+			codes[c] = mortonCode(i, j, k);
+			order[c] = c;
+		});
+
+		std::sort(order.begin(), order.end(), [&](int a, int b) { return codes[a] < codes[b]; });
+
+		rank.resize(num);
+		for (int r = 0; r < num; r++)
+		{
+			rank[order[r]] = r;
+		}
+
+		index.resize(num + 1);
+	}
+
+	template<typename TDataType>
+	void HostGridHash<TDataType>::construct(HostArray<Coord>& pos)
+	{
+		clear();
+
+		int pNum = pos.size();
+		if (pNum <= 0)
+		{
+			particle_num = 0;
+			return;
+		}
+
+		if (m_cellOfParticle.size() != pNum)
+		{
+			m_cellOfParticle.resize(pNum);
+			m_slotOfParticle.resize(pNum);
+		}
+
+		//Counting pass, the returned counter value is the slot of the particle inside its cell
+		int* counter = index.getDataPtr();
+		ThreadPool::getInstance().parallelFor(pNum, [&](int pId) {
+			int gId = getIndex(pos[pId]);
+			m_cellOfParticle[pId] = gId;
+			if (gId >= 0)
+			{
+				m_slotOfParticle[pId] = reinterpret_cast<std::atomic<int>*>(counter + gId)->fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+
+		particle_num = exclusiveScanHost(counter, num + 1);
+
+		if (ids.size() != particle_num)
+		{
+			ids.resize(particle_num);
+			sortedPos.resize(particle_num);
+		}
+
+		ThreadPool::getInstance().parallelFor(pNum, [&](int pId) {
+			int gId = m_cellOfParticle[pId];
+			if (gId >= 0)
+			{
+				int sId = index[gId] + m_slotOfParticle[pId];
+				ids[sId] = pId;
+				sortedPos[sId] = pos[pId];
+			}
+		});
+	}
+
+	template<typename TDataType>
+	void HostGridHash<TDataType>::clear()
+	{
+		if (index.size() > 0)
+			index.reset();
+	}
+
+	template<typename TDataType>
+	void HostGridHash<TDataType>::release()
+	{
+		num = 0;
+		ids.release();
+		sortedPos.release();
+		index.release();
+		rank.release();
+		m_cellOfParticle.release();
+		m_slotOfParticle.release();
+	}
+}
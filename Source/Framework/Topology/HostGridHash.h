@@ -0,0 +1,106 @@
+#pragma once
+#include "Core/DataTypes.h"
+#include "Core/Array/Array.h"
+
+namespace PhysIKA {
+
+	/*!
+	*	\class	HostGridHash
+	*	\brief	Host counterpart of GridHash, built with ThreadPool over positions held in a HostArray.
+	*
+	*	Cells are ranked along a Z-curve (Morton order), so that the particles of spatially adjacent cells
+	*	are stored close to each other in ids. Particles are bucketed with a parallel counting sort,
+	*	index[r] is the first entry in ids of the cell ranked r.
+	*/
+	template<typename TDataType>
+	class HostGridHash
+	{
+	public:
+		typedef typename TDataType::Real Real;
+		typedef typename TDataType::Coord Coord;
+
+		HostGridHash();
+		~HostGridHash();
+
+		/*!
+		*	\brief	Set up the grid, nothing is done if h and the bounds are the same as in the last call.
+		*/
+		void setSpace(Real _h, Coord _lo, Coord _hi);
+
+		void construct(HostArray<Coord>& pos);
+
+		void clear();
+
+		void release();
+
+		/*!
+		*	\brief	Morton rank of the cell (i, j, k), -1 if the cell is out of the grid.
+		*/
+		inline int getIndex(int i, int j, int k)
+		{
+			if (i < 0 || i >= nx) return -1;
+			if (j < 0 || j >= ny) return -1;
+			if (k < 0 || k >= nz) return -1;
+
+			return rank[i + j*nx + k*nx*ny];
+		}
+
+		inline int getIndex(Coord pos)
+		{
+			int i = floor((pos[0] - lo[0]) / ds);
+			int j = floor((pos[1] - lo[1]) / ds);
+			int k = floor((pos[2] - lo[2]) / ds);
+
+			return getIndex(i, j, k);
+		}
+
+		inline void getIndex3(Coord pos, int& i, int& j, int& k)
+		{
+			i = floor((pos[0] - lo[0]) / ds);
+			j = floor((pos[1] - lo[1]) / ds);
+			k = floor((pos[2] - lo[2]) / ds);
+		}
+
+		inline int getCounter(int gId) { return index[gId + 1] - index[gId]; }
+
+		inline int getParticleId(int gId, int n) { return ids[index[gId] + n]; }
+
+		inline int getCellBegin(int gId) { return index[gId]; }
+		inline int getCellEnd(int gId) { return index[gId + 1]; }
+
+		/*!
+		*	\brief	Interleave the lower 21 bits of i, j and k.
+		*/
+		static unsigned long long mortonCode(unsigned int i, unsigned int j, unsigned int k);
+
+	public:
+		int num = 0;
+		int nx = 0, ny = 0, nz = 0;
+
+		int particle_num = 0;
+
+		Real ds;
+
+		Coord lo;
+		Coord hi;
+
+		HostArray<int> ids;			//!< Particle ids sorted by cell rank
+		HostArray<Coord> sortedPos;	//!< Particle positions in the same order as ids, scanned contiguously by neighbor queries
+		HostArray<int> index;		//!< Start of each cell in ids, num + 1 entries
+		HostArray<int> rank;		//!< Morton rank of each cell, indexed by i + j*nx + k*nx*ny
+
+	private:
+		Real m_spaceH = 0;
+		Coord m_spaceLo;
+		Coord m_spaceHi;
+
+		HostArray<int> m_cellOfParticle;
+		HostArray<int> m_slotOfParticle;
+	};
+
+#ifdef PRECISION_FLOAT
+	template class HostGridHash<DataType3f>;
+#else
+	template class HostGridHash<DataType3d>;
+#endif
+}
@@ -2,10 +2,14 @@
 #include "Core/Platform.h"
 #include "Core/Array/Array.h"
 #include "Core/Utility.h"
-//#include <thrust/scan.h>
+#include "Framework/Topology/NeighborList.h"
 
 namespace PhysIKA
 {
+	/*!
+	*	\class	HostNeighborList
+	*	\brief	Host counterpart of NeighborList, accessed by the host kernels executed on ThreadPool.
+	*/
 	template<typename ElementType>
 	class HostNeighborList
 	{
@@ -25,7 +29,7 @@ namespace PhysIKA
 
 		COMM_FUNC int size() { return m_index.size(); }
 
-		GPU_FUNC int getNeighborSize(int i)
+		COMM_FUNC int getNeighborSize(int i)
 		{
 			if (!isLimited())
 			{
@@ -46,20 +50,20 @@ namespace PhysIKA
 			return m_maxNum;
 		}
 
-		GPU_FUNC void setNeighborSize(int i, int num)
+		COMM_FUNC void setNeighborSize(int i, int num)
 		{
 			if (isLimited())
 				m_index[i] = num;
 		}
 
-		GPU_FUNC ElementType getElement(int i, int j) {
+		COMM_FUNC ElementType getElement(int i, int j) {
 			if (!isLimited())
 				return m_elements[m_index[i] + j];
 			else
 				return m_elements[m_maxNum * i + j];
 		};
 
-		GPU_FUNC void setElement(int i, int j, ElementType elem) {
+		COMM_FUNC void setElement(int i, int j, ElementType elem) {
 			if (!isLimited())
 				m_elements[m_index[i] + j] = elem;
 			else
@@ -71,6 +75,19 @@ namespace PhysIKA
 			return m_maxNum > 0;
 		}
 
+		/**
+		 * @brief A half list stores every pair once, particle i only lists neighbors j > i and not itself
+		 */
+		COMM_FUNC bool isHalf()
+		{
+			return m_half;
+		}
+
+		void setHalf(bool half)
+		{
+			m_half = half;
+		}
+
 		void resize(int n, int maxNbr = 0) {
 			m_index.resize(n);
 			if (maxNbr != 0)
@@ -103,6 +120,7 @@ namespace PhysIKA
 		void copyFrom(HostNeighborList<ElementType>& HostNeighborList)
 		{
 			m_maxNum = HostNeighborList.m_maxNum;
+			m_half = HostNeighborList.m_half;
 			if (m_elements.size() != HostNeighborList.m_elements.size())
 				m_elements.resize(HostNeighborList.m_elements.size());
 
@@ -115,12 +133,31 @@ namespace PhysIKA
 
 		}
 
+		/*!
+		*	\brief	Stage a device neighbor list into host memory.
+		*/
+		void copyFrom(NeighborList<ElementType>& neighborlist)
+		{
+			m_maxNum = neighborlist.getNeighborLimit();
+			m_half = neighborlist.isHalf();
+			if (m_elements.size() != neighborlist.getElements().size())
+				m_elements.resize(neighborlist.getElements().size());
+
+			Function1Pt::copy(m_elements, neighborlist.getElements());
+
+			if (m_index.size() != neighborlist.getIndex().size())
+				m_index.resize(neighborlist.getIndex().size());
+
+			Function1Pt::copy(m_index, neighborlist.getIndex());
+		}
+
 		HostArray<int>& getIndex() { return m_index; }
 		HostArray<ElementType>& getElements() { return m_elements; }
 
 	private:
 
 		int m_maxNum;
+		bool m_half = false;
 		HostArray<ElementType> m_elements;
 		HostArray<int> m_index;
 	};
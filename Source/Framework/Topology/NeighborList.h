@@ -70,6 +70,19 @@ namespace PhysIKA
 			return m_maxNum > 0;
 		}
 
+		/**
+		 * @brief A half list stores every pair once, particle i only lists neighbors j > i and not itself
+		 */
+		COMM_FUNC bool isHalf()
+		{
+			return m_half;
+		}
+
+		void setHalf(bool half)
+		{
+			m_half = half;
+		}
+
 		void resize(int n, int maxNbr = 0) {
 			m_index.resize(n);
 			if (maxNbr != 0)
@@ -102,6 +115,7 @@ namespace PhysIKA
 		void copyFrom(NeighborList<ElementType>& neighborlist)
 		{
 			m_maxNum = neighborlist.m_maxNum;
+			m_half = neighborlist.m_half;
 			if (m_elements.size() != neighborlist.m_elements.size())
 				m_elements.resize(neighborlist.m_elements.size());
 
@@ -120,6 +134,7 @@ namespace PhysIKA
 	private:
 
 		int m_maxNum;
+		bool m_half = false;
 		DeviceArray<ElementType> m_elements;
 		DeviceArray<int> m_index;
 	};
@@ -6,6 +6,7 @@
 #include "Framework/Topology/FieldNeighbor.h"
 #include "Framework/Framework/SceneGraph.h"
 #include "Core/Utility/Scan.h"
+#include "Core/Utility/ThreadPool.h"
 
 
 
@@ -40,6 +41,35 @@ namespace PhysIKA
 		-1, -1, -1
 	};
 
+	static const int offset1_host[27][3] = { 0, 0, 0,
+		0, 0, 1,
+		0, 1, 0,
+		1, 0, 0,
+		0, 0, -1,
+		0, -1, 0,
+		-1, 0, 0,
+		0, 1, 1,
+		0, 1, -1,
+		0, -1, 1,
+		0, -1, -1,
+		1, 0, 1,
+		1, 0, -1,
+		-1, 0, 1,
+		-1, 0, -1,
+		1, 1, 0,
+		1, -1, 0,
+		-1, 1, 0,
+		-1, -1, 0,
+		1, 1, 1,
+		1, 1, -1,
+		1, -1, 1,
+		-1, 1, 1,
+		1, -1, -1,
+		-1, 1, -1,
+		-1, -1, 1,
+		-1, -1, -1
+	};
+
 	IMPLEMENT_CLASS_1(NeighborQuery, TDataType)
 
 	template<typename TDataType>
@@ -86,6 +116,10 @@ namespace PhysIKA
 	NeighborQuery<TDataType>::~NeighborQuery()
 	{
 		m_hash.release();
+
+		m_refPosition.release();
+		m_displacement.release();
+		m_hostRefPosition.release();
 	}
 
 	template<typename TDataType>
@@ -139,7 +173,10 @@ namespace PhysIKA
 // 		}
 
 	
-		m_hash.setSpace(this->inRadius()->getValue(), m_lowBound, m_highBound);
+		if (!this->isHostContext())
+			m_hash.setSpace(searchRadius(), m_lowBound, m_highBound);
+
+		invalidate();
 
 //		m_reduce = Reduction<int>::Create(m_position.getElementCount());
 		triangle_first = true;
@@ -151,6 +188,12 @@ namespace PhysIKA
 	template<typename TDataType>
 	void NeighborQuery<TDataType>::compute()
 	{
+		if (this->isHostContext())
+		{
+			computeHost();
+			return;
+		}
+
 		if(this->inTriangleIndex()->isEmpty())
 		{ 
 			if (!this->inPosition()->isEmpty())
@@ -159,18 +202,37 @@ namespace PhysIKA
 				if (this->outNeighborhood()->getElementCount() != p_num)
 				{
 					this->outNeighborhood()->setElementCount(p_num);
+					invalidate();
 				}
 
+				m_queryNum++;
+				if (!isRebuildRequired())
+					return;
+
+				m_rebuildNum++;
+				m_invalid = false;
+
+				Real h = searchRadius();
+				if (m_hash.ds < h)
+					m_hash.setSpace(h, m_lowBound, m_highBound);
+
 				m_hash.clear();
 				m_hash.construct(this->inPosition()->getValue());
 
 				if (!this->outNeighborhood()->getValue().isLimited())
 				{
-					queryNeighborDynamic(this->outNeighborhood()->getValue(), this->inPosition()->getValue(), this->inRadius()->getValue());
+					queryNeighborDynamic(this->outNeighborhood()->getValue(), this->inPosition()->getValue(), h);
 				}
 				else
 				{
-					queryNeighborFixed(this->outNeighborhood()->getValue(), this->inPosition()->getValue(), this->inRadius()->getValue());
+					queryNeighborFixed(this->outNeighborhood()->getValue(), this->inPosition()->getValue(), h);
+				}
+
+				if (this->varSkin()->getValue() > 0)
+				{
+					if (m_refPosition.size() != p_num)
+						m_refPosition.resize(p_num);
+					Function1Pt::copy(m_refPosition, this->inPosition()->getValue());
 				}
 			}
 		}
@@ -199,6 +261,56 @@ namespace PhysIKA
 	}
 
 
+	template<typename TDataType>
+	void NeighborQuery<TDataType>::computeHost()
+	{
+		if (!this->inTriangleIndex()->isEmpty())
+		{
+			Log::sendMessage(Log::Error, "NeighborQuery: triangle queries are not supported on a CPU context");
+			return;
+		}
+
+		if (this->inPosition()->isEmpty())
+			return;
+
+		HostArray<Coord>& pos = this->inPosition()->getHostValue();
+		int p_num = pos.size();
+		if (this->outNeighborhood()->getElementCount() != p_num)
+		{
+			this->outNeighborhood()->setElementCount(p_num);
+			invalidate();
+		}
+
+		m_queryNum++;
+
+		//Same Verlet skin test as isRebuildRequired(), on the host reference positions
+		Real skin = this->varSkin()->getValue();
+		bool rebuild = skin <= 0 || m_invalid || m_hostRefPosition.size() != p_num;
+		if (!rebuild)
+		{
+			Real maxDisp2 = Real(0.25) * skin * skin;
+			for (int i = 0; i < p_num && !rebuild; i++)
+			{
+				rebuild = (pos[i] - m_hostRefPosition[i]).normSquared() > maxDisp2;
+			}
+		}
+
+		if (!rebuild)
+			return;
+
+		m_rebuildNum++;
+		m_invalid = false;
+
+		queryParticleNeighbors(this->outNeighborhood()->getHostValue(), pos, searchRadius());
+
+		if (skin > 0)
+		{
+			if (m_hostRefPosition.size() != p_num)
+				m_hostRefPosition.resize(p_num);
+			Function1Pt::copy(m_hostRefPosition, pos);
+		}
+	}
+
 	template<typename TDataType>
 	void NeighborQuery<TDataType>::setBoundingBox(Coord lowerBound, Coord upperBound)
 	{
@@ -241,16 +353,85 @@ namespace PhysIKA
 		}
 	}
 
+	template<typename TDataType>
+	typename TDataType::Real NeighborQuery<TDataType>::searchRadius()
+	{
+		Real skin = this->varSkin()->getValue();
+		return this->inRadius()->getValue() + (skin > 0 ? skin : Real(0));
+	}
+
+	template<typename Coord, typename Real>
+	__global__ void K_ComputeDisplacement(
+		DeviceArray<Real> displacement,
+		DeviceArray<Coord> position,
+		DeviceArray<Coord> refPosition)
+	{
+		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
+		if (pId >= position.size()) return;
+
+		displacement[pId] = (position[pId] - refPosition[pId]).normSquared();
+	}
+
+	template<typename TDataType>
+	void NeighborQuery<TDataType>::invalidate()
+	{
+		m_invalid = true;
+	}
+
+	template<typename TDataType>
+	bool NeighborQuery<TDataType>::isRebuildRequired()
+	{
+		Real skin = this->varSkin()->getValue();
+		if (skin <= 0 || m_invalid)
+			return true;
+
+		Real maxDisp2 = Real(0.25) * skin * skin;
+		int p_num = this->inPosition()->getElementCount();
+
+		if (m_refPosition.size() != p_num)
+			return true;
+
+		if (m_displacement.size() != p_num)
+			m_displacement.resize(p_num);
+
+		cuExecute(p_num, K_ComputeDisplacement,
+			m_displacement,
+			this->inPosition()->getValue(),
+			m_refPosition);
+
+		return m_reduceReal.maximum(m_displacement.getDataPtr(), p_num) > maxDisp2;
+	}
+
+	template<typename TDataType>
+	void NeighborQuery<TDataType>::queryParticleNeighbors(HostNeighborList<int>& nbr, HostArray<Coord>& pos, Real radius)
+	{
+		m_hostHash.setSpace(radius, m_lowBound, m_highBound);
+		m_hostHash.construct(pos);
+
+		if (nbr.size() != pos.size())
+			nbr.resize(pos.size(), nbr.getNeighborLimit());
+
+		if (!nbr.isLimited())
+		{
+			queryNeighborDynamic(nbr, pos, radius);
+		}
+		else
+		{
+			queryNeighborFixed(nbr, pos, radius);
+		}
+	}
+
 	template<typename Real, typename Coord, typename TDataType>
 	__global__ void K_CalNeighborSize(
 		DeviceArray<int> count,
 		DeviceArray<Coord> position_new,
 		DeviceArray<Coord> position, 
 		GridHash<TDataType> hash, 
-		Real h)
+		Real h,
+		bool half)
 	{
 		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
-		if (pId > position_new.size()) return;
+		if (pId >= position_new.size()) return;
 
 		Coord pos_ijk = position_new[pId];
 		int3 gId3 = hash.getIndex3(pos_ijk);
@@ -263,6 +444,9 @@ namespace PhysIKA
 				int totalNum = hash.getCounter(cId);
 				for (int i = 0; i < totalNum; i++) {
 					int nbId = hash.getParticleId(cId, i);
+					if (half && nbId <= pId)
+						continue;
+
 					Real d_ij = (pos_ijk - position[nbId]).norm();
 					if (d_ij < h)
 					{
@@ -339,10 +523,11 @@ namespace PhysIKA
 		DeviceArray<Coord> position_new,
 		DeviceArray<Coord> position, 
 		GridHash<TDataType> hash, 
-		Real h)
+		Real h,
+		bool half)
 	{
 		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
-		if (pId > position_new.size()) return;
+		if (pId >= position_new.size()) return;
 
 		Coord pos_ijk = position_new[pId];
 		int3 gId3 = hash.getIndex3(pos_ijk);
@@ -355,6 +540,9 @@ namespace PhysIKA
 				int totalNum = hash.getCounter(cId);// min(hash.getCounter(cId), hash.npMax);
 				for (int i = 0; i < totalNum; i++) {
 					int nbId = hash.getParticleId(cId, i);
+					if (half && nbId <= pId)
+						continue;
+
 					Real d_ij = (pos_ijk - position[nbId]).norm();
 					if (d_ij < h)
 					{
@@ -434,7 +622,7 @@ namespace PhysIKA
 	void NeighborQuery<TDataType>::queryNeighborSize(DeviceArray<int>& num, DeviceArray<Coord>& pos, Real h)
 	{
 		uint pDims = cudaGridSize(num.size(), BLOCK_SIZE);
-		K_CalNeighborSize << <pDims, BLOCK_SIZE >> > (num, pos, this->inPosition()->getValue(), m_hash, h);
+		K_CalNeighborSize << <pDims, BLOCK_SIZE >> > (num, pos, this->inPosition()->getValue(), m_hash, h, this->varHalfList()->getValue());
 		cuSynchronize();
 	}
 
@@ -458,6 +646,7 @@ namespace PhysIKA
 		if (nbrNum.size() != pos.size())
 			nbrList.resize(pos.size());
 
+		nbrList.setHalf(this->varHalfList()->getValue());
 		queryNeighborSize(nbrNum, pos, h);
 
 		int sum = m_reduce.accumulate(nbrNum.getDataPtr(), nbrNum.size());
@@ -472,7 +661,7 @@ namespace PhysIKA
 			elements.resize(sum);
 
 			uint pDims = cudaGridSize(pos.size(), BLOCK_SIZE);
-			K_GetNeighborElements << <pDims, BLOCK_SIZE >> > (nbrList, pos, this->inPosition()->getValue(), m_hash, h);
+			K_GetNeighborElements << <pDims, BLOCK_SIZE >> > (nbrList, pos, this->inPosition()->getValue(), m_hash, h, this->varHalfList()->getValue());
 			cuSynchronize();
 		}
 	}
@@ -517,11 +706,12 @@ namespace PhysIKA
 		DeviceArray<Coord> position, 
 		GridHash<TDataType> hash, 
 		Real h,
+		bool half,
 		int* heapIDs,
 		Real* heapDistance)
 	{
 		int pId = threadIdx.x + (blockIdx.x * blockDim.x);
-		if (pId > position_new.size()) return;
+		if (pId >= position_new.size()) return;
 
 		int nbrLimit = neighbors.getNeighborLimit();
 
@@ -539,6 +729,9 @@ namespace PhysIKA
 				int totalNum = hash.getCounter(cId);// min(hash.getCounter(cId), hash.npMax);
 				for (int i = 0; i < totalNum; i++) {
 					int nbId = hash.getParticleId(cId, i);
+					if (half && nbId <= pId)
+						continue;
+
 					float d_ij = (pos_ijk - position[nbId]).norm();
 					if (d_ij < h)
 					{
@@ -589,6 +782,8 @@ namespace PhysIKA
 		cuSafeCall(cudaMalloc((void**)&ids, num * sizeof(int) * nbrList.getNeighborLimit()));
 		cuSafeCall(cudaMalloc((void**)&distance, num * sizeof(int) * nbrList.getNeighborLimit()));
 
+		nbrList.setHalf(this->varHalfList()->getValue());
+
 		uint pDims = cudaGridSize(num, BLOCK_SIZE);
 		K_ComputeNeighborFixed << <pDims, BLOCK_SIZE >> > (
 			nbrList, 
@@ -596,6 +791,7 @@ namespace PhysIKA
 			this->inPosition()->getValue(), 
 			m_hash, 
 			h, 
+			this->varHalfList()->getValue(),
 			ids, 
 			distance);
 		cuSynchronize();
@@ -603,4 +799,204 @@ namespace PhysIKA
 		cuSafeCall(cudaFree(ids));
 		cuSafeCall(cudaFree(distance));
 	}
+
+	/*!
+	*	Host kernels are launched over the Morton-sorted particle order, so that the particles handled
+	*	by one thread and the cells they visit are close in memory. Particles out of the grid have no neighbors.
+	*/
+	template<typename Real, typename TDataType>
+	void H_CalNeighborSize(
+		int sId,
+		HostArray<int>& count,
+		HostGridHash<TDataType>& hash,
+		Real h,
+		bool half)
+	{
+		typedef typename TDataType::Coord Coord;
+
+		int pId = hash.ids[sId];
+		Coord pos_ijk = hash.sortedPos[sId];
+
+		int gi, gj, gk;
+		hash.getIndex3(pos_ijk, gi, gj, gk);
+
+		Real h2 = h * h;
+		int counter = 0;
+		for (int c = 0; c < 27; c++)
+		{
+			int cId = hash.getIndex(gi + offset1_host[c][0], gj + offset1_host[c][1], gk + offset1_host[c][2]);
+			if (cId >= 0) {
+				int end = hash.getCellEnd(cId);
+				for (int i = hash.getCellBegin(cId); i < end; i++) {
+					if (half && hash.ids[i] <= pId)
+						continue;
+
+					if ((pos_ijk - hash.sortedPos[i]).normSquared() < h2)
+					{
+						counter++;
+					}
+				}
+			}
+		}
+
+		count[pId] = counter;
+	}
+
+	template<typename Real, typename TDataType>
+	void H_GetNeighborElements(
+		int sId,
+		HostNeighborList<int>& nbr,
+		HostGridHash<TDataType>& hash,
+		Real h,
+		bool half)
+	{
+		typedef typename TDataType::Coord Coord;
+
+		int pId = hash.ids[sId];
+		Coord pos_ijk = hash.sortedPos[sId];
+
+		int gi, gj, gk;
+		hash.getIndex3(pos_ijk, gi, gj, gk);
+
+		Real h2 = h * h;
+		int j = 0;
+		for (int c = 0; c < 27; c++)
+		{
+			int cId = hash.getIndex(gi + offset1_host[c][0], gj + offset1_host[c][1], gk + offset1_host[c][2]);
+			if (cId >= 0) {
+				int end = hash.getCellEnd(cId);
+				for (int i = hash.getCellBegin(cId); i < end; i++) {
+					if (half && hash.ids[i] <= pId)
+						continue;
+
+					if ((pos_ijk - hash.sortedPos[i]).normSquared() < h2)
+					{
+						nbr.setElement(pId, j, hash.ids[i]);
+						j++;
+					}
+				}
+			}
+		}
+	}
+
+	template<typename Real, typename Coord, typename TDataType>
+	void H_ComputeNeighborFixed(
+		int sId,
+		HostNeighborList<int>& neighbors,
+		HostArray<Coord>& position,
+		HostGridHash<TDataType>& hash,
+		Real h,
+		bool half,
+		HostArray<int>& heapIDs,
+		HostArray<Real>& heapDistance)
+	{
+		int pId = hash.ids[sId];
+		int nbrLimit = neighbors.getNeighborLimit();
+
+		int* ids = heapIDs.getDataPtr() + pId * nbrLimit;
+		Real* distance = heapDistance.getDataPtr() + pId * nbrLimit;
+
+		Coord pos_ijk = position[pId];
+
+		int gi, gj, gk;
+		hash.getIndex3(pos_ijk, gi, gj, gk);
+
+		int counter = 0;
+		for (int c = 0; c < 27; c++)
+		{
+			int cId = hash.getIndex(gi + offset1_host[c][0], gj + offset1_host[c][1], gk + offset1_host[c][2]);
+			if (cId >= 0) {
+				int totalNum = hash.getCounter(cId);
+				for (int i = 0; i < totalNum; i++) {
+					int nbId = hash.getParticleId(cId, i);
+					if (half && nbId <= pId)
+						continue;
+
+					Real d_ij = (pos_ijk - position[nbId]).norm();
+					if (d_ij < h)
+					{
+						if (counter < nbrLimit)
+						{
+							ids[counter] = nbId;
+							distance[counter] = d_ij;
+							counter++;
+						}
+						else
+						{
+							int maxId = 0;
+							Real maxDist = distance[0];
+							for (int ne = 1; ne < nbrLimit; ne++)
+							{
+								if (maxDist < distance[ne])
+								{
+									maxDist = distance[ne];
+									maxId = ne;
+								}
+							}
+							if (d_ij < distance[maxId])
+							{
+								distance[maxId] = d_ij;
+								ids[maxId] = nbId;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		neighbors.setNeighborSize(pId, counter);
+
+		for (int bId = 0; bId < counter; bId++)
+		{
+			neighbors.setElement(pId, bId, ids[bId]);
+		}
+	}
+
+	template<typename TDataType>
+	void NeighborQuery<TDataType>::queryNeighborDynamic(HostNeighborList<int>& nbrList, HostArray<Coord>& pos, Real h)
+	{
+		if (pos.size() <= 0)
+		{
+			return;
+		}
+
+		HostArray<int>& nbrNum = nbrList.getIndex();
+		if (nbrNum.size() != pos.size())
+			nbrList.resize(pos.size());
+
+		bool half = this->varHalfList()->getValue();
+		nbrList.setHalf(half);
+
+		nbrNum.reset();
+		cpuExecute(m_hostHash.particle_num, H_CalNeighborSize, nbrNum, m_hostHash, h, half);
+
+		int sum = exclusiveScanHost(nbrNum.getDataPtr(), nbrNum.size());
+
+		HostArray<int>& elements = nbrList.getElements();
+		if (elements.size() != sum)
+			elements.resize(sum);
+
+		if (sum > 0)
+		{
+			cpuExecute(m_hostHash.particle_num, H_GetNeighborElements, nbrList, m_hostHash, h, half);
+		}
+	}
+
+	template<typename TDataType>
+	void NeighborQuery<TDataType>::queryNeighborFixed(HostNeighborList<int>& nbrList, HostArray<Coord>& pos, Real h)
+	{
+		int num = pos.size();
+		int heapSize = num * nbrList.getNeighborLimit();
+		if (m_hostIds.size() != heapSize)
+		{
+			m_hostIds.resize(heapSize);
+			m_hostDistance.resize(heapSize);
+		}
+
+		bool half = this->varHalfList()->getValue();
+		nbrList.setHalf(half);
+
+		nbrList.getIndex().reset();
+		cpuExecute(m_hostHash.particle_num, H_ComputeNeighborFixed, nbrList, pos, m_hostHash, h, half, m_hostIds, m_hostDistance);
+	}
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "Framework/Framework/FieldArray.h"
 #include "Framework/Topology/FieldNeighbor.h"
 #include "Framework/Topology/GridHash.h"
+#include "Framework/Topology/HostGridHash.h"
+#include "Framework/Topology/HostNeighborList.h"
 #include "Core/Utility.h"
 #include "Framework/Framework/ModuleTopology.h"
 namespace PhysIKA {
@@ -24,6 +26,9 @@ namespace PhysIKA {
 		NeighborQuery(Real s, Coord lo, Coord hi);
 		~NeighborQuery() override;
 		
+		/**
+		 * @brief Rebuild the neighbor list of the particles, on the host with queryParticleNeighbors() if the node runs on a CPU context
+		 */
 		void compute() override;
 
 //		void setRadius(Real r) { m_radius.setValue(r); }
@@ -31,19 +36,46 @@ namespace PhysIKA {
 
 		void queryParticleNeighbors(NeighborList<int>& nbr, DeviceArray<Coord>& pos, Real radius);
 
+		/**
+		 * @brief Host neighbor search executed on ThreadPool over arrays owned by the caller, no CUDA device is involved
+		 */
+		void queryParticleNeighbors(HostNeighborList<int>& nbr, HostArray<Coord>& pos, Real radius);
+
 		void setNeighborSizeLimit(int num) { m_maxNum = num; }
 
+		/**
+		 * @brief Statistics of the Verlet-skin mode, the rebuild ratio is the number of rebuilds over the number of compute() calls
+		 */
+		int getQueryCount() { return m_queryNum; }
+		int getRebuildCount() { return m_rebuildNum; }
+		Real getRebuildRatio() { return m_queryNum == 0 ? Real(0) : Real(m_rebuildNum) / Real(m_queryNum); }
+		void resetRebuildCounter() { m_queryNum = 0; m_rebuildNum = 0; }
+
+		/**
+		 * @brief Force the next compute() to rebuild the neighbor list even if no particle has moved farther than Skin / 2,
+		 * to be called whenever the particles are permuted, inserted or removed
+		 */
+		void invalidate();
+
 //		NeighborList<int>& getNeighborList() { return m_neighborhood.getValue(); }
 
 	protected:
 		bool initializeImpl() override;
 
 	private:
+		void computeHost();
+
 		void queryNeighborSize(DeviceArray<int>& num, DeviceArray<Coord>& pos, Real h);
 		void queryNeighborDynamic(NeighborList<int>& nbrList, DeviceArray<Coord>& pos, Real h);
 
 		void queryNeighborFixed(NeighborList<int>& nbrList, DeviceArray<Coord>& pos, Real h);
 
+		void queryNeighborDynamic(HostNeighborList<int>& nbrList, HostArray<Coord>& pos, Real h);
+		void queryNeighborFixed(HostNeighborList<int>& nbrList, HostArray<Coord>& pos, Real h);
+
+		Real searchRadius();
+		bool isRebuildRequired();
+
 
 		void queryNeighborTriDynamic(NeighborList<int>& nbrList, DeviceArray<Coord>& pos, DeviceArray<Coord>& posT, DeviceArray<Triangle>& Tris, Real h);
 		void queryNeighborSizeTri(DeviceArray<int>& num, DeviceArray<Coord>& pos, DeviceArray<Triangle>& Tris, DeviceArray<Coord>& posT, Real h);
@@ -56,6 +88,21 @@ namespace PhysIKA {
 		*/
 		DEF_EMPTY_IN_VAR(Radius, Real, "Search radius");
 
+		/**
+		* @brief Verlet skin
+		* If positive, neighbors are searched within Radius + Skin and the neighbor list is reused
+		* until some particle has moved farther than Skin / 2 since the last build
+		*/
+		DEF_VAR(Skin, Real, 0, "Verlet skin");
+
+		/**
+		* @brief Half neighbor list
+		* If true, every pair is stored once: particle i only lists the neighbors j > i, and not itself.
+		* This halves the memory of the list and the pair evaluations, but only modules that check
+		* NeighborList::isHalf() and scatter to both particles of a pair may read such a list.
+		*/
+		DEF_VAR(HalfList, bool, false, "Store every neighboring pair once");
+
 		/**
 		 * @brief Particle position
 		 */
@@ -84,6 +131,10 @@ namespace PhysIKA {
 		Coord m_highBound;
 
 		GridHash<TDataType> m_hash;
+		HostGridHash<TDataType> m_hostHash;
+
+		HostArray<int> m_hostIds;
+		HostArray<Real> m_hostDistance;
 
 		int* m_ids;
 		Real* m_distance;
@@ -92,6 +143,16 @@ namespace PhysIKA {
 		Scan m_scan;
 
 		bool triangle_first = true;
+
+		int m_queryNum = 0;
+		int m_rebuildNum = 0;
+		bool m_invalid = true;
+
+		DeviceArray<Coord> m_refPosition;
+		DeviceArray<Real> m_displacement;
+		Reduction<Real> m_reduceReal;
+
+		HostArray<Coord> m_hostRefPosition;
 	};
 
 #ifdef PRECISION_FLOAT
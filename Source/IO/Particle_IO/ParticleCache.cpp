@@ -0,0 +1,547 @@
+#include "ParticleCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace PhysIKA {
+
+	namespace
+	{
+		const char CACHE_MAGIC[4] = { 'P', 'C', 'C', 'H' };
+		const unsigned int CACHE_VERSION = 1;
+
+		const unsigned char ENCODING_QUANTIZED = 1;
+		const unsigned char ENCODING_COMPRESSED = 2;
+
+		const unsigned char CHUNK_RAW = 0;
+		const unsigned char CHUNK_LZ = 1;
+
+		const int LZ_HASH_BITS = 14;
+		const int LZ_MIN_MATCH = 4;
+		const size_t LZ_MAX_OFFSET = 65535;
+
+		template<typename T>
+		void put(std::vector<char>& buffer, T value)
+		{
+			const char* ptr = (const char*)&value;
+			buffer.insert(buffer.end(), ptr, ptr + sizeof(T));
+		}
+
+		template<typename T>
+		void putAt(std::vector<char>& buffer, size_t pos, T value)
+		{
+			memcpy(buffer.data() + pos, &value, sizeof(T));
+		}
+
+		class Cursor
+		{
+		public:
+			Cursor(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+			template<typename T>
+			bool get(T& value)
+			{
+				if (m_pos + sizeof(T) > m_size) return false;
+				memcpy(&value, m_data + m_pos, sizeof(T));
+				m_pos += sizeof(T);
+				return true;
+			}
+
+			const char* take(size_t n)
+			{
+				if (m_pos + n > m_size) return nullptr;
+				const char* ptr = m_data + m_pos;
+				m_pos += n;
+				return ptr;
+			}
+
+			size_t position() { return m_pos; }
+
+		private:
+			const char* m_data;
+			size_t m_size;
+			size_t m_pos = 0;
+		};
+
+		// Group the k-th bytes of all scalars together, neighboring particles then produce long repeated runs
+		void shuffle(const char* src, char* dst, size_t count, size_t scalarSize)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				for (size_t b = 0; b < scalarSize; b++)
+				{
+					dst[b * count + i] = src[i * scalarSize + b];
+				}
+			}
+		}
+
+		void unshuffle(const char* src, char* dst, size_t count, size_t scalarSize)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				for (size_t b = 0; b < scalarSize; b++)
+				{
+					dst[i * scalarSize + b] = src[b * count + i];
+				}
+			}
+		}
+
+		double scalarAt(const ParticleCacheColumn& col, size_t i)
+		{
+			return col.type == ParticleCacheColumn::Float64 ? ((const double*)col.getDataPtr())[i] : ((const float*)col.getDataPtr())[i];
+		}
+
+		void setScalarAt(ParticleCacheColumn& col, size_t i, double value)
+		{
+			if (col.type == ParticleCacheColumn::Float64)
+				((double*)col.getDataPtr())[i] = value;
+			else
+				((float*)col.getDataPtr())[i] = (float)value;
+		}
+
+		void writeLength(std::vector<char>& dst, size_t len)
+		{
+			while (len >= 255)
+			{
+				dst.push_back((char)255);
+				len -= 255;
+			}
+			dst.push_back((char)len);
+		}
+
+		void writeSequence(std::vector<char>& dst, const char* literals, size_t litLen, size_t offset, size_t matchLen)
+		{
+			unsigned char token = (unsigned char)(std::min<size_t>(litLen, 15) << 4);
+			if (matchLen > 0)
+				token |= (unsigned char)std::min<size_t>(matchLen - LZ_MIN_MATCH, 15);
+
+			dst.push_back((char)token);
+			if (litLen >= 15)
+				writeLength(dst, litLen - 15);
+			dst.insert(dst.end(), literals, literals + litLen);
+
+			if (matchLen == 0)
+				return;
+
+			dst.push_back((char)(offset & 0xff));
+			dst.push_back((char)(offset >> 8));
+			if (matchLen - LZ_MIN_MATCH >= 15)
+				writeLength(dst, matchLen - LZ_MIN_MATCH - 15);
+		}
+
+		bool readLength(const unsigned char*& ip, const unsigned char* iend, size_t& len)
+		{
+			unsigned char b;
+			do
+			{
+				if (ip >= iend) return false;
+				b = *ip++;
+				len += b;
+			} while (b == 255);
+			return true;
+		}
+	}
+
+	ParticleCacheColumn& ParticleCacheFrame::addColumn(const std::string& name, ParticleCacheColumn::ScalarType type, int components, int num)
+	{
+		ParticleCacheColumn* col = getColumn(name);
+		if (col == nullptr)
+		{
+			if (!m_unused.empty())
+			{
+				columns.push_back(std::move(m_unused.back()));
+				m_unused.pop_back();
+			}
+			else
+			{
+				columns.push_back(ParticleCacheColumn());
+			}
+			col = &columns.back();
+		}
+
+		col->name = name;
+		col->type = type;
+		col->components = components;
+		col->data.resize(num * col->elementSize());
+
+		particleNum = num;
+		return *col;
+	}
+
+	ParticleCacheColumn* ParticleCacheFrame::getColumn(const std::string& name)
+	{
+		for (auto& col : columns)
+		{
+			if (col.name == name)
+				return &col;
+		}
+		return nullptr;
+	}
+
+	void ParticleCacheFrame::clear()
+	{
+		for (auto& col : columns)
+		{
+			m_unused.push_back(std::move(col));
+		}
+		columns.clear();
+		particleNum = 0;
+	}
+
+	bool ParticleCacheFrame::restoreOrder(const std::string& idName)
+	{
+		ParticleCacheColumn* idCol = getColumn(idName);
+		if (idCol == nullptr || idCol->type != ParticleCacheColumn::Int32 || idCol->components != 1 || (int)idCol->size() != particleNum)
+			return false;
+
+		std::vector<int> ids(particleNum);
+		idCol->copyTo(ids.data());
+
+		//The ids must be a permutation, a duplicate would leave some slots unwritten
+		std::vector<bool> taken(particleNum, false);
+		for (int i = 0; i < particleNum; i++)
+		{
+			if (ids[i] < 0 || ids[i] >= particleNum || taken[ids[i]])
+				return false;
+			taken[ids[i]] = true;
+		}
+
+		std::vector<char> buffer;
+		for (auto& col : columns)
+		{
+			if ((int)col.size() != particleNum)
+				continue;
+
+			size_t elemSize = col.elementSize();
+			buffer.resize(col.data.size());
+			for (int i = 0; i < particleNum; i++)
+			{
+				memcpy(buffer.data() + ids[i] * elemSize, col.data.data() + i * elemSize, elemSize);
+			}
+			col.data.swap(buffer);
+		}
+		return true;
+	}
+
+	void ParticleCache::lzCompress(const char* src, size_t size, std::vector<char>& dst)
+	{
+		dst.clear();
+		dst.reserve(size + size / 255 + 16);
+
+		std::vector<int> table(1 << LZ_HASH_BITS, -1);
+		const unsigned char* in = (const unsigned char*)src;
+
+		size_t anchor = 0;
+		size_t i = 0;
+		while (i + LZ_MIN_MATCH <= size)
+		{
+			unsigned int seq;
+			memcpy(&seq, in + i, 4);
+			unsigned int h = (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+
+			int ref = table[h];
+			table[h] = (int)i;
+
+			if (ref >= 0 && i - ref <= LZ_MAX_OFFSET && memcmp(in + ref, in + i, 4) == 0)
+			{
+				size_t len = LZ_MIN_MATCH;
+				while (i + len < size && in[ref + len] == in[i + len])
+				{
+					len++;
+				}
+
+				writeSequence(dst, src + anchor, i - anchor, i - ref, len);
+				i += len;
+				anchor = i;
+			}
+			else
+			{
+				i++;
+			}
+		}
+
+		writeSequence(dst, src + anchor, size - anchor, 0, 0);
+	}
+
+	bool ParticleCache::lzDecompress(const char* src, size_t size, char* dst, size_t dstSize)
+	{
+		const unsigned char* ip = (const unsigned char*)src;
+		const unsigned char* iend = ip + size;
+		char* op = dst;
+		char* oend = dst + dstSize;
+
+		while (ip < iend)
+		{
+			unsigned char token = *ip++;
+
+			size_t litLen = token >> 4;
+			if (litLen == 15 && !readLength(ip, iend, litLen))
+				return false;
+			if (litLen > (size_t)(iend - ip) || litLen > (size_t)(oend - op))
+				return false;
+
+			memcpy(op, ip, litLen);
+			op += litLen;
+			ip += litLen;
+
+			if (ip == iend)
+				break;
+
+			if (iend - ip < 2)
+				return false;
+			size_t offset = ip[0] | (ip[1] << 8);
+			ip += 2;
+			if (offset == 0 || offset > (size_t)(op - dst))
+				return false;
+
+			size_t matchLen = token & 15;
+			if (matchLen == 15 && !readLength(ip, iend, matchLen))
+				return false;
+			matchLen += LZ_MIN_MATCH;
+			if (matchLen > (size_t)(oend - op))
+				return false;
+
+			//Byte-wise copy, the source may overlap the destination
+			const char* match = op - offset;
+			for (size_t k = 0; k < matchLen; k++)
+			{
+				op[k] = match[k];
+			}
+			op += matchLen;
+		}
+
+		return op == oend;
+	}
+
+	void ParticleCache::encode(const ParticleCacheFrame& frame, const ParticleCacheOptions& options, std::vector<char>& buffer)
+	{
+		buffer.clear();
+
+		int chunkSize = std::max(options.chunkSize, 1);
+
+		buffer.insert(buffer.end(), CACHE_MAGIC, CACHE_MAGIC + 4);
+		put<unsigned int>(buffer, CACHE_VERSION);
+		put<int>(buffer, frame.frame);
+		put<float>(buffer, frame.time);
+		put<unsigned int>(buffer, (unsigned int)frame.particleNum);
+		put<unsigned int>(buffer, (unsigned int)chunkSize);
+		put<unsigned int>(buffer, (unsigned int)frame.columns.size());
+
+		std::vector<char> raw;
+		std::vector<char> shuffled;
+		std::vector<char> compressed;
+
+		for (auto& col : frame.columns)
+		{
+			bool quantize = options.quantize && col.isFloatingPoint();
+
+			unsigned char encoding = 0;
+			if (quantize) encoding |= ENCODING_QUANTIZED;
+			if (options.compress) encoding |= ENCODING_COMPRESSED;
+
+			size_t nameLength = std::min<size_t>(col.name.size(), 255);
+			put<unsigned char>(buffer, (unsigned char)nameLength);
+			buffer.insert(buffer.end(), col.name.begin(), col.name.begin() + nameLength);
+			put<unsigned char>(buffer, (unsigned char)col.type);
+			put<unsigned char>(buffer, (unsigned char)col.components);
+			put<unsigned char>(buffer, encoding);
+
+			size_t sizePos = buffer.size();
+			put<unsigned long long>(buffer, 0);
+
+			size_t num = col.size();
+			size_t storedScalar = quantize ? sizeof(unsigned short) : col.scalarSize();
+			for (size_t first = 0; first < num; first += chunkSize)
+			{
+				size_t count = std::min<size_t>(chunkSize, num - first);
+				size_t scalarNum = count * col.components;
+
+				if (quantize)
+				{
+					raw.resize(scalarNum * sizeof(unsigned short));
+					unsigned short* q = (unsigned short*)raw.data();
+					for (int c = 0; c < col.components; c++)
+					{
+						double lo = scalarAt(col, first * col.components + c);
+						double hi = lo;
+						for (size_t i = 0; i < count; i++)
+						{
+							double v = scalarAt(col, (first + i) * col.components + c);
+							lo = std::min(lo, v);
+							hi = std::max(hi, v);
+						}
+						put<double>(buffer, lo);
+						put<double>(buffer, hi);
+
+						double scale = hi > lo ? 65535.0 / (hi - lo) : 0.0;
+						for (size_t i = 0; i < count; i++)
+						{
+							double v = scalarAt(col, (first + i) * col.components + c);
+							q[i * col.components + c] = (unsigned short)std::lround((v - lo) * scale);
+						}
+					}
+				}
+				else
+				{
+					const char* src = col.getDataPtr() + first * col.elementSize();
+					raw.assign(src, src + count * col.elementSize());
+				}
+
+				unsigned char method = CHUNK_RAW;
+				const std::vector<char>* payload = &raw;
+				if (options.compress)
+				{
+					shuffled.resize(raw.size());
+					shuffle(raw.data(), shuffled.data(), scalarNum, storedScalar);
+					lzCompress(shuffled.data(), shuffled.size(), compressed);
+
+					if (compressed.size() < raw.size())
+					{
+						method = CHUNK_LZ;
+						payload = &compressed;
+					}
+				}
+
+				put<unsigned char>(buffer, method);
+				put<unsigned int>(buffer, (unsigned int)raw.size());
+				put<unsigned int>(buffer, (unsigned int)payload->size());
+				buffer.insert(buffer.end(), payload->begin(), payload->end());
+			}
+
+			putAt<unsigned long long>(buffer, sizePos, buffer.size() - sizePos - sizeof(unsigned long long));
+		}
+	}
+
+	bool ParticleCache::decode(const char* data, size_t size, ParticleCacheFrame& frame)
+	{
+		Cursor cursor(data, size);
+
+		const char* magic = cursor.take(4);
+		if (magic == nullptr || memcmp(magic, CACHE_MAGIC, 4) != 0)
+			return false;
+
+		unsigned int version, particleNum, chunkSize, columnNum;
+		if (!cursor.get(version) || version != CACHE_VERSION)
+			return false;
+		if (!cursor.get(frame.frame) || !cursor.get(frame.time) || !cursor.get(particleNum) || !cursor.get(chunkSize) || !cursor.get(columnNum))
+			return false;
+		if (chunkSize == 0)
+			return false;
+
+		frame.clear();
+
+		std::vector<char> raw;
+		for (unsigned int n = 0; n < columnNum; n++)
+		{
+			unsigned char nameLen, type, components, encoding;
+			unsigned long long columnBytes;
+			if (!cursor.get(nameLen))
+				return false;
+			const char* name = cursor.take(nameLen);
+			if (name == nullptr || !cursor.get(type) || !cursor.get(components) || !cursor.get(encoding) || !cursor.get(columnBytes))
+				return false;
+			if (type > ParticleCacheColumn::Int32 || components == 0)
+				return false;
+
+			ParticleCacheColumn& col = frame.addColumn(std::string(name, nameLen), (ParticleCacheColumn::ScalarType)type, components, particleNum);
+
+			bool quantize = (encoding & ENCODING_QUANTIZED) != 0;
+			size_t storedScalar = quantize ? sizeof(unsigned short) : col.scalarSize();
+
+			std::vector<double> bounds(2 * components);
+			for (size_t first = 0; first < particleNum; first += chunkSize)
+			{
+				size_t count = std::min<size_t>(chunkSize, particleNum - first);
+				size_t scalarNum = count * components;
+
+				if (quantize)
+				{
+					for (int c = 0; c < components; c++)
+					{
+						if (!cursor.get(bounds[2 * c]) || !cursor.get(bounds[2 * c + 1]))
+							return false;
+					}
+				}
+
+				unsigned char method;
+				unsigned int rawSize, storedSize;
+				if (!cursor.get(method) || !cursor.get(rawSize) || !cursor.get(storedSize))
+					return false;
+				const char* payload = cursor.take(storedSize);
+				if (payload == nullptr || rawSize != scalarNum * storedScalar)
+					return false;
+
+				if (method == CHUNK_LZ)
+				{
+					std::vector<char> shuffled(rawSize);
+					if (!lzDecompress(payload, storedSize, shuffled.data(), rawSize))
+						return false;
+					raw.resize(rawSize);
+					unshuffle(shuffled.data(), raw.data(), scalarNum, storedScalar);
+				}
+				else if (method == CHUNK_RAW && storedSize == rawSize)
+				{
+					raw.assign(payload, payload + rawSize);
+				}
+				else
+				{
+					return false;
+				}
+
+				if (quantize)
+				{
+					const unsigned short* q = (const unsigned short*)raw.data();
+					for (size_t i = 0; i < count; i++)
+					{
+						for (int c = 0; c < components; c++)
+						{
+							double lo = bounds[2 * c];
+							double hi = bounds[2 * c + 1];
+							setScalarAt(col, (first + i) * components + c, lo + (hi - lo) * q[i * components + c] / 65535.0);
+						}
+					}
+				}
+				else
+				{
+					memcpy(col.getDataPtr() + first * col.elementSize(), raw.data(), rawSize);
+				}
+			}
+		}
+
+		frame.particleNum = particleNum;
+		return true;
+	}
+
+	bool ParticleCache::write(const std::string& filename, const ParticleCacheFrame& frame, const ParticleCacheOptions& options)
+	{
+		std::vector<char> buffer;
+		encode(frame, options, buffer);
+
+		std::ofstream output(filename.c_str(), std::ios::out | std::ios::binary);
+		if (!output.is_open())
+			return false;
+
+		output.write(buffer.data(), buffer.size());
+		output.close();
+
+		return !output.fail();
+	}
+
+	bool ParticleCache::read(const std::string& filename, ParticleCacheFrame& frame)
+	{
+		std::ifstream input(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+		if (!input.is_open())
+			return false;
+
+		std::streamsize size = input.tellg();
+		input.seekg(0, std::ios::beg);
+
+		std::vector<char> buffer((size_t)size);
+		if (!input.read(buffer.data(), size))
+			return false;
+
+		return decode(buffer.data(), buffer.size(), frame);
+	}
+}
\ No newline at end of file
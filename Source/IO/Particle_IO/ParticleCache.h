@@ -0,0 +1,131 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace PhysIKA {
+
+	/*!
+	*	\class	ParticleCacheColumn
+	*	\brief	One per-particle attribute stored as num x components scalars.
+	*/
+	class ParticleCacheColumn
+	{
+	public:
+		enum ScalarType
+		{
+			Float32 = 0,
+			Float64 = 1,
+			Int32 = 2
+		};
+
+		static ScalarType scalarType(const float*) { return Float32; }
+		static ScalarType scalarType(const double*) { return Float64; }
+		static ScalarType scalarType(const int*) { return Int32; }
+
+		size_t scalarSize() const { return type == Float64 ? 8 : 4; }
+		size_t elementSize() const { return scalarSize() * components; }
+		size_t size() const { return data.size() / elementSize(); }
+
+		bool isFloatingPoint() const { return type != Int32; }
+
+		char* getDataPtr() { return data.data(); }
+		const char* getDataPtr() const { return data.data(); }
+
+		/**
+		 * @brief Convert all scalars to T, dst must hold size() x components values
+		 */
+		template<typename T>
+		void copyTo(T* dst) const
+		{
+			size_t n = size() * components;
+			for (size_t i = 0; i < n; i++)
+			{
+				switch (type)
+				{
+				case Float32: dst[i] = (T)((const float*)data.data())[i]; break;
+				case Float64: dst[i] = (T)((const double*)data.data())[i]; break;
+				case Int32: dst[i] = (T)((const int*)data.data())[i]; break;
+				}
+			}
+		}
+
+	public:
+		std::string name;
+		ScalarType type = Float32;
+		int components = 1;
+		std::vector<char> data;
+	};
+
+	/*!
+	*	\class	ParticleCacheFrame
+	*	\brief	All attributes of a particle set at one frame.
+	*/
+	class ParticleCacheFrame
+	{
+	public:
+		/**
+		 * @brief Add a column or resize the existing one with the same name, the memory of existing columns is reused
+		 * @note The returned reference is invalidated by the next call to addColumn()
+		 */
+		ParticleCacheColumn& addColumn(const std::string& name, ParticleCacheColumn::ScalarType type, int components, int num);
+
+		template<typename T>
+		ParticleCacheColumn& addColumn(const std::string& name, int components, int num)
+		{
+			return addColumn(name, ParticleCacheColumn::scalarType((const T*)nullptr), components, num);
+		}
+
+		ParticleCacheColumn* getColumn(const std::string& name);
+
+		/**
+		 * @brief Drop all columns but keep their memory for the next frame
+		 */
+		void clear();
+
+		/**
+		 * @brief Permute all columns so that particle i is stored at the index given by the id column
+		 * @return false if the id column is missing or does not hold a permutation of the particle indices
+		 */
+		bool restoreOrder(const std::string& idName = "id");
+
+	public:
+		int frame = 0;
+		float time = 0.0f;
+		int particleNum = 0;
+
+		std::vector<ParticleCacheColumn> columns;
+
+	private:
+		std::vector<ParticleCacheColumn> m_unused;
+	};
+
+	struct ParticleCacheOptions
+	{
+		bool quantize = false;		//!< Store floating point columns as 16-bit fixed point values relative to the bounds of each chunk
+		bool compress = true;		//!< Byte shuffling followed by LZ compression of each chunk
+		int chunkSize = 65536;		//!< Number of particles per chunk
+	};
+
+	/*!
+	*	\class	ParticleCache
+	*	\brief	Binary particle cache, one file per frame.
+	*
+	*	Layout: a header (magic "PCCH", version, frame, time, particle number, chunk size, column number), followed by the
+	*	columns. Each column starts with its name, scalar type, component number, encoding and byte size so that readers
+	*	can skip it, followed by its chunks of at most chunkSize particles. A chunk holds the per-component bounds if the
+	*	column is quantized, then the compression method, the raw and the stored size and the payload.
+	*/
+	class ParticleCache
+	{
+	public:
+		static bool write(const std::string& filename, const ParticleCacheFrame& frame, const ParticleCacheOptions& options = ParticleCacheOptions());
+
+		static bool read(const std::string& filename, ParticleCacheFrame& frame);
+
+		static void encode(const ParticleCacheFrame& frame, const ParticleCacheOptions& options, std::vector<char>& buffer);
+		static bool decode(const char* data, size_t size, ParticleCacheFrame& frame);
+
+		static void lzCompress(const char* src, size_t size, std::vector<char>& dst);
+		static bool lzDecompress(const char* src, size_t size, char* dst, size_t dstSize);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+#include "Dynamics/RigidBody/RigidBodyRoot.h"
+#include "Dynamics/RigidBody/RigidBody2.h"
+#include "Dynamics/RigidBody/Joint.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PhysIKA
+{
+	//Builds a rigid body tree for the tests, every test lays out its own joints with attach()
+	class RigidTreeBuilder
+	{
+	public:
+		RigidTreeBuilder(const std::string& name = "rigid_root")
+			: root(std::make_shared<RigidBodyRoot<DataType3f>>(name))
+		{
+		}
+
+		//A new body below parent, connected by joint. Bodies and joints are kept in the order they are attached.
+		RigidBody2_ptr attach(RigidBody2_ptr parent, std::shared_ptr<Joint> joint, const std::string& name = "link")
+		{
+			RigidBody2_ptr body = std::make_shared<RigidBody2<DataType3f>>(name);
+			parent->addChild(body);
+			joint->setRigidBody(parent.get(), body.get());
+			parent->addChildJoint(joint);
+			body->setParentJoint(joint.get());
+
+			bodies.push_back(body);
+			joints.push_back(joint);
+			return body;
+		}
+
+	public:
+		RigidBodyRoot_ptr root;
+		std::vector<RigidBody2_ptr> bodies;
+		std::vector<std::shared_ptr<Joint>> joints;
+	};
+}
@@ -0,0 +1,36 @@
+#include "gtest/gtest.h"
+#include "Core/Array/Array.h"
+
+using namespace PhysIKA;
+
+TEST(Array, append)
+{
+	HostArray<int> arr;
+	HostArray<int> block(3);
+	for (int i = 0; i < 3; i++)
+	{
+		block[i] = i;
+	}
+
+	for (int n = 0; n < 10; n++)
+	{
+		arr.append(block);
+	}
+	EXPECT_EQ(arr.size(), 30);
+	EXPECT_GE(arr.capacity(), 30);
+	for (int i = 0; i < 30; i++)
+	{
+		EXPECT_EQ(arr[i], i % 3);
+	}
+
+	arr.reserve(100);
+	EXPECT_EQ(arr.capacity(), 100);
+	EXPECT_EQ(arr[29], 2);
+
+	arr.shrinkToFit();
+	EXPECT_EQ(arr.capacity(), 30);
+	EXPECT_EQ(arr[28], 1);
+
+	arr.release();
+	block.release();
+}
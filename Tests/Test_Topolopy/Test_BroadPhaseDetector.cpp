@@ -0,0 +1,163 @@
+#include "gtest/gtest.h"
+#include "Dynamics/RigidBody/BroadPhaseDetector.h"
+#include "Dynamics/RigidBody/AABBTreeDetector.h"
+#include <algorithm>
+#include <random>
+#include <set>
+
+using namespace PhysIKA;
+
+typedef std::set<std::pair<int, int>> PairSet;
+
+static PairSet bruteForce(const std::vector<BoxAABB3d<float>>& boxes)
+{
+	PairSet pairs;
+	for (int i = 0; i < boxes.size(); ++i)
+	{
+		for (int j = i + 1; j < boxes.size(); ++j)
+		{
+			if (boxes[i].isIntersect(boxes[j]))
+			{
+				pairs.insert(std::make_pair(i, j));
+			}
+		}
+	}
+	return pairs;
+}
+
+static PairSet toSet(const std::vector<std::pair<int, int>>& pairs)
+{
+	PairSet result;
+	for (auto& p : pairs)
+	{
+		EXPECT_LT(p.first, p.second);
+		EXPECT_TRUE(result.insert(p).second);
+	}
+	return result;
+}
+
+static BoxAABB3d<float> randomBox(std::mt19937& gen)
+{
+	std::uniform_real_distribution<float> pos(0.0f, 10.0f);
+	std::uniform_real_distribution<float> size(0.1f, 1.0f);
+
+	float x = pos(gen), y = pos(gen), z = pos(gen);
+	float h = size(gen);
+	return BoxAABB3d<float>(x - h, y - h, z - h, x + h, y + h, z + h);
+}
+
+//Most boxes drift a little, a few jump to a random place
+static void moveBoxes(std::mt19937& gen, std::vector<BoxAABB3d<float>>& boxes)
+{
+	std::uniform_real_distribution<float> drift(-0.2f, 0.2f);
+	std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+	for (auto& box : boxes)
+	{
+		if (chance(gen) < 0.05f)
+		{
+			box = randomBox(gen);
+			continue;
+		}
+
+		float d[3] = { drift(gen), drift(gen), drift(gen) };
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			box.m_l[axis] += d[axis];
+			box.m_u[axis] += d[axis];
+		}
+	}
+}
+
+TEST(SortSweepDetector, matchBruteForce)
+{
+	std::mt19937 gen(5);
+
+	std::vector<BoxAABB3d<float>> boxes(300);
+	for (auto& box : boxes)
+	{
+		box = randomBox(gen);
+	}
+
+	SortSweepDetector<float> detector;
+	PairSet previous = toSet(detector.detect(boxes));
+	EXPECT_EQ(previous, bruteForce(boxes));
+
+	for (int frame = 0; frame < 30; ++frame)
+	{
+		moveBoxes(gen, boxes);
+
+		//A changed box number triggers the full sweep
+		if (frame == 10)
+		{
+			boxes.push_back(randomBox(gen));
+		}
+		if (frame == 20)
+		{
+			boxes.pop_back();
+			boxes.pop_back();
+		}
+
+		PairSet current = toSet(detector.detect(boxes));
+		ASSERT_EQ(current, bruteForce(boxes)) << "frame " << frame;
+
+		//The reported changes lead from the last result to the current one
+		PairSet updated = previous;
+		for (auto& p : detector.getRemovedPairs())
+		{
+			EXPECT_EQ(updated.erase(p), 1u);
+		}
+		for (auto& p : detector.getAddedPairs())
+		{
+			EXPECT_TRUE(updated.insert(p).second);
+		}
+		EXPECT_EQ(updated, current);
+
+		previous = current;
+	}
+
+	detector.reset();
+	EXPECT_EQ(toSet(detector.detect(boxes)), bruteForce(boxes));
+}
+
+TEST(AABBTreeDetector, matchBruteForce)
+{
+	std::mt19937 gen(9);
+
+	std::vector<BoxAABB3d<float>> boxes(300);
+	for (auto& box : boxes)
+	{
+		box = randomBox(gen);
+	}
+
+	AABBTreeDetector<float> detector;
+	detector.setMargin(0.05f, 0.1f);
+	EXPECT_EQ(toSet(detector.detect(boxes)), bruteForce(boxes));
+	EXPECT_EQ(detector.getMovedNum(), (int)boxes.size());
+
+	int moved = 0;
+	for (int frame = 0; frame < 30; ++frame)
+	{
+		moveBoxes(gen, boxes);
+
+		if (frame == 10)
+		{
+			boxes.push_back(randomBox(gen));
+		}
+		if (frame == 20)
+		{
+			boxes.pop_back();
+			boxes.pop_back();
+		}
+
+		ASSERT_EQ(toSet(detector.detect(boxes)), bruteForce(boxes)) << "frame " << frame;
+		moved += detector.getMovedNum();
+	}
+
+	//Boxes that stay inside their fattened bounds are not reinserted
+	EXPECT_LT(moved, 30 * (int)boxes.size());
+	EXPECT_GT(detector.getHeight(), 0);
+
+	detector.reset();
+	EXPECT_EQ(toSet(detector.detect(boxes)), bruteForce(boxes));
+}
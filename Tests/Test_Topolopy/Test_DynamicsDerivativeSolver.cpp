@@ -0,0 +1,315 @@
+#include "gtest/gtest.h"
+#include "Dynamics/RigidBody/RigidBodyRoot.h"
+#include "Dynamics/RigidBody/RevoluteJoint.h"
+#include "Dynamics/RigidBody/SphericalJoint.h"
+#include "Dynamics/RigidBody/PrismaticJoint.h"
+#include "Dynamics/RigidBody/FixedJoint.h"
+#include "Dynamics/RigidBody/DynamicsDerivativeSolver.h"
+#include "RigidTreeBuilder.h"
+#include <random>
+
+using namespace PhysIKA;
+
+//Hamilton product with w as the scalar part, the convention of Quaternion::get3x3Matrix()
+static Quaternion<float> product(const Quaternion<float>& a, const Quaternion<float>& b)
+{
+	return Quaternion<float>(
+		a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1],
+		a[3] * b[1] + a[1] * b[3] + a[2] * b[0] - a[0] * b[2],
+		a[3] * b[2] + a[2] * b[3] + a[0] * b[1] - a[1] * b[0],
+		a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2]);
+}
+
+//Torso on a spherical joint with a revolute limb ending in a fixed hand and a limb that mixes prismatic and revolute joints
+static RigidBodyRoot_ptr createBody()
+{
+	std::default_random_engine e(2);
+	std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+
+	RigidTreeBuilder tree;
+	RigidBodyRoot_ptr root = tree.root;
+
+	auto randomAxis = [&]() {
+		Vector3f axis(u(e), u(e), u(e));
+		return axis / axis.norm();
+	};
+
+	Vector3f half(0, -0.5f, 0);
+
+	auto torsoJoint = std::make_shared<SphericalJoint>("torso_joint");
+	RigidBody2_ptr torso = tree.attach(root, torsoJoint);
+	torsoJoint->setJointInfo(-half);
+
+	RigidBody2_ptr last = torso;
+	for (int j = 0; j < 2; ++j)
+	{
+		auto joint = std::make_shared<RevoluteJoint>("arm_joint");
+		last = tree.attach(last, joint);
+		joint->setJointInfo(randomAxis(), -half);
+	}
+	tree.attach(last, std::make_shared<FixedJoint>("hand_joint"));
+
+	auto slider = std::make_shared<PrismaticJoint>("leg_slider");
+	last = tree.attach(torso, slider);
+	slider->setJointInfo(randomAxis());
+
+	auto knee = std::make_shared<RevoluteJoint>("leg_joint");
+	last = tree.attach(last, knee);
+	knee->setJointInfo(randomAxis(), -half);
+
+	root->updateTree();
+
+	std::shared_ptr<SystemState> system_state = root->getSystemState();
+	std::shared_ptr<SystemMotionState> motion_state = system_state->m_motionState;
+	const std::vector<int>& idx_map = root->getJointIdxMap();
+	const std::vector<RigidBody2_ptr>& bodies = tree.bodies;
+	const std::vector<std::shared_ptr<Joint>>& joints = tree.joints;
+	for (int i = 0; i < bodies.size(); ++i)
+	{
+		int id = bodies[i]->getId();
+		motion_state->m_rel_r[id] = Vector3f(0.1f * u(e), -1.0f, 0.1f * u(e));
+		motion_state->m_rel_q[id] = Quaternion<float>(randomAxis(), u(e));
+		bodies[i]->setI(Inertia<float>(1.0f + 0.5f * u(e), Vector3f(0.1f, 0.05f, 0.12f)));
+
+		for (int k = 0; k < joints[i]->getJointDOF(); ++k)
+		{
+			motion_state->m_dq[idx_map[id] + k] = u(e);
+		}
+		system_state->m_externalForce[id] = SpatialVector<float>(0.2f * u(e), 0.2f * u(e), 0.2f * u(e), u(e), u(e), u(e));
+	}
+	motion_state->updateGlobalInfo();
+
+	//updateGlobalInfo() composes with Quaternion::operator*, which does not share the scalar convention of get3x3Matrix().
+	//Rebuild the world orientations from m_X so that they agree with the joint transforms.
+	const auto& all_node = root->getAllParentidNodePair();
+	for (int i = 0; i < all_node.size(); ++i)
+	{
+		Quaternion<float> c = motion_state->m_rel_q[i].getConjugate();
+		int parent_id = all_node[i].first;
+		if (parent_id >= 0)
+		{
+			c = product(c, motion_state->m_global_q[parent_id].getConjugate());
+		}
+		motion_state->m_global_q[i] = c.getConjugate();
+	}
+
+	return root;
+}
+
+//Copy of the system state that owns its motion state, so it can be perturbed
+static SystemState copyState(const SystemState& s)
+{
+	SystemState copy = s;
+	copy.m_motionState = std::make_shared<SystemMotionState>(*s.m_motionState);
+	return copy;
+}
+
+//Move the successor body of the joint of node i by eps * S, S expressed in the successor frame.
+//The frames the inverse dynamics reads are displaced directly: m_X of the joint and the world orientation of the subtree.
+static void displace(SystemMotionState& s, const std::vector<int>& parent, int i, const SpatialVector<float>& S, float eps)
+{
+	Vector3f w(S[0], S[1], S[2]);
+	Vector3f v(S[3], S[4], S[5]);
+
+	//Rotation from the old successor frame to the displaced one
+	Quaternion<float> d = w.norm() > 0 ? Quaternion<float>(w / w.norm(), -w.norm() * eps) : Quaternion<float>::Identity();
+	s.m_X[i] = Transform3d<float>(v * eps, d.get3x3Matrix()) * s.m_X[i];
+
+	//m_global_q is read through getConjugate(), c maps world to body coordinates
+	Quaternion<float> ci = s.m_global_q[i].getConjugate();
+	Quaternion<float> g = product(product(Quaternion<float>(-ci[0], -ci[1], -ci[2], ci[3]), d), ci);
+
+	std::vector<bool> subtree(parent.size(), false);
+	for (int j = i; j < parent.size(); ++j)
+	{
+		subtree[j] = j == i || (parent[j] >= 0 && subtree[parent[j]]);
+		if (subtree[j])
+		{
+			s.m_global_q[j] = product(s.m_global_q[j].getConjugate(), g).getConjugate();
+		}
+	}
+}
+
+static void expectColumn(const MatrixMN<float>& analytic, const Vectornd<float>& plus, const Vectornd<float>& minus, float eps, int col, const char* name)
+{
+	for (int row = 0; row < analytic.rows(); ++row)
+	{
+		float fd = (plus[row] - minus[row]) / (2 * eps);
+		EXPECT_NEAR(analytic(row, col), fd, 2e-2f * (1.0f + std::abs(fd))) << name << " (" << row << ", " << col << ")";
+	}
+}
+
+TEST(DynamicsDerivativeSolver, inverseDynamicsFiniteDifferences)
+{
+	RigidBodyRoot_ptr root = createBody();
+	const SystemState& system_state = *(root->getSystemState());
+	const auto& all_node = root->getAllParentidNodePair();
+	const std::vector<int>& idx_map = root->getJointIdxMap();
+	int n_dof = root->getJointDof();
+
+	std::vector<int> parent(all_node.size());
+	for (int i = 0; i < all_node.size(); ++i)
+	{
+		parent[i] = all_node[i].first;
+	}
+
+	Vectornd<float> ddq(n_dof);
+	for (int i = 0; i < n_dof; ++i)
+	{
+		ddq[i] = 0.3f * (i % 3) - 0.4f;
+	}
+
+	DynamicsDerivativeSolver solver(root.get());
+	solver.computeInverseDynamicsDerivatives(system_state, ddq);
+
+	MatrixMN<float> dtau_dq = solver.getDtauDq();
+	MatrixMN<float> dtau_ddqdot = solver.getDtauDdqdot();
+	MatrixMN<float> M = solver.getInertiaMatrix();
+
+	DynamicsDerivativeSolver probe(root.get());
+	Vectornd<float> plus, minus;
+	auto tauAt = [&](const SystemState& s, const Vectornd<float>& acc, Vectornd<float>& tau) {
+		probe.computeInverseDynamicsDerivatives(s, acc);
+		tau = probe.getTau();
+	};
+
+	const float eps = 1e-3f;
+	int checked = 0;
+	for (int i = 0; i < all_node.size(); ++i)
+	{
+		Joint* joint = all_node[i].second->getParentJoint();
+		if (joint->getJointDOF() == 0)
+		{
+			continue;
+		}
+		const SpatialVector<float>* S = joint->getJointSpace().getBases();
+		for (int k = 0; k < joint->getJointDOF(); ++k)
+		{
+			int col = idx_map[i] + k;
+
+			//q: displace the successor along the joint motion subspace
+			SystemState sp = copyState(system_state), sm = copyState(system_state);
+			displace(*sp.m_motionState, parent, i, S[k], eps);
+			displace(*sm.m_motionState, parent, i, S[k], -eps);
+			tauAt(sp, ddq, plus);
+			tauAt(sm, ddq, minus);
+			expectColumn(dtau_dq, plus, minus, eps, col, "dtau/dq");
+
+			//dq
+			sp = copyState(system_state);
+			sm = copyState(system_state);
+			sp.m_motionState->m_dq[col] += eps;
+			sm.m_motionState->m_dq[col] -= eps;
+			tauAt(sp, ddq, plus);
+			tauAt(sm, ddq, minus);
+			expectColumn(dtau_ddqdot, plus, minus, eps, col, "dtau/d(dq)");
+
+			//ddq
+			Vectornd<float> ddq_p = ddq, ddq_m = ddq;
+			ddq_p[col] += eps;
+			ddq_m[col] -= eps;
+			tauAt(system_state, ddq_p, plus);
+			tauAt(system_state, ddq_m, minus);
+			expectColumn(M, plus, minus, eps, col, "M");
+
+			checked++;
+		}
+	}
+	EXPECT_EQ(checked, n_dof);
+
+	//M is symmetric
+	for (int i = 0; i < n_dof; ++i)
+	{
+		for (int j = 0; j < i; ++j)
+		{
+			EXPECT_NEAR(M(i, j), M(j, i), 1e-4f);
+		}
+	}
+}
+
+TEST(DynamicsDerivativeSolver, forwardDynamics)
+{
+	RigidBodyRoot_ptr root = createBody();
+	const SystemState& system_state = *(root->getSystemState());
+	int n_dof = root->getJointDof();
+
+	Vectornd<float> tau(n_dof);
+	for (int i = 0; i < n_dof; ++i)
+	{
+		tau[i] = 0.5f - 0.2f * (i % 4);
+	}
+
+	DynamicsDerivativeSolver solver(root.get());
+	ASSERT_TRUE(solver.computeForwardDynamicsDerivatives(system_state, tau));
+
+	Vectornd<float> ddq = solver.getDdq();
+	MatrixMN<float> dddq_dq = solver.getDddqDq();
+	MatrixMN<float> dddq_ddqdot = solver.getDddqDdqdot();
+	MatrixMN<float> dddq_dtau = solver.getDddqDtau();
+
+	//The inverse dynamics at the solution reproduces tau
+	DynamicsDerivativeSolver probe(root.get());
+	probe.computeInverseDynamicsDerivatives(system_state, ddq);
+	const MatrixMN<float>& M = probe.getInertiaMatrix();
+	for (int i = 0; i < n_dof; ++i)
+	{
+		EXPECT_NEAR(probe.getTau()[i], tau[i], 1e-3f);
+	}
+
+	//d(ddq)/d(tau) = M^-1
+	for (int i = 0; i < n_dof; ++i)
+	{
+		for (int j = 0; j < n_dof; ++j)
+		{
+			float sum = 0;
+			for (int k = 0; k < n_dof; ++k)
+			{
+				sum += M(i, k) * dddq_dtau(k, j);
+			}
+			EXPECT_NEAR(sum, i == j ? 1.0f : 0.0f, 1e-3f);
+		}
+	}
+
+	//d(ddq)/d(dq) and d(ddq)/dq by central differences of the forward dynamics
+	const auto& all_node = root->getAllParentidNodePair();
+	const std::vector<int>& idx_map = root->getJointIdxMap();
+	std::vector<int> parent(all_node.size());
+	for (int i = 0; i < all_node.size(); ++i)
+	{
+		parent[i] = all_node[i].first;
+	}
+
+	const float eps = 1e-3f;
+	for (int i = 0; i < all_node.size(); ++i)
+	{
+		Joint* joint = all_node[i].second->getParentJoint();
+		if (joint->getJointDOF() == 0)
+		{
+			continue;
+		}
+		const SpatialVector<float>* S = joint->getJointSpace().getBases();
+		for (int k = 0; k < joint->getJointDOF(); ++k)
+		{
+			int col = idx_map[i] + k;
+
+			SystemState sp = copyState(system_state), sm = copyState(system_state);
+			sp.m_motionState->m_dq[col] += eps;
+			sm.m_motionState->m_dq[col] -= eps;
+			ASSERT_TRUE(probe.computeForwardDynamicsDerivatives(sp, tau));
+			Vectornd<float> plus = probe.getDdq();
+			ASSERT_TRUE(probe.computeForwardDynamicsDerivatives(sm, tau));
+			Vectornd<float> minus = probe.getDdq();
+			expectColumn(dddq_ddqdot, plus, minus, eps, col, "d(ddq)/d(dq)");
+
+			sp = copyState(system_state);
+			sm = copyState(system_state);
+			displace(*sp.m_motionState, parent, i, S[k], eps);
+			displace(*sm.m_motionState, parent, i, S[k], -eps);
+			ASSERT_TRUE(probe.computeForwardDynamicsDerivatives(sp, tau));
+			plus = probe.getDdq();
+			ASSERT_TRUE(probe.computeForwardDynamicsDerivatives(sm, tau));
+			minus = probe.getDdq();
+			expectColumn(dddq_dq, plus, minus, eps, col, "d(ddq)/dq");
+		}
+	}
+}
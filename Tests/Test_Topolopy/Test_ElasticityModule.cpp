@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+#include "Dynamics/ParticleSystem/ElasticityModule.h"
+#include "Core/Utility.h"
+#include <random>
+
+using namespace PhysIKA;
+
+typedef TPair<DataType3f> NPair;
+
+//A 4x4x4 lattice, every particle carries itself followed by its neighbors within the horizon
+static void createRestShape(HostArray<Vector3f>& rest, HostNeighborList<NPair>& restShapes, float spacing, float horizon)
+{
+	const int n = 4;
+	rest.resize(n * n * n);
+	for (int i = 0; i < n; i++)
+	{
+		for (int j = 0; j < n; j++)
+		{
+			for (int k = 0; k < n; k++)
+			{
+				rest[(i * n + j) * n + k] = Vector3f(i, j, k) * spacing;
+			}
+		}
+	}
+
+	int num = rest.size();
+	restShapes.resize(num, num);
+	for (int i = 0; i < num; i++)
+	{
+		int size = 0;
+		restShapes.setElement(i, size++, NPair(i, rest[i]));
+		for (int j = 0; j < num; j++)
+		{
+			if (j != i && (rest[j] - rest[i]).norm() < horizon)
+			{
+				restShapes.setElement(i, size++, NPair(j, rest[j]));
+			}
+		}
+		restShapes.setNeighborSize(i, size);
+	}
+}
+
+//Runs one host step on the compressed and jittered lattice, returns the positions
+static HostArray<Vector3f> solve(ElasticityModule<DataType3f>& module, float tolerance, float rho, int iterations = 50)
+{
+	const float spacing = 0.1f;
+	const float horizon = 0.25f;
+
+	HostArray<Vector3f> rest;
+	HostNeighborList<NPair> restShapes;
+	createRestShape(rest, restShapes, spacing, horizon);
+
+	std::mt19937 gen(3);
+	std::uniform_real_distribution<float> jitter(-0.01f, 0.01f);
+
+	int num = rest.size();
+	HostArray<Vector3f> position(num);
+	HostArray<Vector3f> velocity(num);
+	for (int i = 0; i < num; i++)
+	{
+		position[i] = rest[i] * 0.8f + Vector3f(jitter(gen), jitter(gen), jitter(gen));
+		velocity[i] = Vector3f(0.0f);
+	}
+
+	module.inHorizon()->setValue(horizon);
+	module.setMu(0.05f);
+	module.setLambda(0.1f);
+	module.setIterationNumber(iterations);
+	module.varTolerance()->setValue(tolerance);
+	module.varSpectralRadius()->setValue(rho);
+	module.constrain(position, velocity, restShapes, 0.01f);
+
+	return position;
+}
+
+TEST(ElasticityModule, fixedIterations)
+{
+	//Without a tolerance every iteration runs, also with acceleration
+	ElasticityModule<DataType3f> plain;
+	HostArray<Vector3f> expected = solve(plain, 0.0f, 0.0f);
+	EXPECT_EQ(plain.getLastIterationNumber(), 50);
+
+	ElasticityModule<DataType3f> accelerated;
+	solve(accelerated, 0.0f, 0.5f);
+	EXPECT_EQ(accelerated.getLastIterationNumber(), 50);
+
+	//Tracking without relaxation leaves the result unchanged
+
+	ElasticityModule<DataType3f> tracked;
+	HostArray<Vector3f> position = solve(tracked, 1e-30f, 0.0f);
+	EXPECT_EQ(tracked.getLastIterationNumber(), 50);
+
+	for (int i = 0; i < position.size(); i++)
+	{
+		EXPECT_EQ(position[i], expected[i]) << "particle " << i;
+	}
+}
+
+TEST(ElasticityModule, earlyExit)
+{
+	ElasticityModule<DataType3f> module;
+	HostArray<Vector3f> position = solve(module, 1e-2f, 0.0f);
+	int iterations = module.getLastIterationNumber();
+	EXPECT_GT(iterations, 0);
+	EXPECT_LT(iterations, 50);
+
+	//Same result as a fixed number of that many iterations
+	ElasticityModule<DataType3f> plain;
+	HostArray<Vector3f> expected = solve(plain, 0.0f, 0.0f, iterations);
+	EXPECT_EQ(plain.getLastIterationNumber(), iterations);
+
+	for (int i = 0; i < position.size(); i++)
+	{
+		EXPECT_EQ(position[i], expected[i]) << "particle " << i;
+	}
+}
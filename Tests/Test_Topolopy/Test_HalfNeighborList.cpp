@@ -0,0 +1,102 @@
+#include "gtest/gtest.h"
+#include "Dynamics/ParticleSystem/SummationDensity.h"
+#include "Dynamics/ParticleSystem/DensityPBD.h"
+#include "Framework/Topology/NeighborQuery.h"
+#include "Core/Utility.h"
+#include <random>
+
+using namespace PhysIKA;
+
+//A jittered block of 10x10x10 particles at the default sampling distance, slightly compressed
+static HostArray<Vector3f> createBlock()
+{
+	std::mt19937 gen(11);
+	std::uniform_real_distribution<float> jitter(-0.0005f, 0.0005f);
+
+	const int n = 10;
+	const float d = 0.0045f;
+	HostArray<Vector3f> pos(n * n * n);
+	for (int i = 0; i < n; i++)
+	{
+		for (int j = 0; j < n; j++)
+		{
+			for (int k = 0; k < n; k++)
+			{
+				pos[(i * n + j) * n + k] = Vector3f(0.1f) + Vector3f(i, j, k) * d + Vector3f(jitter(gen), jitter(gen), jitter(gen));
+			}
+		}
+	}
+	return pos;
+}
+
+static void queryNeighbors(HostNeighborList<int>& nbr, HostArray<Vector3f>& pos, float h, bool half)
+{
+	NeighborQuery<DataType3f> query(h, Vector3f(0.0f), Vector3f(0.3f));
+	query.varHalfList()->setValue(half);
+	query.queryParticleNeighbors(nbr, pos, h);
+	ASSERT_EQ(nbr.isHalf(), half);
+}
+
+static void expectNear(HostArray<float>& a, HostArray<float>& b, float tol)
+{
+	ASSERT_EQ(a.size(), b.size());
+	for (int i = 0; i < a.size(); i++)
+	{
+		EXPECT_NEAR(a[i], b[i], tol * std::max(std::abs(b[i]), 1.0f)) << "particle " << i;
+	}
+}
+
+TEST(HalfNeighborList, summationDensity)
+{
+	HostArray<Vector3f> pos = createBlock();
+	const float h = 0.011f;
+
+	HostNeighborList<int> full, half;
+	queryNeighbors(full, pos, h, false);
+	queryNeighbors(half, pos, h, true);
+
+	//Every pair is stored once, the full list also holds each particle itself
+	int pairs = 0;
+	for (int i = 0; i < pos.size(); i++)
+	{
+		pairs += half.getNeighborSize(i);
+	}
+	EXPECT_EQ(2 * pairs + pos.size(), full.getElements().size());
+
+	SummationDensity<DataType3f> summation;
+	summation.varSmoothingLength()->setValue(h);
+
+	HostArray<float> rhoFull(pos.size()), rhoHalf(pos.size());
+	summation.compute(rhoFull, pos, full);
+	summation.compute(rhoHalf, pos, half);
+	expectNear(rhoHalf, rhoFull, 1e-5f);
+}
+
+TEST(HalfNeighborList, densityPBD)
+{
+	HostArray<Vector3f> posFull = createBlock();
+	HostArray<Vector3f> posHalf = createBlock();
+	const float h = 0.011f;
+
+	HostNeighborList<int> full, half;
+	queryNeighbors(full, posFull, h, false);
+	queryNeighbors(half, posHalf, h, true);
+
+	HostArray<Vector3f> velFull(posFull.size()), velHalf(posHalf.size());
+	velFull.reset();
+	velHalf.reset();
+
+	DensityPBD<DataType3f> pbdFull, pbdHalf;
+	pbdFull.constrain(posFull, velFull, full, 0.001f);
+	pbdHalf.constrain(posHalf, velHalf, half, 0.001f);
+	EXPECT_EQ(pbdHalf.getLastIterationNumber(), pbdFull.getLastIterationNumber());
+
+	//Densities and lambdas of the last iteration, then the projected positions
+	expectNear(pbdHalf.getHostDensity(), pbdFull.getHostDensity(), 1e-5f);
+	expectNear(pbdHalf.getHostLambda(), pbdFull.getHostLambda(), 1e-4f);
+
+	for (int i = 0; i < posFull.size(); i++)
+	{
+		EXPECT_LT((posHalf[i] - posFull[i]).norm(), 1e-6f) << "particle " << i;
+	}
+}
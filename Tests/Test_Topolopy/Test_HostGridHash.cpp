@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include "Framework/Topology/HostGridHash.h"
+#include <random>
+
+using namespace PhysIKA;
+
+TEST(HostGridHash, construct)
+{
+	EXPECT_EQ(HostGridHash<DataType3f>::mortonCode(1, 0, 0), 1ull);
+	EXPECT_EQ(HostGridHash<DataType3f>::mortonCode(0, 1, 0), 2ull);
+	EXPECT_EQ(HostGridHash<DataType3f>::mortonCode(1, 1, 1), 7ull);
+	EXPECT_EQ(HostGridHash<DataType3f>::mortonCode(2, 0, 0), 8ull);
+
+	std::mt19937 gen(5);
+	std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+	const int num = 2000;
+	HostArray<Vector3f> pos(num);
+	for (int i = 0; i < num; i++)
+	{
+		pos[i] = Vector3f(dist(gen), dist(gen), dist(gen));
+	}
+
+	float h = 0.1f;
+	HostGridHash<DataType3f> hash;
+	hash.setSpace(h, Vector3f(0.0f), Vector3f(1.0f));
+	hash.construct(pos);
+	EXPECT_EQ(hash.particle_num, num);
+
+	//Each particle is found exactly once, in the cell it belongs to
+	std::vector<int> found(num, 0);
+	for (int r = 0; r < hash.num; r++)
+	{
+		for (int n = 0; n < hash.getCounter(r); n++)
+		{
+			int pId = hash.getParticleId(r, n);
+			EXPECT_EQ(hash.getIndex(pos[pId]), r);
+			found[pId]++;
+		}
+	}
+	for (int i = 0; i < num; i++)
+	{
+		EXPECT_EQ(found[i], 1);
+	}
+
+	//Neighbors gathered from the 27 surrounding cells match a brute-force search
+	for (int i = 0; i < num; i += 37)
+	{
+		int gi, gj, gk;
+		hash.getIndex3(pos[i], gi, gj, gk);
+
+		int counter = 0;
+		for (int di = -1; di <= 1; di++)
+			for (int dj = -1; dj <= 1; dj++)
+				for (int dk = -1; dk <= 1; dk++)
+				{
+					int cId = hash.getIndex(gi + di, gj + dj, gk + dk);
+					if (cId < 0) continue;
+					for (int n = 0; n < hash.getCounter(cId); n++)
+					{
+						if ((pos[i] - pos[hash.getParticleId(cId, n)]).norm() < h)
+							counter++;
+					}
+				}
+
+		int expected = 0;
+		for (int j = 0; j < num; j++)
+		{
+			if ((pos[i] - pos[j]).norm() < h)
+				expected++;
+		}
+		EXPECT_EQ(counter, expected);
+	}
+
+	pos.release();
+}
@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+#include "Framework/Framework/IOPipeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace PhysIKA;
+
+TEST(IOPipeline, backpressure)
+{
+	IOPipeline& io = IOPipeline::getInstance();
+	io.setThreadNumber(1);
+	io.setCapacity(2);
+	io.setOverflowPolicy(IOPipeline::Block);
+	io.resetMetrics();
+
+	std::atomic<int> done(0);
+	for (int i = 0; i < 10; i++)
+	{
+		EXPECT_TRUE(io.submit([&]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			done++;
+			return true;
+		}));
+		EXPECT_LE(io.getQueueDepth(), 2);
+	}
+	io.flush();
+
+	EXPECT_EQ(done, 10);
+	EXPECT_EQ(io.getCompletedNumber(), 10);
+	EXPECT_EQ(io.getDroppedNumber(), 0);
+	EXPECT_LE(io.getPeakQueueDepth(), 2);
+	EXPECT_GT(io.getBlockedTime(), 0.0);
+}
+
+TEST(IOPipeline, dropFrames)
+{
+	IOPipeline& io = IOPipeline::getInstance();
+	io.setThreadNumber(1);
+	io.setCapacity(2);
+	io.setOverflowPolicy(IOPipeline::DropNewest);
+	io.resetMetrics();
+
+	std::atomic<bool> release(false);
+	io.submit([&]() {
+		while (!release) std::this_thread::yield();
+		return true;
+	});
+
+	//Wait until the writer holds the blocking task, then fill the queue
+	while (io.getQueueDepth() > 0) std::this_thread::yield();
+	EXPECT_TRUE(io.submit([]() { return true; }));
+	EXPECT_TRUE(io.submit([]() { return false; }));
+	EXPECT_FALSE(io.submit([]() { return true; }));
+
+	release = true;
+	io.flush();
+
+	EXPECT_EQ(io.getSubmittedNumber(), 4);
+	EXPECT_EQ(io.getDroppedNumber(), 1);
+	EXPECT_EQ(io.getCompletedNumber(), 3);
+	EXPECT_EQ(io.getFailedNumber(), 1);
+
+	io.setOverflowPolicy(IOPipeline::Block);
+	io.setCapacity(8);
+	io.setThreadNumber(2);
+}
+
+TEST(IOBufferPool, reuse)
+{
+	IOBufferPool<std::vector<int>> pool;
+
+	std::vector<int>* first;
+	{
+		auto buffer = pool.acquire();
+		buffer->resize(100);
+		first = buffer.get();
+	}
+
+	auto buffer = pool.acquire();
+	EXPECT_EQ(buffer.get(), first);
+	EXPECT_EQ(buffer->size(), 100);
+}
@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "Dynamics/ParticleSystem/Kernel.h"
+
+using namespace PhysIKA;
+
+TEST(Kernel, policies)
+{
+	const float h = 0.011f;
+	SpikyKernel<float> spiky;
+	SmoothKernel<float> smooth;
+	CubicKernel<float> cubic;
+
+	KernelFunction<float, SpikyPolicy<float>> spikyFunc(h);
+	KernelFunction<float, SmoothPolicy<float>> smoothFunc(h);
+	KernelFunction<float, CubicPolicy<float>> cubicFunc(h);
+	KernelFunction<float, WendlandPolicy<float>> wendland(h);
+
+	for (int i = 0; i <= 60; i++)
+	{
+		float r = 0.025f * i * h;
+		float tol = 1e-5f * spikyFunc.weight(0.0f);
+		EXPECT_NEAR(spikyFunc.weight(r), spiky.Weight(r, h), tol);
+		EXPECT_NEAR(spikyFunc.gradient(r), spiky.Gradient(r, h), 3 * tol);
+		EXPECT_NEAR(smoothFunc.weight(r), smooth.Weight(r, h), 1e-5f);
+		EXPECT_NEAR(smoothFunc.gradient(r), smooth.Gradient(r, h), 1e-5f);
+		EXPECT_NEAR(cubicFunc.weight(r), cubic.Weight(r, h), tol);
+		EXPECT_NEAR(cubicFunc.gradient(r), cubic.Gradient(r, h), tol);
+	}
+
+	EXPECT_EQ(wendland.weight(1.01f*h), 0.0f);
+	EXPECT_FLOAT_EQ(wendland.gradient(0.0f), 0.0f);
+
+	//Finite difference of the Wendland weight with respect to q
+	float q = 0.4f;
+	float dq = 1e-3f;
+	float fd = (wendland.weight((q + dq)*h) - wendland.weight((q - dq)*h)) / (2 * dq);
+	EXPECT_NEAR(wendland.gradient(q*h), fd, 1e-3f*std::abs(fd));
+
+	//The viscosity weight is linear in 1-q
+	KernelFunction<float, ViscosityPolicy<float>> viscosity(h);
+	float scale = 45.0f / (13.0f * (float)M_PI * h*h*h);
+	EXPECT_NEAR(viscosity.weight(0.25f*h), 0.75f*scale, 1e-5f*scale);
+	EXPECT_EQ(viscosity.weight(1.01f*h), 0.0f);
+	EXPECT_FLOAT_EQ(viscosity.gradient(0.5f*h), -scale);
+}
+
+TEST(Kernel, batched)
+{
+	const float h = 0.011f;
+	KernelFunction<float, SpikyPolicy<float>> kern(h);
+	TabulatedKernel<float, SpikyPolicy<float>, 256> table(h);
+
+	const int n = 37;
+	float r[n];
+	float w[n];
+	float wt[n];
+	float g[n];
+	for (int i = 0; i < n; i++)
+	{
+		r[i] = 1.2f * h * i / (n - 1);
+	}
+
+	kern.evaluate(r, w, n);
+	kern.evaluateGradient(r, g, n);
+	table.evaluate(r, wt, n);
+	for (int i = 0; i < n; i++)
+	{
+		EXPECT_FLOAT_EQ(w[i], kern.weight(r[i]));
+		EXPECT_FLOAT_EQ(g[i], kern.gradient(r[i]));
+		EXPECT_NEAR(wt[i], w[i], 1e-4f * kern.weight(0.0f));
+	}
+	EXPECT_EQ(w[n - 1], 0.0f);
+	EXPECT_EQ(wt[n - 1], 0.0f);
+}
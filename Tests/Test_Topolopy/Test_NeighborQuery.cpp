@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "Framework/Topology/NeighborQuery.h"
+#include "Core/Utility.h"
+#include <random>
+
+using namespace PhysIKA;
+
+TEST(NeighborQuery, skinReuse)
+{
+	std::mt19937 gen(7);
+	std::uniform_real_distribution<float> dist(0.2f, 0.8f);
+
+	const int num = 1000;
+	HostArray<Vector3f> pos(num);
+	for (int i = 0; i < num; i++)
+	{
+		pos[i] = Vector3f(dist(gen), dist(gen), dist(gen));
+	}
+
+	NeighborQuery<DataType3f> query(0.05f, Vector3f(0.0f), Vector3f(1.0f));
+	query.varSkin()->setValue(0.02f);
+	query.inPosition()->setElementCount(num);
+	Function1Pt::copy(query.inPosition()->getValue(), pos);
+
+	//initialize() always builds the list
+	ASSERT_TRUE(query.initialize());
+	EXPECT_EQ(query.getRebuildCount(), 1);
+
+	//No motion, the list is reused
+	query.compute();
+	EXPECT_EQ(query.getQueryCount(), 2);
+	EXPECT_EQ(query.getRebuildCount(), 1);
+
+	//Every particle moves less than Skin / 2
+	for (int i = 0; i < num; i++)
+	{
+		pos[i] += Vector3f(0.005f, 0.0f, 0.0f);
+	}
+	Function1Pt::copy(query.inPosition()->getValue(), pos);
+	query.compute();
+	EXPECT_EQ(query.getRebuildCount(), 1);
+
+	//A single particle moving farther than Skin / 2 triggers a rebuild
+	pos[num / 2] += Vector3f(0.0f, 0.015f, 0.0f);
+	Function1Pt::copy(query.inPosition()->getValue(), pos);
+	query.compute();
+	EXPECT_EQ(query.getRebuildCount(), 2);
+
+	query.compute();
+	EXPECT_EQ(query.getRebuildCount(), 2);
+
+	//An explicit invalidation rebuilds without any motion
+	query.invalidate();
+	query.compute();
+	EXPECT_EQ(query.getRebuildCount(), 3);
+
+	//So does a change of the particle number
+	HostArray<Vector3f> extra(10);
+	for (int i = 0; i < 10; i++)
+	{
+		extra[i] = Vector3f(dist(gen), dist(gen), dist(gen));
+	}
+	DeviceArray<Vector3f> deviceExtra(10);
+	Function1Pt::copy(deviceExtra, extra);
+	query.inPosition()->append(deviceExtra);
+
+	query.compute();
+	EXPECT_EQ(query.getRebuildCount(), 4);
+	EXPECT_EQ(query.outNeighborhood()->getElementCount(), num + 10u);
+
+	pos.release();
+	extra.release();
+	deviceExtra.release();
+}
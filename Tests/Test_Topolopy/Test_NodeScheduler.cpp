@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include "Framework/Framework/Node.h"
+#include "Framework/Framework/NodeScheduler.h"
+#include "Framework/Action/Action.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+using namespace PhysIKA;
+
+class RecordAct : public Action
+{
+public:
+	void process(Node* node) override
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		order[node->getName()] = counter++;
+	}
+
+	void end(Node* node) override
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ends[node->getName()] = counter++;
+	}
+
+	std::mutex mutex;
+	std::map<std::string, int> order;
+	std::map<std::string, int> ends;
+	int counter = 0;
+};
+
+TEST(NodeScheduler, dependencies)
+{
+	std::shared_ptr<Node> root = std::make_shared<Node>("root");
+	std::shared_ptr<Node> a = root->addChild(std::make_shared<Node>("a"));
+	std::shared_ptr<Node> b = root->addChild(std::make_shared<Node>("b"));
+	std::shared_ptr<Node> c = b->addChild(std::make_shared<Node>("c"));
+	std::shared_ptr<Node> d = root->addChild(std::make_shared<Node>("d"));
+
+	NodeScheduler scheduler;
+	scheduler.build(root.get());
+	EXPECT_EQ(scheduler.getNodeNum(), 5);
+
+	//Independent subtrees: root | a, b, d | c
+	RecordAct act;
+	scheduler.traverse(&act);
+	EXPECT_EQ(scheduler.getRoundNum(), 3);
+	EXPECT_EQ(act.order.size(), 5u);
+	EXPECT_EQ(act.order["root"], 0);
+	EXPECT_LT(act.order["b"], act.order["c"]);
+
+	//A connection from d to c orders them as in the serial traversal: root, a, b, c, d
+	d->varScale()->connectPtr(c->varScale());
+	scheduler.build(root.get());
+
+	RecordAct linked;
+	scheduler.traverse(&linked);
+	EXPECT_EQ(scheduler.getRoundNum(), 4);
+	EXPECT_LT(linked.order["c"], linked.order["d"]);
+}
+
+
+TEST(NodeScheduler, endAfterSubtree)
+{
+	std::shared_ptr<Node> root = std::make_shared<Node>("root");
+	std::shared_ptr<Node> a = root->addChild(std::make_shared<Node>("a"));
+	std::shared_ptr<Node> b = root->addChild(std::make_shared<Node>("b"));
+	std::shared_ptr<Node> c = b->addChild(std::make_shared<Node>("c"));
+	std::shared_ptr<Node> d = root->addChild(std::make_shared<Node>("d"));
+
+	NodeScheduler scheduler;
+	scheduler.build(root.get());
+
+	RecordAct act;
+	scheduler.traverse(&act);
+	EXPECT_EQ(act.ends.size(), 5u);
+	EXPECT_LT(act.order["c"], act.ends["c"]);
+	EXPECT_LT(act.ends["c"], act.ends["b"]);
+	EXPECT_EQ(act.ends["root"], 9);
+
+	//d depends on b outside of the subtree of b, it waits for the end of b and so for c
+	d->varScale()->connectPtr(b->varScale());
+	scheduler.build(root.get());
+
+	RecordAct linked;
+	scheduler.traverse(&linked);
+	EXPECT_EQ(scheduler.getRoundNum(), 4);
+	EXPECT_LT(linked.ends["c"], linked.ends["b"]);
+	EXPECT_LT(linked.ends["b"], linked.order["d"]);
+	EXPECT_EQ(linked.ends["root"], 9);
+}
+
+TEST(NodeScheduler, update)
+{
+	std::shared_ptr<Node> root = std::make_shared<Node>("root");
+	std::shared_ptr<Node> a = root->addChild(std::make_shared<Node>("a"));
+	std::shared_ptr<Node> b = root->addChild(std::make_shared<Node>("b"));
+
+	NodeScheduler scheduler;
+	EXPECT_TRUE(scheduler.update(root.get()));
+	EXPECT_FALSE(scheduler.update(root.get()));
+
+	//A new connection, a new child
+	b->varScale()->connectPtr(a->varScale());
+	EXPECT_TRUE(scheduler.update(root.get()));
+	EXPECT_FALSE(scheduler.update(root.get()));
+
+	a->addChild(std::make_shared<Node>("c"));
+	EXPECT_TRUE(scheduler.update(root.get()));
+	EXPECT_EQ(scheduler.getNodeNum(), 4);
+	EXPECT_FALSE(scheduler.update(root.get()));
+}
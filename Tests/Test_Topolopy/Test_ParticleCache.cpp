@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+#include "IO/Particle_IO/ParticleCache.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace PhysIKA;
+
+static void createFrame(ParticleCacheFrame& frame, int num)
+{
+	frame.addColumn<float>("position", 3, num);
+	frame.addColumn<int>("id", 1, num);
+
+	float* p = (float*)frame.getColumn("position")->getDataPtr();
+	int* ids = (int*)frame.getColumn("id")->getDataPtr();
+	for (int i = 0; i < num; i++)
+	{
+		p[3 * i] = 0.01f * (i % 37);
+		p[3 * i + 1] = 0.02f * (i / 37);
+		p[3 * i + 2] = std::sin(0.1f * i);
+		ids[i] = num - 1 - i;
+	}
+}
+
+TEST(ParticleCache, lz)
+{
+	std::vector<char> src(100000);
+	for (size_t i = 0; i < src.size(); i++)
+	{
+		src[i] = i < 50000 ? (char)(i % 7) : (char)(rand() & 0xff);
+	}
+
+	std::vector<char> compressed;
+	ParticleCache::lzCompress(src.data(), src.size(), compressed);
+	EXPECT_LT(compressed.size(), src.size());
+
+	std::vector<char> dst(src.size());
+	EXPECT_TRUE(ParticleCache::lzDecompress(compressed.data(), compressed.size(), dst.data(), dst.size()));
+	EXPECT_EQ(src, dst);
+
+	EXPECT_FALSE(ParticleCache::lzDecompress(compressed.data(), compressed.size() / 2, dst.data(), dst.size()));
+}
+
+TEST(ParticleCache, roundTrip)
+{
+	int num = 5000;
+	ParticleCacheFrame frame;
+	frame.frame = 7;
+	createFrame(frame, num);
+
+	ParticleCacheOptions options;
+	options.chunkSize = 1024;
+
+	for (int quantize = 0; quantize < 2; quantize++)
+	{
+		options.quantize = quantize == 1;
+
+		std::vector<char> buffer;
+		ParticleCache::encode(frame, options, buffer);
+
+		ParticleCacheFrame result;
+		ASSERT_TRUE(ParticleCache::decode(buffer.data(), buffer.size(), result));
+		EXPECT_EQ(result.frame, 7);
+		EXPECT_EQ(result.particleNum, num);
+
+		ParticleCacheColumn* pos = result.getColumn("position");
+		ParticleCacheColumn* id = result.getColumn("id");
+		ASSERT_TRUE(pos != nullptr && id != nullptr);
+		EXPECT_EQ(id->data, frame.getColumn("id")->data);
+
+		const float* expected = (const float*)frame.getColumn("position")->getDataPtr();
+		const float* actual = (const float*)pos->getDataPtr();
+		for (int i = 0; i < 3 * num; i++)
+		{
+			EXPECT_NEAR(actual[i], expected[i], options.quantize ? 1e-4 : 0.0);
+		}
+	}
+
+	ASSERT_TRUE(frame.restoreOrder());
+	EXPECT_EQ(((int*)frame.getColumn("id")->getDataPtr())[0], 0);
+	EXPECT_FLOAT_EQ(((float*)frame.getColumn("position")->getDataPtr())[3 * (num - 1)], 0.0f);
+}
+
+TEST(ParticleCache, longName)
+{
+	//Names longer than 255 characters are truncated without corrupting the following columns
+	ParticleCacheFrame frame;
+	std::string name(300, 'x');
+	frame.addColumn<float>(name, 1, 10);
+	createFrame(frame, 10);
+
+	std::vector<char> buffer;
+	ParticleCache::encode(frame, ParticleCacheOptions(), buffer);
+
+	ParticleCacheFrame result;
+	ASSERT_TRUE(ParticleCache::decode(buffer.data(), buffer.size(), result));
+	EXPECT_TRUE(result.getColumn(name.substr(0, 255)) != nullptr);
+	ASSERT_TRUE(result.getColumn("id") != nullptr);
+	EXPECT_EQ(result.getColumn("id")->data, frame.getColumn("id")->data);
+}
+
+TEST(ParticleCache, restoreOrder)
+{
+	ParticleCacheFrame frame;
+	createFrame(frame, 10);
+
+	//A duplicate id is rejected and leaves the columns untouched
+	int* ids = (int*)frame.getColumn("id")->getDataPtr();
+	ids[3] = ids[4];
+	std::vector<char> position = frame.getColumn("position")->data;
+	EXPECT_FALSE(frame.restoreOrder());
+	EXPECT_EQ(frame.getColumn("position")->data, position);
+
+	ids[3] = 20;
+	EXPECT_FALSE(frame.restoreOrder());
+}
@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+#include "Dynamics/ParticleSystem/ParticleFluid.h"
+#include "Dynamics/ParticleSystem/PositionBasedFluidModel.h"
+#include "Dynamics/ParticleSystem/ParticleEmitter.h"
+#include "Dynamics/ParticleSystem/ParticleReorder.h"
+#include "Framework/Topology/NeighborQuery.h"
+#include "Framework/Framework/SceneGraph.h"
+#include "Framework/Action/ActInit.h"
+#include "Framework/Action/ActAnimate.h"
+
+#include <cmath>
+
+using namespace PhysIKA;
+
+//Drops a 4x4 layer of resting particles every frame, each layer one spacing below the previous one
+class LayerEmitter : public ParticleEmitter<DataType3f>
+{
+public:
+	void generateParticles() override
+	{
+		const int n = 4;
+		const float d = 0.005f;
+		HostArray<Vector3f> pos(n * n);
+		HostArray<Vector3f> vel(n * n);
+		for (int i = 0; i < n; i++)
+		{
+			for (int k = 0; k < n; k++)
+			{
+				pos[i * n + k] = Vector3f(0.5f + i * d, layerHeight(m_layer), 0.5f + k * d);
+				vel[i * n + k] = Vector3f(0.0f);
+			}
+		}
+		m_layer++;
+
+		gen_pos.resize(n * n);
+		gen_vel.resize(n * n);
+		Function1Pt::copy(gen_pos, pos);
+		Function1Pt::copy(gen_vel, vel);
+
+		pos.release();
+		vel.release();
+	}
+
+	static float layerHeight(int layer) { return 0.5f - 0.005f * layer; }
+
+private:
+	int m_layer = 0;
+};
+
+TEST(ParticleFluid, cpuContext)
+{
+	auto fluid = std::make_shared<ParticleFluid<DataType3f>>("fluid");
+
+	//The context is selected before the particles are loaded, they are then kept on the host
+	auto context = std::make_shared<DeviceContext>();
+	context->setDeviceType(DeviceType::CPU);
+	fluid->setContext(context);
+
+	fluid->loadParticles(Vector3f(0.5f), Vector3f(0.53f), 0.005f);
+	fluid->setDt(0.001f);
+	fluid->traverseBottomUp<InitAct>();
+
+	auto position = fluid->currentPosition();
+	ASSERT_TRUE(position->isHostStorage());
+	EXPECT_EQ(position->getReference(), nullptr);
+
+	int num = position->getElementCount();
+	ASSERT_GT(num, 0);
+
+	float yStart = 0.0f;
+	for (int i = 0; i < num; i++)
+	{
+		yStart += position->getHostValue()[i][1];
+	}
+	yStart /= num;
+
+	const int steps = 10;
+	for (int n = 0; n < steps; n++)
+	{
+		fluid->traverseTopDown<AnimateAct>(fluid->getDt());
+	}
+
+	auto pbf = TypeInfo::CastPointerDown<PositionBasedFluidModel<DataType3f>>(fluid->getNumericalModel());
+	ASSERT_NE(pbf, nullptr);
+
+	//Neighbors and densities were computed on the host
+	auto neighbors = pbf->getNeighborQuery()->outNeighborhood();
+	ASSERT_TRUE(neighbors->isHostStorage());
+	EXPECT_EQ(neighbors->getHostValue().size(), num);
+	EXPECT_EQ(pbf->getNeighborQuery()->getRebuildCount(), steps + 1);
+
+	auto density = pbf->getDensityField();
+	ASSERT_TRUE(density->isHostStorage());
+	ASSERT_EQ(density->getElementCount(), num);
+	for (int i = 0; i < num; i++)
+	{
+		EXPECT_GT(density->getHostValue()[i], 0.0f) << "particle " << i;
+	}
+
+	//The pairwise corrections leave the center of mass in free fall
+	float yEnd = 0.0f;
+	for (int i = 0; i < num; i++)
+	{
+		Vector3f p = position->getHostValue()[i];
+		ASSERT_TRUE(std::isfinite(p[0]) && std::isfinite(p[1]) && std::isfinite(p[2])) << "particle " << i;
+		yEnd += p[1];
+	}
+	yEnd /= num;
+
+	float g = -SceneGraph::getInstance().getGravity()[1];
+	float dt = fluid->getDt();
+	float fall = g * dt * dt * steps * (steps + 1) / 2;
+	EXPECT_NEAR(yStart - yEnd, fall, 0.2f * fall);
+}
+
+TEST(ParticleFluid, emitter)
+{
+	auto fluid = std::make_shared<ParticleFluid<DataType3f>>("fluid");
+	auto emitter = std::make_shared<LayerEmitter>();
+	fluid->addParticleEmitter(emitter);
+
+	auto pbf = TypeInfo::CastPointerDown<PositionBasedFluidModel<DataType3f>>(fluid->getNumericalModel());
+	ASSERT_NE(pbf, nullptr);
+	pbf->setReorderInterval(2);
+
+	fluid->setDt(0.001f);
+	fluid->traverseBottomUp<InitAct>();
+
+	const int steps = 6;
+	for (int n = 0; n < steps; n++)
+	{
+		fluid->traverseTopDown<AnimateAct>(fluid->getDt());
+	}
+
+	//Every frame appends one layer to the fluid, the emitter itself keeps none of them
+	int num = fluid->currentPosition()->getElementCount();
+	EXPECT_EQ(num, steps * 16);
+	EXPECT_EQ(fluid->currentVelocity()->getElementCount(), num);
+	EXPECT_EQ(fluid->currentForce()->getElementCount(), num);
+	EXPECT_EQ(emitter->currentPosition()->getElementCount(), 0);
+
+	//Sorting is not turned off by the emitter
+	EXPECT_EQ(pbf->getReorderModule()->varInterval()->getValue(), 2);
+	EXPECT_GT(pbf->getReorderModule()->getReorderCount(), 0);
+
+	//Every layer fell from where it was emitted, none was reset to its initial position
+	HostArray<Vector3f> position(num);
+	Function1Pt::copy(position, fluid->currentPosition()->getValue());
+
+	float yEmitted = 0.0f;
+	for (int n = 0; n < steps; n++)
+	{
+		yEmitted += 16 * LayerEmitter::layerHeight(n);
+	}
+
+	float ySum = 0.0f;
+	for (int i = 0; i < num; i++)
+	{
+		Vector3f p = position[i];
+		ASSERT_TRUE(std::isfinite(p[0]) && std::isfinite(p[1]) && std::isfinite(p[2])) << "particle " << i;
+		ySum += p[1];
+	}
+	EXPECT_LT(ySum, yEmitted);
+
+	position.release();
+}
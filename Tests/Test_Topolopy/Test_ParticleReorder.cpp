@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+#include "Dynamics/ParticleSystem/ParticleReorder.h"
+#include "Core/Utility.h"
+#include <random>
+
+using namespace PhysIKA;
+
+TEST(ParticleReorder, roundTrip)
+{
+	std::mt19937 gen(11);
+	std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+
+	const int num = 3000;
+	HostArray<Vector3f> pos(num);
+	HostArray<Vector3f> vel(num);
+	HostArray<float> mass(num);
+	for (int i = 0; i < num; i++)
+	{
+		pos[i] = Vector3f(dist(gen), dist(gen), dist(gen));
+		vel[i] = Vector3f(float(i), -float(i), 0.5f * i);
+		mass[i] = 1.0f + i;
+	}
+
+	const float h = 0.05f;
+	VarField<float> cellSize;
+	cellSize.setValue(h);
+
+	DeviceArrayField<Vector3f> position;
+	DeviceArrayField<Vector3f> velocity;
+	DeviceArrayField<float> massField;
+	position.setElementCount(num);
+	velocity.setElementCount(num);
+	massField.setElementCount(num);
+	Function1Pt::copy(position.getValue(), pos);
+	Function1Pt::copy(velocity.getValue(), vel);
+	Function1Pt::copy(massField.getValue(), mass);
+
+	ParticleReorder<DataType3f> reorder;
+	cellSize.connect(reorder.inCellSize());
+	position.connect(reorder.inPosition());
+	velocity.connect(reorder.inVelocity());
+	reorder.attachParticleField(&massField);
+	ASSERT_TRUE(reorder.initialize());
+
+	reorder.reorder();
+	EXPECT_EQ(reorder.getReorderCount(), 1);
+
+	HostArray<Vector3f> sortedPos(num);
+	HostArray<Vector3f> sortedVel(num);
+	HostArray<float> sortedMass(num);
+	HostArray<int> ids(num);
+	Function1Pt::copy(sortedPos, position.getValue());
+	Function1Pt::copy(sortedVel, velocity.getValue());
+	Function1Pt::copy(sortedMass, massField.getValue());
+	Function1Pt::copy(ids, reorder.outParticleId()->getValue());
+
+	//Every field is permuted by the same order, and the ids form a permutation
+	std::vector<int> seen(num, 0);
+	for (int i = 0; i < num; i++)
+	{
+		int id = ids[i];
+		ASSERT_GE(id, 0);
+		ASSERT_LT(id, num);
+		seen[id]++;
+
+		EXPECT_EQ(sortedPos[i], pos[id]);
+		EXPECT_EQ(sortedVel[i], vel[id]);
+		EXPECT_EQ(sortedMass[i], mass[id]);
+	}
+	for (int i = 0; i < num; i++)
+	{
+		EXPECT_EQ(seen[i], 1);
+	}
+
+	//Particles sharing a cell end up next to each other
+	auto cellOf = [h](const Vector3f& p) {
+		return Vector3f(floor(p[0] / h), floor(p[1] / h), floor(p[2] / h));
+	};
+	int changes = 0;
+	for (int i = 1; i < num; i++)
+	{
+		if (!(cellOf(sortedPos[i]) == cellOf(sortedPos[i - 1])))
+			changes++;
+	}
+	int cells = 0;
+	{
+		std::vector<Vector3f> visited;
+		for (int i = 0; i < num; i++)
+		{
+			Vector3f c = cellOf(pos[i]);
+			bool found = false;
+			for (auto& v : visited)
+			{
+				if (v == c) { found = true; break; }
+			}
+			if (!found) visited.push_back(c);
+		}
+		cells = (int)visited.size();
+	}
+	EXPECT_EQ(changes, cells - 1);
+
+	//Scattering back through the ids is the inverse permutation
+	HostArray<Vector3f> restoredPos(num);
+	HostArray<float> restoredMass(num);
+	for (int i = 0; i < num; i++)
+	{
+		restoredPos[ids[i]] = sortedPos[i];
+		restoredMass[ids[i]] = sortedMass[i];
+	}
+	for (int i = 0; i < num; i++)
+	{
+		EXPECT_EQ(restoredPos[i], pos[i]);
+		EXPECT_EQ(restoredMass[i], mass[i]);
+	}
+
+	pos.release();
+	vel.release();
+	mass.release();
+	sortedPos.release();
+	sortedVel.release();
+	sortedMass.release();
+	ids.release();
+	restoredPos.release();
+	restoredMass.release();
+}
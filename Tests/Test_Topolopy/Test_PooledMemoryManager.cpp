@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+#include "Core/Array/Array.h"
+#include "Core/Array/PooledMemoryManager.h"
+#include <thread>
+#include <vector>
+
+using namespace PhysIKA;
+
+TEST(PooledMemoryManager, reuse)
+{
+	auto pool = std::make_shared<PooledMemoryManager<DeviceType::CPU>>();
+
+	EXPECT_EQ(PooledMemoryManager<DeviceType::CPU>::roundUp(1), size_t(256));
+	EXPECT_EQ(PooledMemoryManager<DeviceType::CPU>::roundUp(1000), size_t(1024));
+
+	HostArray<float> arr(pool);
+	arr.resize(1000);
+	EXPECT_EQ(arr.capacity(), 1000);
+
+	arr.resize(500);
+	EXPECT_EQ(arr.size(), 500);
+	EXPECT_EQ(arr.capacity(), 1000);
+
+	arr.resize(2000);
+	arr.release();
+
+	//The block released above serves the next request of the same size class
+	HostArray<float> arr2(1800, pool);
+
+	PoolStatistics stat = pool->getStatistics();
+	EXPECT_EQ(stat.requests, size_t(3));
+	EXPECT_EQ(stat.hits, size_t(1));
+	EXPECT_EQ(stat.bytesInUse, size_t(8192));
+	EXPECT_EQ(stat.peakBytes, size_t(8192));
+
+	arr2.release();
+	pool->trim();
+	EXPECT_EQ(pool->getStatistics().bytesReserved, size_t(0));
+}
+
+TEST(PooledMemoryManager, threads)
+{
+	auto pool = std::make_shared<PooledMemoryManager<DeviceType::CPU>>();
+
+	//Every thread releases its own blocks, a block can also be released by another thread than the one that allocated it
+	std::vector<void*> shared(8, nullptr);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 8; t++)
+	{
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < 1000; i++)
+			{
+				void* ptr = nullptr;
+				pool->allocMemory1D(&ptr, 256 << (i % 6), 1);
+				pool->releaseMemory(&ptr);
+				EXPECT_EQ(ptr, nullptr);
+			}
+			pool->allocMemory1D(&shared[t], 1000, 1);
+		});
+	}
+	for (auto& t : threads)
+	{
+		t.join();
+	}
+
+	for (void*& ptr : shared)
+	{
+		pool->releaseMemory(&ptr);
+	}
+
+	PoolStatistics stat = pool->getStatistics();
+	EXPECT_EQ(stat.requests, size_t(8 * 1001));
+	EXPECT_EQ(stat.bytesInUse, size_t(0));
+
+	pool->trim();
+	EXPECT_EQ(pool->getStatistics().bytesReserved, size_t(0));
+}
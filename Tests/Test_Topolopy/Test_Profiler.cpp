@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "Framework/Framework/Profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace PhysIKA;
+
+TEST(Profiler, nestedScopes)
+{
+	Profiler& profiler = Profiler::getInstance();
+	profiler.reset();
+	profiler.setEnabled(true);
+
+	for (int frame = 0; frame < 2; frame++)
+	{
+		profiler.beginFrame(frame);
+		{
+			ProfileScope outer("Outer");
+			for (int i = 0; i < 3; i++)
+			{
+				ProfileScope inner("Inner");
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			}
+		}
+		profiler.endFrame();
+	}
+	profiler.setEnabled(false);
+
+	{
+		ProfileScope ignored("Ignored");
+	}
+
+	auto records = profiler.getStatistics();
+	ASSERT_EQ(records.size(), 2);
+
+	ProfileRecord& outer = records[0];
+	ProfileRecord& inner = records[1];
+	EXPECT_EQ(inner.path, "Outer/Inner");
+	EXPECT_EQ(outer.path, "Outer");
+	EXPECT_EQ(inner.depth, 1);
+	EXPECT_EQ(inner.calls, 6);
+	EXPECT_EQ(outer.calls, 2);
+	EXPECT_GE(inner.inclusive, 12.0);
+	EXPECT_GE(outer.inclusive, inner.inclusive);
+	EXPECT_NEAR(outer.exclusive, outer.inclusive - inner.inclusive, 1e-6);
+
+	auto frameRecords = profiler.getFrameStatistics();
+	ASSERT_EQ(frameRecords.size(), 2);
+	EXPECT_EQ(frameRecords[1].calls, 3);
+
+	EXPECT_TRUE(profiler.exportCSV("profile_test.csv"));
+	std::ifstream csv("profile_test.csv");
+	std::string line;
+	int lines = 0;
+	while (std::getline(csv, line)) lines++;
+	csv.close();
+	EXPECT_EQ(lines, 5);
+
+	EXPECT_TRUE(profiler.exportChromeTrace("profile_test.json"));
+	std::ifstream json("profile_test.json");
+	std::stringstream content;
+	content << json.rdbuf();
+	json.close();
+	EXPECT_NE(content.str().find("\"traceEvents\""), std::string::npos);
+	EXPECT_NE(content.str().find("\"name\":\"Inner\""), std::string::npos);
+
+	std::remove("profile_test.csv");
+	std::remove("profile_test.json");
+	profiler.reset();
+}
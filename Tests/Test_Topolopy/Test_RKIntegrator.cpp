@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+#include "Dynamics/RigidBody/RKIntegrator.h"
+#include <cmath>
+
+using namespace PhysIKA;
+
+//y' = -k * y on a single joint coordinate, no rigid bodies and no root, so setSum() only touches m_dq
+struct ExponentialDecay
+{
+	float k;
+	int evaluations = 0;
+
+	void operator()(const SystemMotionState& s0, DSystemMotionState& ds)
+	{
+		ds.setRigidNum(0);
+		ds.setDof(1);
+		ds.m_dq[0] = -k * s0.m_dq[0];
+		evaluations++;
+	}
+};
+
+static SystemMotionState initialState(float y0)
+{
+	SystemMotionState s;
+	s.setNum(0, 1);
+	s.m_dq[0] = y0;
+	return s;
+}
+
+TEST(RK45Integrator, accuracy)
+{
+	ExponentialDecay dydt{ 1.0f };
+	SystemMotionState s = initialState(1.0f);
+
+	RK45Integrator rk45;
+	rk45.setTolerance(1e-5, 1e-7);
+	rk45.solve(s, dydt, 1.0);
+
+	EXPECT_NEAR(s.m_dq[0], std::exp(-1.0f), 1e-5f);
+	EXPECT_GT(rk45.getStepNum(), 0);
+}
+
+TEST(RK45Integrator, rejectAndCarryOver)
+{
+	ExponentialDecay dydt{ 5.0f };
+	SystemMotionState s = initialState(1.0f);
+
+	RK45Integrator rk45;
+	rk45.setTolerance(1e-5, 1e-7);
+
+	//The first trial step is the whole frame, far outside the tolerance
+	rk45.solve(s, dydt, 0.5);
+	EXPECT_GT(rk45.getRejectedNum(), 0);
+	EXPECT_GT(rk45.getStepNum(), 1);
+	EXPECT_NEAR(s.m_dq[0], std::exp(-2.5f), 1e-5f);
+
+	//The accepted step size is carried over, so the next frame starts with a step that fits
+	rk45.solve(s, dydt, 0.5);
+	EXPECT_EQ(rk45.getRejectedNum(), 0);
+	EXPECT_NEAR(s.m_dq[0], std::exp(-5.0f), 1e-5f);
+}
+
+TEST(RK45Integrator, firstSameAsLast)
+{
+	ExponentialDecay dydt{ 5.0f };
+	SystemMotionState s = initialState(1.0f);
+
+	RK45Integrator rk45;
+	rk45.setTolerance(1e-5, 1e-7);
+	rk45.solve(s, dydt, 0.5);
+
+	//One evaluation at the start, then six per trial step since the last stage of an accepted step is reused
+	int trials = rk45.getStepNum() + rk45.getRejectedNum();
+	EXPECT_EQ(dydt.evaluations, 1 + 6 * trials);
+}
+
+TEST(RK45Integrator, minimumStep)
+{
+	ExponentialDecay dydt{ 5.0f };
+	SystemMotionState s = initialState(1.0f);
+
+	//Every step is at least as large as the minimum step and thus accepted regardless of the error
+	RK45Integrator rk45;
+	rk45.setTolerance(1e-5, 1e-7);
+	rk45.setMinimumStep(0.5);
+	rk45.solve(s, dydt, 0.5);
+
+	EXPECT_EQ(rk45.getStepNum(), 1);
+	EXPECT_EQ(rk45.getRejectedNum(), 0);
+	EXPECT_EQ(dydt.evaluations, 7);
+}
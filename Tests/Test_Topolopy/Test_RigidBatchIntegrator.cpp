@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include "Dynamics/RigidBody/RigidBodyRoot.h"
+#include "Dynamics/RigidBody/RevoluteJoint.h"
+#include "Dynamics/RigidBody/SphericalJoint.h"
+#include "Dynamics/RigidBody/ArticulatedBodyFDSolver.h"
+#include "Dynamics/RigidBody/RigidTimeIntegrationModule.h"
+#include "Dynamics/RigidBody/RigidBatchIntegrator.h"
+#include "RigidTreeBuilder.h"
+#include <random>
+
+using namespace PhysIKA;
+
+//Torso on a spherical joint with two limbs of two revolute links each
+static RigidBodyRoot_ptr createBody()
+{
+	std::default_random_engine e(1);
+	std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+
+	RigidTreeBuilder tree;
+	RigidBodyRoot_ptr root = tree.root;
+
+	Vector3f half(0, -0.5f, 0);
+
+	auto torsoJoint = std::make_shared<SphericalJoint>("torso_joint");
+	RigidBody2_ptr torso = tree.attach(root, torsoJoint);
+	torsoJoint->setJointInfo(-half);
+
+	for (int i = 0; i < 2; ++i)
+	{
+		RigidBody2_ptr last = torso;
+		for (int j = 0; j < 2; ++j)
+		{
+			auto joint = std::make_shared<RevoluteJoint>("limb_joint");
+			last = tree.attach(last, joint);
+
+			Vector3f axis(u(e), u(e), u(e));
+			joint->setJointInfo(axis / axis.norm(), -half);
+		}
+	}
+
+	root->updateTree();
+
+	std::shared_ptr<SystemMotionState> motion_state = root->getSystemState()->m_motionState;
+	const std::vector<int>& idx_map = root->getJointIdxMap();
+	const std::vector<RigidBody2_ptr>& bodies = tree.bodies;
+	const std::vector<std::shared_ptr<Joint>>& joints = tree.joints;
+	for (int i = 0; i < bodies.size(); ++i)
+	{
+		int id = bodies[i]->getId();
+		motion_state->m_rel_r[id] = Vector3f(0, -1.0f, 0);
+		motion_state->m_rel_q[id] = Quaternion<float>(Vector3f(u(e), u(e), u(e)), u(e));
+		bodies[i]->setI(Inertia<float>(1.0f, Vector3f(0.1f, 0.02f, 0.1f)));
+
+		int dof = joints[i]->getJointDOF();
+		for (int k = 0; k < dof; ++k)
+		{
+			motion_state->m_dq[idx_map[id] + k] = u(e);
+		}
+		if (dof > 0)
+		{
+			motion_state->m_v[id] = joints[i]->getJointSpace().mul(&(motion_state->m_dq[idx_map[id]]));
+		}
+	}
+	motion_state->updateGlobalInfo();
+
+	return root;
+}
+
+TEST(RigidBatchIntegrator, matchSerialSteps)
+{
+	RigidBodyRoot_ptr root = createBody();
+
+	const int envNum = 5;
+	const int stepNum = 3;
+	const int substeps = 4;
+	const double dt = 1e-3;
+
+	RigidBatchIntegrator batch(root.get());
+	batch.setEnvironmentNum(envNum);
+	ASSERT_EQ(batch.getEnvironmentNum(), envNum);
+
+	int n = batch.getRigidNum();
+	int dof = batch.getDof();
+
+	//Every environment gets its own controls and initial joint velocities
+	for (int env = 0; env < envNum; env++)
+	{
+		batch.getExternalForces(env)[env % n] = SpatialVector<float>(0.1f * env, 0, 0, 0, 2.0f * env, -1.0f * env);
+		batch.getJointVelocities(env)[dof - 1] += 0.5f * env;
+	}
+
+	std::vector<SystemMotionState> initial(envNum);
+	for (int env = 0; env < envNum; env++)
+	{
+		batch.storeState(env, initial[env]);
+	}
+
+	for (int i = 0; i < stepNum; i++)
+	{
+		ASSERT_TRUE(batch.step(dt, substeps));
+	}
+
+	for (int env = 0; env < envNum; env++)
+	{
+		SystemState system(root.get());
+		system.m_gravity = root->getSystemState()->m_gravity;
+		system.setNum(n, dof);
+		for (int i = 0; i < n; i++)
+		{
+			system.m_externalForce[i] = batch.getExternalForces(env)[i];
+		}
+
+		ArticulatedBodyFDSolver solver;
+		solver.setParent(root.get());
+
+		auto dydt = [&](const SystemMotionState& s0, DSystemMotionState& ds) {
+			ASSERT_TRUE(RigidTimeIntegrationModule::dydt(solver, system, s0, ds));
+		};
+
+		SystemMotionState s = initial[env];
+		RK4Integrator rk4;
+		for (int i = 0; i < stepNum * substeps; i++)
+		{
+			rk4.solve(s, dydt, dt);
+		}
+
+		SystemMotionState result;
+		batch.storeState(env, result);
+
+		for (int i = 0; i < n; i++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				EXPECT_NEAR(result.m_rel_r[i][c], s.m_rel_r[i][c], 1e-5f);
+			}
+			for (int c = 0; c < 4; c++)
+			{
+				EXPECT_NEAR(result.m_rel_q[i][c], s.m_rel_q[i][c], 1e-5f);
+			}
+			for (int c = 0; c < 6; c++)
+			{
+				EXPECT_NEAR(result.m_v[i][c], s.m_v[i][c], 1e-4f);
+			}
+		}
+		for (int i = 0; i < dof; i++)
+		{
+			EXPECT_NEAR(result.m_dq[i], s.m_dq[i], 1e-4f);
+		}
+	}
+
+	//The environments really differ, so a mixed up scatter would be noticed
+	SystemMotionState first, last;
+	batch.storeState(0, first);
+	batch.storeState(envNum - 1, last);
+	EXPECT_GT(std::abs(first.m_dq[dof - 1] - last.m_dq[dof - 1]), 0.1f);
+}
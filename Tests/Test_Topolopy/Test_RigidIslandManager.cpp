@@ -0,0 +1,234 @@
+#include "gtest/gtest.h"
+#include "Dynamics/RigidBody/RigidIslandManager.h"
+#include "Dynamics/RigidBody/RevoluteJoint.h"
+#include "Dynamics/RigidBody/SphericalJoint.h"
+#include "RigidTreeBuilder.h"
+#include <algorithm>
+
+using namespace PhysIKA;
+
+//Three subtrees of the root: an arm of two links and two single bodies
+struct Scene
+{
+	RigidBodyRoot_ptr root;
+	int arm, hand, ball, box;
+};
+
+static Scene createScene()
+{
+	Scene scene;
+	RigidTreeBuilder tree;
+	scene.root = tree.root;
+
+	auto spherical = [](Vector3f r) {
+		auto joint = std::make_shared<SphericalJoint>("spherical");
+		joint->setJointInfo(r);
+		return joint;
+	};
+
+	RigidBody2_ptr arm = tree.attach(scene.root, spherical(Vector3f(0, 0.5f, 0)));
+	auto elbow = std::make_shared<RevoluteJoint>("elbow");
+	elbow->setJointInfo(Vector3f(0, 0, 1), Vector3f(0, 0.5f, 0));
+	RigidBody2_ptr hand = tree.attach(arm, elbow);
+	RigidBody2_ptr ball = tree.attach(scene.root, spherical(Vector3f(0, 0.2f, 0)));
+	RigidBody2_ptr box = tree.attach(scene.root, spherical(Vector3f(0, 0.3f, 0)));
+
+	for (auto& body : tree.bodies)
+	{
+		body->setI(Inertia<float>(1.0f, Vector3f(0.1f, 0.1f, 0.1f)));
+	}
+
+	scene.root->updateTree();
+	scene.arm = arm->getId();
+	scene.hand = hand->getId();
+	scene.ball = ball->getId();
+	scene.box = box->getId();
+
+	return scene;
+}
+
+//Joint velocity of a node, all components set to w
+static void setVelocity(const Scene& scene, int node_id, float w)
+{
+	SystemMotionState& s = *(scene.root->getSystemState()->m_motionState);
+	const auto& all_node = scene.root->getAllParentidNodePair();
+	Joint* joint = all_node[node_id].second->getParentJoint();
+	int offset = scene.root->getJointIdxMap()[node_id];
+
+	for (int k = 0; k < joint->getJointDOF(); ++k)
+	{
+		s.m_dq[offset + k] = w;
+	}
+	s.m_v[node_id] = joint->getJointSpace().mul(&(s.m_dq[offset]));
+}
+
+static std::vector<int> islandOf(const RigidIslandManager& islands, int node_id)
+{
+	for (int k = 0; k < islands.getIslandNum(); ++k)
+	{
+		const std::vector<int>& nodes = islands.getIsland(k).nodes;
+		if (std::find(nodes.begin(), nodes.end(), node_id) != nodes.end())
+		{
+			return nodes;
+		}
+	}
+	return std::vector<int>();
+}
+
+TEST(RigidIslandManager, splitByJointsAndContacts)
+{
+	Scene scene = createScene();
+	SystemState& system_state = *(scene.root->getSystemState());
+
+	RigidIslandManager islands;
+	islands.setSleepingEnabled(false);
+	islands.update(scene.root.get(), system_state, 0.01f);
+
+	//Every subtree of the root is an island
+	ASSERT_EQ(islands.getIslandNum(), 3);
+	std::vector<int> arm = islandOf(islands, scene.arm);
+	EXPECT_EQ(arm, islandOf(islands, scene.hand));
+	EXPECT_EQ(arm.size(), 2u);
+	EXPECT_EQ(islandOf(islands, scene.ball), std::vector<int>{ scene.ball });
+	EXPECT_EQ(islandOf(islands, scene.box), std::vector<int>{ scene.box });
+
+	int dof = 0;
+	for (int k = 0; k < islands.getIslandNum(); ++k)
+	{
+		const RigidIslandManager::Island& island = islands.getIsland(k);
+		EXPECT_TRUE(std::is_sorted(island.nodes.begin(), island.nodes.end()));
+		dof += island.dof;
+	}
+	EXPECT_EQ(dof, scene.root->getJointDof());
+
+	//A contact merges the subtrees it touches, invalid ids are ignored
+	islands.setContactPairs({ std::make_pair(scene.hand, scene.box), std::make_pair(scene.ball, 100) });
+	islands.update(scene.root.get(), system_state, 0.01f);
+
+	ASSERT_EQ(islands.getIslandNum(), 2);
+	EXPECT_EQ(islandOf(islands, scene.arm).size(), 3u);
+	EXPECT_EQ(islandOf(islands, scene.arm), islandOf(islands, scene.box));
+	EXPECT_EQ(islandOf(islands, scene.ball).size(), 1u);
+
+	islands.setContactPairs({});
+	islands.update(scene.root.get(), system_state, 0.01f);
+	EXPECT_EQ(islands.getIslandNum(), 3);
+}
+
+TEST(RigidIslandManager, sleepAfterTimeToSleep)
+{
+	Scene scene = createScene();
+	SystemState& system_state = *(scene.root->getSystemState());
+	SystemMotionState& s = *(system_state.m_motionState);
+
+	//The arm keeps moving, the ball creeps below the sleep threshold, the box rests
+	setVelocity(scene, scene.arm, 2.0f);
+	setVelocity(scene, scene.ball, 1e-3f);
+
+	RigidIslandManager islands;
+	islands.setSleepThreshold(1e-3f, 4e-3f);
+	islands.setTimeToSleep(0.5f);
+
+	const float dt = 0.125f;
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		islands.update(scene.root.get(), system_state, dt);
+		EXPECT_EQ(islands.getSleepingBodyNum(), 0) << "frame " << frame;
+	}
+
+	islands.update(scene.root.get(), system_state, dt);
+	EXPECT_FALSE(islands.isSleeping(scene.arm));
+	EXPECT_FALSE(islands.isSleeping(scene.hand));
+	EXPECT_TRUE(islands.isSleeping(scene.ball));
+	EXPECT_TRUE(islands.isSleeping(scene.box));
+	EXPECT_EQ(islands.getAwakeIslandNum(), 1);
+	EXPECT_EQ(islands.getActiveBodyNum(), 2);
+	EXPECT_EQ(islands.getSleepingBodyNum(), 2);
+
+	//Sleeping bodies are stopped
+	int offset = scene.root->getJointIdxMap()[scene.ball];
+	for (int k = 0; k < 3; ++k)
+	{
+		EXPECT_EQ(s.m_dq[offset + k], 0.0f);
+	}
+	EXPECT_EQ(s.m_v[scene.ball].normSquared(), 0.0f);
+	EXPECT_GT(s.m_v[scene.arm].normSquared(), 0.0f);
+
+	//Without sleeping everything is awake
+	islands.setSleepingEnabled(false);
+	islands.update(scene.root.get(), system_state, dt);
+	EXPECT_EQ(islands.getSleepingBodyNum(), 0);
+}
+
+TEST(RigidIslandManager, wakeUpByForce)
+{
+	Scene scene = createScene();
+	SystemState& system_state = *(scene.root->getSystemState());
+
+	RigidIslandManager islands;
+	islands.setTimeToSleep(0.25f);
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		islands.update(scene.root.get(), system_state, 0.125f);
+	}
+	ASSERT_EQ(islands.getSleepingBodyNum(), 4);
+
+	//A force on the hand wakes the whole arm
+	system_state.m_externalForce[scene.hand] = SpatialVector<float>(0, 0, 0, 0, 1.0f, 0);
+	islands.update(scene.root.get(), system_state, 0.125f);
+	EXPECT_FALSE(islands.isSleeping(scene.arm));
+	EXPECT_FALSE(islands.isSleeping(scene.hand));
+	EXPECT_TRUE(islands.isSleeping(scene.ball));
+
+	//The rest time starts again once the force is gone
+	system_state.m_externalForce[scene.hand] = SpatialVector<float>();
+	islands.update(scene.root.get(), system_state, 0.125f);
+	EXPECT_FALSE(islands.isSleeping(scene.arm));
+	islands.update(scene.root.get(), system_state, 0.125f);
+	EXPECT_TRUE(islands.isSleeping(scene.arm));
+
+	//An explicit request wakes the island in the next update
+	islands.wakeUp(scene.box);
+	EXPECT_TRUE(islands.isSleeping(scene.box));
+	islands.update(scene.root.get(), system_state, 0.125f);
+	EXPECT_FALSE(islands.isSleeping(scene.box));
+	EXPECT_TRUE(islands.isSleeping(scene.ball));
+
+	islands.wakeUp();
+	EXPECT_FALSE(islands.isSleeping(scene.ball));
+}
+
+TEST(RigidIslandManager, wakeUpByContact)
+{
+	Scene scene = createScene();
+	SystemState& system_state = *(scene.root->getSystemState());
+
+	RigidIslandManager islands;
+	islands.setSleepThreshold(1e-3f, 4e-3f);
+	islands.setTimeToSleep(0.25f);
+
+	//The box sleeps, the ball and the arm are awake
+	setVelocity(scene, scene.ball, 2.0f);
+	setVelocity(scene, scene.arm, 2.0f);
+	for (int frame = 0; frame < 2; ++frame)
+	{
+		islands.update(scene.root.get(), system_state, 0.125f);
+	}
+	ASSERT_TRUE(islands.isSleeping(scene.box));
+	ASSERT_FALSE(islands.isSleeping(scene.ball));
+
+	//A slow body touching a sleeping island comes to rest on it
+	setVelocity(scene, scene.ball, 1e-2f);
+	islands.setContactPairs({ std::make_pair(scene.ball, scene.box) });
+	islands.update(scene.root.get(), system_state, 0.125f);
+	EXPECT_TRUE(islands.isSleeping(scene.ball));
+	EXPECT_TRUE(islands.isSleeping(scene.box));
+
+	//A fast body touching a sleeping island wakes it
+	ASSERT_FALSE(islands.isSleeping(scene.hand));
+	islands.setContactPairs({ std::make_pair(scene.hand, scene.box) });
+	islands.update(scene.root.get(), system_state, 0.125f);
+	EXPECT_FALSE(islands.isSleeping(scene.box));
+	EXPECT_FALSE(islands.isSleeping(scene.hand));
+	EXPECT_TRUE(islands.isSleeping(scene.ball));
+}
@@ -0,0 +1,243 @@
+#include "gtest/gtest.h"
+#include "Dynamics/RigidBody/RigidModelCache.h"
+#include "Dynamics/RigidBody/RevoluteJoint.h"
+#include "Dynamics/RigidBody/PrismaticJoint.h"
+#include "Dynamics/RigidBody/SphericalJoint.h"
+#include "Dynamics/RigidBody/HelicalJoint.h"
+#include "Dynamics/RigidBody/FixedJoint.h"
+#include "Dynamics/RigidBody/urdf.h"
+#include "RigidTreeBuilder.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+using namespace PhysIKA;
+
+//Base on a fixed joint carrying a spherical and a revolute branch, a prismatic and a helical joint below them
+static RigidBodyRoot_ptr createBody()
+{
+	std::default_random_engine e(4);
+	std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+
+	RigidTreeBuilder tree("cached_root");
+	RigidBodyRoot_ptr root = tree.root;
+
+	//Every joint gets a random tree transform
+	auto attach = [&](RigidBody2_ptr parent, std::shared_ptr<Joint> joint, const std::string& name) {
+		joint->setXT(Transform3d<float>(Vector3f(u(e), u(e), u(e)), Quaternion<float>(Vector3f(0, 0, 1), u(e))));
+		return tree.attach(parent, joint, name);
+	};
+
+	RigidBody2_ptr base = attach(root, std::make_shared<FixedJoint>("base_joint"), "base");
+
+	auto spherical = std::make_shared<SphericalJoint>("spherical_joint");
+	RigidBody2_ptr torso = attach(base, spherical, "torso");
+	spherical->setJointInfo(Vector3f(0, 0.5f, 0));
+
+	auto revolute = std::make_shared<RevoluteJoint>("revolute_joint");
+	RigidBody2_ptr arm = attach(base, revolute, "arm");
+	revolute->setJointInfo(Vector3f(0, 0.6f, 0.8f), Vector3f(0.1f, 0.5f, 0));
+
+	auto prismatic = std::make_shared<PrismaticJoint>("prismatic_joint");
+	attach(torso, prismatic, "slider");
+	prismatic->setJointInfo(Vector3f(1, 0, 0));
+
+	auto helical = std::make_shared<HelicalJoint>("helical_joint");
+	attach(arm, helical, "screw");
+	Vectornd<float> screw_axis(3);
+	screw_axis[2] = 1.0f;
+	helical->setJointInfo(screw_axis, 0.2f);
+
+	const std::vector<RigidBody2_ptr>& bodies = tree.bodies;
+	for (int i = 0; i < bodies.size(); ++i)
+	{
+		bodies[i]->setI(Inertia<float>(1.0f + i, Vector3f(0.1f * (i + 1), 0.2f, 0.3f)));
+		bodies[i]->setGeometrySize(0.5f + i, 1.0f, 0.25f);
+	}
+	bodies[2]->setShapeFile("meshes/arm.obj", Vector3f(0.5f, 2.0f, 1.0f));
+
+	root->updateTree();
+
+	std::shared_ptr<SystemState> system_state = root->getSystemState();
+	system_state->m_gravity = Vector3f(0, -9.8f, 0.5f);
+
+	SystemMotionState& motion_state = *(system_state->m_motionState);
+	for (int i = 0; i < bodies.size(); ++i)
+	{
+		motion_state.m_rel_r[i] = Vector3f(u(e), u(e), u(e));
+		motion_state.m_rel_q[i] = Quaternion<float>(Vector3f(0, 1, 0), u(e));
+	}
+	motion_state.updateGlobalInfo();
+
+	return root;
+}
+
+static void expectEqual(const Vector3f& a, const Vector3f& b)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		EXPECT_FLOAT_EQ(a[i], b[i]);
+	}
+}
+
+static void expectEqual(const Quaternion<float>& a, const Quaternion<float>& b)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		EXPECT_FLOAT_EQ(a[i], b[i]);
+	}
+}
+
+static void expectEqual(const Transform3d<float>& a, const Transform3d<float>& b)
+{
+	expectEqual(a.getTranslation(), b.getTranslation());
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			EXPECT_FLOAT_EQ(a.getRotationMatrix()(i, j), b.getRotationMatrix()(i, j));
+		}
+	}
+}
+
+static void writeFile(const std::string& filename, const std::string& content)
+{
+	std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+	out << content;
+}
+
+TEST(RigidModelCache, roundTrip)
+{
+	RigidBodyRoot_ptr root = createBody();
+	const std::string filename = "rigid_model_cache_test.pkrb";
+	const uint64_t key = RigidModelCache::hash("model", 5);
+
+	ASSERT_TRUE(RigidModelCache::save(filename, *root, key));
+	RigidBodyRoot_ptr loaded = RigidModelCache::load(filename, key);
+	ASSERT_TRUE(loaded);
+
+	EXPECT_EQ(loaded->getName(), root->getName());
+	EXPECT_EQ(loaded->getJointDof(), root->getJointDof());
+	expectEqual(loaded->getSystemState()->m_gravity, root->getSystemState()->m_gravity);
+
+	const auto& nodes = root->getAllParentidNodePair();
+	const auto& loaded_nodes = loaded->getAllParentidNodePair();
+	ASSERT_EQ(loaded_nodes.size(), nodes.size());
+	EXPECT_EQ(loaded->getJointIdxMap(), root->getJointIdxMap());
+
+	const SystemMotionState& s = *(root->getSystemState()->m_motionState);
+	const SystemMotionState& ls = *(loaded->getSystemState()->m_motionState);
+	for (int i = 0; i < nodes.size(); ++i)
+	{
+		const RigidBody2_ptr& node = nodes[i].second;
+		const RigidBody2_ptr& loaded_node = loaded_nodes[i].second;
+		EXPECT_EQ(loaded_nodes[i].first, nodes[i].first);
+		EXPECT_EQ(loaded_node->getName(), node->getName());
+
+		EXPECT_FLOAT_EQ(loaded_node->getI().getMass(), node->getI().getMass());
+		expectEqual(loaded_node->getI().getInertiaDiagonal(), node->getI().getInertiaDiagonal());
+		expectEqual(loaded_node->getGeometrySize(), node->getGeometrySize());
+		EXPECT_EQ(loaded_node->getShapeFile(), node->getShapeFile());
+		expectEqual(loaded_node->getShapeScale(), node->getShapeScale());
+
+		const Joint* joint = node->getParentJoint();
+		const Joint* loaded_joint = loaded_node->getParentJoint();
+		EXPECT_EQ(typeid(*loaded_joint), typeid(*joint));
+		ASSERT_EQ(loaded_joint->getJointDOF(), joint->getJointDOF());
+		for (int k = 0; k < joint->getJointDOF(); ++k)
+		{
+			for (int j = 0; j < 6; ++j)
+			{
+				EXPECT_FLOAT_EQ(loaded_joint->getJointSpace().getBases()[k][j], joint->getJointSpace().getBases()[k][j]);
+			}
+		}
+		expectEqual(loaded_joint->getXT(), joint->getXT());
+		expectEqual(loaded_joint->getXJ(), joint->getXJ());
+
+		expectEqual(ls.m_rel_r[i], s.m_rel_r[i]);
+		expectEqual(ls.m_rel_q[i], s.m_rel_q[i]);
+		expectEqual(ls.m_global_r[i], s.m_global_r[i]);
+		expectEqual(ls.m_global_q[i], s.m_global_q[i]);
+		expectEqual(ls.m_X[i], s.m_X[i]);
+	}
+	EXPECT_EQ(loaded_nodes[2].second->getShapeFile(), "meshes/arm.obj");
+
+	std::remove(filename.c_str());
+}
+
+TEST(RigidModelCache, rejectInvalidImage)
+{
+	RigidBodyRoot_ptr root = createBody();
+	const std::string filename = "rigid_model_cache_invalid.pkrb";
+	const uint64_t key = RigidModelCache::hash("model", 5);
+	ASSERT_TRUE(RigidModelCache::save(filename, *root, key));
+
+	EXPECT_FALSE(RigidModelCache::load(filename, key + 1));
+	EXPECT_FALSE(RigidModelCache::load("rigid_model_cache_missing.pkrb", key));
+
+	std::string image;
+	{
+		std::ifstream in(filename, std::ios::binary);
+		image.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	//Another format version, the version follows the 8 byte magic
+	std::string changed = image;
+	changed[8] ^= 0x7f;
+	writeFile(filename, changed);
+	EXPECT_FALSE(RigidModelCache::load(filename, key));
+
+	//Truncated image
+	writeFile(filename, image.substr(0, image.size() - 1));
+	EXPECT_FALSE(RigidModelCache::load(filename, key));
+
+	writeFile(filename, image);
+	EXPECT_TRUE(RigidModelCache::load(filename, key));
+
+	std::remove(filename.c_str());
+}
+
+TEST(Urdf, meshFile)
+{
+	const std::string filename = "./rigid_model_cache_test.urdf";
+	writeFile(filename,
+		"<robot name=\"mesh_robot\">"
+		"<link name=\"base\">"
+		"<inertial><origin xyz=\"0 0 0\" rpy=\"0 0 0\"/><mass value=\"1\"/>"
+		"<inertia ixx=\"0.1\" ixy=\"0\" ixz=\"0\" iyy=\"0.1\" iyz=\"0\" izz=\"0.1\"/></inertial>"
+		"<visual><geometry><mesh filename=\"meshes/base.OBJ\" scale=\"0.5 2 1\"/></geometry></visual>"
+		"</link>"
+		"<link name=\"link_arm\">"
+		"<inertial><origin xyz=\"0 0 0\" rpy=\"0 0 0\"/><mass value=\"1\"/>"
+		"<inertia ixx=\"0.1\" ixy=\"0\" ixz=\"0\" iyy=\"0.1\" iyz=\"0\" izz=\"0.1\"/></inertial>"
+		"<visual><geometry><box size=\"1 2 3\"/><mesh filename=\"package://robot/arm.stl\"/></geometry></visual>"
+		"</link>"
+		"<joint name=\"elbow\"><parent link=\"base\"/><child link=\"link_arm\"/>"
+		"<origin xyz=\"0 1 0\" rpy=\"0 0 0\"/><axis xyz=\"0 0 1\"/></joint>"
+		"</robot>");
+
+	//The parser takes the links in the order of their names as roots, base comes first
+	Urdf urdf;
+	RigidBodyRoot_ptr root = urdf.loadFile(filename);
+	ASSERT_TRUE(root);
+
+	const auto& nodes = root->getAllParentidNodePair();
+	ASSERT_EQ(nodes.size(), 2u);
+	for (auto& node : nodes)
+	{
+		if (node.second->getName() == "base")
+		{
+			//Relative to the URDF file, with the mesh scale
+			EXPECT_EQ(node.second->getShapeFile(), "./meshes/base.OBJ");
+			expectEqual(node.second->getShapeScale(), Vector3f(0.5f, 2.0f, 1.0f));
+		}
+		else
+		{
+			//Only local obj files are loaded, the box stays
+			EXPECT_TRUE(node.second->getShapeFile().empty());
+			expectEqual(node.second->getGeometrySize(), Vector3f(1, 2, 3));
+		}
+	}
+
+	std::remove(filename.c_str());
+}
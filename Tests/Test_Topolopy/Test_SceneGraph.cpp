@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include "Framework/Framework/SceneGraph.h"
+
+#include <vector>
+
+using namespace PhysIKA;
+
+class StableNode : public Node
+{
+public:
+	StableNode(std::string name = "default") : Node(name) {}
+
+	Real getStableDt() override { return stable; }
+	void advance(Real dt) override { steps.push_back(dt); }
+
+	float stable = 0.01f;
+	std::vector<float> steps;
+};
+
+TEST(SceneGraph, adaptiveTimeStep)
+{
+	SceneGraph& scene = SceneGraph::getInstance();
+	std::shared_ptr<StableNode> root = std::make_shared<StableNode>("root");
+	scene.setRootNode(root);
+	scene.setFrameRate(25);
+	scene.setAdaptiveInterval(false);
+	scene.setAdaptiveTimeStep(true);
+	scene.setTimeStepLimits(1e-4f, 0.02f);
+	scene.setTimeStepGrowth(1.5f);
+
+	//A restrictive node, the frame is split into even steps below the stable step
+	root->stable = 0.003f;
+	float nodeDt = root->getDt();
+	scene.takeOneFrame();
+
+	float sum = 0.0f;
+	for (float dt : root->steps)
+	{
+		EXPECT_LE(dt, 0.003f * 1.0001f);
+		sum += dt;
+	}
+	EXPECT_NEAR(sum, 0.04f, 1e-5f);
+	EXPECT_EQ(scene.getSubstepNum(), (int)root->steps.size());
+	EXPECT_EQ(root->getDt(), nodeDt);
+
+	//A calm node, the step grows smoothly up to the largest step
+	root->stable = 1.0f;
+	root->steps.clear();
+	for (int i = 0; i < 4; i++)
+	{
+		scene.takeOneFrame();
+	}
+
+	EXPECT_LE(root->steps[0], 1.5f * 0.003f * 1.0001f);
+	for (float dt : root->steps)
+	{
+		EXPECT_LE(dt, 0.02f * 1.0001f);
+	}
+	EXPECT_NEAR(scene.getTimeStep(), 0.02f, 1e-5f);
+	EXPECT_EQ(scene.getSubstepNum(), 2);
+
+	//With an adaptive interval a frame is one stable step
+	scene.setAdaptiveInterval(true);
+	root->stable = 0.005f;
+	root->steps.clear();
+	float elapsed = scene.getElapsedTime();
+	scene.takeOneFrame();
+	ASSERT_EQ(root->steps.size(), 1u);
+	EXPECT_FLOAT_EQ(root->steps[0], 0.005f);
+	EXPECT_EQ(scene.getSubstepNum(), 1);
+	EXPECT_NEAR(scene.getElapsedTime() - elapsed, 0.005f, 1e-6f);
+	EXPECT_EQ(root->getDt(), nodeDt);
+
+	scene.setAdaptiveTimeStep(false);
+	scene.setRootNode(nullptr);
+}
@@ -0,0 +1,161 @@
+#include "gtest/gtest.h"
+#include "Dynamics/RigidBody/SparseInertiaMatrixFDSolver.h"
+#include <random>
+#include <cmath>
+
+using namespace PhysIKA;
+
+//Tree with a free base, two branches, a fixed joint and a joint below it
+static void buildTree(std::vector<std::pair<int, int>>& parent_dof, std::vector<int>& idx_map)
+{
+	parent_dof = {
+		{ -1, 6 },
+		{ 0, 1 },
+		{ 0, 3 },
+		{ 1, 2 },
+		{ 2, 1 },
+		{ 1, 0 },
+		{ 5, 1 } };
+
+	idx_map.resize(parent_dof.size());
+	idx_map[0] = 0;
+	for (int i = 1; i < parent_dof.size(); ++i)
+	{
+		idx_map[i] = idx_map[i - 1] + parent_dof[i - 1].second;
+	}
+}
+
+//Dense Gaussian elimination with partial pivoting, used as the reference solution
+static void denseSolve(MatrixMN<float> A, Vectornd<float>& b)
+{
+	int n = b.size();
+	for (int k = 0; k < n; ++k)
+	{
+		int p = k;
+		for (int i = k + 1; i < n; ++i)
+		{
+			if (std::fabs(A(i, k)) > std::fabs(A(p, k)))
+				p = i;
+		}
+		for (int j = 0; j < n; ++j)
+		{
+			std::swap(A(k, j), A(p, j));
+		}
+		std::swap(b[k], b[p]);
+
+		for (int i = k + 1; i < n; ++i)
+		{
+			float a = A(i, k) / A(k, k);
+			for (int j = k; j < n; ++j)
+			{
+				A(i, j) -= a * A(k, j);
+			}
+			b[i] -= a * b[k];
+		}
+	}
+	for (int i = n - 1; i >= 0; --i)
+	{
+		for (int j = i + 1; j < n; ++j)
+		{
+			b[i] -= A(i, j) * b[j];
+		}
+		b[i] /= A(i, i);
+	}
+}
+
+TEST(SparseInertiaMatrixFDSolver, buildParentDof)
+{
+	std::vector<std::pair<int, int>> parent_dof;
+	std::vector<int> idx_map;
+	buildTree(parent_dof, idx_map);
+
+	std::vector<int> lambda;
+	SparseInertiaMatrixFDSolver::buildParentDof(parent_dof, idx_map, lambda);
+
+	std::vector<int> expected = { -1, 0, 1, 2, 3, 4, 5, 5, 7, 8, 6, 10, 9, 6 };
+	EXPECT_EQ(lambda, expected);
+}
+
+TEST(SparseInertiaMatrixFDSolver, factorizeAndSolve)
+{
+	std::vector<std::pair<int, int>> parent_dof;
+	std::vector<int> idx_map;
+	buildTree(parent_dof, idx_map);
+
+	std::vector<int> lambda;
+	SparseInertiaMatrixFDSolver::buildParentDof(parent_dof, idx_map, lambda);
+	int n = lambda.size();
+
+	std::mt19937 gen(3);
+	std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+
+	//H = L^T * D * L, with L unit lower triangular and nonzero only along the branches
+	MatrixMN<float> L(n, n);
+	Vectornd<float> D(n);
+	L.setZeros();
+	for (int i = 0; i < n; ++i)
+	{
+		L(i, i) = 1.0f;
+		D[i] = 1.5f + dist(gen);
+		for (int j = lambda[i]; j >= 0; j = lambda[j])
+		{
+			L(i, j) = dist(gen);
+		}
+	}
+
+	MatrixMN<float> H(n, n);
+	H.setZeros();
+	for (int i = 0; i < n; ++i)
+	{
+		for (int j = 0; j < n; ++j)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < n; ++k)
+			{
+				sum += L(k, i) * D[k] * L(k, j);
+			}
+			H(i, j) = sum;
+		}
+	}
+
+	MatrixMN<float> factor = H;
+	ASSERT_TRUE(SparseInertiaMatrixFDSolver::factorize(factor, lambda));
+
+	//The factors are recovered in place
+	for (int i = 0; i < n; ++i)
+	{
+		EXPECT_NEAR(factor(i, i), D[i], 1e-4f);
+		for (int j = lambda[i]; j >= 0; j = lambda[j])
+		{
+			EXPECT_NEAR(factor(i, j), L(i, j), 1e-4f);
+		}
+	}
+
+	Vectornd<float> b(n);
+	for (int i = 0; i < n; ++i)
+	{
+		b[i] = dist(gen);
+	}
+
+	Vectornd<float> x = b;
+	SparseInertiaMatrixFDSolver::backSubstitute(factor, lambda, x);
+
+	Vectornd<float> ref = b;
+	denseSolve(H, ref);
+
+	for (int i = 0; i < n; ++i)
+	{
+		EXPECT_NEAR(x[i], ref[i], 1e-3f * (1.0f + std::fabs(ref[i])));
+	}
+}
+
+TEST(SparseInertiaMatrixFDSolver, rejectIndefinite)
+{
+	std::vector<int> lambda = { -1, 0 };
+
+	MatrixMN<float> H(2, 2);
+	H(0, 0) = 1.0f;	H(0, 1) = 2.0f;
+	H(1, 0) = 2.0f;	H(1, 1) = 1.0f;
+
+	EXPECT_FALSE(SparseInertiaMatrixFDSolver::factorize(H, lambda));
+}
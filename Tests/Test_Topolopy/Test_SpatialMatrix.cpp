@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+#include "Dynamics/RigidBody/Transform3d.h"
+#include "Dynamics/RigidBody/RigidUtil.h"
+
+#include <cstdlib>
+
+using namespace PhysIKA;
+
+static float randomValue()
+{
+	return (float)rand() / RAND_MAX - 0.5f;
+}
+
+TEST(SpatialMatrix, symmetricTransform)
+{
+	SpatialMatrix<float> m;
+	for (int i = 0; i < 6; i++)
+	{
+		for (int j = 0; j < 6; j++)
+		{
+			m(i, j) = randomValue();
+		}
+	}
+	SpatialInertia<float> inertia(m);
+
+	Quaternion<float> q(0.3f, -0.2f, 0.5f, 0.8f);
+	q.normalize();
+	Transform3d<float> X(Vector3f(0.4f, -1.2f, 0.7f), q);
+
+	SpatialInertia<float> fast = X.transformI(inertia);
+	SpatialMatrix<float> full = X.transformI((const SpatialMatrix<float>&)inertia);
+
+	for (int i = 0; i < 6; i++)
+	{
+		for (int j = 0; j < 6; j++)
+		{
+			EXPECT_NEAR(fast(i, j), full(i, j), 1e-5);
+			EXPECT_EQ(fast(i, j), fast(j, i));
+		}
+	}
+}
+
+TEST(SpatialMatrix, inverse)
+{
+	SpatialMatrix<float> D;
+	int dof = 3;
+	for (int i = 0; i < dof; i++)
+	{
+		for (int j = 0; j < dof; j++)
+		{
+			D(i, j) = randomValue() + (i == j ? 2.0f : 0.0f);
+		}
+	}
+
+	SpatialMatrix<float> prod = D * RigidUtil::inverse(D, dof);
+	for (int i = 0; i < dof; i++)
+	{
+		for (int j = 0; j < dof; j++)
+		{
+			EXPECT_NEAR(prod(i, j), i == j ? 1.0f : 0.0f, 1e-5);
+		}
+	}
+
+	SpatialVector<float> U[2] = { SpatialVector<float>(1, 0, 0, 0, 2, 0), SpatialVector<float>(0, 1, 0, 0, 0, 3) };
+	SpatialMatrix<float> S;
+	S(0, 0) = 2; S(0, 1) = 1; S(1, 0) = 1; S(1, 1) = 4;
+	SpatialInertia<float> res = UxDxUT(U, 2, S);
+	EXPECT_FLOAT_EQ(res(4, 5), U[0][4] * S(0, 1) * U[1][5]);
+	EXPECT_FLOAT_EQ(res(0, 0), S(0, 0));
+	EXPECT_FLOAT_EQ(res(5, 4), res(4, 5));
+}
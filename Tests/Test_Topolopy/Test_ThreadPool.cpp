@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+#include "Core/Utility/ThreadPool.h"
+#include <vector>
+
+using namespace PhysIKA;
+
+static void T_AddValue(int pId, std::vector<int>& arr, int val)
+{
+	arr[pId] += val;
+}
+
+TEST(ThreadPool, parallelFor)
+{
+	ThreadPool pool(4);
+	EXPECT_EQ(pool.getThreadNum(), 4u);
+
+	std::vector<int> arr(100000, 1);
+	pool.parallelFor((int)arr.size(), [&](int i) { arr[i] *= 2; });
+	pool.parallelFor((int)arr.size(), [&](int i) { T_AddValue(i, arr, 1); }, 7);
+
+	for (auto v : arr)
+	{
+		EXPECT_EQ(v, 3);
+	}
+
+	float sum = 0.0f;
+	pool.parallelFor(64, [&](int i) {
+		pool.parallelFor(64, [&](int j) { atomicAddHost(&sum, 1.0f); });
+	});
+	EXPECT_EQ(sum, 64.0f * 64.0f);
+}
+
+TEST(ThreadPool, cpuExecute)
+{
+	std::vector<int> arr(1000, 0);
+	cpuExecute((int)arr.size(), T_AddValue, arr, 5);
+
+	for (auto v : arr)
+	{
+		EXPECT_EQ(v, 5);
+	}
+}
+
+TEST(ThreadPool, ScatterBuffer)
+{
+	ThreadPool::getInstance().setThreadNum(4);
+
+	//Every pair (i, i + 1) adds one to both particles
+	int num = 10000;
+	std::vector<int> arr(num, 0);
+	ScatterBuffer<int> buffer;
+	buffer.scatter(arr.data(), num, num - 1, [&](int i, int* acc) {
+		acc[i] += 1;
+		acc[i + 1] += 1;
+	});
+
+	EXPECT_EQ(arr[0], 1);
+	EXPECT_EQ(arr[num - 1], 1);
+	for (int i = 1; i < num - 1; i++)
+	{
+		EXPECT_EQ(arr[i], 2);
+	}
+
+	ThreadPool::getInstance().setThreadNum(0);
+}
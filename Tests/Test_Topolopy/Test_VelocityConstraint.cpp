@@ -0,0 +1,238 @@
+#include "gtest/gtest.h"
+#include "Dynamics/ParticleSystem/VelocityConstraint.h"
+#include "Dynamics/ParticleSystem/Attribute.h"
+#include "Framework/Framework/Node.h"
+#include "Core/Utility.h"
+#include <random>
+
+using namespace PhysIKA;
+
+typedef VelocityConstraint<DataType3f> Constraint;
+
+static const float h = 0.011f;
+static const int maxNbr = 80;
+static const int n = 8;
+
+//A jittered nxnxn block of particles at the default sampling distance
+static HostArray<Vector3f> createBlock()
+{
+	std::mt19937 gen(13);
+	std::uniform_real_distribution<float> jitter(-0.0005f, 0.0005f);
+
+	const float d = 0.005f;
+	HostArray<Vector3f> pos(n * n * n);
+	for (int i = 0; i < n; i++)
+	{
+		for (int j = 0; j < n; j++)
+		{
+			for (int k = 0; k < n; k++)
+			{
+				pos[(i * n + j) * n + k] = Vector3f(0.1f) + Vector3f(i, j, k) * d + Vector3f(jitter(gen), jitter(gen), jitter(gen));
+			}
+		}
+	}
+	return pos;
+}
+
+//Every particle lists itself and all particles within h, in the layout of a device list limited to maxNbr
+static void findNeighbors(HostArray<int>& size, HostArray<int>& elements, HostArray<Vector3f>& pos)
+{
+	int num = pos.size();
+	size.resize(num);
+	elements.resize(num * maxNbr);
+	for (int i = 0; i < num; i++)
+	{
+		int k = 0;
+		for (int j = 0; j < num; j++)
+		{
+			if ((pos[j] - pos[i]).norm() < h && k < maxNbr)
+			{
+				elements[i * maxNbr + k++] = j;
+			}
+		}
+		size[i] = k;
+	}
+}
+
+//The first layer of the block is a fixed wall, it gives the particles next to it a different diagonal
+static bool isWall(int id)
+{
+	return id < n * n;
+}
+
+//The block moving with random velocities, all particles but the wall are dynamic fluid particles
+static void setup(Constraint& module, Node& node)
+{
+	HostArray<Vector3f> pos = createBlock();
+	int num = pos.size();
+
+	std::mt19937 gen(5);
+	std::uniform_real_distribution<float> dist(-0.1f, 0.1f);
+
+	HostArray<Vector3f> vel(num);
+	HostArray<Vector3f> normal(num);
+	HostArray<Attribute> att(num);
+	for (int i = 0; i < num; i++)
+	{
+		vel[i] = Vector3f(dist(gen), dist(gen), dist(gen));
+		normal[i] = Vector3f(0.0f);
+		if (isWall(i))
+		{
+			att[i].SetRigid();
+			att[i].SetFixed();
+		}
+		else
+		{
+			att[i].SetFluid();
+			att[i].SetDynamic();
+		}
+	}
+
+	HostArray<int> size, elements;
+	findNeighbors(size, elements, pos);
+
+	module.m_position.setElementCount(num);
+	module.m_velocity.setElementCount(num);
+	module.m_normal.setElementCount(num);
+	module.m_attribute.setElementCount(num);
+	module.m_neighborhood.setElementCount(num, maxNbr);
+	Function1Pt::copy(module.m_position.getValue(), pos);
+	Function1Pt::copy(module.m_velocity.getValue(), vel);
+	Function1Pt::copy(module.m_normal.getValue(), normal);
+	Function1Pt::copy(module.m_attribute.getValue(), att);
+	Function1Pt::copy(module.m_neighborhood.getValue().getIndex(), size);
+	Function1Pt::copy(module.m_neighborhood.getValue().getElements(), elements);
+
+	node.setDt(0.001f);
+	module.setParent(&node);
+	ASSERT_TRUE(module.initialize());
+	module.getPressure().reset();
+
+	pos.release();
+	vel.release();
+	normal.release();
+	att.release();
+	size.release();
+	elements.release();
+}
+
+//kernWRR() of VelocityConstraint.cu
+static float pairWeight(float r)
+{
+	float q = r / h;
+	if (q > 1.0f) return 0.0f;
+
+	float w = 1.0f - pow(q, 4.0f);
+	return q < 0.4f ? w / (0.16f * h * h) : w / (r * r);
+}
+
+static float maxAbs(HostArray<float>& a)
+{
+	float m = 0.0f;
+	for (int i = 0; i < a.size(); i++)
+	{
+		m = std::max(m, std::abs(a[i]));
+	}
+	return m;
+}
+
+TEST(VelocityConstraint, cachedProduct)
+{
+	Node node;
+	Constraint module;
+	setup(module, node);
+	module.constrain();
+
+	HostArray<Vector3f> pos = createBlock();
+	int num = pos.size();
+
+	HostArray<int> size, elements;
+	findNeighbors(size, elements, pos);
+
+	HostArray<float> alpha(num), diagonal(num);
+	Function1Pt::copy(alpha, module.getAlpha());
+	Function1Pt::copy(diagonal, module.getDiagonal());
+
+	std::mt19937 gen(17);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	HostArray<float> x(num);
+	for (int i = 0; i < num; i++)
+	{
+		x[i] = dist(gen);
+	}
+
+	//The scatter product the solver applied before the pair weights were cached, the wall rows stay zero
+	HostArray<float> expected(num);
+	expected.reset();
+	for (int i = 0; i < num; i++)
+	{
+		if (isWall(i)) continue;
+
+		expected[i] += diagonal[i] * x[i];
+		for (int ne = 0; ne < size[i]; ne++)
+		{
+			int j = elements[i * maxNbr + ne];
+			float r = (pos[i] - pos[j]).norm();
+			if (r > EPSILON && !isWall(j))
+			{
+				float a_ij = -pairWeight(r) / alpha[i];
+				expected[i] += a_ij * x[j];
+				expected[j] += a_ij * x[i];
+			}
+		}
+	}
+
+	DeviceArray<float> deviceX(num), deviceY(num);
+	Function1Pt::copy(deviceX, x);
+	module.multiply(deviceY, deviceX);
+
+	HostArray<float> y(num);
+	Function1Pt::copy(y, deviceY);
+
+	float tol = 1e-5f * maxAbs(expected);
+	for (int i = 0; i < num; i++)
+	{
+		EXPECT_NEAR(y[i], expected[i], tol) << "particle " << i;
+	}
+
+	pos.release();
+	size.release();
+	elements.release();
+	alpha.release();
+	diagonal.release();
+	x.release();
+	expected.release();
+	y.release();
+	deviceX.release();
+	deviceY.release();
+}
+
+TEST(VelocityConstraint, jacobiPreconditioner)
+{
+	Node node;
+	Constraint plain, jacobi;
+	jacobi.setPreconditioner(Constraint::Jacobi);
+	setup(plain, node);
+	setup(jacobi, node);
+
+	plain.constrain();
+	jacobi.constrain();
+	EXPECT_LT(plain.getIterationNumber(), 1000);
+	EXPECT_LT(jacobi.getIterationNumber(), 1000);
+
+	int num = plain.getPressure().size();
+	HostArray<float> pPlain(num), pJacobi(num);
+	Function1Pt::copy(pPlain, plain.getPressure());
+	Function1Pt::copy(pJacobi, jacobi.getPressure());
+	ASSERT_GT(maxAbs(pPlain), 0.0f);
+
+	//Both solves stop at the same residual, so the pressures agree up to the tolerance of the solve
+	float tol = 1e-3f * maxAbs(pPlain);
+	for (int i = 0; i < num; i++)
+	{
+		EXPECT_NEAR(pJacobi[i], pPlain[i], tol) << "particle " << i;
+	}
+
+	pPlain.release();
+	pJacobi.release();
+}